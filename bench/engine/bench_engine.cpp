@@ -0,0 +1,350 @@
+// Streaming engine benchmark: replays a WAV corpus through StreamingWhisperEngine
+// the way a live session drives it, and reports speed and accuracy.
+//
+//   bench_engine --model models/ggml-small.bin --corpus corpus/
+//
+// The corpus is a directory of .wav files; a .txt next to a WAV (same stem) is
+// its reference transcript and enables WER. --wav file.wav [--ref file.txt]
+// replays a single file.
+//
+// Audio is fed in --chunk-ms chunks on a simulated clock, so a run takes only
+// the decode time: the replay polls and triggers decodes with the server's own
+// FlushPolicy (a PartialCadence stride of new audio, 2 s minimum, or 400 ms
+// after the last frame), and audio keeps "arriving" while a decode runs, so a
+// slow engine falls behind exactly as it would live. Stream end is a force commit, as in handleEnd().
+//
+// Prints one JSON line per file and a final {"summary":true,...} line:
+//   rtf                 decode wall time / audio time
+//   partial_latency_*   audio arrival -> partial result (poll lag + decode), ms
+//   commit_lag_*        end of the committed audio -> commit, ms
+//   cpu_s_per_audio_s   process CPU time (user + sys) / audio time
+//   dropped_audio_s     audio refused at the high-water mark (the engine could not keep up)
+//   wer                 word error rate vs the reference (-1 without one)
+//
+// --decode-log file.jsonl also writes every decode's window, audio_ctx, beam size
+// and wall time: flushsim (bench/sim) fits its decode-cost model to it.
+
+#include "whisper/StreamingWhisperEngine.h"
+#include "whisper/DecodeConfig.h"
+#include "server/FlushPolicy.h"
+#include "server/PartialCadence.h"
+#include "utils/AudioDecoder.h"
+#include "log/Log.h"
+#include <whisper.h>
+#include <sys/resource.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t SAMPLE_RATE = 16000;
+
+struct Args {
+    std::string model = "third_party/whisper.cpp/models/ggml-small.bin";
+    std::string corpus;
+    std::string wav;
+    std::string ref;
+    int chunk_ms = 100;
+    int threads = 4;
+    int beam_size = 1;
+    std::string language = "en";
+    bool use_gpu = true;
+    std::string decode_log; // one JSON line per decode: the cost model input of bench/sim
+};
+
+void usage(const char* bin) {
+    std::cerr << "Usage: " << bin << " [--model path] (--corpus dir | --wav file.wav [--ref file.txt])"
+              << " [--chunk-ms N] [--threads N] [--beam-size N] [--language xx] [--cpu]"
+              << " [--decode-log file.jsonl]" << std::endl;
+}
+
+struct Item {
+    fs::path wav;
+    fs::path ref; // empty = no reference
+};
+
+struct Result {
+    double audio_s = 0.0;
+    double decode_s = 0.0;
+    double cpu_s = 0.0;
+    double dropped_s = 0.0; // audio refused at the engine's high-water mark (engine too slow)
+    size_t decodes = 0;
+    std::vector<double> partial_latency_ms;
+    std::vector<double> commit_lag_ms;
+    std::string text;
+    double wer = -1.0;
+    size_t ref_words = 0;
+    size_t word_errors = 0;
+};
+
+std::string readFile(const fs::path& p) {
+    std::ifstream f(p, std::ios::binary);
+    if (!f) throw std::runtime_error("cannot open " + p.string());
+    return std::string((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+}
+
+double cpuSeconds() {
+    rusage ru{};
+    getrusage(RUSAGE_SELF, &ru);
+    auto sec = [](const timeval& tv) { return tv.tv_sec + tv.tv_usec / 1e6; };
+    return sec(ru.ru_utime) + sec(ru.ru_stime);
+}
+
+double percentile(std::vector<double> v, double q) {
+    if (v.empty()) return 0.0;
+    size_t k = std::min(static_cast<size_t>(q * v.size()), v.size() - 1);
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+// Lowercase words with punctuation stripped (apostrophes kept).
+std::vector<std::string> words(const std::string& text) {
+    std::vector<std::string> out;
+    std::string cur;
+    for (unsigned char c : text) {
+        if (std::isalnum(c) || c == '\'' || c >= 0x80) {
+            cur += static_cast<char>(c >= 0x80 ? c : std::tolower(c));
+        } else if (!cur.empty()) {
+            out.push_back(std::move(cur));
+            cur.clear();
+        }
+    }
+    if (!cur.empty()) out.push_back(std::move(cur));
+    return out;
+}
+
+// Word-level Levenshtein distance (substitutions + insertions + deletions).
+size_t editDistance(const std::vector<std::string>& ref, const std::vector<std::string>& hyp) {
+    std::vector<size_t> prev(hyp.size() + 1), cur(hyp.size() + 1);
+    for (size_t j = 0; j <= hyp.size(); ++j) prev[j] = j;
+    for (size_t i = 1; i <= ref.size(); ++i) {
+        cur[0] = i;
+        for (size_t j = 1; j <= hyp.size(); ++j) {
+            size_t sub = prev[j - 1] + (ref[i - 1] == hyp[j - 1] ? 0 : 1);
+            cur[j] = std::min({sub, prev[j] + 1, cur[j - 1] + 1});
+        }
+        std::swap(prev, cur);
+    }
+    return prev[hyp.size()];
+}
+
+std::string jsonEscape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') { out += '\\'; out += c; }
+        else if (static_cast<unsigned char>(c) < 0x20) out += ' ';
+        else out += c;
+    }
+    return out;
+}
+
+// One stream, driven like StreamingSession::flushLoop on a simulated clock.
+Result replay(whisper_context* ctx, const Args& args, const std::vector<float>& pcm, std::ostream* decode_log) {
+    StreamingWhisperEngine engine(ctx);
+    engine.setLanguage(args.language);
+    engine.setThreads(args.threads);
+    engine.setBeamSize(args.beam_size);
+    engine.setTemperature(0.0f);
+
+    const FlushPolicy policy;
+    const double poll_s = std::chrono::duration<double>(policy.pollInterval(false)).count();
+    PartialCadence cadence;
+    Result r;
+    r.audio_s = static_cast<double>(pcm.size()) / SAMPLE_RATE;
+
+    const size_t chunk = std::max<size_t>(1, SAMPLE_RATE * args.chunk_ms / 1000);
+    size_t fed = 0;                 // samples handed to the engine
+    size_t last_transcribed = 0;    // buffer size after the last decode (flushLoop's last_transcribed_size_)
+    double now = 0.0;               // simulated time, seconds since the stream started
+
+    auto feedUntil = [&](double t) {
+        // A chunk is sent once all of its audio has been captured.
+        while (fed < pcm.size() && static_cast<double>(std::min(fed + chunk, pcm.size())) / SAMPLE_RATE <= t) {
+            size_t n = std::min(chunk, pcm.size() - fed);
+            if (engine.processAudioChunk(std::vector<float>(pcm.begin() + fed, pcm.begin() + fed + n))) {
+                r.dropped_s += static_cast<double>(n) / SAMPLE_RATE;
+            }
+            fed += n;
+        }
+    };
+
+    auto decode = [&](bool force) {
+        const size_t before = engine.getBufferSize();
+        const double buffer_start_s = static_cast<double>(fed - before) / SAMPLE_RATE;
+        const double arrival_s = static_cast<double>(fed) / SAMPLE_RATE; // newest audio in the window
+
+        auto t0 = std::chrono::steady_clock::now();
+        auto res = engine.transcribeSlidingWindow(force);
+        double d = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        r.decode_s += d;
+        ++r.decodes;
+        now += d;
+        cadence.onDecode(d);
+        if (decode_log) {
+            *decode_log << "{\"window_s\":" << static_cast<double>(before) / SAMPLE_RATE
+                        << ",\"audio_ctx\":" << audioCtxFor(before) << ",\"beam_size\":" << args.beam_size
+                        << ",\"threads\":" << args.threads << ",\"final\":" << (force ? "true" : "false")
+                        << ",\"decode_s\":" << d << "}\n";
+        }
+
+        if (!force) r.partial_latency_ms.push_back((now - arrival_s) * 1000.0);
+        if (!res.committed_text.empty()) {
+            const size_t erased = before - std::min(before, engine.getBufferSize());
+            double committed_end_s = buffer_start_s + static_cast<double>(erased) / SAMPLE_RATE;
+            r.commit_lag_ms.push_back((now - committed_end_s) * 1000.0);
+            r.text += res.committed_text;
+        }
+        last_transcribed = engine.getBufferSize();
+    };
+
+    const double cpu0 = cpuSeconds();
+    while (fed < pcm.size()) {
+        now += poll_s; // flushLoop sleeps after every cycle, decode or not
+        feedUntil(now);
+
+        const size_t size = engine.getBufferSize();
+        if (!policy.hasMinimumBuffer(size)) continue;
+        cadence.update(0.0); // a lone session: no slot pressure
+        // The newest frame arrived when its audio was complete.
+        const auto since_audio = std::chrono::duration_cast<FlushPolicy::ms>(
+            std::chrono::duration<double>(now - static_cast<double>(fed) / SAMPLE_RATE));
+        if (!policy.due(size, last_transcribed, since_audio, false, cadence.strideSamples())) continue;
+        decode(false);
+    }
+    decode(true); // end-of-stream
+    r.cpu_s = cpuSeconds() - cpu0;
+    return r;
+}
+
+void printResult(const std::string& name, const Result& r) {
+    std::printf("{\"file\":\"%s\",\"audio_s\":%.2f,\"decodes\":%zu,\"rtf\":%.4f,\"cpu_s_per_audio_s\":%.4f,"
+                "\"partial_latency_p50_ms\":%.1f,\"partial_latency_p90_ms\":%.1f,\"partial_latency_p99_ms\":%.1f,"
+                "\"commit_lag_p50_ms\":%.1f,\"commit_lag_p90_ms\":%.1f,\"dropped_audio_s\":%.2f,"
+                "\"wer\":%.4f,\"ref_words\":%zu}\n",
+                jsonEscape(name).c_str(), r.audio_s, r.decodes,
+                r.audio_s > 0 ? r.decode_s / r.audio_s : 0.0,
+                r.audio_s > 0 ? r.cpu_s / r.audio_s : 0.0,
+                percentile(r.partial_latency_ms, 0.5), percentile(r.partial_latency_ms, 0.9),
+                percentile(r.partial_latency_ms, 0.99),
+                percentile(r.commit_lag_ms, 0.5), percentile(r.commit_lag_ms, 0.9),
+                r.dropped_s, r.wer, r.ref_words);
+    std::fflush(stdout);
+}
+
+std::vector<Item> collect(const Args& args) {
+    std::vector<Item> items;
+    if (!args.wav.empty()) {
+        items.push_back({args.wav, args.ref});
+        return items;
+    }
+    for (const auto& e : fs::directory_iterator(args.corpus)) {
+        if (!e.is_regular_file() || e.path().extension() != ".wav") continue;
+        fs::path ref = e.path();
+        ref.replace_extension(".txt");
+        items.push_back({e.path(), fs::exists(ref) ? ref : fs::path()});
+    }
+    std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) { return a.wav < b.wav; });
+    return items;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Args args;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--model" && i + 1 < argc) args.model = argv[++i];
+        else if (a == "--corpus" && i + 1 < argc) args.corpus = argv[++i];
+        else if (a == "--wav" && i + 1 < argc) args.wav = argv[++i];
+        else if (a == "--ref" && i + 1 < argc) args.ref = argv[++i];
+        else if (a == "--chunk-ms" && i + 1 < argc) args.chunk_ms = std::stoi(argv[++i]);
+        else if (a == "--threads" && i + 1 < argc) args.threads = std::stoi(argv[++i]);
+        else if (a == "--beam-size" && i + 1 < argc) args.beam_size = std::stoi(argv[++i]);
+        else if (a == "--language" && i + 1 < argc) args.language = argv[++i];
+        else if (a == "--cpu") args.use_gpu = false;
+        else if (a == "--decode-log" && i + 1 < argc) args.decode_log = argv[++i];
+        else { usage(argv[0]); return a == "--help" ? 0 : 1; }
+    }
+    if (args.corpus.empty() == args.wav.empty() || args.chunk_ms <= 0) { usage(argv[0]); return 1; }
+    Log::setLevel(Log::Level::WARN);
+
+    std::vector<Item> items;
+    try {
+        items = collect(args);
+    } catch (const std::exception& e) {
+        std::cerr << "Cannot read corpus: " << e.what() << std::endl;
+        return 1;
+    }
+    if (items.empty()) { std::cerr << "No .wav files found" << std::endl; return 1; }
+
+    whisper_context_params cparams = whisper_context_default_params();
+    cparams.use_gpu = args.use_gpu;
+    whisper_context* ctx = whisper_init_from_file_with_params(args.model.c_str(), cparams);
+    if (!ctx) { std::cerr << "Failed to load model: " << args.model << std::endl; return 1; }
+
+    std::ofstream decode_log;
+    if (!args.decode_log.empty()) {
+        decode_log.open(args.decode_log);
+        if (!decode_log) { std::cerr << "Cannot write " << args.decode_log << std::endl; return 1; }
+    }
+
+    int rc = 0;
+    Result total;
+    size_t files = 0;
+    for (const auto& item : items) {
+        try {
+            std::vector<float> pcm = AudioDecoder::decodeWav(readFile(item.wav));
+            Result r = replay(ctx, args, pcm, decode_log.is_open() ? &decode_log : nullptr);
+            if (!item.ref.empty()) {
+                auto ref = words(readFile(item.ref));
+                r.ref_words = ref.size();
+                r.word_errors = editDistance(ref, words(r.text));
+                r.wer = ref.empty() ? 0.0 : static_cast<double>(r.word_errors) / ref.size();
+            }
+            printResult(item.wav.filename().string(), r);
+
+            ++files;
+            total.audio_s += r.audio_s;
+            total.decode_s += r.decode_s;
+            total.cpu_s += r.cpu_s;
+            total.dropped_s += r.dropped_s;
+            total.decodes += r.decodes;
+            total.ref_words += r.ref_words;
+            total.word_errors += r.word_errors;
+            total.partial_latency_ms.insert(total.partial_latency_ms.end(),
+                                            r.partial_latency_ms.begin(), r.partial_latency_ms.end());
+            total.commit_lag_ms.insert(total.commit_lag_ms.end(), r.commit_lag_ms.begin(), r.commit_lag_ms.end());
+        } catch (const std::exception& e) {
+            std::cerr << item.wav << " failed: " << e.what() << std::endl;
+            rc = 1;
+        }
+    }
+
+    // Corpus WER weights files by their reference length.
+    if (total.ref_words > 0) total.wer = static_cast<double>(total.word_errors) / total.ref_words;
+    std::printf("{\"summary\":true,\"files\":%zu,\"audio_s\":%.2f,\"decodes\":%zu,\"rtf\":%.4f,"
+                "\"cpu_s_per_audio_s\":%.4f,\"partial_latency_p50_ms\":%.1f,\"partial_latency_p90_ms\":%.1f,"
+                "\"partial_latency_p99_ms\":%.1f,\"commit_lag_p50_ms\":%.1f,\"commit_lag_p90_ms\":%.1f,"
+                "\"dropped_audio_s\":%.2f,\"wer\":%.4f,\"ref_words\":%zu,\"threads\":%d,\"beam_size\":%d,\"chunk_ms\":%d}\n",
+                files, total.audio_s, total.decodes,
+                total.audio_s > 0 ? total.decode_s / total.audio_s : 0.0,
+                total.audio_s > 0 ? total.cpu_s / total.audio_s : 0.0,
+                percentile(total.partial_latency_ms, 0.5), percentile(total.partial_latency_ms, 0.9),
+                percentile(total.partial_latency_ms, 0.99),
+                percentile(total.commit_lag_ms, 0.5), percentile(total.commit_lag_ms, 0.9),
+                total.dropped_s, total.wer, total.ref_words, args.threads, args.beam_size, args.chunk_ms);
+
+    whisper_free(ctx);
+    Log::flush();
+    return rc;
+}
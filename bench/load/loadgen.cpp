@@ -0,0 +1,446 @@
+// End-to-end capacity test: N concurrent WebSocket sessions against a running
+// server, each streaming a WAV (or a synthetic tone) at real time or faster.
+//
+//   loadgen --url ws://localhost:9001/ --wav speech.wav --sessions 4,8,16,32 --slo-final-ms 2000
+//
+// Every stage opens its sessions (spread over --ramp-up-s), streams --seconds of
+// audio per session honouring the server's flow-control credits, sends `end`
+// and waits for the final. Measured per session, from the client's side:
+//   time to first partial    first audio sent -> first partial
+//   partial gap              time between consecutive partials (cadence)
+//   final latency            `end` sent -> final transcription
+// plus buffer_full warnings (dropped audio), credit stalls, server error codes
+// (OVERLOADED = shed by admission control) and connection errors.
+//
+// Prints one JSON line per stage and a {"summary":true,...} line with the
+// largest session count whose stage met the SLO: every session got its final,
+// and p90 final latency / p90 partial gap are within --slo-final-ms /
+// --slo-partial-gap-ms. Stops at the first failing stage unless --no-stop.
+// Plain ws:// only.
+
+#include "utils/AudioDecoder.h"
+#include <boost/asio/connect.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace beast = boost::beast;
+namespace websocket = beast::websocket;
+namespace net = boost::asio;
+using tcp = net::ip::tcp;
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Args {
+    std::string host = "localhost";
+    std::string port = "9001";
+    std::string path = "/";
+    std::string wav;
+    double seconds = 0.0;          // audio per session (0 = the WAV's length; 30 for the tone)
+    std::vector<int> sessions{1, 2, 4, 8, 16, 32};
+    int chunk_ms = 100;
+    double speed = 1.0;            // 1 = real time
+    double ramp_up_s = 5.0;
+    std::string token;
+    std::string language = "en";
+    double slo_final_ms = 2000.0;
+    double slo_partial_gap_ms = 1500.0;
+    int threads = static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+    bool stop_on_fail = true;
+};
+
+void usage(const char* bin) {
+    std::cerr << "Usage: " << bin << " [--url ws://host:port/path] [--wav file.wav] [--seconds N]"
+              << " [--sessions 1,2,4] [--chunk-ms N] [--speed X] [--ramp-up-s N] [--token T]"
+              << " [--language xx] [--slo-final-ms N] [--slo-partial-gap-ms N] [--threads N] [--no-stop]"
+              << std::endl;
+}
+
+bool parseUrl(const std::string& url, Args& args) {
+    const std::string scheme = "ws://";
+    if (url.compare(0, scheme.size(), scheme) != 0) return false;
+    std::string rest = url.substr(scheme.size());
+    auto slash = rest.find('/');
+    std::string hostport = rest.substr(0, slash);
+    args.path = slash == std::string::npos ? "/" : rest.substr(slash);
+    auto colon = hostport.rfind(':');
+    args.host = hostport.substr(0, colon);
+    if (colon != std::string::npos) args.port = hostport.substr(colon + 1);
+    return !args.host.empty();
+}
+
+std::vector<int> parseList(const std::string& s) {
+    std::vector<int> out;
+    std::stringstream ss(s);
+    for (std::string item; std::getline(ss, item, ',');) {
+        if (!item.empty()) out.push_back(std::stoi(item));
+    }
+    return out;
+}
+
+double percentile(std::vector<double> v, double q) {
+    if (v.empty()) return 0.0;
+    size_t k = std::min(static_cast<size_t>(q * v.size()), v.size() - 1);
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+double ms(Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); }
+
+// Results of one stage, filled in by its sessions.
+struct StageStats {
+    std::mutex mutex;
+    int completed = 0;             // got their final
+    int failed = 0;
+    int dropped_warnings = 0;      // buffer_full warnings
+    int credit_stalls = 0;
+    double credit_stall_s = 0.0;
+    std::vector<double> first_partial_ms;
+    std::vector<double> partial_gap_ms;
+    std::vector<double> final_ms;
+    std::map<std::string, int> errors; // server error codes and connection errors
+    int remaining = 0;                 // sessions that have not reported yet
+    std::function<void()> on_done;     // runs (on the io_context) when the last one reports
+};
+
+// One client session: connect, config, paced audio, end, final, close.
+// All handlers run on the session's strand.
+class LoadSession : public std::enable_shared_from_this<LoadSession> {
+public:
+    LoadSession(net::io_context& ioc, const Args& args, std::shared_ptr<const std::vector<float>> pcm,
+                StageStats& stats, Clock::duration start_delay)
+        : resolver_(net::make_strand(ioc)),
+          ws_(resolver_.get_executor()),
+          timer_(resolver_.get_executor()),
+          args_(args), pcm_(std::move(pcm)), stats_(stats), start_delay_(start_delay),
+          chunk_samples_(std::max<size_t>(1, 16000 * static_cast<size_t>(args.chunk_ms) / 1000)),
+          interval_(std::chrono::duration_cast<Clock::duration>(
+              std::chrono::duration<double, std::milli>(args.chunk_ms / args.speed))) {}
+
+    void start() {
+        timer_.expires_after(start_delay_);
+        timer_.async_wait([self = shared_from_this()](beast::error_code ec) {
+            if (ec) return;
+            self->resolver_.async_resolve(self->args_.host, self->args_.port,
+                beast::bind_front_handler(&LoadSession::onResolve, self));
+        });
+    }
+
+private:
+    void onResolve(beast::error_code ec, tcp::resolver::results_type results) {
+        if (ec) return fail("resolve");
+        beast::get_lowest_layer(ws_).expires_after(std::chrono::seconds(10));
+        beast::get_lowest_layer(ws_).async_connect(results,
+            beast::bind_front_handler(&LoadSession::onConnect, shared_from_this()));
+    }
+
+    void onConnect(beast::error_code ec, tcp::resolver::results_type::endpoint_type ep) {
+        if (ec) return fail("connect");
+        beast::get_lowest_layer(ws_).expires_never();
+        ws_.set_option(websocket::stream_base::timeout::suggested(beast::role_type::client));
+        ws_.async_handshake(args_.host + ":" + std::to_string(ep.port()), args_.path,
+            beast::bind_front_handler(&LoadSession::onHandshake, shared_from_this()));
+    }
+
+    void onHandshake(beast::error_code ec) {
+        if (ec) return fail("handshake");
+        json config = {{"type", "config"}, {"language", args_.language}};
+        if (!args_.token.empty()) config["token"] = args_.token;
+        send(config.dump(), true);
+        read();
+    }
+
+    void read() {
+        ws_.async_read(buffer_, beast::bind_front_handler(&LoadSession::onRead, shared_from_this()));
+    }
+
+    void onRead(beast::error_code ec, size_t) {
+        if (ec) {
+            if (!done_) fail(final_received_ ? "" : "closed_before_final");
+            return;
+        }
+        const auto now = Clock::now();
+        json msg = json::parse(beast::buffers_to_string(buffer_.data()), nullptr, false);
+        buffer_.consume(buffer_.size());
+        const std::string type = msg.is_object() ? msg.value("type", "") : "";
+
+        if (type == "ready") {
+            if (msg.contains("flow_control")) credit_limit_ = msg["flow_control"].value("limit_samples", uint64_t{0});
+            audio_start_ = now;
+            next_send_ = now;
+            scheduleChunk();
+        } else if (type == "transcription") {
+            if (msg.value("is_final", false)) {
+                final_received_ = true;
+                final_ms_ = ms(now - end_sent_);
+                ws_.async_close(websocket::close_code::normal,
+                    [self = shared_from_this()](beast::error_code) { self->finish(); });
+                return;
+            }
+            if (last_partial_) partial_gaps_.push_back(ms(now - *last_partial_));
+            else first_partial_ms_ = ms(now - audio_start_);
+            last_partial_ = now;
+        } else if (type == "credit") {
+            credit_limit_ = std::max(credit_limit_, msg.value("limit_samples", uint64_t{0}));
+            if (stalled_since_ && sent_ + chunk_samples_ <= credit_limit_) {
+                stall_s_ += std::chrono::duration<double>(now - *stalled_since_).count();
+                stalled_since_.reset();
+                next_send_ = std::max(next_send_, now);
+                scheduleChunk();
+            }
+        } else if (type == "warning") {
+            if (msg.value("code", "") == "buffer_full") ++dropped_warnings_;
+        } else if (type == "error") {
+            error_ = msg.value("code", "UNKNOWN"); // the server closes after OVERLOADED etc.
+        }
+        read();
+    }
+
+    void scheduleChunk() {
+        timer_.expires_at(next_send_);
+        timer_.async_wait(beast::bind_front_handler(&LoadSession::onChunkTimer, shared_from_this()));
+    }
+
+    void onChunkTimer(beast::error_code ec) {
+        if (ec || done_ || end_sent_ != Clock::time_point{}) return;
+        const size_t total = audioSamples();
+        if (sent_ >= total) {
+            end_sent_ = Clock::now();
+            send(json{{"type", "end"}}.dump(), true);
+            return;
+        }
+        const size_t n = std::min(chunk_samples_, total - sent_);
+        if (credit_limit_ > 0 && sent_ + n > credit_limit_) {
+            // Out of credit: hold the audio until the server grants more.
+            if (!stalled_since_) {
+                stalled_since_ = Clock::now();
+                ++stalls_;
+            }
+            return;
+        }
+        std::string bytes(n * sizeof(float), '\0');
+        const auto& pcm = *pcm_;
+        for (size_t i = 0; i < n; ++i) {
+            float s = pcm[(sent_ + i) % pcm.size()]; // loop the file up to --seconds
+            std::memcpy(&bytes[i * sizeof(float)], &s, sizeof(float));
+        }
+        send(std::move(bytes), false);
+        sent_ += n;
+        next_send_ += interval_;
+        scheduleChunk();
+    }
+
+    size_t audioSamples() const {
+        return args_.seconds > 0 ? static_cast<size_t>(args_.seconds * 16000) : pcm_->size();
+    }
+
+    void send(std::string payload, bool text) {
+        outbox_.push_back({std::move(payload), text});
+        if (outbox_.size() == 1) write();
+    }
+
+    void write() {
+        ws_.text(outbox_.front().second);
+        ws_.async_write(net::buffer(outbox_.front().first),
+            [self = shared_from_this()](beast::error_code ec, size_t) {
+                if (ec) return self->fail("write");
+                self->outbox_.pop_front();
+                if (!self->outbox_.empty()) self->write();
+            });
+    }
+
+    void fail(const std::string& what) {
+        if (error_.empty()) error_ = what;
+        finish();
+        beast::error_code ignored;
+        beast::get_lowest_layer(ws_).socket().close(ignored);
+        timer_.cancel();
+    }
+
+    void finish() {
+        if (done_) return;
+        done_ = true;
+        std::lock_guard<std::mutex> lock(stats_.mutex);
+        if (final_received_) {
+            ++stats_.completed;
+            stats_.final_ms.push_back(final_ms_);
+        } else {
+            ++stats_.failed;
+        }
+        if (!error_.empty()) ++stats_.errors[error_];
+        if (first_partial_ms_ >= 0) stats_.first_partial_ms.push_back(first_partial_ms_);
+        stats_.partial_gap_ms.insert(stats_.partial_gap_ms.end(), partial_gaps_.begin(), partial_gaps_.end());
+        stats_.dropped_warnings += dropped_warnings_;
+        stats_.credit_stalls += stalls_;
+        stats_.credit_stall_s += stall_s_;
+        if (--stats_.remaining == 0 && stats_.on_done) stats_.on_done();
+    }
+
+    tcp::resolver resolver_;
+    websocket::stream<beast::tcp_stream> ws_;
+    net::steady_timer timer_;
+    beast::flat_buffer buffer_;
+    std::deque<std::pair<std::string, bool>> outbox_; // payload, is_text
+
+    const Args& args_;
+    std::shared_ptr<const std::vector<float>> pcm_;
+    StageStats& stats_;
+    Clock::duration start_delay_;
+    size_t chunk_samples_;
+    Clock::duration interval_;
+
+    uint64_t credit_limit_ = 0;   // 0 = server does not advertise credits
+    size_t sent_ = 0;
+    Clock::time_point audio_start_, next_send_, end_sent_;
+    std::optional<Clock::time_point> last_partial_, stalled_since_;
+    double first_partial_ms_ = -1.0;
+    double final_ms_ = 0.0;
+    std::vector<double> partial_gaps_;
+    int dropped_warnings_ = 0;
+    int stalls_ = 0;
+    double stall_s_ = 0.0;
+    bool final_received_ = false;
+    bool done_ = false;
+    std::string error_;
+};
+
+// Tone bursts with short pauses (no --wav): keeps the server decoding.
+std::vector<float> syntheticAudio(double seconds) {
+    std::vector<float> pcm(static_cast<size_t>(seconds * 16000));
+    for (size_t i = 0; i < pcm.size(); ++i) {
+        bool voiced = (i / 16000) % 4 != 3;
+        pcm[i] = voiced ? 0.3f * std::sin(2.0f * static_cast<float>(M_PI) * 220.0f * static_cast<float>(i) / 16000.0f)
+                        : 0.0f;
+    }
+    return pcm;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Args args;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--url" && i + 1 < argc) {
+            if (!parseUrl(argv[++i], args)) { std::cerr << "Only ws://host:port/path URLs are supported" << std::endl; return 1; }
+        }
+        else if (a == "--wav" && i + 1 < argc) args.wav = argv[++i];
+        else if (a == "--seconds" && i + 1 < argc) args.seconds = std::stod(argv[++i]);
+        else if (a == "--sessions" && i + 1 < argc) args.sessions = parseList(argv[++i]);
+        else if (a == "--chunk-ms" && i + 1 < argc) args.chunk_ms = std::stoi(argv[++i]);
+        else if (a == "--speed" && i + 1 < argc) args.speed = std::stod(argv[++i]);
+        else if (a == "--ramp-up-s" && i + 1 < argc) args.ramp_up_s = std::stod(argv[++i]);
+        else if (a == "--token" && i + 1 < argc) args.token = argv[++i];
+        else if (a == "--language" && i + 1 < argc) args.language = argv[++i];
+        else if (a == "--slo-final-ms" && i + 1 < argc) args.slo_final_ms = std::stod(argv[++i]);
+        else if (a == "--slo-partial-gap-ms" && i + 1 < argc) args.slo_partial_gap_ms = std::stod(argv[++i]);
+        else if (a == "--threads" && i + 1 < argc) args.threads = std::stoi(argv[++i]);
+        else if (a == "--no-stop") args.stop_on_fail = false;
+        else { usage(argv[0]); return a == "--help" ? 0 : 1; }
+    }
+    if (args.chunk_ms <= 0 || args.speed <= 0 || args.threads <= 0) { usage(argv[0]); return 1; }
+
+    std::vector<float> pcm;
+    if (!args.wav.empty()) {
+        std::ifstream f(args.wav, std::ios::binary);
+        if (!f) { std::cerr << "Cannot open " << args.wav << std::endl; return 1; }
+        std::string bytes((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+        try {
+            pcm = AudioDecoder::decodeWav(bytes);
+        } catch (const std::exception& e) {
+            std::cerr << "Invalid WAV: " << e.what() << std::endl;
+            return 1;
+        }
+    } else {
+        pcm = syntheticAudio(args.seconds > 0 ? args.seconds : 30.0);
+    }
+    if (pcm.empty()) { std::cerr << "No audio" << std::endl; return 1; }
+    auto audio = std::make_shared<const std::vector<float>>(std::move(pcm));
+    const double audio_s = args.seconds > 0 ? args.seconds : static_cast<double>(audio->size()) / 16000.0;
+
+    int best = 0;
+    for (int n : args.sessions) {
+        if (n <= 0) continue;
+        StageStats stats;
+        stats.remaining = n;
+        net::io_context ioc;
+        auto t0 = Clock::now();
+        for (int i = 0; i < n; ++i) {
+            auto delay = std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(args.ramp_up_s * i / n));
+            std::make_shared<LoadSession>(ioc, args, audio, stats, delay)->start();
+        }
+
+        // Sessions that are still running long after their audio ended are stuck: stop the stage.
+        net::steady_timer deadline(ioc, std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(args.ramp_up_s + audio_s / args.speed + 120.0)));
+        deadline.async_wait([&ioc](beast::error_code ec) { if (!ec) ioc.stop(); });
+        stats.on_done = [&ioc, &deadline] { net::post(ioc, [&deadline] { deadline.cancel(); }); };
+
+        std::vector<std::thread> pool;
+        for (int t = 0; t < args.threads; ++t) pool.emplace_back([&ioc] { ioc.run(); });
+        for (auto& t : pool) t.join();
+        const double wall_s = std::chrono::duration<double>(Clock::now() - t0).count();
+
+        std::lock_guard<std::mutex> lock(stats.mutex);
+        if (stats.remaining > 0) stats.errors["timeout"] += stats.remaining;
+
+        const double final_p90 = percentile(stats.final_ms, 0.9);
+        const double gap_p90 = percentile(stats.partial_gap_ms, 0.9);
+        const bool pass = stats.completed == n && final_p90 <= args.slo_final_ms && gap_p90 <= args.slo_partial_gap_ms;
+        if (pass) best = std::max(best, n);
+
+        json line = {
+            {"sessions", n},
+            {"completed", stats.completed},
+            {"failed", n - stats.completed},
+            {"wall_s", wall_s},
+            {"first_partial_ms", {{"p50", percentile(stats.first_partial_ms, 0.5)},
+                                  {"p90", percentile(stats.first_partial_ms, 0.9)},
+                                  {"p99", percentile(stats.first_partial_ms, 0.99)}}},
+            {"partial_gap_ms", {{"p50", percentile(stats.partial_gap_ms, 0.5)},
+                                {"p90", gap_p90},
+                                {"p99", percentile(stats.partial_gap_ms, 0.99)}}},
+            {"final_ms", {{"p50", percentile(stats.final_ms, 0.5)},
+                          {"p90", final_p90},
+                          {"p99", percentile(stats.final_ms, 0.99)}}},
+            {"dropped_warnings", stats.dropped_warnings},
+            {"credit_stalls", stats.credit_stalls},
+            {"credit_stall_s", stats.credit_stall_s},
+            {"errors", stats.errors},
+            {"slo_met", pass}
+        };
+        std::cout << line.dump() << std::endl;
+        if (!pass && args.stop_on_fail) break;
+    }
+
+    std::cout << json{{"summary", true},
+                      {"max_sessions_meeting_slo", best},
+                      {"slo_final_ms", args.slo_final_ms},
+                      {"slo_partial_gap_ms", args.slo_partial_gap_ms},
+                      {"audio_s_per_session", audio_s},
+                      {"speed", args.speed}}.dump() << std::endl;
+    return 0;
+}
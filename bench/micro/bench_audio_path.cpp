@@ -0,0 +1,103 @@
+#include <benchmark/benchmark.h>
+#include "whisper/StreamingWhisperEngine.h"
+#include "utils/AudioPreprocessor.h"
+#include <whisper.h>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Per-chunk audio path: what handleBinaryMessage does for every frame a client
+// sends. Arguments are chunk lengths in ms (20 ms frames from browsers up to
+// 500 ms batches from file uploaders), 16 kHz mono.
+
+#ifndef PROJECT_ROOT
+#define PROJECT_ROOT "."
+#endif
+
+namespace {
+
+constexpr int64_t kChunkMs[] = {20, 100, 250, 500};
+
+size_t samplesFor(int64_t ms) { return static_cast<size_t>(ms) * 16; }
+
+std::vector<float> speechLike(size_t n) {
+    std::vector<float> v(n);
+    for (size_t i = 0; i < n; ++i) {
+        float t = static_cast<float>(i) / 16000.0f;
+        v[i] = 0.2f * std::sin(2.0f * 3.14159265f * 180.0f * t) + 0.05f * std::sin(2.0f * 3.14159265f * 2400.0f * t);
+    }
+    return v;
+}
+
+void chunkArgs(benchmark::internal::Benchmark* b) {
+    for (int64_t ms : kChunkMs) b->Arg(ms);
+    b->ArgName("chunk_ms");
+}
+
+// Shared context for the engine benchmarks; null (and the benchmark skipped) without a model.
+whisper_context* benchContext() {
+    static whisper_context* ctx = [] () -> whisper_context* {
+        const char* env = std::getenv("MICROBENCH_MODEL");
+        std::string path = env ? env : std::string(PROJECT_ROOT) + "/third_party/whisper.cpp/models/ggml-small.bin";
+        if (!std::filesystem::exists(path)) return nullptr;
+        whisper_context_params p = whisper_context_default_params();
+        p.use_gpu = false;
+        return whisper_init_from_file_with_params(path.c_str(), p);
+    }();
+    return ctx;
+}
+
+} // namespace
+
+// High-pass + normalization, in place (the engine runs it on its own copy of each chunk).
+static void BM_AudioPreprocessor_Process(benchmark::State& state) {
+    std::vector<float> pcm = speechLike(samplesFor(state.range(0)));
+    float prev_raw = 0.0f, prev_filtered = 0.0f;
+    for (auto _ : state) {
+        AudioPreprocessor::process(pcm, prev_raw, prev_filtered);
+        benchmark::DoNotOptimize(pcm.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(pcm.size()));
+}
+BENCHMARK(BM_AudioPreprocessor_Process)->Apply(chunkArgs);
+
+// Wire bytes (int16 LE) to float32.
+static void BM_ConvertBytesToFloat32(benchmark::State& state) {
+    const size_t n = samplesFor(state.range(0));
+    std::vector<uint8_t> bytes(n * 2);
+    for (size_t i = 0; i < bytes.size(); ++i) bytes[i] = static_cast<uint8_t>(i * 31);
+    for (auto _ : state) {
+        auto pcm = StreamingWhisperEngine::convertBytesToFloat32(bytes);
+        benchmark::DoNotOptimize(pcm.data());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes.size()));
+}
+BENCHMARK(BM_ConvertBytesToFloat32)->Apply(chunkArgs);
+
+// Buffer append (copy + preprocess + insert) in the streaming steady state: once
+// the buffer reaches the 10 s commit window the committed audio is erased from
+// the front, keeping the 2 s overlap, as transcribeSlidingWindow() does.
+static void BM_ProcessAudioChunk(benchmark::State& state) {
+    whisper_context* ctx = benchContext();
+    if (!ctx) {
+        state.SkipWithError("no model (set MICROBENCH_MODEL)");
+        return;
+    }
+    StreamingWhisperEngine engine(ctx);
+    const std::vector<float> chunk = speechLike(samplesFor(state.range(0)));
+    int64_t trims = 0;
+    for (auto _ : state) {
+        engine.processAudioChunk(chunk);
+        if (engine.getBufferSize() >= StreamingWhisperEngine::COMMIT_WINDOW_SAMPLES) {
+            engine.reset(32000);
+            ++trims;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(chunk.size()));
+    state.counters["trims"] = static_cast<double>(trims);
+}
+BENCHMARK(BM_ProcessAudioChunk)->Apply(chunkArgs);
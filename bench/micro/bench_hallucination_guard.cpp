@@ -0,0 +1,120 @@
+#include <benchmark/benchmark.h>
+#include "utils/HallucinationGuard.h"
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// isHallucination() speed and agreement with the previous istringstream /
+// unordered_map implementation (kept here as the reference).
+
+namespace {
+
+bool legacyIsHallucination(const std::string& text) {
+    if (text.length() > 500) return true;
+
+    std::istringstream ss(text);
+    std::unordered_map<std::string, int> bigrams;
+    std::string prev, cur;
+    int consec = 0;
+
+    while (ss >> cur) {
+        if (cur == prev) {
+            if (++consec >= 4) return true;
+        } else {
+            consec = 1;
+        }
+        if (!prev.empty() && ++bigrams[prev + ' ' + cur] >= 4) return true;
+        prev = cur;
+    }
+    return false;
+}
+
+const std::string kNormal =
+    " El motor de transcripción procesa el audio en tiempo real usando una ventana"
+    " deslizante con commit semántico basado en los timestamps de los segmentos.";
+
+const std::string kLoop =
+    " la verdad es que la verdad es que la verdad es que la verdad es que no sé";
+
+// Mix of normal text and injected loops from a small vocabulary, so that
+// repeated words and bigrams occur both by chance and by construction.
+std::vector<std::string> makeCorpus(size_t n) {
+    static const char* vocab[] = {
+        "el", "la", "de", "que", "y", "en", "un", "es", "se", "no", "te", "lo",
+        "le", "da", "su", "por", "son", "con", "para", "una", "audio", "motor",
+        "verdad", "gracias", "hola", "tiempo", "real", "ventana", "segmento"};
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> word(0, sizeof(vocab) / sizeof(vocab[0]) - 1);
+    std::uniform_int_distribution<int> len(1, 60);
+    std::uniform_int_distribution<int> loop(0, 4);
+
+    std::vector<std::string> corpus;
+    corpus.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        std::string text;
+        int words = len(rng);
+        for (int w = 0; w < words; ++w) {
+            text += ' ';
+            text += vocab[word(rng)];
+        }
+        if (loop(rng) == 0) {
+            std::string unit = std::string(" ") + vocab[word(rng)] + " " + vocab[word(rng)];
+            for (int r = 0; r < 4; ++r) text += unit;
+        }
+        corpus.push_back(std::move(text));
+    }
+    return corpus;
+}
+
+} // namespace
+
+static void BM_Hallucination_Legacy_Normal(benchmark::State& state) {
+    for (auto _ : state) benchmark::DoNotOptimize(legacyIsHallucination(kNormal));
+}
+BENCHMARK(BM_Hallucination_Legacy_Normal);
+
+static void BM_Hallucination_Normal(benchmark::State& state) {
+    for (auto _ : state) benchmark::DoNotOptimize(isHallucination(kNormal));
+}
+BENCHMARK(BM_Hallucination_Normal);
+
+static void BM_Hallucination_Legacy_Loop(benchmark::State& state) {
+    for (auto _ : state) benchmark::DoNotOptimize(legacyIsHallucination(kLoop));
+}
+BENCHMARK(BM_Hallucination_Legacy_Loop);
+
+static void BM_Hallucination_Loop(benchmark::State& state) {
+    for (auto _ : state) benchmark::DoNotOptimize(isHallucination(kLoop));
+}
+BENCHMARK(BM_Hallucination_Loop);
+
+// Per-commit cost of the cross-commit tracker (check + append), steady state.
+static void BM_HallucinationTracker_CheckAppend(benchmark::State& state) {
+    HallucinationTracker tracker;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tracker.check(kNormal));
+        tracker.append(kNormal.substr(0, 40));
+    }
+}
+BENCHMARK(BM_HallucinationTracker_CheckAppend);
+
+// Runs both implementations over a synthetic corpus; reports the verdict
+// agreement ratio (expected 1.0) and the number of positives found.
+static void BM_Hallucination_Agreement(benchmark::State& state) {
+    static const std::vector<std::string> corpus = makeCorpus(2000);
+    size_t agree = 0, positives = 0, total = 0;
+    for (auto _ : state) {
+        for (const auto& text : corpus) {
+            bool a = legacyIsHallucination(text);
+            bool b = isHallucination(text);
+            agree     += (a == b);
+            positives += b;
+            ++total;
+        }
+    }
+    state.counters["agreement"] = static_cast<double>(agree) / static_cast<double>(total);
+    state.counters["positive_rate"] = static_cast<double>(positives) / static_cast<double>(total);
+}
+BENCHMARK(BM_Hallucination_Agreement)->Iterations(5);
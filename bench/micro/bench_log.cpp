@@ -0,0 +1,105 @@
+#include <benchmark/benchmark.h>
+#include "log/Log.h"
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+// Per-call cost of logging on the flushLoop hot path.
+//
+// Legacy* benchmarks reproduce the previous synchronous logger (global mutex,
+// std::put_time timestamp, std::endl flush) writing to /dev/null, as a baseline.
+
+namespace {
+
+std::FILE* devNull() {
+    static std::FILE* f = std::fopen("/dev/null", "w");
+    return f;
+}
+
+std::ostream& legacyStream() {
+    static std::ofstream sink("/dev/null");
+    return sink;
+}
+
+void legacyWrite(const std::string& msg, const std::string& ctx) {
+    static std::mutex mx;
+    std::lock_guard<std::mutex> lk(mx);
+
+    auto now  = std::chrono::system_clock::now();
+    auto ms   = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
+    auto time = std::chrono::system_clock::to_time_t(now);
+    std::ostringstream oss;
+    std::tm tm{};
+    localtime_r(&time, &tm);
+    oss << std::put_time(&tm, "%H:%M:%S") << '.' << std::setfill('0') << std::setw(3) << ms.count();
+
+    auto& out = legacyStream();
+    out << oss.str() << " [INFO] ";
+    if (!ctx.empty()) out << " [" << ctx << "]";
+    out << " " << msg << std::endl;
+}
+
+struct LogSetup {
+    LogSetup(Log::Level level) {
+        Log::setOutput(devNull(), devNull());
+        Log::setLevel(level);
+    }
+    ~LogSetup() {
+        Log::flush();
+        Log::setOutput(stdout, stderr);
+        Log::configureFromEnv();
+    }
+};
+
+const std::string kSession = "session-1792337000134-8382";
+
+} // namespace
+
+// Previous behaviour: message is always built, then written under a mutex.
+static void BM_Legacy_InfoSync(benchmark::State& state) {
+    size_t n = 4000;
+    for (auto _ : state) {
+        legacyWrite("flushLoop inference: new=" + std::to_string(n) + " silence_ms=" + std::to_string(120), kSession);
+    }
+}
+BENCHMARK(BM_Legacy_InfoSync)->ThreadRange(1, 4)->UseRealTime();
+
+// DEBUG disabled, eager string: caller still pays for building the message.
+static void BM_Log_DebugDisabledEager(benchmark::State& state) {
+    LogSetup setup(Log::Level::INFO);
+    size_t n = 4000;
+    for (auto _ : state) {
+        Log::debug("flushLoop inference: new=" + std::to_string(n) + " silence_ms=" + std::to_string(120), kSession);
+    }
+}
+BENCHMARK(BM_Log_DebugDisabledEager);
+
+// DEBUG disabled, lazy callable: only the level check runs.
+static void BM_Log_DebugDisabledLazy(benchmark::State& state) {
+    LogSetup setup(Log::Level::INFO);
+    size_t n = 4000;
+    for (auto _ : state) {
+        Log::debug([&] {
+            return "flushLoop inference: new=" + std::to_string(n) + " silence_ms=" + std::to_string(120);
+        }, kSession);
+    }
+}
+BENCHMARK(BM_Log_DebugDisabledLazy);
+
+// Enabled record: build + lock-free enqueue; formatting happens on the writer thread.
+static void BM_Log_InfoAsync(benchmark::State& state) {
+    std::unique_ptr<LogSetup> setup;
+    if (state.thread_index() == 0) setup = std::make_unique<LogSetup>(Log::Level::INFO);
+    size_t n = 4000;
+    for (auto _ : state) {
+        Log::info("flushLoop inference: new=" + std::to_string(n) + " silence_ms=" + std::to_string(120), kSession);
+    }
+}
+BENCHMARK(BM_Log_InfoAsync)->ThreadRange(1, 4)->UseRealTime();
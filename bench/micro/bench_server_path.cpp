@@ -0,0 +1,86 @@
+#include <benchmark/benchmark.h>
+#include "auth/AuthCache.h"
+#include "server/ConnectionLimiter.h"
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+// Server-side per-message and per-connection costs under thread contention:
+// auth cache hits and inserts, connection slot accounting, and the JSON a
+// session builds for every partial (sendMessage).
+
+namespace {
+
+constexpr size_t kTokens = 1000;
+
+const std::vector<std::string>& tokens() {
+    static const std::vector<std::string> t = [] {
+        std::vector<std::string> v;
+        for (size_t i = 0; i < kTokens; ++i) v.push_back("tok_" + std::to_string(i) + "_a8f3c1e9d2b74f60");
+        return v;
+    }();
+    return t;
+}
+
+AuthCache& warmCache() {
+    static AuthCache* cache = [] {
+        auto* c = new AuthCache(10000, 3600);
+        for (const auto& t : tokens()) c->put(t, true, 3600);
+        return c;
+    }();
+    return *cache;
+}
+
+} // namespace
+
+// Cache hit: SHA-256 of the token + sharded LRU touch.
+static void BM_AuthCache_LookupHit(benchmark::State& state) {
+    AuthCache& cache = warmCache();
+    size_t i = static_cast<size_t>(state.thread_index()) * 7919;
+    for (auto _ : state) {
+        auto r = cache.lookup(tokens()[i++ % kTokens]);
+        benchmark::DoNotOptimize(r);
+    }
+}
+BENCHMARK(BM_AuthCache_LookupHit)->ThreadRange(1, 16)->UseRealTime();
+
+// Insert / overwrite (cache-miss path after the auth API answers).
+static void BM_AuthCache_Put(benchmark::State& state) {
+    AuthCache& cache = warmCache();
+    size_t i = static_cast<size_t>(state.thread_index()) * 7919;
+    for (auto _ : state) {
+        cache.put(tokens()[i++ % kTokens], true, 3600);
+    }
+}
+BENCHMARK(BM_AuthCache_Put)->ThreadRange(1, 16)->UseRealTime();
+
+// Connection admission: one acquire + release per iteration. Arg 0 = every
+// thread from its own IP, 1 = all from one IP (NAT / load balancer).
+static void BM_ConnectionLimiter_AcquireRelease(benchmark::State& state) {
+    static ConnectionLimiter limiter(100000, 100000);
+    const std::string ip = state.range(0) ? "10.0.0.1" : "10.0.1." + std::to_string(state.thread_index());
+    for (auto _ : state) {
+        if (limiter.tryAcquire(ip)) limiter.release(ip);
+    }
+}
+BENCHMARK(BM_ConnectionLimiter_AcquireRelease)->ArgName("shared_ip")->Arg(0)->Arg(1)
+    ->ThreadRange(1, 16)->UseRealTime();
+
+// A partial message: the text is the whole transcript so far plus the partial,
+// so it grows with the session. Arg = text length in bytes.
+static void BM_TranscriptionMessage_Json(benchmark::State& state) {
+    std::string text;
+    while (text.size() < static_cast<size_t>(state.range(0))) text += " la transcripcion en tiempo real"; // ASCII: resize() must not split a UTF-8 sequence
+    text.resize(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        nlohmann::json msg = {
+            {"type", "transcription"},
+            {"text", text},
+            {"is_final", false}
+        };
+        std::string str = msg.dump();
+        benchmark::DoNotOptimize(str.data());
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TranscriptionMessage_Json)->ArgName("text_bytes")->Arg(64)->Arg(1024)->Arg(16384);
@@ -0,0 +1,225 @@
+// Model cold start and memory per process: load time, RSS and PSS of N worker
+// processes loading the same model at once, for each MODEL_LOAD mode.
+//
+//   bench_model_load --model models/ggml-medium.bin --load read,mmap --processes 1,4 --cold
+//
+// Each run forks --processes children; every child loads the model through
+// ModelCache (as the server does), waits until all siblings have loaded, then
+// samples its memory, so shared pages are split N ways in PSS. --cold evicts
+// the file from the page cache before each run (posix_fadvise DONTNEED: works
+// without root for clean pages), i.e. a first start after boot or deploy.
+//
+// Prints one JSON line per process and a {"summary":true,...} line per run:
+//   load_s        wall time of ModelCache::acquire (file read + tensor setup + probe state)
+//   rss_anon_mb   private memory: whisper's copy of the weights, states
+//   rss_file_mb   file pages still mapped (mmap drops them once loaded)
+//   pss_mb        proportional set size; pss_total_mb is what N workers cost the host
+
+#include "whisper/ModelCache.h"
+#include "utils/ProcessMemory.h"
+#include "log/Log.h"
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Args {
+    std::string model = "third_party/whisper.cpp/models/ggml-small.bin";
+    std::vector<std::string> loads{"read", "mmap"};
+    std::vector<int> processes{1};
+    bool cold = false;
+    bool use_gpu = true;
+};
+
+struct Sample {
+    double load_s = 0.0;
+    procmem::Usage mem;
+};
+
+void usage(const char* bin) {
+    std::cerr << "Usage: " << bin << " [--model path] [--load read,mmap] [--processes 1,4] [--cold] [--cpu]"
+              << std::endl;
+}
+
+std::vector<std::string> splitList(const std::string& s) {
+    std::vector<std::string> out;
+    std::stringstream ss(s);
+    for (std::string item; std::getline(ss, item, ',');) {
+        if (!item.empty()) out.push_back(item);
+    }
+    return out;
+}
+
+void evict(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    ::fdatasync(fd);
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+}
+
+bool readAll(int fd, void* buf, size_t n) {
+    auto* p = static_cast<char*>(buf);
+    while (n > 0) {
+        const ssize_t r = ::read(fd, p, n);
+        if (r <= 0) return false;
+        p += r;
+        n -= static_cast<size_t>(r);
+    }
+    return true;
+}
+
+// Child: load, report "loaded", wait for the siblings, sample memory, report it,
+// then hold the model until the parent has every sample.
+[[noreturn]] void child(const Args& args, ModelCache::LoadMode mode, int to_parent, int go, int done) {
+    Sample s;
+    std::cout.rdbuf(std::cerr.rdbuf()); // ModelCache logs to stdout; keep it JSON only
+    try {
+        ModelCache::instance().configure(-1);
+        ModelCache::instance().setLoadMode(mode);
+        ModelCache::instance().acquire(args.model, args.use_gpu);
+        s.load_s = ModelCache::instance().loadSeconds();
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        s.load_s = -1.0;
+    }
+    char c = 'L';
+    if (::write(to_parent, &c, 1) != 1) ::_exit(1);
+    readAll(go, &c, 1);
+    s.mem = procmem::read();
+    if (::write(to_parent, &s, sizeof s) != static_cast<ssize_t>(sizeof s)) ::_exit(1);
+    readAll(done, &c, 1); // EOF when the parent is done
+    ::_exit(s.load_s < 0 ? 1 : 0);
+}
+
+int run(const Args& args, const std::string& load, int n) {
+    const auto mode = ModelCache::parseLoadMode(load);
+    if (args.cold) evict(args.model);
+
+    int go[2], done[2];
+    if (::pipe(go) != 0) return 1;
+    if (::pipe(done) != 0) {
+        ::close(go[0]);
+        ::close(go[1]);
+        return 1;
+    }
+    std::vector<int> from_child;
+    std::vector<pid_t> pids;
+    // Children already forked block on `done` (or on a full pipe): closing every
+    // write end lets them exit, then they are reaped.
+    auto abort_run = [&](const char* what) {
+        std::perror(what);
+        ::close(go[0]);
+        ::close(go[1]);
+        ::close(done[0]);
+        ::close(done[1]);
+        for (int fd : from_child) ::close(fd);
+        for (pid_t pid : pids) ::waitpid(pid, nullptr, 0);
+        return 1;
+    };
+    for (int i = 0; i < n; ++i) {
+        int p[2];
+        if (::pipe(p) != 0) return abort_run("pipe");
+        const pid_t pid = ::fork();
+        if (pid < 0) {
+            ::close(p[0]);
+            ::close(p[1]);
+            return abort_run("fork");
+        }
+        if (pid == 0) {
+            ::close(p[0]);
+            ::close(go[1]);
+            ::close(done[1]);
+            child(args, mode, p[1], go[0], done[0]);
+        }
+        ::close(p[1]);
+        from_child.push_back(p[0]);
+        pids.push_back(pid);
+    }
+    ::close(go[0]);
+    ::close(done[0]);
+
+    char c;
+    for (int fd : from_child) readAll(fd, &c, 1);            // all loaded
+    for (int i = 0; i < n; ++i) {
+        if (::write(go[1], "g", 1) != 1) return 1;          // sample together
+    }
+    std::vector<Sample> samples(n);
+    int rc = 0;
+    for (int i = 0; i < n; ++i) {
+        if (!readAll(from_child[i], &samples[i], sizeof(Sample))) rc = 1;
+        ::close(from_child[i]);
+    }
+    ::close(go[1]);
+    ::close(done[1]);                                        // let them exit
+    for (pid_t pid : pids) {
+        int status = 0;
+        ::waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) rc = 1;
+    }
+
+    constexpr double MB = 1024.0 * 1024.0;
+    double load_sum = 0.0, load_max = 0.0, pss_total = 0.0, rss_total = 0.0;
+    for (int i = 0; i < n; ++i) {
+        const Sample& s = samples[i];
+        std::printf("{\"load\":\"%s\",\"processes\":%d,\"process\":%d,\"load_s\":%.3f,\"rss_mb\":%.1f,"
+                    "\"rss_anon_mb\":%.1f,\"rss_file_mb\":%.1f,\"pss_mb\":%.1f}\n",
+                    load.c_str(), n, i, s.load_s, s.mem.rss / MB, s.mem.rss_anon / MB, s.mem.rss_file / MB,
+                    s.mem.pss / MB);
+        load_sum += s.load_s;
+        load_max = std::max(load_max, s.load_s);
+        pss_total += s.mem.pss / MB;
+        rss_total += s.mem.rss / MB;
+    }
+    std::printf("{\"summary\":true,\"load\":\"%s\",\"processes\":%d,\"cold\":%s,\"load_s_mean\":%.3f,"
+                "\"load_s_max\":%.3f,\"rss_total_mb\":%.1f,\"pss_total_mb\":%.1f}\n",
+                load.c_str(), n, args.cold ? "true" : "false", load_sum / n, load_max, rss_total, pss_total);
+    std::fflush(stdout);
+    return rc;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Args args;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--model" && i + 1 < argc) args.model = argv[++i];
+        else if (a == "--load" && i + 1 < argc) args.loads = splitList(argv[++i]);
+        else if (a == "--processes" && i + 1 < argc) {
+            args.processes.clear();
+            for (const auto& p : splitList(argv[++i])) args.processes.push_back(std::stoi(p));
+        }
+        else if (a == "--cold") args.cold = true;
+        else if (a == "--cpu") args.use_gpu = false;
+        else { usage(argv[0]); return a == "--help" ? 0 : 1; }
+    }
+    for (const auto& l : args.loads) {
+        try {
+            ModelCache::parseLoadMode(l);
+        } catch (const std::invalid_argument& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+    if (args.loads.empty() || args.processes.empty() ||
+        std::any_of(args.processes.begin(), args.processes.end(), [](int n) { return n <= 0; })) {
+        usage(argv[0]);
+        return 1;
+    }
+    Log::setLevel(Log::Level::WARN);
+    std::fflush(stdout);
+
+    int rc = 0;
+    for (int n : args.processes) {
+        for (const auto& load : args.loads) rc |= run(args, load, n);
+    }
+    return rc;
+}
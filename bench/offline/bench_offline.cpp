@@ -0,0 +1,142 @@
+// Offline (POST /v1/transcribe) throughput: audio-hours transcribed per wall-hour.
+//
+// Runs OfflineTranscriber over a WAV file (or synthetic speech-like audio) once
+// per parallelism level and prints one JSON line per run, e.g.
+//
+//   bench_offline --model models/ggml-small.bin --wav meeting.wav --parallel 1,2,4
+//
+// Throughput scales with --parallel until the cores (or GPU) saturate; compare
+// against --parallel 1 to see what chunked decoding buys on this machine.
+
+#include "whisper/OfflineTranscriber.h"
+#include "whisper/WhisperStatePool.h"
+#include "whisper/InferenceLimiter.h"
+#include "utils/AudioDecoder.h"
+#include "log/Log.h"
+#include <whisper.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Args {
+    std::string model = "third_party/whisper.cpp/models/ggml-small.bin";
+    std::string wav;
+    double seconds = 300.0; // synthetic audio length when no --wav
+    std::vector<int> parallel{1, 2, 4};
+    int threads = 4;
+    int beam_size = 1;
+    std::string language = "en";
+    bool use_gpu = true;
+};
+
+void usage(const char* bin) {
+    std::cerr << "Usage: " << bin << " [--model path] [--wav file.wav | --seconds N]"
+              << " [--parallel 1,2,4] [--threads N] [--beam-size N] [--language xx] [--cpu]" << std::endl;
+}
+
+std::vector<int> parseList(const std::string& s) {
+    std::vector<int> out;
+    std::stringstream ss(s);
+    for (std::string item; std::getline(ss, item, ',');) {
+        if (!item.empty()) out.push_back(std::stoi(item));
+    }
+    return out;
+}
+
+// Tone bursts of 2-6s separated by short pauses, so the splitter has cut points.
+std::vector<float> syntheticAudio(double seconds) {
+    std::vector<float> pcm(static_cast<size_t>(seconds * 16000));
+    size_t i = 0, burst = 0;
+    while (i < pcm.size()) {
+        size_t voiced = 16000 * (2 + burst % 5);
+        size_t pause  = 16000 * (3 + burst % 3) / 10;
+        for (size_t k = 0; k < voiced && i < pcm.size(); ++k, ++i) {
+            float f = 180.0f + 40.0f * static_cast<float>(burst % 4);
+            pcm[i] = 0.3f * std::sin(2.0f * static_cast<float>(M_PI) * f * static_cast<float>(i) / 16000.0f);
+        }
+        i += std::min(pause, pcm.size() - i);
+        ++burst;
+    }
+    return pcm;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Args args;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--model" && i + 1 < argc) args.model = argv[++i];
+        else if (a == "--wav" && i + 1 < argc) args.wav = argv[++i];
+        else if (a == "--seconds" && i + 1 < argc) args.seconds = std::stod(argv[++i]);
+        else if (a == "--parallel" && i + 1 < argc) args.parallel = parseList(argv[++i]);
+        else if (a == "--threads" && i + 1 < argc) args.threads = std::stoi(argv[++i]);
+        else if (a == "--beam-size" && i + 1 < argc) args.beam_size = std::stoi(argv[++i]);
+        else if (a == "--language" && i + 1 < argc) args.language = argv[++i];
+        else if (a == "--cpu") args.use_gpu = false;
+        else { usage(argv[0]); return a == "--help" ? 0 : 1; }
+    }
+    Log::setLevel(Log::Level::WARN);
+
+    std::vector<float> pcm;
+    if (!args.wav.empty()) {
+        std::ifstream f(args.wav, std::ios::binary);
+        if (!f) { std::cerr << "Cannot open " << args.wav << std::endl; return 1; }
+        std::string bytes((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+        try {
+            pcm = AudioDecoder::decodeWav(bytes);
+        } catch (const std::exception& e) {
+            std::cerr << "Invalid WAV: " << e.what() << std::endl;
+            return 1;
+        }
+    } else {
+        pcm = syntheticAudio(args.seconds);
+    }
+
+    whisper_context_params cparams = whisper_context_default_params();
+    cparams.use_gpu = args.use_gpu;
+    whisper_context* ctx = whisper_init_from_file_with_params(args.model.c_str(), cparams);
+    if (!ctx) { std::cerr << "Failed to load model: " << args.model << std::endl; return 1; }
+
+    int rc = 0;
+    {
+        WhisperStatePool pool(ctx);
+        for (int p : args.parallel) {
+            if (p <= 0) continue;
+            InferenceLimiter::instance().setMaxConcurrency(p);
+
+            OfflineTranscriber::Options opts;
+            opts.decode.language    = args.language;
+            opts.decode.n_threads   = args.threads;
+            opts.decode.beam_size   = args.beam_size;
+            opts.decode.temperature = 0.0f;
+            opts.max_parallel       = p;
+
+            try {
+                auto res = OfflineTranscriber(pool, opts).transcribe(pcm);
+                double speedup = res.processing_seconds > 0 ? res.audio_seconds / res.processing_seconds : 0.0;
+                std::printf("{\"parallel\":%d,\"threads\":%d,\"audio_s\":%.1f,\"wall_s\":%.2f,"
+                            "\"chunks\":%zu,\"chunks_decoded\":%zu,\"segments\":%zu,"
+                            "\"audio_hours_per_wall_hour\":%.2f}\n",
+                            p, args.threads, res.audio_seconds, res.processing_seconds,
+                            res.chunks, res.chunks_decoded, res.segments.size(), speedup);
+                std::fflush(stdout);
+            } catch (const std::exception& e) {
+                std::cerr << "parallel=" << p << " failed: " << e.what() << std::endl;
+                rc = 1;
+            }
+        }
+    }
+
+    whisper_free(ctx);
+    Log::flush();
+    return rc;
+}
@@ -0,0 +1,391 @@
+// Replay a recorded session (CAPTURE_DIR) to reproduce a latency spike or a bad
+// transcript, and compare the outcome with what the server originally sent.
+//
+//   replay --capture caps/session-123.cap --url ws://localhost:9001/ [--speed 4] [--token T]
+//   replay --capture caps/session-123.cap --model ggml-small.bin      (engine, in-process)
+//   replay --capture caps/session-123.cap --mock                      (engine, MockTranscriptionEngine)
+//
+// The client's frames (config, audio, end) are re-sent with their recorded
+// timing divided by --speed. Against a server (--url) they go through the full
+// session path; tokens are redacted in captures, so pass --token when the server
+// requires auth. In engine mode they are fed straight to a TranscriptionEngine
+// driven by a fixed-cadence flush thread (2 s minimum buffer, a partial every
+// 250 ms of new audio or after 400 ms without audio), so a change to the engine
+// can be compared without a server; adaptive cadence and slot contention are not
+// reproduced there.
+//
+// Prints one JSON line: {"recorded":{...},"replayed":{...},"final_text_match":bool}
+// where each side has the final text, the number of partials, time to first
+// partial (from the first audio frame), partial gap p50/p90, final latency (from
+// `end` to the final) and server error/warning codes.
+
+#include "utils/CaptureFile.h"
+#include "whisper/StreamingWhisperEngine.h"
+#include "whisper/MockTranscriptionEngine.h"
+#include <whisper.h>
+#include <boost/asio/connect.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace beast = boost::beast;
+namespace websocket = beast::websocket;
+namespace net = boost::asio;
+using tcp = net::ip::tcp;
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Args {
+    std::string capture;
+    // Server mode
+    std::string host, port = "9001", path = "/";
+    std::string token;
+    // Engine mode
+    std::string model;
+    bool mock = false;
+    MockTranscriptionEngine::Options mock_opt;
+    int threads = 4;
+    bool use_gpu = false;
+
+    double speed = 1.0;     // 1 = recorded timing
+    double timeout_s = 60;  // waiting for the final after the last frame
+};
+
+void usage(const char* bin) {
+    std::cerr << "Usage: " << bin << " --capture file.cap"
+              << " (--url ws://host:port/path [--token T] | --model model.bin [--threads N] [--gpu]"
+              << " | --mock [--mock-decode-ms N] [--mock-decode-ms-per-audio-s N] [--mock-words-per-second N])"
+              << " [--speed X] [--timeout-s N]" << std::endl;
+}
+
+bool parseUrl(const std::string& url, Args& args) {
+    const std::string scheme = "ws://";
+    if (url.compare(0, scheme.size(), scheme) != 0) return false;
+    std::string rest = url.substr(scheme.size());
+    auto slash = rest.find('/');
+    std::string hostport = rest.substr(0, slash);
+    args.path = slash == std::string::npos ? "/" : rest.substr(slash);
+    auto colon = hostport.rfind(':');
+    args.host = hostport.substr(0, colon);
+    if (colon != std::string::npos) args.port = hostport.substr(colon + 1);
+    return !args.host.empty();
+}
+
+double percentile(std::vector<double> v, double q) {
+    if (v.empty()) return 0.0;
+    size_t k = std::min(static_cast<size_t>(q * v.size()), v.size() - 1);
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+// What one run of the session looked like from the client's side (ms on its own clock).
+class Timeline {
+public:
+    void audio(double t)  { if (!first_audio_) first_audio_ = t; }
+    void end(double t)    { end_ = t; }
+
+    void message(double t, const std::string& text) {
+        json msg = json::parse(text, nullptr, false);
+        if (!msg.is_object()) return;
+        const std::string type = msg.value("type", "");
+        if (type == "transcription") {
+            if (msg.value("is_final", false)) {
+                final_ = t;
+                final_text_ = msg.value("text", "");
+            } else {
+                partials_.push_back(t);
+            }
+        } else if (type == "error" || type == "warning") {
+            codes_.push_back(msg.value("code", type));
+        }
+    }
+
+    bool done() const { return final_.has_value(); }
+    const std::string& finalText() const { return final_text_; }
+
+    json summary() const {
+        std::vector<double> gaps;
+        for (size_t i = 1; i < partials_.size(); ++i) gaps.push_back(partials_[i] - partials_[i - 1]);
+        json j = {
+            {"final_text", final_ ? json(final_text_) : json(nullptr)},
+            {"partials", partials_.size()},
+            {"first_partial_ms", !partials_.empty() && first_audio_ ? json(partials_.front() - *first_audio_) : json(nullptr)},
+            {"partial_gap_ms", {{"p50", percentile(gaps, 0.5)}, {"p90", percentile(gaps, 0.9)}}},
+            {"final_ms", final_ && end_ ? json(*final_ - *end_) : json(nullptr)},
+            {"codes", codes_},
+        };
+        return j;
+    }
+
+private:
+    std::optional<double> first_audio_, end_, final_;
+    std::vector<double> partials_;
+    std::string final_text_;
+    std::vector<std::string> codes_;
+};
+
+bool isEnd(const std::string& text) {
+    json msg = json::parse(text, nullptr, false);
+    return msg.is_object() && msg.value("type", "") == "end";
+}
+
+Timeline recorded(const capture::Capture& cap) {
+    Timeline tl;
+    for (const auto& r : cap.records) {
+        const double t = r.t_us / 1000.0;
+        switch (r.type) {
+            case capture::RecordType::AudioIn: tl.audio(t); break;
+            case capture::RecordType::TextIn:  if (isEnd(r.payload)) tl.end(t); break;
+            case capture::RecordType::TextOut: tl.message(t, r.payload); break;
+            default: break;
+        }
+    }
+    return tl;
+}
+
+// Sleep until the record's (scaled) offset from `start`.
+void waitFor(const capture::Record& r, Clock::time_point start, double speed) {
+    std::this_thread::sleep_until(start + std::chrono::microseconds(static_cast<int64_t>(r.t_us / speed)));
+}
+
+double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// ─── Server mode ────────────────────────────────────────────────────────────
+
+Timeline replayServer(const capture::Capture& cap, const Args& args) {
+    net::io_context ioc;
+    tcp::resolver resolver(ioc);
+    websocket::stream<tcp::socket> ws(ioc);
+    net::connect(ws.next_layer(), resolver.resolve(args.host, args.port));
+    ws.handshake(args.host + ":" + args.port, args.path);
+
+    Timeline tl;
+    std::mutex mutex;
+    std::atomic<bool> closed{false};
+    const auto start = Clock::now();
+
+    std::thread reader([&] {
+        try {
+            while (true) {
+                beast::flat_buffer buffer;
+                ws.read(buffer);
+                std::string text = beast::buffers_to_string(buffer.data());
+                std::lock_guard<std::mutex> lock(mutex);
+                tl.message(msSince(start), text);
+            }
+        } catch (const std::exception&) {
+            // server closed after the final, or the connection dropped
+        }
+        closed = true;
+    });
+
+    try {
+        for (const auto& r : cap.records) {
+            if (r.type != capture::RecordType::TextIn && r.type != capture::RecordType::AudioIn) continue;
+            if (closed) break;
+            waitFor(r, start, args.speed);
+
+            std::string payload = r.payload;
+            if (r.type == capture::RecordType::TextIn) {
+                json msg = json::parse(payload, nullptr, false);
+                if (msg.is_object() && msg.contains("token")) {
+                    if (args.token.empty()) msg.erase("token");
+                    else msg["token"] = args.token;
+                    payload = msg.dump();
+                }
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (isEnd(payload)) tl.end(msSince(start));
+                }
+                ws.text(true);
+            } else {
+                std::lock_guard<std::mutex> lock(mutex);
+                tl.audio(msSince(start));
+                ws.binary(true);
+            }
+            ws.write(net::buffer(payload));
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Send failed: " << e.what() << std::endl;
+    }
+
+    const auto deadline = Clock::now() + std::chrono::duration<double>(args.timeout_s);
+    while (!closed && Clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    boost::system::error_code ec;
+    beast::get_lowest_layer(ws).shutdown(tcp::socket::shutdown_both, ec);
+    beast::get_lowest_layer(ws).close(ec);
+    reader.join();
+    return tl;
+}
+
+// ─── Engine mode ────────────────────────────────────────────────────────────
+
+Timeline replayEngine(const capture::Capture& cap, TranscriptionEngine& engine, const Args& args) {
+    constexpr size_t MIN_BUFFER_SAMPLES = 32000; // 2s, as flushLoop
+    constexpr size_t STRIDE_SAMPLES = 4000;      // 250 ms, PartialCadence's minimum
+    std::atomic<bool> bulk{false};
+
+    Timeline tl;
+    std::mutex mutex; // the session's state_mutex_: engine calls and text state
+    std::string committed;
+    size_t last_transcribed = 0;
+    auto last_audio = Clock::now();
+    std::atomic<bool> running{true};
+    const auto start = Clock::now();
+
+    std::thread flusher([&] {
+        while (running) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(bulk ? 20 : 200));
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running) break;
+            const size_t size = engine.getBufferSize();
+            if (size < MIN_BUFFER_SAMPLES) continue;
+            const bool silence = Clock::now() - last_audio > std::chrono::milliseconds(400) && size > last_transcribed;
+            const bool due = bulk ? size >= TranscriptionEngine::BULK_MAX_CHUNK_SAMPLES
+                                  : size - last_transcribed >= STRIDE_SAMPLES || silence;
+            if (!due) continue;
+
+            auto res = bulk ? engine.transcribeBulkChunk() : engine.transcribeSlidingWindow(false);
+            committed += res.committed_text;
+            last_transcribed = res.committed_text.empty() ? size : engine.getBufferSize();
+            if (!res.committed_text.empty() || !res.partial_text.empty()) {
+                json msg = {{"type", "transcription"}, {"text", committed + res.partial_text}, {"is_final", false}};
+                tl.message(msSince(start), msg.dump());
+            }
+        }
+    });
+
+    for (const auto& r : cap.records) {
+        if (r.type == capture::RecordType::AudioIn) {
+            waitFor(r, start, args.speed);
+            // Frames are raw float32, as the session reads them.
+            std::vector<float> pcm(r.payload.size() / sizeof(float));
+            std::memcpy(pcm.data(), r.payload.data(), pcm.size() * sizeof(float));
+            std::lock_guard<std::mutex> lock(mutex);
+            tl.audio(msSince(start));
+            last_audio = Clock::now();
+            if (engine.processAudioChunk(pcm)) {
+                tl.message(msSince(start), R"({"type":"warning","code":"buffer_full"})");
+            }
+        } else if (r.type == capture::RecordType::TextIn) {
+            json msg = json::parse(r.payload, nullptr, false);
+            if (!msg.is_object()) continue;
+            waitFor(r, start, args.speed);
+            const std::string type = msg.value("type", "");
+            std::lock_guard<std::mutex> lock(mutex);
+            if (type == "config") {
+                if (msg.contains("language")) engine.setLanguage(msg["language"].get<std::string>());
+                if (msg.contains("vad_thold")) engine.setVadThreshold(msg["vad_thold"].get<float>());
+                bulk = msg.value("mode", "live") == "bulk";
+            } else if (type == "end") {
+                tl.end(msSince(start));
+                if (auto hypothesis = engine.takeFreshHypothesis()) {
+                    committed += *hypothesis;
+                } else {
+                    committed += engine.transcribeSlidingWindow(true).committed_text;
+                }
+                json fin = {{"type", "transcription"}, {"text", committed}, {"is_final", true}};
+                tl.message(msSince(start), fin.dump());
+                break;
+            }
+        }
+    }
+
+    running = false;
+    flusher.join();
+    return tl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Args args;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--capture" && i + 1 < argc) args.capture = argv[++i];
+        else if (a == "--url" && i + 1 < argc) {
+            if (!parseUrl(argv[++i], args)) { std::cerr << "Only ws://host:port/path URLs are supported" << std::endl; return 1; }
+        }
+        else if (a == "--token" && i + 1 < argc) args.token = argv[++i];
+        else if (a == "--model" && i + 1 < argc) args.model = argv[++i];
+        else if (a == "--mock") args.mock = true;
+        else if (a == "--mock-decode-ms" && i + 1 < argc) args.mock_opt.base_latency_ms = std::stod(argv[++i]);
+        else if (a == "--mock-decode-ms-per-audio-s" && i + 1 < argc) args.mock_opt.latency_ms_per_audio_second = std::stod(argv[++i]);
+        else if (a == "--mock-words-per-second" && i + 1 < argc) args.mock_opt.words_per_second = std::stod(argv[++i]);
+        else if (a == "--threads" && i + 1 < argc) args.threads = std::stoi(argv[++i]);
+        else if (a == "--gpu") args.use_gpu = true;
+        else if (a == "--speed" && i + 1 < argc) args.speed = std::stod(argv[++i]);
+        else if (a == "--timeout-s" && i + 1 < argc) args.timeout_s = std::stod(argv[++i]);
+        else { usage(argv[0]); return a == "--help" ? 0 : 1; }
+    }
+    const int targets = !args.host.empty() + !args.model.empty() + args.mock;
+    if (args.capture.empty() || targets != 1 || args.speed <= 0) { usage(argv[0]); return 1; }
+
+    capture::Capture cap;
+    try {
+        cap = capture::read(args.capture);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    if (cap.truncated) std::cerr << "Capture is truncated; replaying what was recorded" << std::endl;
+
+    Timeline replayed;
+    std::string target;
+    try {
+        if (!args.host.empty()) {
+            target = "ws://" + args.host + ":" + args.port + args.path;
+            replayed = replayServer(cap, args);
+        } else if (args.mock) {
+            target = "mock";
+            MockTranscriptionEngine engine(args.mock_opt);
+            replayed = replayEngine(cap, engine, args);
+        } else {
+            target = args.model;
+            whisper_context_params cparams = whisper_context_default_params();
+            cparams.use_gpu = args.use_gpu;
+            whisper_context* ctx = whisper_init_from_file_with_params(args.model.c_str(), cparams);
+            if (!ctx) { std::cerr << "Failed to load model: " << args.model << std::endl; return 1; }
+            {
+                StreamingWhisperEngine engine(ctx);
+                engine.setThreads(args.threads);
+                replayed = replayEngine(cap, engine, args);
+            }
+            whisper_free(ctx);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Replay failed: " << e.what() << std::endl;
+        return 1;
+    }
+
+    Timeline original = recorded(cap);
+    json line = {
+        {"capture", args.capture},
+        {"target", target},
+        {"speed", args.speed},
+        {"truncated", cap.truncated},
+        {"recorded", original.summary()},
+        {"replayed", replayed.summary()},
+        {"final_text_match", original.done() && replayed.done() && original.finalText() == replayed.finalText()},
+    };
+    std::cout << line.dump() << std::endl;
+    return 0;
+}
@@ -0,0 +1,704 @@
+// Scheduler simulator: N streaming sessions on a virtual clock, driven by the
+// server's own flush and slot logic, to tune the flushLoop / inference-slot
+// constants without a model or a loaded box.
+//
+//   flushsim --capture captures/ --sessions 8,16,32,64 --slots 2,4 --poll-ms 100,200
+//
+// Run for real, exactly as the server does:
+//   FlushPolicy              when flushLoop decodes (stride, silence flush, 2s minimum)
+//   PartialCadence           the stride under load, fed by a LoadEstimator on virtual time
+//   InferenceLimiter::admits slot priorities: partials try once per poll, finals queue
+//                            at FINAL_PRIORITY ahead of every partial
+//   partial deadline, hypothesis reuse at `end`, and the commit window / high-water
+//   mark of MockTranscriptionEngine (StreamingWhisperEngine's buffer logic, no model)
+// Modelled:
+//   decode wall time = a + b*audio_ctx + (beam-1)*(c + d*audio_ctx), with audio_ctx
+//   from audioCtxFor(window) as in makeWhisperParams. --cost a,b,c,d sets it; --fit
+//   decodes.jsonl fits it (least squares) to `bench_engine --decode-log` output.
+//   Concurrent decodes do not slow each other down beyond the slot cap, and audio
+//   frames queue behind a running decode as they do behind state_mutex_.
+//   Flow-control credits are not modelled: clients send on their recorded schedule.
+//
+// Arrivals: every --capture file (see CAPTURE_DIR) gives one live session's frame
+// timing and its `end`; session i replays capture i % count. Without captures each
+// session streams --seconds of audio in --chunk-ms frames at real time. Session
+// starts are spread over --ramp-up-s.
+//
+// Every policy flag takes a comma list; each combination is a policy. Per policy,
+// one JSON line per stage (session count) and a {"summary":true,...} line with the
+// largest count meeting the same SLO as loadgen (p90 final latency, p90 partial
+// gap) with no audio dropped at the high-water mark.
+
+#include "server/FlushPolicy.h"
+#include "server/PartialCadence.h"
+#include "utils/CaptureFile.h"
+#include "whisper/DecodeConfig.h"
+#include "whisper/InferenceLimiter.h"
+#include "whisper/LoadEstimator.h"
+#include "whisper/MockTranscriptionEngine.h"
+#include "log/Log.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace {
+
+constexpr double SAMPLE_RATE = 16000.0;
+
+// Decode wall time of one window. The defaults are rough placeholders; fit the
+// model to the target hardware with bench_engine --decode-log and --fit.
+struct CostModel {
+    double a = 0.05;    // s per decode
+    double b = 0.0006;  // s per audio_ctx token (1500 tokens = 30 s window)
+    double c = 0.0;     // s per decode per extra beam
+    double d = 0.00015; // s per audio_ctx token per extra beam
+
+    double seconds(size_t window_samples, int beam) const {
+        const double ctx = audioCtxFor(window_samples);
+        const double extra = std::max(beam - 1, 0);
+        return std::max(a + b * ctx + extra * (c + d * ctx), 0.0);
+    }
+
+    json toJson() const { return {{"a", a}, {"b", b}, {"c", c}, {"d", d}}; }
+};
+
+// Solve A x = y (n x n, Gaussian elimination with partial pivoting). false if singular.
+bool solve(std::vector<std::vector<double>> A, std::vector<double> y, std::vector<double>& x) {
+    const size_t n = y.size();
+    for (size_t col = 0; col < n; ++col) {
+        size_t piv = col;
+        for (size_t r = col + 1; r < n; ++r) {
+            if (std::abs(A[r][col]) > std::abs(A[piv][col])) piv = r;
+        }
+        if (std::abs(A[piv][col]) < 1e-12) return false;
+        std::swap(A[col], A[piv]);
+        std::swap(y[col], y[piv]);
+        for (size_t r = col + 1; r < n; ++r) {
+            const double f = A[r][col] / A[col][col];
+            for (size_t k = col; k < n; ++k) A[r][k] -= f * A[col][k];
+            y[r] -= f * y[col];
+        }
+    }
+    x.assign(n, 0.0);
+    for (size_t i = n; i-- > 0;) {
+        double s = y[i];
+        for (size_t k = i + 1; k < n; ++k) s -= A[i][k] * x[k];
+        x[i] = s / A[i][i];
+    }
+    return true;
+}
+
+/**
+ * Least-squares fit of the cost model to bench_engine --decode-log lines.
+ * With a single beam size in the log the beam terms keep their current values.
+ * @throws std::runtime_error on an unreadable log or too few distinct windows
+ */
+CostModel fitCost(const std::string& path, CostModel model, double& rmse, size_t& samples) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("cannot open " + path);
+
+    struct Point { double ctx, extra, decode_s; };
+    std::vector<Point> pts;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        json j = json::parse(line, nullptr, false);
+        if (!j.is_object() || !j.contains("audio_ctx") || !j.contains("decode_s")) continue;
+        pts.push_back({j["audio_ctx"].get<double>(), std::max(j.value("beam_size", 1) - 1, 0) * 1.0,
+                       j["decode_s"].get<double>()});
+    }
+    samples = pts.size();
+
+    const bool beams = std::any_of(pts.begin(), pts.end(), [&](const Point& p) { return p.extra != pts[0].extra; });
+    auto features = [&](const Point& p) {
+        std::vector<double> f = {1.0, p.ctx};
+        if (beams) { f.push_back(p.extra); f.push_back(p.extra * p.ctx); }
+        return f;
+    };
+    const size_t n = beams ? 4 : 2;
+    std::vector<std::vector<double>> A(n, std::vector<double>(n, 0.0));
+    std::vector<double> y(n, 0.0);
+    for (const auto& p : pts) {
+        // One beam size only: the beam terms cannot be separated, keep them and fit the rest.
+        const auto f = features(p);
+        const double target = beams ? p.decode_s : p.decode_s - p.extra * (model.c + model.d * p.ctx);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t k = 0; k < n; ++k) A[i][k] += f[i] * f[k];
+            y[i] += f[i] * target;
+        }
+    }
+    std::vector<double> x;
+    if (pts.size() < n || !solve(A, y, x)) {
+        throw std::runtime_error("not enough distinct decodes in " + path + " to fit the cost model");
+    }
+    model.a = x[0];
+    model.b = x[1];
+    if (beams) { model.c = x[2]; model.d = x[3]; }
+
+    double sq = 0.0;
+    for (const auto& p : pts) {
+        const double e = model.a + model.b * p.ctx + p.extra * (model.c + model.d * p.ctx) - p.decode_s;
+        sq += e * e;
+    }
+    rmse = std::sqrt(sq / pts.size());
+    return model;
+}
+
+// One session's client side: when each audio frame and the `end` are sent.
+struct Arrivals {
+    std::string name;
+    std::vector<std::pair<double, size_t>> frames; // (seconds since session start, samples)
+    double end_s = 0.0;
+};
+
+Arrivals fromCapture(const fs::path& path) {
+    auto cap = capture::read(path.string());
+    Arrivals a;
+    a.name = path.filename().string();
+    std::optional<double> end;
+    for (const auto& r : cap.records) {
+        const double t = static_cast<double>(r.t_us) / 1e6;
+        if (r.type == capture::RecordType::AudioIn) {
+            a.frames.emplace_back(t, r.payload.size() / sizeof(float));
+        } else if (r.type == capture::RecordType::TextIn) {
+            json msg = json::parse(r.payload, nullptr, false);
+            if (!msg.is_object()) continue;
+            if (msg.value("type", "") == "config" && msg.value("mode", "") == "bulk") {
+                throw std::runtime_error("bulk session (only live sessions are simulated)");
+            }
+            if (msg.value("type", "") == "end" && !end) end = t;
+        }
+    }
+    if (a.frames.empty()) throw std::runtime_error("no audio");
+    // A capture without `end` is a client that disconnected: treat its last frame as the end.
+    a.end_s = std::max(end.value_or(a.frames.back().first), a.frames.back().first);
+    return a;
+}
+
+Arrivals synthetic(double seconds, int chunk_ms) {
+    Arrivals a;
+    a.name = "synthetic";
+    const size_t chunk = static_cast<size_t>(SAMPLE_RATE * chunk_ms / 1000);
+    const size_t total = static_cast<size_t>(seconds * SAMPLE_RATE);
+    for (size_t sent = 0; sent < total; sent += chunk) {
+        const size_t n = std::min(chunk, total - sent);
+        a.frames.emplace_back(static_cast<double>(sent + n) / SAMPLE_RATE, n); // sent once captured
+    }
+    a.end_s = a.frames.empty() ? 0.0 : a.frames.back().first;
+    return a;
+}
+
+struct Policy {
+    double poll_ms = 200.0;
+    double min_stride_ms = 250.0;
+    double max_stride_ms = 1000.0;
+    double min_buffer_s = 2.0;
+    double silence_ms = 400.0;
+    double commit_window_s = 10.0;
+    double deadline_ms = 3000.0; // 0 = none
+    int slots = 4;
+    int beam = 1;
+
+    json toJson() const {
+        return {{"poll_ms", poll_ms}, {"min_stride_ms", min_stride_ms}, {"max_stride_ms", max_stride_ms},
+                {"min_buffer_s", min_buffer_s}, {"silence_ms", silence_ms}, {"commit_window_s", commit_window_s},
+                {"deadline_ms", deadline_ms}, {"slots", slots}, {"beam", beam}};
+    }
+};
+
+struct StageStats {
+    int sessions = 0;
+    int completed = 0;
+    size_t partials = 0;       // decodes that produced a message
+    size_t deadline_drops = 0; // partials aborted at the deadline
+    size_t busy_skips = 0;     // due partials that found no free slot
+    size_t reused_finals = 0;
+    double dropped_audio_s = 0.0;
+    double busy_s = 0.0;       // slot-seconds spent decoding
+    double makespan_s = 0.0;
+    std::vector<double> first_partial_ms, partial_gap_ms, partial_latency_ms, commit_lag_ms, final_ms;
+};
+
+double percentile(std::vector<double> v, double q) {
+    if (v.empty()) return 0.0;
+    size_t k = std::min(static_cast<size_t>(q * v.size()), v.size() - 1);
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+json dist(const std::vector<double>& v) {
+    auto ms = [&](double q) { return std::round(percentile(v, q) * 10.0) / 10.0; };
+    return {{"p50", ms(0.5)}, {"p90", ms(0.9)}, {"p99", ms(0.99)}};
+}
+
+// One stage: `n` sessions under `policy`, until every session has its final.
+class Simulation {
+public:
+    Simulation(const Policy& policy, const CostModel& cost, const std::vector<Arrivals>& arrivals,
+               int n, double ramp_up_s)
+        : policy_(policy), cost_(cost), estimator_(std::chrono::seconds(30)),
+          flush_([&] {
+              FlushPolicy::Options o;
+              o.poll = FlushPolicy::ms(static_cast<int64_t>(policy.poll_ms));
+              o.min_buffer_samples = static_cast<size_t>(policy.min_buffer_s * SAMPLE_RATE);
+              o.silence_flush = FlushPolicy::ms(static_cast<int64_t>(policy.silence_ms));
+              return o;
+          }()) {
+        stats_.sessions = n;
+        MockTranscriptionEngine::Options mock;
+        mock.base_latency_ms = 0.0; // time comes from the cost model, not from sleeping
+        mock.latency_ms_per_audio_second = 0.0;
+        mock.commit_window_samples = static_cast<size_t>(policy.commit_window_s * SAMPLE_RATE);
+        PartialCadence::Options cad;
+        cad.min_stride = PartialCadence::ms(static_cast<int64_t>(policy.min_stride_ms));
+        cad.max_stride = PartialCadence::ms(static_cast<int64_t>(policy.max_stride_ms));
+
+        sessions_.resize(n);
+        for (int i = 0; i < n; ++i) {
+            auto& s = sessions_[i];
+            s.arrivals = &arrivals[i % arrivals.size()];
+            s.start = ramp_up_s * i / n;
+            s.engine = std::make_unique<MockTranscriptionEngine>(mock);
+            s.cadence = std::make_unique<PartialCadence>(cad);
+            schedule(s.start + s.arrivals->frames.front().first, Event::Receive, i);
+            s.receive_pending = true;
+            schedule(s.start + flush_.pollInterval(false).count() / 1000.0, Event::Poll, i);
+        }
+    }
+
+    StageStats run() {
+        while (!events_.empty()) {
+            Event e = events_.top();
+            events_.pop();
+            now_ = e.t;
+            auto& s = sessions_[e.session];
+            switch (e.kind) {
+                case Event::Receive:    s.receive_pending = false; receive(e.session); break;
+                case Event::Poll:       poll(e.session); break;
+                case Event::DecodeDone: if (e.generation == s.generation) finishPartial(e.session, false); break;
+                case Event::FinalDone:  finishFinal(e.session); break;
+            }
+        }
+        stats_.makespan_s = now_;
+        return std::move(stats_);
+    }
+
+private:
+    struct Event {
+        enum Kind { Receive, Poll, DecodeDone, FinalDone };
+        double t;
+        uint64_t seq; // FIFO among events at the same instant
+        Kind kind;
+        int session;
+        uint64_t generation;
+        bool operator>(const Event& o) const { return t != o.t ? t > o.t : seq > o.seq; }
+    };
+
+    struct Session {
+        const Arrivals* arrivals = nullptr;
+        double start = 0.0;
+        std::unique_ptr<MockTranscriptionEngine> engine;
+        std::unique_ptr<PartialCadence> cadence;
+        size_t next_frame = 0;
+        bool receive_pending = false;                    // a Receive event is queued
+        uint64_t fed = 0;                                // stream samples handed to the engine
+        std::vector<std::pair<uint64_t, double>> sent;   // (stream end, send time) per frame
+        double last_audio = 0.0;                         // last frame appended (last_audio_time_)
+        size_t last_transcribed = 0;
+        std::optional<double> waiting_since;
+        std::optional<double> last_message;
+        // Partial in flight
+        bool decoding = false;
+        double decode_start = 0.0;
+        double queue_wait = 0.0;
+        size_t window = 0;
+        bool deadline_hit = false;
+        uint64_t generation = 0;
+        // End of stream
+        bool ended = false;
+        double end_at = 0.0;
+        double final_wait = 0.0;
+    };
+
+    using Clock = LoadEstimator::Clock;
+    static Clock::time_point at(double t) {
+        return Clock::time_point(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(t)));
+    }
+
+    void schedule(double t, Event::Kind kind, int session, uint64_t generation = 0) {
+        events_.push({t, seq_++, kind, session, generation});
+    }
+
+    bool admits(int priority) const {
+        // Every simulated session is DEFAULT_PRIORITY, so the priority-0 reservation
+        // (server default: 1 slot) never applies; it is passed for completeness.
+        return InferenceLimiter::admits(priority, active_, policy_.slots, 1, waiting_);
+    }
+
+    // Receive loop: frames and `end` in order; blocked behind a running decode (state_mutex_).
+    void receive(int i) {
+        auto& s = sessions_[i];
+        if (s.ended) return;
+        const auto& frames = s.arrivals->frames;
+        while (s.next_frame < frames.size() && s.start + frames[s.next_frame].first <= now_) {
+            if (s.decoding) return; // DecodeDone delivers it
+            const size_t n = frames[s.next_frame].second;
+            if (s.engine->processAudioChunk(std::vector<float>(n, 0.0f))) {
+                stats_.dropped_audio_s += n / SAMPLE_RATE;
+            } else {
+                s.fed += n;
+                s.sent.emplace_back(s.fed, s.start + frames[s.next_frame].first);
+            }
+            s.last_audio = now_;
+            ++s.next_frame;
+        }
+        const double next = s.next_frame < frames.size() ? s.start + frames[s.next_frame].first
+                                                         : s.start + s.arrivals->end_s;
+        if (next > now_) {
+            if (!s.receive_pending) schedule(next, Event::Receive, i);
+            s.receive_pending = true;
+            return;
+        }
+        handleEnd(i);
+    }
+
+    void handleEnd(int i) {
+        auto& s = sessions_[i];
+        s.ended = true;
+        s.end_at = now_;
+        if (s.decoding) finishPartial(i, true); // the final supersedes the partial: abort it
+        if (s.engine->takeFreshHypothesis()) {
+            ++stats_.reused_finals;
+            stats_.final_ms.push_back(0.0);
+            ++stats_.completed;
+            return;
+        }
+        ++waiting_[InferenceLimiter::FINAL_PRIORITY];
+        finals_.push_back(i);
+        grantFinals();
+    }
+
+    void grantFinals() {
+        while (!finals_.empty() && admits(InferenceLimiter::FINAL_PRIORITY)) {
+            const int i = finals_.front();
+            finals_.pop_front();
+            --waiting_[InferenceLimiter::FINAL_PRIORITY];
+            ++active_;
+            auto& s = sessions_[i];
+            s.final_wait = now_ - s.end_at;
+            const double d = cost_.seconds(s.engine->getBufferSize(), policy_.beam);
+            stats_.busy_s += d;
+            schedule(now_ + d, Event::FinalDone, i);
+        }
+    }
+
+    void finishFinal(int i) {
+        auto& s = sessions_[i];
+        --active_;
+        s.engine->transcribeSlidingWindow(true);
+        estimator_.recordDecode(now_ - s.end_at - s.final_wait, s.final_wait, false, at(now_));
+        stats_.final_ms.push_back((now_ - s.end_at) * 1000.0);
+        ++stats_.completed;
+        grantFinals();
+    }
+
+    // One flushLoop cycle.
+    void poll(int i) {
+        auto& s = sessions_[i];
+        if (s.ended) return;
+        const double next = now_ + flush_.pollInterval(false).count() / 1000.0;
+
+        const size_t size = s.engine->getBufferSize();
+        if (!flush_.hasMinimumBuffer(size)) { schedule(next, Event::Poll, i); return; }
+        s.cadence->update(estimator_.load(at(now_)) / std::max(policy_.slots, 1));
+        const auto since_audio = FlushPolicy::ms(static_cast<int64_t>((now_ - s.last_audio) * 1000.0));
+        if (!flush_.due(size, s.last_transcribed, since_audio, false, s.cadence->strideSamples())) {
+            schedule(next, Event::Poll, i);
+            return;
+        }
+        if (!admits(InferenceLimiter::DEFAULT_PRIORITY)) {
+            ++stats_.busy_skips;
+            if (!s.waiting_since) s.waiting_since = now_;
+            s.cadence->onBusy();
+            schedule(next, Event::Poll, i);
+            return;
+        }
+
+        ++active_;
+        s.queue_wait = s.waiting_since ? now_ - *s.waiting_since : 0.0;
+        s.waiting_since.reset();
+        const bool has_deadline = policy_.deadline_ms > 0 &&
+                                  size < static_cast<size_t>(policy_.commit_window_s * SAMPLE_RATE);
+        double d = cost_.seconds(size, policy_.beam);
+        s.deadline_hit = has_deadline && d > policy_.deadline_ms / 1000.0;
+        if (s.deadline_hit) d = policy_.deadline_ms / 1000.0;
+        s.decoding = true;
+        s.decode_start = now_;
+        s.window = size;
+        schedule(now_ + d, Event::DecodeDone, i, ++s.generation);
+    }
+
+    void finishPartial(int i, bool cancelled) {
+        auto& s = sessions_[i];
+        --active_;
+        s.decoding = false;
+        ++s.generation;
+        const double d = now_ - s.decode_start;
+        stats_.busy_s += d;
+        estimator_.recordDecode(d, s.queue_wait, !cancelled, at(now_));
+
+        if (cancelled) { grantFinals(); return; } // handleEnd takes over
+        s.cadence->onDecode(d);
+        if (s.deadline_hit) {
+            ++stats_.deadline_drops;
+            s.last_transcribed = s.window;
+        } else {
+            const uint64_t window_start = s.fed - s.window;
+            auto res = s.engine->transcribeSlidingWindow(false);
+            const double newest = s.sent.empty() ? s.decode_start : s.sent.back().second;
+            stats_.partial_latency_ms.push_back((now_ - newest) * 1000.0);
+            if (!res.committed_text.empty()) {
+                const uint64_t committed_end = window_start + (s.window - s.engine->getBufferSize());
+                auto it = std::lower_bound(s.sent.begin(), s.sent.end(), std::make_pair(committed_end, 0.0));
+                if (it != s.sent.end()) stats_.commit_lag_ms.push_back((now_ - it->second) * 1000.0);
+                s.last_transcribed = s.engine->getBufferSize();
+            } else {
+                s.last_transcribed = s.window;
+            }
+            if (!res.committed_text.empty() || !res.partial_text.empty()) {
+                ++stats_.partials;
+                if (s.last_message) {
+                    stats_.partial_gap_ms.push_back((now_ - *s.last_message) * 1000.0);
+                } else {
+                    stats_.first_partial_ms.push_back((now_ - s.start - s.arrivals->frames.front().first) * 1000.0);
+                }
+                s.last_message = now_;
+            }
+        }
+
+        grantFinals();
+        receive(i); // frames that queued behind the decode
+        if (!s.ended) schedule(now_ + flush_.pollInterval(false).count() / 1000.0, Event::Poll, i);
+    }
+
+    Policy policy_;
+    CostModel cost_;
+    LoadEstimator estimator_;
+    FlushPolicy flush_;
+    std::vector<Session> sessions_;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events_;
+    uint64_t seq_ = 0;
+    double now_ = 0.0;
+    int active_ = 0;
+    std::array<int, InferenceLimiter::PRIORITY_LEVELS> waiting_{};
+    std::deque<int> finals_;
+    StageStats stats_;
+};
+
+struct Args {
+    std::vector<std::string> captures;
+    double seconds = 30.0;
+    int chunk_ms = 100;
+    double ramp_up_s = 5.0;
+    std::vector<int> sessions{1, 2, 4, 8, 16, 32, 64, 128, 256};
+    double slo_final_ms = 2000.0;
+    double slo_partial_gap_ms = 1500.0;
+    bool stop_on_fail = true;
+    CostModel cost;
+    std::string fit;
+};
+
+void usage(const char* bin) {
+    std::cerr << "Usage: " << bin << " [--capture file.cap|dir]... [--seconds N] [--chunk-ms N]"
+              << " [--ramp-up-s N] [--sessions 1,2,4] [--slo-final-ms N] [--slo-partial-gap-ms N] [--no-stop]"
+              << " [--cost a,b,c,d | --fit decodes.jsonl]"
+              << " [--poll-ms L] [--min-stride-ms L] [--max-stride-ms L] [--min-buffer-s L] [--silence-ms L]"
+              << " [--commit-window-s L] [--deadline-ms L] [--slots L] [--beam L]   (L = comma list)" << std::endl;
+}
+
+std::vector<double> parseList(const std::string& s) {
+    std::vector<double> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) out.push_back(std::stod(item));
+    }
+    return out;
+}
+
+// A sweepable policy parameter: its flag, the values to try and how to apply one.
+struct Axis {
+    std::string flag;
+    std::function<void(Policy&, double)> set;
+    std::vector<double> values;
+};
+
+std::vector<Axis> policyAxes() {
+    return {
+        {"--poll-ms",         [](Policy& p, double v) { p.poll_ms = v; }, {}},
+        {"--min-stride-ms",   [](Policy& p, double v) { p.min_stride_ms = v; }, {}},
+        {"--max-stride-ms",   [](Policy& p, double v) { p.max_stride_ms = v; }, {}},
+        {"--min-buffer-s",    [](Policy& p, double v) { p.min_buffer_s = v; }, {}},
+        {"--silence-ms",      [](Policy& p, double v) { p.silence_ms = v; }, {}},
+        {"--commit-window-s", [](Policy& p, double v) { p.commit_window_s = v; }, {}},
+        {"--deadline-ms",     [](Policy& p, double v) { p.deadline_ms = v; }, {}},
+        {"--slots",           [](Policy& p, double v) { p.slots = static_cast<int>(v); }, {}},
+        {"--beam",            [](Policy& p, double v) { p.beam = static_cast<int>(v); }, {}},
+    };
+}
+
+// Cartesian product of the axes that were given (the others keep the server defaults).
+std::vector<Policy> expand(const std::vector<Axis>& axes) {
+    std::vector<Policy> out{Policy{}};
+    for (const auto& axis : axes) {
+        if (axis.values.empty()) continue;
+        std::vector<Policy> next;
+        for (const auto& p : out) {
+            for (double v : axis.values) {
+                Policy q = p;
+                axis.set(q, v);
+                next.push_back(q);
+            }
+        }
+        out = std::move(next);
+    }
+    return out;
+}
+
+bool valid(const Policy& p) {
+    return p.poll_ms > 0 && p.min_stride_ms > 0 && p.min_stride_ms <= p.max_stride_ms && p.min_buffer_s >= 0 &&
+           p.silence_ms >= 0 && p.commit_window_s > 2.0 && p.deadline_ms >= 0 && p.slots >= 1 && p.beam >= 1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Args args;
+    auto axes = policyAxes();
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string a = argv[i];
+            auto axis = std::find_if(axes.begin(), axes.end(), [&](const Axis& x) { return x.flag == a; });
+            if (axis != axes.end() && i + 1 < argc) axis->values = parseList(argv[++i]);
+            else if (a == "--capture" && i + 1 < argc) args.captures.push_back(argv[++i]);
+            else if (a == "--seconds" && i + 1 < argc) args.seconds = std::stod(argv[++i]);
+            else if (a == "--chunk-ms" && i + 1 < argc) args.chunk_ms = std::stoi(argv[++i]);
+            else if (a == "--ramp-up-s" && i + 1 < argc) args.ramp_up_s = std::stod(argv[++i]);
+            else if (a == "--sessions" && i + 1 < argc) {
+                args.sessions.clear();
+                for (double n : parseList(argv[++i])) args.sessions.push_back(static_cast<int>(n));
+            }
+            else if (a == "--slo-final-ms" && i + 1 < argc) args.slo_final_ms = std::stod(argv[++i]);
+            else if (a == "--slo-partial-gap-ms" && i + 1 < argc) args.slo_partial_gap_ms = std::stod(argv[++i]);
+            else if (a == "--no-stop") args.stop_on_fail = false;
+            else if (a == "--fit" && i + 1 < argc) args.fit = argv[++i];
+            else if (a == "--cost" && i + 1 < argc) {
+                auto v = parseList(argv[++i]);
+                if (v.size() != 4) { usage(argv[0]); return 1; }
+                args.cost = {v[0], v[1], v[2], v[3]};
+            }
+            else { usage(argv[0]); return a == "--help" ? 0 : 1; }
+        }
+    } catch (const std::exception&) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (args.chunk_ms <= 0 || args.seconds <= 0 || args.ramp_up_s < 0) { usage(argv[0]); return 1; }
+    Log::setLevel(Log::Level::WARN);
+
+    if (!args.fit.empty()) {
+        try {
+            double rmse = 0.0;
+            size_t samples = 0;
+            args.cost = fitCost(args.fit, args.cost, rmse, samples);
+            std::cout << json{{"cost_model", args.cost.toJson()}, {"fit_samples", samples},
+                              {"fit_rmse_s", rmse}}.dump() << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "Cannot fit cost model: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<Arrivals> arrivals;
+    for (const auto& c : args.captures) {
+        std::vector<fs::path> files;
+        if (fs::is_directory(c)) {
+            for (const auto& e : fs::directory_iterator(c)) {
+                if (e.is_regular_file() && e.path().extension() == ".cap") files.push_back(e.path());
+            }
+            std::sort(files.begin(), files.end());
+        } else {
+            files.emplace_back(c);
+        }
+        for (const auto& f : files) {
+            try {
+                arrivals.push_back(fromCapture(f));
+            } catch (const std::exception& e) {
+                std::cerr << "Skipping " << f << ": " << e.what() << std::endl;
+            }
+        }
+    }
+    if (!args.captures.empty() && arrivals.empty()) { std::cerr << "No usable captures" << std::endl; return 1; }
+    if (arrivals.empty()) arrivals.push_back(synthetic(args.seconds, args.chunk_ms));
+
+    const auto policies = expand(axes);
+    for (const auto& policy : policies) {
+        if (!valid(policy)) {
+            std::cerr << "Skipping invalid policy " << policy.toJson().dump() << std::endl;
+            continue;
+        }
+        int best = 0;
+        for (int n : args.sessions) {
+            if (n <= 0) continue;
+            StageStats st = Simulation(policy, args.cost, arrivals, n, args.ramp_up_s).run();
+
+            const double final_p90 = percentile(st.final_ms, 0.9);
+            const double gap_p90 = percentile(st.partial_gap_ms, 0.9);
+            const bool pass = st.completed == n && final_p90 <= args.slo_final_ms &&
+                              gap_p90 <= args.slo_partial_gap_ms && st.dropped_audio_s == 0.0;
+            if (pass) best = std::max(best, n);
+
+            std::cout << json{
+                {"policy", policy.toJson()},
+                {"sessions", n},
+                {"completed", st.completed},
+                {"simulated_s", st.makespan_s},
+                {"utilization", st.makespan_s > 0 ? st.busy_s / (st.makespan_s * policy.slots) : 0.0},
+                {"partials", st.partials},
+                {"deadline_drops", st.deadline_drops},
+                {"busy_skips", st.busy_skips},
+                {"reused_finals", st.reused_finals},
+                {"dropped_audio_s", st.dropped_audio_s},
+                {"first_partial_ms", dist(st.first_partial_ms)},
+                {"partial_gap_ms", dist(st.partial_gap_ms)},
+                {"partial_latency_ms", dist(st.partial_latency_ms)},
+                {"commit_lag_ms", dist(st.commit_lag_ms)},
+                {"final_ms", dist(st.final_ms)},
+                {"slo_met", pass}
+            }.dump() << std::endl;
+            if (!pass && args.stop_on_fail) break;
+        }
+        std::cout << json{{"summary", true},
+                          {"policy", policy.toJson()},
+                          {"max_sessions_meeting_slo", best},
+                          {"slo_final_ms", args.slo_final_ms},
+                          {"slo_partial_gap_ms", args.slo_partial_gap_ms}}.dump() << std::endl;
+    }
+    return 0;
+}
@@ -51,6 +51,11 @@ class TranscriptionClient:
         self.ws = None
         self.running = False
         self.received_final = False
+        # Control de flujo: total acumulado de muestras que el servidor acepta
+        self.credit_limit = None
+        self.samples_sent = 0
+        # Modo bulk: enviar lo más rápido posible (solo limitado por los créditos)
+        self.bulk = False
     
     async def connect(self):
         """Conectar al servidor WebSocket"""
@@ -69,7 +74,7 @@ class TranscriptionClient:
         )
         print("✓ Conectado")
     
-    async def configure(self, language="es", token=None, vad_thold=0.0):
+    async def configure(self, language="es", token=None, vad_thold=0.0, mode=None):
         """Enviar configuración inicial"""
         config_msg = {
             "type": "config",
@@ -82,6 +87,10 @@ class TranscriptionClient:
         if vad_thold > 0.0:
             config_msg["vad_thold"] = vad_thold
 
+        if mode:
+            config_msg["mode"] = mode
+            self.bulk = mode == "bulk"
+
         print(f"⚙️  Enviando configuración: {config_msg}")
         await self.ws.send(json.dumps(config_msg))
         
@@ -91,6 +100,7 @@ class TranscriptionClient:
         
         if msg["type"] == "ready":
             print(f"✓ Servidor listo: {msg}")
+            self.credit_limit = msg.get("flow_control", {}).get("limit_samples")
         else:
             print(f"⚠️  Respuesta inesperada: {msg}")
     
@@ -98,8 +108,15 @@ class TranscriptionClient:
         """Enviar un chunk de audio (float32 array)"""
         # Convertir a bytes (float32 little-endian)
         audio_bytes = float_samples.tobytes()
-        
+
+        # Sin crédito: retener el audio hasta que el servidor vacíe su buffer
+        if self.credit_limit is not None and self.samples_sent + len(float_samples) > self.credit_limit:
+            print("⏸️  Sin crédito de audio, esperando al servidor...")
+            while self.samples_sent + len(float_samples) > self.credit_limit:
+                await self.handle_message(await self.ws.recv())
+
         await self.ws.send(audio_bytes)
+        self.samples_sent += len(float_samples)
 
     async def send_audio_file(self, wav_path, chunk_duration_ms=500):
         """Enviar archivo WAV en chunks"""
@@ -142,7 +159,8 @@ class TranscriptionClient:
                 await self.send_audio_chunk(float_samples, sample_rate)
                 chunk_num += 1
                 
-                await asyncio.sleep(chunk_duration_ms / 1000.0)
+                if not self.bulk:
+                    await asyncio.sleep(chunk_duration_ms / 1000.0)
                 await self.process_pending_messages()
 
             print(f"✓ Enviados {chunk_num} chunks")
@@ -240,6 +258,9 @@ class TranscriptionClient:
                 if is_final:
                     self.received_final = True
             
+            elif msg_type == "credit":
+                self.credit_limit = max(self.credit_limit or 0, msg.get("limit_samples", 0))
+
             elif msg_type == "warning":
                 print(f"⚠️  Servidor: [{msg.get('code')}] {msg.get('message')}")
 
@@ -268,6 +289,7 @@ async def main():
     parser.add_argument("--freq", type=float, default=440.0, help="Frecuencia para tono (Hz)")
     parser.add_argument("--url", type=str, default="ws://localhost:9001", help="URL del servidor")
     parser.add_argument("--token", type=str, help="Token de autenticación")
+    parser.add_argument("--bulk", action="store_true", help="Modo bulk: archivo más rápido que tiempo real, sin parciales")
     
     args = parser.parse_args()
     
@@ -275,7 +297,7 @@ async def main():
     
     try:
         await client.connect()
-        await client.configure(token=args.token)
+        await client.configure(token=args.token, mode="bulk" if args.bulk else None)
         
         if args.file:
             if not Path(args.file).exists():
@@ -7,9 +7,16 @@
 #include <boost/beast/ssl.hpp>
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <deque>
+#include <functional>
 #include <string>
 #include <stdexcept>
 #include <regex>
+#include <thread>
 
 #include "log/Log.h"
 
@@ -18,142 +25,451 @@ namespace http  = beast::http;
 namespace asio  = boost::asio;
 namespace ssl   = asio::ssl;
 using     tcp   = asio::ip::tcp;
+using     Clock = std::chrono::steady_clock;
 
 namespace {
 
 bool parseUrl(const std::string& url,
               std::string& scheme,
               std::string& host,
+              std::string& port,
               std::string& base_path) {
-    static const std::regex re(R"(^(https?)://([^/]+)(/.*)?)");
+    static const std::regex re(R"(^(https?)://([^/:]+)(?::(\d+))?(/.*)?)");
     std::smatch m;
     if (!std::regex_match(url, m, re)) {
         return false;
     }
     scheme    = m[1].str();
     host      = m[2].str();
-    base_path = m[3].matched ? m[3].str() : "";
+    port      = m[3].matched ? m[3].str() : (scheme == "https" ? "443" : "80");
+    base_path = m[4].matched ? m[4].str() : "";
+    if (!base_path.empty() && base_path.back() == '/') base_path.pop_back();
     return true;
 }
 
-// Returns the first non-link-local endpoint for the given host:port.
-tcp::endpoint resolveEndpoint(tcp::resolver& resolver,
-                              const std::string& host,
-                              const std::string& port) {
-    auto const results = resolver.resolve(host, port);
+// Drops link-local IPv6 addresses (not routable without a scope id).
+std::vector<tcp::endpoint> routableEndpoints(const tcp::resolver::results_type& results) {
+    std::vector<tcp::endpoint> out;
     for (auto const& ep : results) {
         auto addr = ep.endpoint().address();
         if (addr.is_v6() && addr.to_v6().is_link_local()) continue;
-        return ep.endpoint();
+        out.push_back(ep.endpoint());
     }
-    throw std::runtime_error("no routable address for " + host);
+    return out;
 }
 
+// Optional limits next to is_active; wrong types are ignored (the key keeps the defaults).
+ClientPolicy parsePolicy(const nlohmann::json& body) {
+    ClientPolicy policy;
+    if (auto it = body.find("tenant_id"); it != body.end()) {
+        if (it->is_string())              policy.tenant_id = it->get<std::string>();
+        else if (it->is_number_integer()) policy.tenant_id = std::to_string(it->get<int64_t>());
+    }
+    if (auto it = body.find("tier"); it != body.end()) {
+        if (it->is_string()) {
+            std::string tier = it->get<std::string>();
+            std::transform(tier.begin(), tier.end(), tier.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            if (tier == "free")         policy.tier = PriorityTier::Free;
+            else if (tier == "premium") policy.tier = PriorityTier::Premium;
+        } else if (it->is_number_integer()) {
+            policy.tier = static_cast<PriorityTier>(std::clamp(it->get<int>(), 0, 2));
+        }
+    }
+    if (auto it = body.find("max_sessions"); it != body.end() && it->is_number_integer()) {
+        policy.max_sessions = std::max(0, it->get<int>());
+    }
+    if (auto it = body.find("audio_seconds_per_minute"); it != body.end() && it->is_number()) {
+        policy.audio_seconds_per_minute = std::max(0.0, it->get<double>());
+    }
+    return policy;
+}
+
+struct Connection {
+    std::unique_ptr<beast::tcp_stream>                    plain;
+    std::unique_ptr<beast::ssl_stream<beast::tcp_stream>> tls;
+    Clock::time_point idle_since;
+
+    beast::tcp_stream& lowest() { return tls ? beast::get_lowest_layer(*tls) : *plain; }
+
+    // Invoke f with the concrete stream (plain or TLS).
+    template <class F>
+    void withStream(F&& f) {
+        if (tls) f(*tls);
+        else     f(*plain);
+    }
+};
+
 } // namespace
 
-ApiAuthClient::ApiAuthClient(const ApiAuthConfig& config)
-    : config_(config) {}
+// ---------------------------------------------------------------------------
+// Shared client state. Everything except the atomics is only touched on the
+// I/O thread, so it needs no locking.
+// ---------------------------------------------------------------------------
+struct ApiAuthClient::Impl {
+    explicit Impl(const ApiAuthConfig& cfg)
+        : config(cfg),
+          ssl_ctx(ssl::context::tls_client),
+          work(asio::make_work_guard(ioc)),
+          resolver(ioc),
+          dns_timer(ioc) {
+        valid_url = parseUrl(config.api_base_url, scheme, host, port, base_path);
+        use_tls   = (scheme == "https");
+        host_header = (port == (use_tls ? "443" : "80")) ? host : host + ":" + port;
+        // Internal service — skip certificate verification.
+        ssl_ctx.set_verify_mode(ssl::verify_none);
+    }
 
-AuthResult ApiAuthClient::validate(const std::string& client_key) {
-    std::string scheme, host, base_path;
-    if (!parseUrl(config_.api_base_url, scheme, host, base_path)) {
-        Log::error("Invalid auth API URL: " + config_.api_base_url);
-        return AuthResult::ApiUnavailable;
+    ~Impl() {
+        if (tls_session) SSL_SESSION_free(tls_session);
+    }
+
+    ApiAuthConfig config;
+    bool        valid_url = false;
+    bool        use_tls   = false;
+    std::string scheme, host, port, base_path, host_header;
+
+    ssl::context      ssl_ctx;
+    asio::io_context  ioc;
+    asio::executor_work_guard<asio::io_context::executor_type> work;
+    tcp::resolver     resolver;
+    asio::steady_timer dns_timer; // deadline of the lookup in flight
+    std::thread       thread;
+
+    // Keep-alive pool (most recently used at the back)
+    std::deque<std::unique_ptr<Connection>> idle;
+
+    // DNS cache; exchanges arriving while a lookup is in flight wait for it
+    std::vector<tcp::endpoint> endpoints;
+    Clock::time_point          endpoints_expire{};
+    bool                       resolving = false;
+    uint64_t                   dns_lookup_id = 0; // the lookup in flight; stale handlers ignore themselves
+    std::vector<std::function<void(const std::string& error)>> dns_waiters;
+
+    // Last resumable TLS session (owned reference)
+    SSL_SESSION* tls_session = nullptr;
+
+    // Metrics
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> connections_opened{0};
+    std::atomic<uint64_t> connections_reused{0};
+    std::atomic<uint64_t> tls_resumed{0};
+    std::atomic<uint64_t> dns_lookups{0};
+
+    std::unique_ptr<Connection> takeIdle() {
+        const auto max_idle = std::chrono::seconds(config.idle_timeout_seconds);
+        while (!idle.empty()) {
+            std::unique_ptr<Connection> c = std::move(idle.back());
+            idle.pop_back();
+            if (Clock::now() - c->idle_since < max_idle && c->lowest().socket().is_open()) {
+                return c;
+            }
+        }
+        return nullptr;
     }
 
-    const bool        use_tls = (scheme == "https");
-    const std::string port    = use_tls ? "443" : "80";
-    const std::string target  = base_path + "/client";
-    const std::string masked  = Log::maskKey(client_key);
+    void returnIdle(std::unique_ptr<Connection> c) {
+        c->idle_since = Clock::now();
+        idle.push_back(std::move(c));
+        while (idle.size() > static_cast<size_t>(std::max(config.pool_size, 0))) {
+            idle.pop_front(); // oldest first
+        }
+    }
 
-    Log::debug("Auth API GET " + config_.api_base_url + "/client key=" + masked);
+    // Ends the lookup in flight (answer, failure or deadline) for every exchange waiting on it.
+    void finishResolve(const std::string& error) {
+        resolving = false;
+        dns_timer.cancel();
+        auto waiters = std::move(dns_waiters);
+        dns_waiters.clear();
+        for (auto& w : waiters) w(error);
+    }
 
-    try {
-        asio::io_context ioc;
-        tcp::resolver    resolver(ioc);
-        auto const       endpoint = resolveEndpoint(resolver, host, port);
+    bool endpointsFresh() const {
+        return !endpoints.empty() && Clock::now() < endpoints_expire;
+    }
 
-        http::request<http::empty_body> req{http::verb::get, target, 11};
-        req.set(http::field::host, host);
-        req.set(http::field::user_agent, "TranscriptionServer/1.0");
-        req.set(http::field::authorization, "Bearer " + config_.api_secret_key);
-        req.set("X-API-Key", client_key);
+    void storeTlsSession(SSL* ssl) {
+        SSL_SESSION* s = SSL_get1_session(ssl);
+        if (!s) return;
+        if (!SSL_SESSION_is_resumable(s)) {
+            SSL_SESSION_free(s);
+            return;
+        }
+        if (tls_session) SSL_SESSION_free(tls_session);
+        tls_session = s;
+    }
+};
 
-        beast::flat_buffer              buf;
-        http::response<http::string_body> res;
+// ---------------------------------------------------------------------------
+// One request/response exchange: [resolve] → [connect] → [TLS handshake] →
+// write → read. A reused keep-alive connection the server has already closed
+// fails on write/read; that case is retried once on a fresh connection.
+// ---------------------------------------------------------------------------
+class ApiAuthClient::Exchange : public std::enable_shared_from_this<ApiAuthClient::Exchange> {
+public:
+    Exchange(Impl* impl, std::string key, Callback on_done)
+        : impl_(impl), key_(std::move(key)), masked_(Log::maskKey(key_)), on_done_(std::move(on_done)) {
+        req_ = {http::verb::get, impl_->base_path + "/client", 11};
+        req_.set(http::field::host, impl_->host_header);
+        req_.set(http::field::user_agent, "TranscriptionServer/1.0");
+        req_.set(http::field::authorization, "Bearer " + impl_->config.api_secret_key);
+        req_.set("X-API-Key", key_);
+        req_.keep_alive(true);
+    }
 
-        if (use_tls) {
-            ssl::context ctx(ssl::context::tls_client);
-            // Internal service — skip certificate verification.
-            ctx.set_verify_mode(ssl::verify_none);
+    // Exchanges dropped with the io_context at shutdown still report a result.
+    ~Exchange() {
+        if (!done_) on_done_(AuthResult::ApiUnavailable, ClientPolicy{});
+    }
 
-            beast::ssl_stream<beast::tcp_stream> stream(ioc, ctx);
-            // SNI
-            SSL_set_tlsext_host_name(stream.native_handle(), host.c_str());
+    void start() {
+        if (!impl_->valid_url) return complete(AuthResult::ApiUnavailable);
+        impl_->requests.fetch_add(1, std::memory_order_relaxed);
+        Log::debug("Auth API GET " + impl_->config.api_base_url + "/client key=" + masked_);
 
-            beast::get_lowest_layer(stream).expires_after(
-                std::chrono::seconds(config_.timeout_seconds));
-            beast::get_lowest_layer(stream).connect(endpoint);
+        conn_ = impl_->takeIdle();
+        if (conn_) {
+            reused_ = true;
+            impl_->connections_reused.fetch_add(1, std::memory_order_relaxed);
+            sendRequest();
+        } else {
+            connect();
+        }
+    }
 
-            beast::get_lowest_layer(stream).expires_after(
-                std::chrono::seconds(config_.timeout_seconds));
-            stream.handshake(ssl::stream_base::client);
+private:
+    std::chrono::seconds timeout() const { return std::chrono::seconds(impl_->config.timeout_seconds); }
+
+    void connect() {
+        reused_ = false;
+        if (impl_->endpointsFresh()) {
+            openConnection();
+            return;
+        }
 
-            beast::get_lowest_layer(stream).expires_after(
-                std::chrono::seconds(config_.timeout_seconds));
-            http::write(stream, req);
+        auto self = shared_from_this();
+        impl_->dns_waiters.push_back([self](const std::string& error) {
+            if (!error.empty()) return self->fail(error);
+            self->openConnection();
+        });
+        if (impl_->resolving) return;
 
-            beast::get_lowest_layer(stream).expires_after(
-                std::chrono::seconds(config_.timeout_seconds));
-            http::read(stream, buf, res);
+        impl_->resolving = true;
+        impl_->dns_lookups.fetch_add(1, std::memory_order_relaxed);
+        Impl* impl = impl_;
+        const uint64_t lookup = ++impl_->dns_lookup_id;
+        // getaddrinfo has no timeout of its own: without a deadline a hung lookup
+        // would hold every waiting exchange (and the sessions blocked on them).
+        impl_->dns_timer.expires_after(timeout());
+        impl_->dns_timer.async_wait([impl, lookup](beast::error_code ec) {
+            if (ec || !impl->resolving || lookup != impl->dns_lookup_id) return;
+            impl->resolver.cancel();
+            impl->finishResolve("resolve: timed out");
+        });
+        impl_->resolver.async_resolve(impl_->host, impl_->port,
+            [impl, lookup](beast::error_code ec, tcp::resolver::results_type results) {
+                if (!impl->resolving || lookup != impl->dns_lookup_id) return; // timed out
+                std::string error;
+                if (ec) {
+                    error = "resolve: " + ec.message();
+                } else {
+                    auto eps = routableEndpoints(results);
+                    if (eps.empty()) {
+                        error = "no routable address for " + impl->host;
+                    } else {
+                        impl->endpoints        = std::move(eps);
+                        impl->endpoints_expire = Clock::now() +
+                            std::chrono::seconds(impl->config.dns_cache_ttl_seconds);
+                    }
+                }
+                impl->finishResolve(error);
+            });
+    }
 
-            beast::error_code ec;
-            stream.shutdown(ec);
+    void openConnection() {
+        conn_ = std::make_unique<Connection>();
+        if (impl_->use_tls) {
+            conn_->tls = std::make_unique<beast::ssl_stream<beast::tcp_stream>>(impl_->ioc, impl_->ssl_ctx);
+            SSL* ssl = conn_->tls->native_handle();
+            SSL_set_tlsext_host_name(ssl, impl_->host.c_str()); // SNI
+            if (impl_->tls_session) SSL_set_session(ssl, impl_->tls_session);
         } else {
-            beast::tcp_stream stream(ioc);
-            stream.expires_after(std::chrono::seconds(config_.timeout_seconds));
-            stream.connect(endpoint);
+            conn_->plain = std::make_unique<beast::tcp_stream>(impl_->ioc);
+        }
+        impl_->connections_opened.fetch_add(1, std::memory_order_relaxed);
+
+        auto self = shared_from_this();
+        conn_->lowest().expires_after(timeout());
+        conn_->lowest().async_connect(impl_->endpoints,
+            [self](beast::error_code ec, const tcp::endpoint&) {
+                if (ec) {
+                    self->impl_->endpoints.clear(); // re-resolve next time
+                    return self->fail("connect: " + ec.message());
+                }
+                if (self->conn_->tls) self->handshake();
+                else                  self->sendRequest();
+            });
+    }
 
-            stream.expires_after(std::chrono::seconds(config_.timeout_seconds));
-            http::write(stream, req);
+    void handshake() {
+        auto self = shared_from_this();
+        conn_->lowest().expires_after(timeout());
+        conn_->tls->async_handshake(ssl::stream_base::client,
+            [self](beast::error_code ec) {
+                if (ec) return self->fail("TLS handshake: " + ec.message());
+                if (SSL_session_reused(self->conn_->tls->native_handle())) {
+                    self->impl_->tls_resumed.fetch_add(1, std::memory_order_relaxed);
+                }
+                self->sendRequest();
+            });
+    }
 
-            stream.expires_after(std::chrono::seconds(config_.timeout_seconds));
-            http::read(stream, buf, res);
+    void sendRequest() {
+        auto self = shared_from_this();
+        conn_->lowest().expires_after(timeout());
+        conn_->withStream([&](auto& stream) {
+            http::async_write(stream, req_,
+                [self](beast::error_code ec, std::size_t) {
+                    if (ec) return self->retryOrFail("write: " + ec.message());
+                    self->readResponse();
+                });
+        });
+    }
 
-            beast::error_code ec;
-            stream.socket().shutdown(tcp::socket::shutdown_both, ec);
+    void readResponse() {
+        auto self = shared_from_this();
+        res_ = {};
+        buf_.clear();
+        conn_->lowest().expires_after(timeout());
+        conn_->withStream([&](auto& stream) {
+            http::async_read(stream, buf_, res_,
+                [self](beast::error_code ec, std::size_t) {
+                    if (ec) return self->retryOrFail("read: " + ec.message());
+                    self->finish();
+                });
+        });
+    }
+
+    void retryOrFail(const std::string& what) {
+        if (reused_ && !retried_) {
+            Log::debug("Auth API pooled connection went stale (" + what + "), reconnecting");
+            retried_ = true;
+            conn_.reset();
+            connect();
+            return;
         }
+        fail(what);
+    }
 
-        const auto status = res.result_int();
-        Log::debug("Auth API response: HTTP " + std::to_string(status) + " key=" + masked);
+    void finish() {
+        // TLS 1.3 tickets arrive after the handshake: capture the session only now.
+        if (conn_->tls) impl_->storeTlsSession(conn_->tls->native_handle());
+
+        if (res_.keep_alive()) {
+            conn_->lowest().expires_never();
+            impl_->returnIdle(std::move(conn_));
+        }
+        complete(interpret());
+    }
+
+    AuthResult interpret() {
+        const auto status = res_.result_int();
+        Log::debug("Auth API response: HTTP " + std::to_string(status) + " key=" + masked_);
 
         if (status == 401 || status == 403) {
-            Log::info("Auth API: Denied (HTTP " + std::to_string(status) + ") key=" + masked);
+            Log::info("Auth API: Denied (HTTP " + std::to_string(status) + ") key=" + masked_);
             return AuthResult::Denied;
         }
 
         if (status == 200) {
             try {
-                auto body   = nlohmann::json::parse(res.body());
+                auto body   = nlohmann::json::parse(res_.body());
                 bool active = body.value("is_active", false);
                 if (active) {
-                    Log::info("Auth API: Allowed key=" + masked);
+                    policy_ = parsePolicy(body);
+                    Log::info("Auth API: Allowed key=" + masked_ +
+                              (policy_.tenant_id.empty() ? "" : " tenant=" + policy_.tenant_id) +
+                              " tier=" + tierName(policy_.tier));
                     return AuthResult::Allowed;
                 } else {
-                    Log::info("Auth API: Denied (is_active=false) key=" + masked);
+                    Log::info("Auth API: Denied (is_active=false) key=" + masked_);
                     return AuthResult::Denied;
                 }
             } catch (...) {
-                Log::warn("Auth API returned HTTP 200 but invalid JSON body key=" + masked);
+                Log::warn("Auth API returned HTTP 200 but invalid JSON body key=" + masked_);
                 return AuthResult::ApiUnavailable;
             }
         }
 
-        Log::warn("Auth API unexpected HTTP " + std::to_string(status) + " key=" + masked);
+        Log::warn("Auth API unexpected HTTP " + std::to_string(status) + " key=" + masked_);
         return AuthResult::ApiUnavailable;
+    }
 
-    } catch (std::exception& e) {
-        Log::error("Auth API request failed: " + std::string(e.what()) + " key=" + masked);
-        return AuthResult::ApiUnavailable;
+    void fail(const std::string& what) {
+        Log::error("Auth API request failed: " + what + " key=" + masked_);
+        conn_.reset();
+        complete(AuthResult::ApiUnavailable);
     }
+
+    void complete(AuthResult r) {
+        done_ = true;
+        on_done_(r, policy_);
+    }
+
+    Impl* impl_; // outlives every exchange: ~ApiAuthClient destroys pending ones with the io_context
+    std::string key_;
+    std::string masked_;
+    Callback on_done_;
+    ClientPolicy policy_;
+    bool done_    = false;
+    bool reused_  = false;
+    bool retried_ = false;
+
+    std::unique_ptr<Connection>       conn_;
+    http::request<http::empty_body>   req_;
+    beast::flat_buffer                buf_;
+    http::response<http::string_body> res_;
+};
+
+// ---------------------------------------------------------------------------
+
+ApiAuthClient::ApiAuthClient(const ApiAuthConfig& config)
+    : impl_(std::make_unique<Impl>(config)) {
+    if (!impl_->valid_url) {
+        Log::error("Invalid auth API URL: " + config.api_base_url);
+    }
+    impl_->thread = std::thread([impl = impl_.get()]() { impl->ioc.run(); });
+}
+
+ApiAuthClient::~ApiAuthClient() {
+    impl_->work.reset();
+    impl_->ioc.stop();
+    if (impl_->thread.joinable()) impl_->thread.join();
+    // impl_ (and its io_context) is destroyed next: handlers still queued are
+    // dropped, which resolves their futures as ApiUnavailable.
+}
+
+std::future<AuthResult> ApiAuthClient::validateAsync(const std::string& client_key) {
+    auto promise = std::make_shared<std::promise<AuthResult>>();
+    auto fut = promise->get_future();
+    validateAsync(client_key, [promise](AuthResult r, const ClientPolicy&) { promise->set_value(r); });
+    return fut;
+}
+
+void ApiAuthClient::validateAsync(const std::string& client_key, Callback on_done) {
+    auto exchange = std::make_shared<Exchange>(impl_.get(), client_key, std::move(on_done));
+    asio::post(impl_->ioc, [exchange]() { exchange->start(); });
+}
+
+AuthResult ApiAuthClient::validate(const std::string& client_key) {
+    return validateAsync(client_key).get();
+}
+
+std::string ApiAuthClient::getMetrics() const {
+    return "transcription_auth_api_requests_total " + std::to_string(impl_->requests.load(std::memory_order_relaxed)) + "\n" +
+           "transcription_auth_api_connections_opened_total " + std::to_string(impl_->connections_opened.load(std::memory_order_relaxed)) + "\n" +
+           "transcription_auth_api_connections_reused_total " + std::to_string(impl_->connections_reused.load(std::memory_order_relaxed)) + "\n" +
+           "transcription_auth_api_tls_resumed_total " + std::to_string(impl_->tls_resumed.load(std::memory_order_relaxed)) + "\n" +
+           "transcription_auth_api_dns_lookups_total " + std::to_string(impl_->dns_lookups.load(std::memory_order_relaxed)) + "\n";
 }
@@ -1,6 +1,10 @@
 #pragma once
+#include <functional>
+#include <future>
+#include <memory>
 #include <string>
 #include "ApiAuthConfig.h"
+#include "ClientPolicy.h"
 
 enum class AuthResult {
     Allowed,
@@ -8,12 +12,55 @@ enum class AuthResult {
     ApiUnavailable
 };
 
+/**
+ * @brief HTTP/1.1 client for the external auth API (`GET <base>/client`).
+ *
+ * A 200 response carries `is_active` and, optionally, the key's limits:
+ * `tenant_id`, `tier` ("free" | "standard" | "premium"), `max_sessions` and
+ * `audio_seconds_per_minute` (see ClientPolicy).
+ *
+ * Requests run asynchronously on a dedicated I/O thread. Connections are
+ * kept alive and pooled (up to pool_size idle), resolved addresses are cached
+ * for dns_cache_ttl_seconds, and on https the last TLS session is offered for
+ * resumption, so a cache miss usually costs one round-trip instead of
+ * DNS + TCP + TLS handshakes.
+ *
+ * Thread-safe.
+ */
 class ApiAuthClient {
 public:
     explicit ApiAuthClient(const ApiAuthConfig& config);
+    ~ApiAuthClient();
 
+    // Non-copyable
+    ApiAuthClient(const ApiAuthClient&) = delete;
+    ApiAuthClient& operator=(const ApiAuthClient&) = delete;
+
+    /// policy is only meaningful for AuthResult::Allowed.
+    using Callback = std::function<void(AuthResult, const ClientPolicy& policy)>;
+
+    /// Start validating client_key; the future never throws.
+    std::future<AuthResult> validateAsync(const std::string& client_key);
+
+    /**
+     * @brief Start validating client_key and call on_done exactly once.
+     *
+     * on_done runs on the client's I/O thread (or in ~ApiAuthClient with
+     * ApiUnavailable for requests still pending), never inside this call.
+     * It must not block.
+     */
+    void validateAsync(const std::string& client_key, Callback on_done);
+
+    /// Blocking convenience wrapper around validateAsync().
     AuthResult validate(const std::string& client_key);
 
+    /**
+     * @brief Get telemetry metrics in Prometheus format
+     */
+    std::string getMetrics() const;
+
 private:
-    ApiAuthConfig config_;
+    struct Impl;
+    class Exchange;
+    std::unique_ptr<Impl> impl_;
 };
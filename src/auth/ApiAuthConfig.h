@@ -1,4 +1,5 @@
 #pragma once
+#include <cstddef>
 #include <string>
 
 struct ApiAuthConfig {
@@ -6,6 +7,13 @@ struct ApiAuthConfig {
     std::string api_secret_key;     // Authorization: Bearer <...>
     int timeout_seconds = 5;
     int cache_ttl_seconds = 300;
+    int negative_cache_ttl_seconds = 30; // TTL for denied keys (a newly activated key is retried sooner)
+    size_t cache_max_entries = 10000;    // LRU-evicted beyond this (bounds memory under unique-key floods)
 
     std::string static_token;       // Simple static token (used when api_base_url is empty)
+
+    // HTTP client tuning
+    int pool_size = 4;              // idle keep-alive connections kept to the auth API
+    int idle_timeout_seconds = 30;  // drop pooled connections idle for longer than this
+    int dns_cache_ttl_seconds = 60; // reuse resolved addresses for this long
 };
@@ -1,22 +1,147 @@
 #include "AuthCache.h"
+#include <openssl/evp.h>
 
-std::optional<bool> AuthCache::get(const std::string& token) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = entries_.find(token);
-    if (it == entries_.end()) {
-        return std::nullopt;
+AuthCache::AuthCache(size_t max_entries, int sweep_interval_seconds)
+    : shard_capacity_(std::max<size_t>(1, (max_entries + SHARDS - 1) / SHARDS)) {
+    if (sweep_interval_seconds > 0) {
+        sweeper_ = std::thread([this, sweep_interval_seconds]() {
+            sweepLoop(std::chrono::seconds(sweep_interval_seconds));
+        });
     }
-    if (std::chrono::steady_clock::now() >= it->second.expires_at) {
-        entries_.erase(it);
-        return std::nullopt;
+}
+
+AuthCache::~AuthCache() {
+    {
+        std::lock_guard<std::mutex> lock(sweeper_mutex_);
+        stopping_ = true;
+    }
+    sweeper_cv_.notify_all();
+    if (sweeper_.joinable()) sweeper_.join();
+}
+
+// static
+AuthCache::Key AuthCache::hashToken(const std::string& token) {
+    Key key{};
+    unsigned int len = 0;
+    EVP_Digest(token.data(), token.size(), key.data(), &len, EVP_sha256(), nullptr);
+    return key;
+}
+
+AuthCache::Lookup AuthCache::lookup(const std::string& token) {
+    const Key key = hashToken(token);
+    Shard& shard  = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return {};
     }
-    return it->second.is_valid;
+    auto now = Clock::now();
+    CacheEntry& entry = *it->second;
+    if (now >= entry.expires_at) {
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+        expired_.fetch_add(1, std::memory_order_relaxed);
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return {};
+    }
+
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    hits_.fetch_add(1, std::memory_order_relaxed);
+
+    Lookup result{entry.is_valid, entry.policy, false};
+    if (now >= entry.refresh_at && !entry.refreshing) {
+        entry.refreshing = true;
+        result.refresh = true;
+    }
+    return result;
 }
 
-void AuthCache::put(const std::string& token, bool is_valid, int ttl_seconds) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    entries_[token] = CacheEntry{
+void AuthCache::put(const std::string& token, bool is_valid, int ttl_seconds, const ClientPolicy& policy) {
+    const Key key = hashToken(token);
+    Shard& shard  = shardFor(key);
+
+    auto now = Clock::now();
+    auto ttl = std::chrono::milliseconds(static_cast<int64_t>(ttl_seconds) * 1000);
+    CacheEntry entry{
+        key,
         is_valid,
-        std::chrono::steady_clock::now() + std::chrono::seconds(ttl_seconds)
+        policy,
+        now + ttl,
+        now + std::chrono::duration_cast<std::chrono::milliseconds>(ttl * (1.0 - REFRESH_AHEAD)),
+        false
     };
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        *it->second = entry;
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        return;
+    }
+
+    if (shard.lru.size() >= shard_capacity_) {
+        shard.index.erase(shard.lru.back().key);
+        shard.lru.pop_back();
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+    shard.lru.push_front(entry);
+    shard.index.emplace(key, shard.lru.begin());
+}
+
+void AuthCache::refreshFailed(const std::string& token) {
+    const Key key = hashToken(token);
+    Shard& shard  = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        it->second->refreshing = false;
+    }
+}
+
+size_t AuthCache::sweepExpired() {
+    size_t removed = 0;
+    for (Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto now = Clock::now();
+        for (auto it = shard.lru.begin(); it != shard.lru.end();) {
+            if (now >= it->expires_at) {
+                shard.index.erase(it->key);
+                it = shard.lru.erase(it);
+                ++removed;
+            } else {
+                ++it;
+            }
+        }
+    }
+    expired_.fetch_add(removed, std::memory_order_relaxed);
+    return removed;
+}
+
+size_t AuthCache::size() const {
+    size_t n = 0;
+    for (const Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        n += shard.lru.size();
+    }
+    return n;
+}
+
+void AuthCache::sweepLoop(std::chrono::seconds interval) {
+    std::unique_lock<std::mutex> lock(sweeper_mutex_);
+    while (!sweeper_cv_.wait_for(lock, interval, [this] { return stopping_; })) {
+        lock.unlock();
+        sweepExpired();
+        lock.lock();
+    }
+}
+
+std::string AuthCache::getMetrics() const {
+    return "transcription_auth_cache_hits_total " + std::to_string(hits_.load(std::memory_order_relaxed)) + "\n" +
+           "transcription_auth_cache_misses_total " + std::to_string(misses_.load(std::memory_order_relaxed)) + "\n" +
+           "transcription_auth_cache_entries " + std::to_string(size()) + "\n" +
+           "transcription_auth_cache_capacity " + std::to_string(capacity()) + "\n" +
+           "transcription_auth_cache_evictions_total " + std::to_string(evictions_.load(std::memory_order_relaxed)) + "\n" +
+           "transcription_auth_cache_expired_total " + std::to_string(expired_.load(std::memory_order_relaxed)) + "\n";
 }
@@ -1,21 +1,118 @@
 #pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include "ClientPolicy.h"
 
+/**
+ * @brief Bounded cache of auth verdicts.
+ *
+ * Entries are keyed by the SHA-256 of the token (raw keys are never stored)
+ * and spread over SHARDS independently locked shards, each an LRU list with
+ * max_entries / SHARDS slots: a flood of unique keys evicts the least
+ * recently used entries instead of growing the map. A sweeper thread drops
+ * expired entries every sweep_interval_seconds (0 = only on lookup).
+ *
+ * Thread-safe.
+ */
 class AuthCache {
 public:
-    std::optional<bool> get(const std::string& token);
-    void put(const std::string& token, bool is_valid, int ttl_seconds);
+    static constexpr size_t SHARDS = 16;
+
+    /// Fraction of the TTL left at which an entry becomes due for refresh.
+    static constexpr double REFRESH_AHEAD = 0.2;
+
+    explicit AuthCache(size_t max_entries = 10000, int sweep_interval_seconds = 30);
+    ~AuthCache();
+
+    // Non-copyable (owns the sweeper thread)
+    AuthCache(const AuthCache&) = delete;
+    AuthCache& operator=(const AuthCache&) = delete;
+
+    struct Lookup {
+        std::optional<bool> valid; // nullopt = miss or expired
+        ClientPolicy policy;       // limits cached with an allowed verdict
+        bool refresh = false;      // hit inside the refresh-ahead window; claimed by this caller only
+    };
+
+    /**
+     * @brief Look up a token.
+     *
+     * The first lookup that lands in the last REFRESH_AHEAD of an entry's TTL
+     * gets refresh=true; later ones keep getting the cached verdict without
+     * the flag until put() or refreshFailed() is called for the token.
+     */
+    Lookup lookup(const std::string& token);
+
+    void put(const std::string& token, bool is_valid, int ttl_seconds, const ClientPolicy& policy = {});
+
+    /// A background refresh failed: let the next lookup in the window retry.
+    void refreshFailed(const std::string& token);
+
+    /// Drop expired entries now; returns how many were removed.
+    size_t sweepExpired();
+
+    size_t size() const;
+    size_t capacity() const { return shard_capacity_ * SHARDS; }
+
+    /**
+     * @brief Get telemetry metrics in Prometheus format
+     */
+    std::string getMetrics() const;
 
 private:
+    using Clock = std::chrono::steady_clock;
+    using Key   = std::array<uint8_t, 32>; // SHA-256 of the token
+
+    struct KeyHash {
+        size_t operator()(const Key& k) const {
+            size_t h;
+            std::memcpy(&h, k.data(), sizeof(h));
+            return h;
+        }
+    };
+
     struct CacheEntry {
+        Key key;
         bool is_valid;
-        std::chrono::steady_clock::time_point expires_at;
+        ClientPolicy policy;
+        Clock::time_point expires_at;
+        Clock::time_point refresh_at;
+        bool refreshing = false;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<CacheEntry> lru; // most recently used at the front
+        std::unordered_map<Key, std::list<CacheEntry>::iterator, KeyHash> index;
     };
 
-    std::mutex mutex_;
-    std::unordered_map<std::string, CacheEntry> entries_;
+    static Key hashToken(const std::string& token);
+    Shard& shardFor(const Key& key) { return shards_[key[sizeof(size_t)] % SHARDS]; }
+
+    void sweepLoop(std::chrono::seconds interval);
+
+    size_t shard_capacity_;
+    std::array<Shard, SHARDS> shards_;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+    std::atomic<uint64_t> expired_{0};
+
+    std::mutex sweeper_mutex_;
+    std::condition_variable sweeper_cv_;
+    bool stopping_ = false;
+    std::thread sweeper_;
 };
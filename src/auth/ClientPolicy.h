@@ -0,0 +1,32 @@
+#pragma once
+#include <string>
+
+/// Service tier of an API key. Higher tiers win inference slots first.
+enum class PriorityTier : int {
+    Free     = 0,
+    Standard = 1,
+    Premium  = 2
+};
+
+inline const char* tierName(PriorityTier tier) {
+    switch (tier) {
+        case PriorityTier::Free:    return "free";
+        case PriorityTier::Premium: return "premium";
+        default:                    return "standard";
+    }
+}
+
+/**
+ * @brief Per-key limits returned by the auth API next to `is_active`.
+ *
+ * Every field is optional in the response; the defaults impose no limit, so
+ * an auth API that only returns `is_active` behaves as before.
+ */
+struct ClientPolicy {
+    std::string  tenant_id;                     // "" = no per-tenant accounting
+    PriorityTier tier = PriorityTier::Standard;
+    int          max_sessions = 0;              // concurrent sessions per tenant (0 = unlimited)
+    double       audio_seconds_per_minute = 0;  // audio quota per tenant (0 = unlimited)
+
+    int priority() const { return static_cast<int>(tier); }
+};
@@ -1,13 +1,17 @@
 #pragma once
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
 #include <ctime>
-#include <iomanip>
-#include <iostream>
 #include <mutex>
-#include <sstream>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
 
-// Simple thread-safe logger with timestamps and log levels.
+// Asynchronous, level-filtered logger with timestamps.
 //
 // Usage:
 //   Log::info("Server started", "main");
@@ -15,19 +19,73 @@
 //   Log::error("Model load failed: " + e.what(), session_id_);
 //   Log::debug("HTTP 200 from auth API", session_id_);
 //
-// Set LOG_LEVEL env var at runtime (not supported here — compile-time only).
-// To suppress DEBUG output compile with -DLOG_NO_DEBUG.
+// Hot paths should pass a callable so the message is only built when the
+// level is enabled:
+//   Log::debug([&] { return "new=" + std::to_string(n); }, session_id_);
+//
+// Runtime configuration (read on first use and again by configureFromEnv()):
+//   LOG_LEVEL  = debug | info | warn | error | off   (default: info)
+//   LOG_FORMAT = text | json                         (default: text)
+// To compile DEBUG output out entirely build with -DLOG_NO_DEBUG.
+//
+// Callers only pay for a relaxed level check plus a lock-free push onto an
+// MPSC queue. A background writer thread formats timestamps and writes
+// batches to stdout (DEBUG/INFO) and stderr (WARN/ERROR). Pending records
+// are drained at process exit.
 
 class Log {
 public:
+    enum class Level { DEBUG, INFO, WARN, ERROR, OFF };
+    enum class Format { TEXT, JSON };
+
     static void debug(const std::string& msg, const std::string& ctx = "") {
 #ifndef LOG_NO_DEBUG
-        write(Level::DEBUG, msg, ctx);
+        if (enabled(Level::DEBUG)) write(Level::DEBUG, msg, ctx);
 #endif
     }
-    static void info (const std::string& msg, const std::string& ctx = "") { write(Level::INFO,  msg, ctx); }
-    static void warn (const std::string& msg, const std::string& ctx = "") { write(Level::WARN,  msg, ctx); }
-    static void error(const std::string& msg, const std::string& ctx = "") { write(Level::ERROR, msg, ctx); }
+    static void info (const std::string& msg, const std::string& ctx = "") { if (enabled(Level::INFO))  write(Level::INFO,  msg, ctx); }
+    static void warn (const std::string& msg, const std::string& ctx = "") { if (enabled(Level::WARN))  write(Level::WARN,  msg, ctx); }
+    static void error(const std::string& msg, const std::string& ctx = "") { if (enabled(Level::ERROR)) write(Level::ERROR, msg, ctx); }
+
+    // Lazy variant: build_msg() is only invoked when DEBUG is enabled.
+    template <class F, class = std::enable_if_t<std::is_invocable_r_v<std::string, F&>>>
+    static void debug(F&& build_msg, const std::string& ctx = "") {
+#ifndef LOG_NO_DEBUG
+        if (enabled(Level::DEBUG)) write(Level::DEBUG, build_msg(), ctx);
+#endif
+    }
+
+    static bool enabled(Level level) {
+        return level >= threshold().load(std::memory_order_relaxed);
+    }
+
+    static void setLevel(Level level)   { threshold().store(level, std::memory_order_relaxed); }
+    static void setFormat(Format fmt)   { format().store(fmt, std::memory_order_relaxed); }
+
+    // Redirect output (default stdout / stderr). Used by tests and benchmarks.
+    static void setOutput(std::FILE* out, std::FILE* err) {
+        outStream().store(out, std::memory_order_relaxed);
+        errStream().store(err, std::memory_order_relaxed);
+    }
+
+    // Re-read LOG_LEVEL / LOG_FORMAT (call after loading a .env file).
+    static void configureFromEnv() {
+        setLevel(levelFromEnv());
+        setFormat(formatFromEnv());
+    }
+
+    static Level parseLevel(const std::string& s, Level fallback) {
+        std::string v = lower(s);
+        if (v == "debug")                    return Level::DEBUG;
+        if (v == "info")                     return Level::INFO;
+        if (v == "warn" || v == "warning")   return Level::WARN;
+        if (v == "error")                    return Level::ERROR;
+        if (v == "off" || v == "none")       return Level::OFF;
+        return fallback;
+    }
+
+    // Block until every record enqueued before this call has been written.
+    static void flush() { writer().flush(); }
 
     // Mask a token/key for safe logging: show first 6 chars + "..."
     static std::string maskKey(const std::string& key) {
@@ -35,30 +93,284 @@ public:
         return key.substr(0, 6) + "...";
     }
 
+    // Render one log line (without trailing newline). Exposed for tests.
+    static std::string formatLine(Level level,
+                                  std::chrono::system_clock::time_point ts,
+                                  const std::string& msg,
+                                  const std::string& ctx,
+                                  Format fmt) {
+        std::string out;
+        TimeCache cache;
+        appendLine(out, level, ts, msg, ctx, fmt, cache);
+        return out;
+    }
+
 private:
-    enum class Level { DEBUG, INFO, WARN, ERROR };
+    struct Record {
+        std::atomic<Record*> next{nullptr};
+        Level level = Level::INFO;
+        std::chrono::system_clock::time_point ts;
+        std::string msg;
+        std::string ctx;
+    };
+
+    // Per-second cache of the formatted date part; only touched by the writer.
+    struct TimeCache {
+        std::time_t sec = -1;
+        Format      fmt = Format::TEXT;
+        char        buf[32] = {0};
+    };
+
+    // Vyukov intrusive MPSC queue: producers exchange head_, the single
+    // consumer walks from tail_. push() never blocks or takes a lock.
+    class Writer {
+    public:
+        Writer() : head_(&stub_), tail_(&stub_) {
+            thread_ = std::thread([this] { run(); });
+        }
+
+        void push(Record* r) {
+            enqueued_.fetch_add(1, std::memory_order_relaxed);
+            Record* prev = head_.exchange(r, std::memory_order_acq_rel);
+            prev->next.store(r, std::memory_order_release);
+            if (idle_.load(std::memory_order_acquire)) cv_.notify_one();
+        }
+
+        bool running() const { return !stopped_.load(std::memory_order_acquire); }
+
+        void flush() {
+            uint64_t target = enqueued_.load(std::memory_order_relaxed);
+            while (running() && written_.load(std::memory_order_acquire) < target) {
+                cv_.notify_one();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        void stop() {
+            if (stop_requested_.exchange(true)) return;
+            cv_.notify_one();
+            if (thread_.joinable()) thread_.join();
+            stopped_.store(true, std::memory_order_release);
+        }
+
+    private:
+        Record* pop() {
+            Record* tail = tail_;
+            Record* next = tail->next.load(std::memory_order_acquire);
+            if (!next) return nullptr;
+            // next becomes the new stub; hand its payload out in tail's place.
+            tail->level = next->level;
+            tail->ts    = next->ts;
+            tail->msg   = std::move(next->msg);
+            tail->ctx   = std::move(next->ctx);
+            tail_ = next;
+            return tail;
+        }
+
+        void run() {
+            std::string out, err;
+            TimeCache cache;
+            while (true) {
+                size_t n = 0;
+                // Cap each batch so a flood of records still gets flushed regularly.
+                while (n < 1024) {
+                    Record* r = pop();
+                    if (!r) break;
+                    std::string& dst = (r->level >= Level::WARN) ? err : out;
+                    appendLine(dst, r->level, r->ts, r->msg, r->ctx,
+                               format().load(std::memory_order_relaxed), cache);
+                    dst += '\n';
+                    if (r != &stub_) delete r;
+                    ++n;
+                }
+
+                if (n > 0) {
+                    if (!out.empty()) { writeBatch(outStream().load(std::memory_order_relaxed), out); }
+                    if (!err.empty()) { writeBatch(errStream().load(std::memory_order_relaxed), err); }
+                    written_.fetch_add(n, std::memory_order_release);
+                    continue;
+                }
+
+                if (stop_requested_.load(std::memory_order_acquire)) break;
+
+                // Producers notify only while idle_ is set; the timeout bounds
+                // the delay if a notify races with the transition to idle.
+                std::unique_lock<std::mutex> lk(idle_mutex_);
+                idle_.store(true, std::memory_order_release);
+                if (!tail_->next.load(std::memory_order_acquire) &&
+                    !stop_requested_.load(std::memory_order_acquire)) {
+                    cv_.wait_for(lk, std::chrono::milliseconds(50));
+                }
+                idle_.store(false, std::memory_order_release);
+            }
+        }
+
+        static void writeBatch(std::FILE* f, std::string& buf) {
+            std::fwrite(buf.data(), 1, buf.size(), f);
+            std::fflush(f);
+            buf.clear();
+        }
+
+        Record stub_;
+        std::atomic<Record*> head_;
+        Record* tail_; // consumer only
+        std::thread thread_;
+        std::mutex idle_mutex_;
+        std::condition_variable cv_;
+        std::atomic<bool> idle_{false};
+        std::atomic<bool> stop_requested_{false};
+        std::atomic<bool> stopped_{false};
+        std::atomic<uint64_t> enqueued_{0};
+        std::atomic<uint64_t> written_{0};
+    };
 
     static void write(Level level, const std::string& msg, const std::string& ctx) {
+        Writer& w = writer();
+        if (w.running()) {
+            Record* r = new Record;
+            r->level = level;
+            r->ts    = std::chrono::system_clock::now();
+            r->msg   = msg;
+            r->ctx   = ctx;
+            w.push(r);
+            return;
+        }
+
+        // Writer already stopped (process exit): write synchronously.
         static std::mutex mx;
         std::lock_guard<std::mutex> lk(mx);
+        std::string line;
+        TimeCache cache;
+        appendLine(line, level, std::chrono::system_clock::now(), msg, ctx,
+                   format().load(std::memory_order_relaxed), cache);
+        line += '\n';
+        std::FILE* f = (level >= Level::WARN) ? errStream().load() : outStream().load();
+        std::fwrite(line.data(), 1, line.size(), f);
+        std::fflush(f);
+    }
+
+    // Intentionally leaked so that logging from other static destructors stays
+    // valid; the atexit hook drains the queue and joins the writer thread.
+    static Writer& writer() {
+        static Writer* w = [] {
+            auto* inst = new Writer();
+            std::atexit([] { writer().stop(); });
+            return inst;
+        }();
+        return *w;
+    }
+
+    static std::atomic<Level>& threshold() {
+        static std::atomic<Level> level{levelFromEnv()};
+        return level;
+    }
+
+    static std::atomic<Format>& format() {
+        static std::atomic<Format> fmt{formatFromEnv()};
+        return fmt;
+    }
+
+    static std::atomic<std::FILE*>& outStream() {
+        static std::atomic<std::FILE*> f{stdout};
+        return f;
+    }
 
-        auto& out = (level >= Level::WARN) ? std::cerr : std::cout;
-        out << timestamp() << " " << tag(level);
-        if (!ctx.empty()) out << " [" << ctx << "]";
-        out << " " << msg << std::endl;
+    static std::atomic<std::FILE*>& errStream() {
+        static std::atomic<std::FILE*> f{stderr};
+        return f;
     }
 
-    static std::string timestamp() {
-        auto now  = std::chrono::system_clock::now();
-        auto ms   = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
-        auto time = std::chrono::system_clock::to_time_t(now);
-        std::ostringstream oss;
-        // localtime_r is thread-safe; localtime is not on all platforms
-        std::tm tm{};
-        localtime_r(&time, &tm);
-        oss << std::put_time(&tm, "%H:%M:%S")
-            << '.' << std::setfill('0') << std::setw(3) << ms.count();
-        return oss.str();
+    static Level levelFromEnv() {
+        const char* v = std::getenv("LOG_LEVEL");
+        return v ? parseLevel(v, Level::INFO) : Level::INFO;
+    }
+
+    static Format formatFromEnv() {
+        const char* v = std::getenv("LOG_FORMAT");
+        return (v && lower(v) == "json") ? Format::JSON : Format::TEXT;
+    }
+
+    static std::string lower(std::string s) {
+        for (char& c : s) {
+            if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+        }
+        return s;
+    }
+
+    static void appendLine(std::string& out, Level level,
+                           std::chrono::system_clock::time_point ts,
+                           const std::string& msg, const std::string& ctx,
+                           Format fmt, TimeCache& cache) {
+        auto since_epoch = ts.time_since_epoch();
+        auto ms   = std::chrono::duration_cast<std::chrono::milliseconds>(since_epoch).count() % 1000;
+        auto secs = std::chrono::system_clock::to_time_t(ts);
+
+        if (secs != cache.sec || fmt != cache.fmt) {
+            // localtime_r/gmtime_r are thread-safe; localtime is not on all platforms
+            std::tm tm{};
+            if (fmt == Format::JSON) {
+                gmtime_r(&secs, &tm);
+                std::strftime(cache.buf, sizeof(cache.buf), "%Y-%m-%dT%H:%M:%S", &tm);
+            } else {
+                localtime_r(&secs, &tm);
+                std::strftime(cache.buf, sizeof(cache.buf), "%H:%M:%S", &tm);
+            }
+            cache.sec = secs;
+            cache.fmt = fmt;
+        }
+
+        char millis[8];
+        std::snprintf(millis, sizeof(millis), ".%03d", static_cast<int>(ms));
+
+        if (fmt == Format::JSON) {
+            out += "{\"ts\":\"";
+            out += cache.buf;
+            out += millis;
+            out += "Z\",\"level\":\"";
+            out += name(level);
+            out += '"';
+            if (!ctx.empty()) {
+                out += ",\"ctx\":\"";
+                appendJsonEscaped(out, ctx);
+                out += '"';
+            }
+            out += ",\"msg\":\"";
+            appendJsonEscaped(out, msg);
+            out += "\"}";
+            return;
+        }
+
+        out += cache.buf;
+        out += millis;
+        out += ' ';
+        out += tag(level);
+        if (!ctx.empty()) {
+            out += " [";
+            out += ctx;
+            out += ']';
+        }
+        out += ' ';
+        out += msg;
+    }
+
+    static void appendJsonEscaped(std::string& out, const std::string& s) {
+        for (char c : s) {
+            switch (c) {
+                case '"':  out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n";  break;
+                case '\r': out += "\\r";  break;
+                case '\t': out += "\\t";  break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char buf[8];
+                        std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
+                        out += buf;
+                    } else {
+                        out += c;
+                    }
+            }
+        }
     }
 
     static const char* tag(Level l) {
@@ -67,7 +379,19 @@ private:
             case Level::INFO:  return "[INFO] ";
             case Level::WARN:  return "[WARN] ";
             case Level::ERROR: return "[ERROR]";
+            case Level::OFF:   break;
         }
         return "[?]   ";
     }
+
+    static const char* name(Level l) {
+        switch (l) {
+            case Level::DEBUG: return "debug";
+            case Level::INFO:  return "info";
+            case Level::WARN:  return "warn";
+            case Level::ERROR: return "error";
+            case Level::OFF:   break;
+        }
+        return "?";
+    }
 };
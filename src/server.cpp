@@ -13,15 +13,26 @@
 #include <unordered_map>
 #include <sstream>
 #include <cstdlib>
+#include <filesystem>
+#include <algorithm>
 #include "server/StreamingSession.h"
 #include "server/ServerConfig.h"
 #include "server/ConnectionLimiter.h"
 #include "server/ConnectionGuard.h"
 #include "server/AuthManager.h"
+#include "server/TranscribeEndpoint.h"
+#include "server/AdmissionController.h"
+#include "server/SessionCapture.h"
+#include "server/MemoryBudget.h"
+#include "server/AutoSizing.h"
 #include "auth/ApiAuthConfig.h"
 #include "whisper/ModelCache.h"
+#include "whisper/TranscriptionBackend.h"
 #include "whisper/InferenceLimiter.h"
+#include "whisper/NumaPlacement.h"
+#include "whisper/EngineMetrics.h"
 #include "server/SessionTracker.h"
+#include "utils/ProcessMemory.h"
 #include "log/Log.h"
 
 using tcp = boost::asio::ip::tcp;
@@ -75,6 +86,15 @@ std::string env(const char* var) {
     return v ? std::string(v) : std::string{};
 }
 
+// "auto" → 0, which ServerConfig reads as "size from the cgroup limits". A literal 0
+// (or less) is refused rather than silently read as auto.
+int parseAuto(const std::string& v) {
+    if (v == "auto") return 0;
+    const int n = std::stoi(v);
+    if (n <= 0) throw std::invalid_argument("expected a positive number or 'auto', got " + v);
+    return n;
+}
+
 ServerConfig configFromEnv() {
     ServerConfig cfg;
 
@@ -99,9 +119,18 @@ ServerConfig configFromEnv() {
     if (auto v = env("AUTH_CACHE_TTL"); !v.empty())
         cfg.auth_cache_ttl = std::stoi(v);
 
+    if (auto v = env("AUTH_NEGATIVE_CACHE_TTL"); !v.empty())
+        cfg.auth_negative_cache_ttl = std::stoi(v);
+
+    if (auto v = env("AUTH_CACHE_MAX_ENTRIES"); !v.empty())
+        cfg.auth_cache_max_entries = std::stoul(v);
+
     if (auto v = env("AUTH_API_TIMEOUT"); !v.empty())
         cfg.auth_api_timeout = std::stoi(v);
 
+    if (auto v = env("AUTH_API_POOL_SIZE"); !v.empty())
+        cfg.auth_api_pool_size = std::stoi(v);
+
     if (auto v = env("TLS_CERT"); !v.empty())
         cfg.cert_path = v;
 
@@ -119,14 +148,17 @@ ServerConfig configFromEnv() {
         cfg.whisper_beam_size = std::stoi(v);
 
     if (auto v = env("WHISPER_THREADS"); !v.empty())
-        cfg.whisper_threads = std::stoi(v);
+        cfg.whisper_threads = parseAuto(v);
 
     if (auto v = env("MAX_CONCURRENT_INFERENCE"); !v.empty())
-        cfg.max_concurrent_inference = std::stoi(v);
+        cfg.max_concurrent_inference = parseAuto(v);
 
     if (auto v = env("MODEL_CACHE_TTL"); !v.empty())
         cfg.model_cache_ttl = std::stoi(v);
 
+    if (auto v = env("MODEL_LOAD"); !v.empty())
+        cfg.model_load = v;
+
     if (auto v = env("WHISPER_INITIAL_PROMPT"); !v.empty())
         cfg.whisper_initial_prompt = v;
 
@@ -148,6 +180,47 @@ ServerConfig configFromEnv() {
     if (auto v = env("SHUTDOWN_TIMEOUT_SEC"); !v.empty())
         cfg.shutdown_timeout_sec = std::stoi(v);
 
+    if (auto v = env("PARTIAL_DEADLINE_MS"); !v.empty())
+        cfg.partial_deadline_ms = std::stoi(v);
+
+    if (auto v = env("PARTIAL_LATENCY_SLO_MS"); !v.empty())
+        cfg.partial_latency_slo_ms = std::stoi(v);
+
+    if (auto v = env("ADMISSION_MAX_UTILIZATION"); !v.empty())
+        cfg.admission_max_utilization = std::stod(v);
+
+    if (auto v = env("MAX_UPLOAD_MB"); !v.empty())
+        cfg.max_upload_mb = static_cast<size_t>(std::stoul(v));
+
+    if (auto v = env("MEMORY_BUDGET_MB"); !v.empty()) {
+        cfg.memory_budget_auto = (v == "auto");
+        if (!cfg.memory_budget_auto) cfg.memory_budget_mb = static_cast<size_t>(std::stoul(v));
+    }
+
+    if (auto v = env("MEMORY_QUEUE_TIMEOUT_MS"); !v.empty())
+        cfg.memory_queue_timeout_ms = std::stoi(v);
+
+    if (auto v = env("NUMA_PLACEMENT"); !v.empty())
+        cfg.numa_placement = v;
+
+    if (auto v = env("NUMA_TOPOLOGY"); !v.empty())
+        cfg.numa_topology = v;
+
+    if (auto v = env("TRANSCRIPTION_BACKEND"); !v.empty())
+        cfg.backend = v;
+
+    if (auto v = env("MOCK_DECODE_MS"); !v.empty())
+        cfg.mock_decode_ms = std::stod(v);
+
+    if (auto v = env("MOCK_DECODE_MS_PER_AUDIO_S"); !v.empty())
+        cfg.mock_decode_ms_per_audio_s = std::stod(v);
+
+    if (auto v = env("MOCK_WORDS_PER_SECOND"); !v.empty())
+        cfg.mock_words_per_second = std::stod(v);
+
+    if (auto v = env("CAPTURE_DIR"); !v.empty())
+        cfg.capture_dir = v;
+
     return cfg;
 }
 
@@ -158,21 +231,36 @@ void printUsage(const char* binary) {
               << " [--model path] [--bind address] [--port N]"
               << " [--auth-token TOKEN]"
               << " [--auth-api-url URL] [--auth-api-secret SECRET]"
-              << " [--auth-cache-ttl N] [--auth-api-timeout N]"
+              << " [--auth-cache-ttl N] [--auth-negative-cache-ttl N] [--auth-cache-max-entries N]"
+              << " [--auth-api-timeout N] [--auth-api-pool-size N]"
               << " [--cert cert.pem] [--key key.pem]"
               << " [--max-connections N] [--max-connections-per-ip N]"
-              << " [--whisper-beam-size N] [--whisper-threads N]"
-              << " [--max-concurrent-inference N] [--model-cache-ttl N]"
+              << " [--whisper-beam-size N] [--whisper-threads N|auto]"
+              << " [--max-concurrent-inference N|auto] [--model-cache-ttl N]"
+              << " [--model-load read|mmap]"
               << " [--whisper-initial-prompt TEXT] [--session-timeout-sec N] [--shutdown-timeout-sec N]"
+              << " [--partial-deadline-ms N] [--partial-latency-slo-ms N] [--admission-max-utilization F]"
+              << " [--max-upload-mb N]"
+              << " [--memory-budget-mb N|auto] [--memory-queue-timeout-ms N]"
+              << " [--numa-placement off|pin|replicate] [--numa-topology SPEC]"
+              << " [--backend whisper|mock] [--mock-decode-ms N] [--mock-decode-ms-per-audio-s N]"
+              << " [--mock-words-per-second N] [--capture-dir DIR]"
               << " [--env-file path]" << std::endl;
     std::cout << "All options can also be set via environment variables (or a .env file):" << std::endl;
     std::cout << "  MODEL_PATH, BIND_ADDRESS, PORT," << std::endl;
-    std::cout << "  AUTH_TOKEN, AUTH_API_URL, AUTH_API_SECRET, AUTH_CACHE_TTL, AUTH_API_TIMEOUT," << std::endl;
+    std::cout << "  AUTH_TOKEN, AUTH_API_URL, AUTH_API_SECRET," << std::endl;
+    std::cout << "  AUTH_CACHE_TTL, AUTH_NEGATIVE_CACHE_TTL, AUTH_CACHE_MAX_ENTRIES," << std::endl;
+    std::cout << "  AUTH_API_TIMEOUT, AUTH_API_POOL_SIZE," << std::endl;
     std::cout << "  TLS_CERT, TLS_KEY, MAX_CONNECTIONS, MAX_CONNECTIONS_PER_IP," << std::endl;
     std::cout << "  WHISPER_BEAM_SIZE, WHISPER_THREADS, MAX_CONCURRENT_INFERENCE," << std::endl;
-    std::cout << "  MODEL_CACHE_TTL, WHISPER_INITIAL_PROMPT, SESSION_TIMEOUT_SEC, SHUTDOWN_TIMEOUT_SEC," << std::endl;
+    std::cout << "  MODEL_CACHE_TTL, MODEL_LOAD, WHISPER_INITIAL_PROMPT, SESSION_TIMEOUT_SEC, SHUTDOWN_TIMEOUT_SEC," << std::endl;
     std::cout << "  WHISPER_TEMPERATURE, WHISPER_TEMPERATURE_INC," << std::endl;
-    std::cout << "  WHISPER_NO_SPEECH_THOLD, WHISPER_LOGPROB_THOLD" << std::endl;
+    std::cout << "  WHISPER_NO_SPEECH_THOLD, WHISPER_LOGPROB_THOLD, PARTIAL_DEADLINE_MS," << std::endl;
+    std::cout << "  PARTIAL_LATENCY_SLO_MS, ADMISSION_MAX_UTILIZATION, MAX_UPLOAD_MB," << std::endl;
+    std::cout << "  MEMORY_BUDGET_MB, MEMORY_QUEUE_TIMEOUT_MS, NUMA_PLACEMENT, NUMA_TOPOLOGY," << std::endl;
+    std::cout << "  TRANSCRIPTION_BACKEND, MOCK_DECODE_MS, MOCK_DECODE_MS_PER_AUDIO_S, MOCK_WORDS_PER_SECOND," << std::endl;
+    std::cout << "  CAPTURE_DIR," << std::endl;
+    std::cout << "  LOG_LEVEL (debug|info|warn|error|off), LOG_FORMAT (text|json)" << std::endl;
     std::cout << "CLI arguments override environment variables." << std::endl;
 }
 
@@ -211,8 +299,14 @@ ServerConfig parseArgs(int argc, char* argv[]) {
             config.auth_api_secret = argv[++i];
         } else if (arg == "--auth-cache-ttl" && i + 1 < argc) {
             config.auth_cache_ttl = std::stoi(argv[++i]);
+        } else if (arg == "--auth-negative-cache-ttl" && i + 1 < argc) {
+            config.auth_negative_cache_ttl = std::stoi(argv[++i]);
+        } else if (arg == "--auth-cache-max-entries" && i + 1 < argc) {
+            config.auth_cache_max_entries = std::stoul(argv[++i]);
         } else if (arg == "--auth-api-timeout" && i + 1 < argc) {
             config.auth_api_timeout = std::stoi(argv[++i]);
+        } else if (arg == "--auth-api-pool-size" && i + 1 < argc) {
+            config.auth_api_pool_size = std::stoi(argv[++i]);
         } else if (arg == "--cert" && i + 1 < argc) {
             config.cert_path = argv[++i];
         } else if (arg == "--key" && i + 1 < argc) {
@@ -224,11 +318,13 @@ ServerConfig parseArgs(int argc, char* argv[]) {
         } else if (arg == "--whisper-beam-size" && i + 1 < argc) {
             config.whisper_beam_size = std::stoi(argv[++i]);
         } else if (arg == "--whisper-threads" && i + 1 < argc) {
-            config.whisper_threads = std::stoi(argv[++i]);
+            config.whisper_threads = parseAuto(argv[++i]);
         } else if (arg == "--max-concurrent-inference" && i + 1 < argc) {
-            config.max_concurrent_inference = std::stoi(argv[++i]);
+            config.max_concurrent_inference = parseAuto(argv[++i]);
         } else if (arg == "--model-cache-ttl" && i + 1 < argc) {
             config.model_cache_ttl = std::stoi(argv[++i]);
+        } else if (arg == "--model-load" && i + 1 < argc) {
+            config.model_load = argv[++i];
         } else if (arg == "--whisper-initial-prompt" && i + 1 < argc) {
             config.whisper_initial_prompt = argv[++i];
         } else if (arg == "--session-timeout-sec" && i + 1 < argc) {
@@ -243,6 +339,34 @@ ServerConfig parseArgs(int argc, char* argv[]) {
             config.whisper_no_speech_thold = std::stof(argv[++i]);
         } else if (arg == "--whisper-logprob-thold" && i + 1 < argc) {
             config.whisper_logprob_thold = std::stof(argv[++i]);
+        } else if (arg == "--partial-deadline-ms" && i + 1 < argc) {
+            config.partial_deadline_ms = std::stoi(argv[++i]);
+        } else if (arg == "--partial-latency-slo-ms" && i + 1 < argc) {
+            config.partial_latency_slo_ms = std::stoi(argv[++i]);
+        } else if (arg == "--admission-max-utilization" && i + 1 < argc) {
+            config.admission_max_utilization = std::stod(argv[++i]);
+        } else if (arg == "--max-upload-mb" && i + 1 < argc) {
+            config.max_upload_mb = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--memory-budget-mb" && i + 1 < argc) {
+            std::string v = argv[++i];
+            config.memory_budget_auto = (v == "auto");
+            if (!config.memory_budget_auto) config.memory_budget_mb = static_cast<size_t>(std::stoul(v));
+        } else if (arg == "--memory-queue-timeout-ms" && i + 1 < argc) {
+            config.memory_queue_timeout_ms = std::stoi(argv[++i]);
+        } else if (arg == "--numa-placement" && i + 1 < argc) {
+            config.numa_placement = argv[++i];
+        } else if (arg == "--numa-topology" && i + 1 < argc) {
+            config.numa_topology = argv[++i];
+        } else if (arg == "--backend" && i + 1 < argc) {
+            config.backend = argv[++i];
+        } else if (arg == "--mock-decode-ms" && i + 1 < argc) {
+            config.mock_decode_ms = std::stod(argv[++i]);
+        } else if (arg == "--mock-decode-ms-per-audio-s" && i + 1 < argc) {
+            config.mock_decode_ms_per_audio_s = std::stod(argv[++i]);
+        } else if (arg == "--mock-words-per-second" && i + 1 < argc) {
+            config.mock_words_per_second = std::stod(argv[++i]);
+        } else if (arg == "--capture-dir" && i + 1 < argc) {
+            config.capture_dir = argv[++i];
         } else if (arg == "--thread-safe") {
             // accepted for backwards compatibility
         } else if (arg.rfind("--", 0) != 0 &&
@@ -271,6 +395,9 @@ void handleSession(tcp::socket socket,
                    float whisper_temperature_inc,
                    float whisper_no_speech_thold,
                    float whisper_logprob_thold,
+                   int partial_deadline_ms,
+                   const std::shared_ptr<TranscribeEndpoint>& transcribe_endpoint,
+                   size_t max_upload_bytes,
                    std::shared_ptr<ssl::context> ssl_ctx) {
     ConnectionGuard guard(limiter, client_ip);
 
@@ -278,22 +405,177 @@ void handleSession(tcp::socket socket,
         boost::beast::flat_buffer buffer;
         boost::beast::http::request<boost::beast::http::string_body> req;
 
+        // Headers first: only an authorized POST /v1/transcribe may send up to
+        // MAX_UPLOAD_MB; everything else keeps Beast's default body limit (1 MB).
+        // Beast checks Content-Length against the limit while parsing the header, so
+        // the header is read with the upload limit and other targets are cut down after.
+        // Returns false when the request was already answered (body never read).
+        auto read_request = [&](auto& stream) -> bool {
+            constexpr uint64_t DEFAULT_BODY_LIMIT = 1024 * 1024;
+            boost::beast::http::request_parser<boost::beast::http::string_body> parser;
+            parser.body_limit(std::max<uint64_t>(max_upload_bytes, DEFAULT_BODY_LIMIT));
+            boost::beast::http::read_header(stream, buffer, parser);
+            const auto& head = parser.get();
+            auto refuse = [&](boost::beast::http::response<boost::beast::http::string_body> res) {
+                res.keep_alive(false);
+                boost::beast::http::write(stream, res);
+                return false;
+            };
+            if (TranscribeEndpoint::matches(std::string_view(head.target().data(), head.target().size()))) {
+                if (auto rejected = transcribe_endpoint->precheck(head)) return refuse(std::move(*rejected));
+                parser.body_limit(max_upload_bytes);
+            } else {
+                if (parser.content_length() && *parser.content_length() > DEFAULT_BODY_LIMIT) {
+                    boost::beast::http::response<boost::beast::http::string_body> res{
+                        boost::beast::http::status::payload_too_large, head.version()};
+                    res.prepare_payload();
+                    return refuse(std::move(res));
+                }
+                parser.body_limit(DEFAULT_BODY_LIMIT); // chunked bodies are counted as they arrive
+            }
+            boost::beast::http::read(stream, buffer, parser);
+            req = parser.release();
+            return true;
+        };
+
         auto handle_http_request = [&](auto& stream) -> bool {
-            if (req.target() == "/metrics") {
+            if (TranscribeEndpoint::matches(std::string_view(req.target().data(), req.target().size()))) {
+                Log::info("Offline transcription request from " + client_ip +
+                          " (" + std::to_string(req.body().size()) + " bytes)");
+                auto res = transcribe_endpoint->handle(req);
+                boost::beast::http::write(stream, res);
+                return true;
+            } else if (req.target() == "/metrics") {
                 std::string inf_metrics = InferenceLimiter::instance().getMetrics();
                 std::string cache_metrics = ModelCache::instance().getMetrics();
                 std::string conn_metrics = limiter->getMetrics();
+                std::string engine_metrics = EngineMetrics::instance().getMetrics();
+                std::string auth_metrics = auth_manager->getMetrics();
+                std::string admission_metrics = AdmissionController::instance().getMetrics();
+                std::string flow_metrics = FlowControlMetrics::instance().getMetrics();
+                std::string cadence_metrics = CadenceMetrics::instance().getMetrics();
+                std::string capture_metrics = CaptureWriter::instance().getMetrics();
+                std::string memory_metrics = MemoryBudget::instance().getMetrics();
+                std::string sizing_metrics = AutoSizing::instance().getMetrics();
+                std::string numa_metrics = NumaPlacement::instance().getMetrics();
+                std::string process_metrics = procmem::getMetrics();
 
                 std::string combined = 
                     "# HELP transcription_active_inferences Number of concurrent inferences\n"
                     "# TYPE transcription_active_inferences gauge\n" +
                     inf_metrics +
                     "# HELP transcription_model_loaded Whether the model is currently in memory (1=yes, 0=no)\n"
-                    "# TYPE transcription_model_loaded gauge\n" +
+                    "# TYPE transcription_model_loaded gauge\n"
+                    "# HELP transcription_model_load_seconds Wall time of the last model load (cold start), by load mode\n"
+                    "# TYPE transcription_model_load_seconds gauge\n"
+                    "# HELP transcription_model_load_rss_bytes Process RSS added by the last model load\n"
+                    "# TYPE transcription_model_load_rss_bytes gauge\n" +
                     cache_metrics +
                     "# HELP transcription_active_connections Number of active WebSocket connections\n"
-                    "# TYPE transcription_active_connections gauge\n" +
-                    conn_metrics;
+                    "# TYPE transcription_active_connections gauge\n"
+                    "# HELP transcription_tenant_quota_throttles_total Times a stream stopped reading until its tenant's audio quota refilled\n"
+                    "# TYPE transcription_tenant_quota_throttles_total counter\n" +
+                    conn_metrics +
+                    "# HELP transcription_decodes_total Completed whisper decodes\n"
+                    "# TYPE transcription_decodes_total counter\n"
+                    "# HELP transcription_decode_cache_hits_total Sliding-window decodes skipped because the audio window was unchanged\n"
+                    "# TYPE transcription_decode_cache_hits_total counter\n"
+                    "# HELP transcription_decode_loop_aborts_total Decodes stopped early on a repetition loop\n"
+                    "# TYPE transcription_decode_loop_aborts_total counter\n"
+                    "# HELP transcription_decode_tokens_saved_total Decoder tokens not generated thanks to loop aborts (upper bound)\n"
+                    "# TYPE transcription_decode_tokens_saved_total counter\n"
+                    "# HELP transcription_decode_cancelled_total Decodes aborted by cancellation (close, shutdown, superseded)\n"
+                    "# TYPE transcription_decode_cancelled_total counter\n"
+                    "# HELP transcription_decode_deadline_exceeded_total Partial decodes aborted at their deadline\n"
+                    "# TYPE transcription_decode_deadline_exceeded_total counter\n"
+                    "# HELP transcription_final_reused_total Finals served from the last partial without a decode\n"
+                    "# TYPE transcription_final_reused_total counter\n"
+                    "# HELP transcription_final_latency_seconds Time from the client's end message to its final result\n"
+                    "# TYPE transcription_final_latency_seconds histogram\n" +
+                    engine_metrics +
+                    "# HELP transcription_admitted_sessions Streaming sessions currently admitted\n"
+                    "# TYPE transcription_admitted_sessions gauge\n"
+                    "# HELP transcription_admitted_uploads Offline uploads currently admitted\n"
+                    "# TYPE transcription_admitted_uploads gauge\n"
+                    "# HELP transcription_admission_admitted_total Sessions and uploads admitted\n"
+                    "# TYPE transcription_admission_admitted_total counter\n"
+                    "# HELP transcription_inference_utilization Average busy inference slots over the last 30s / slots\n"
+                    "# TYPE transcription_inference_utilization gauge\n"
+                    "# HELP transcription_session_inference_load Average busy slots per admitted session, uploads excluded\n"
+                    "# TYPE transcription_session_inference_load gauge\n"
+                    "# HELP transcription_admission_headroom Capacity left before shedding new sessions (<0 = shedding)\n"
+                    "# TYPE transcription_admission_headroom gauge\n"
+                    "# HELP transcription_admission_rejected_total Sessions and uploads shed with OVERLOADED\n"
+                    "# TYPE transcription_admission_rejected_total counter\n"
+                    "# HELP transcription_partial_latency_p90_seconds p90 slot wait + decode of partials over the last 30s\n"
+                    "# TYPE transcription_partial_latency_p90_seconds gauge\n"
+                    "# HELP transcription_inference_queue_wait_p90_seconds p90 slot wait of partials over the last 30s\n"
+                    "# TYPE transcription_inference_queue_wait_p90_seconds gauge\n" +
+                    admission_metrics +
+                    "# HELP transcription_flow_credit_stalls_total Times a streaming client ran out of audio credits\n"
+                    "# TYPE transcription_flow_credit_stalls_total counter\n"
+                    "# HELP transcription_flow_credit_stall_seconds_total Time clients spent waiting for audio credits\n"
+                    "# TYPE transcription_flow_credit_stall_seconds_total counter\n"
+                    "# HELP transcription_audio_dropped_seconds_total Audio dropped at the buffer high-water mark (clients ignoring credits)\n"
+                    "# TYPE transcription_audio_dropped_seconds_total counter\n" +
+                    flow_metrics +
+                    "# HELP transcription_partial_stride_seconds Average audio between partials across live sessions (adapts to load)\n"
+                    "# TYPE transcription_partial_stride_seconds gauge\n"
+                    "# HELP transcription_partial_stride_stretched_sessions Live sessions with a stride above the 250ms minimum\n"
+                    "# TYPE transcription_partial_stride_stretched_sessions gauge\n" +
+                    cadence_metrics +
+                    "# HELP transcription_capture_sessions_total Sessions recorded to CAPTURE_DIR\n"
+                    "# TYPE transcription_capture_sessions_total counter\n"
+                    "# HELP transcription_capture_abandoned_total Captures stopped because the writer fell behind\n"
+                    "# TYPE transcription_capture_abandoned_total counter\n"
+                    "# HELP transcription_capture_queued_bytes Capture data waiting for the writer thread\n"
+                    "# TYPE transcription_capture_queued_bytes gauge\n" +
+                    capture_metrics +
+                    "# HELP transcription_memory_charged_bytes Memory reserved by streaming sessions (max of estimate and use, per session)\n"
+                    "# TYPE transcription_memory_charged_bytes gauge\n"
+                    "# HELP transcription_memory_shared_bytes Model weights and idle decoder states, counted against the budget\n"
+                    "# TYPE transcription_memory_shared_bytes gauge\n"
+                    "# HELP transcription_memory_session_bytes Memory in use by streaming sessions, by component\n"
+                    "# TYPE transcription_memory_session_bytes gauge\n"
+                    "# HELP transcription_memory_session_max_bytes Largest memory charge of a single session so far\n"
+                    "# TYPE transcription_memory_session_max_bytes gauge\n"
+                    "# HELP transcription_memory_queued_total Sessions that had to wait for memory\n"
+                    "# TYPE transcription_memory_queued_total counter\n"
+                    "# HELP transcription_memory_rejected_total Sessions refused because the memory budget was exhausted\n"
+                    "# TYPE transcription_memory_rejected_total counter\n" +
+                    memory_metrics +
+                    "# HELP transcription_auto_threads Threads per decode chosen by auto sizing\n"
+                    "# TYPE transcription_auto_threads gauge\n"
+                    "# HELP transcription_auto_max_concurrent Inference slots chosen by auto sizing\n"
+                    "# TYPE transcription_auto_max_concurrent gauge\n"
+                    "# HELP transcription_auto_reevaluations_total Times a cgroup limit change re-sized threads and slots\n"
+                    "# TYPE transcription_auto_reevaluations_total counter\n" +
+                    sizing_metrics +
+                    "# HELP transcription_numa_remote_ratio Share of decodes that ran on a different node than their model\n"
+                    "# TYPE transcription_numa_remote_ratio gauge\n"
+                    "# HELP transcription_numa_sessions Sessions placed on each NUMA node\n"
+                    "# TYPE transcription_numa_sessions gauge\n"
+                    "# HELP transcription_numa_decodes_total Decodes run on each NUMA node\n"
+                    "# TYPE transcription_numa_decodes_total counter\n"
+                    "# HELP transcription_numa_remote_decodes_total Decodes on each node that read a model on another node\n"
+                    "# TYPE transcription_numa_remote_decodes_total counter\n"
+                    "# HELP transcription_numa_audio_seconds_total Audio decoded on each node (throughput: rate())\n"
+                    "# TYPE transcription_numa_audio_seconds_total counter\n"
+                    "# HELP transcription_numa_decode_seconds_total Time spent decoding on each node\n"
+                    "# TYPE transcription_numa_decode_seconds_total counter\n" +
+                    numa_metrics +
+                    "# HELP transcription_process_rss_bytes Resident memory of this process: anon is private, file is shared page cache\n"
+                    "# TYPE transcription_process_rss_bytes gauge\n"
+                    "# HELP transcription_process_pss_bytes Proportional set size: shared pages split among the processes mapping them\n"
+                    "# TYPE transcription_process_pss_bytes gauge\n" +
+                    process_metrics +
+                    "# HELP transcription_auth_api_connections_reused_total Auth API requests served on a pooled keep-alive connection\n"
+                    "# TYPE transcription_auth_api_connections_reused_total counter\n"
+                    "# HELP transcription_auth_cache_entries Cached auth verdicts (bounded by transcription_auth_cache_capacity)\n"
+                    "# TYPE transcription_auth_cache_entries gauge\n"
+                    "# HELP transcription_auth_cache_evictions_total Auth cache entries evicted as least recently used\n"
+                    "# TYPE transcription_auth_cache_evictions_total counter\n" +
+                    auth_metrics;
 
                 boost::beast::http::response<boost::beast::http::string_body> res;
                 res.version(req.version());
@@ -315,13 +597,33 @@ void handleSession(tcp::socket socket,
                 boost::beast::http::write(stream, res);
                 return true;
             } else if (req.target() == "/ready") {
-                bool is_busy = !InferenceLimiter::instance().hasCapacity();
+                // Same verdict a new session would get, so balancers route around shedding nodes.
+                auto admission = AdmissionController::instance().evaluate();
+                MemoryBudget::instance().updateShared(ModelCache::totalSharedBytes());
+                const size_t memory_available = MemoryBudget::instance().available();
+                const bool memory_full =
+                    memory_available < MemoryBudget::sessionEstimate(ModelCache::instance().stateBytes());
+                if (memory_full && admission.admit) {
+                    admission.retry_after_seconds = MemoryBudget::instance().config().retry_after_seconds;
+                }
+                bool is_busy = !admission.admit || memory_full;
+                nlohmann::json body = {
+                    {"status", is_busy ? "busy" : "ready"},
+                    {"headroom", admission.headroom},
+                    {"utilization", admission.utilization},
+                    {"predicted_partial_latency_ms", static_cast<int64_t>(admission.predicted_latency_ms)}
+                };
+                if (memory_available != SIZE_MAX) body["memory_available_bytes"] = memory_available;
                 boost::beast::http::response<boost::beast::http::string_body> res;
                 res.version(req.version());
                 res.result(is_busy ? boost::beast::http::status::service_unavailable : boost::beast::http::status::ok);
                 res.set(boost::beast::http::field::server, BOOST_BEAST_VERSION_STRING);
                 res.set(boost::beast::http::field::content_type, "application/json");
-                res.body() = is_busy ? "{\"status\": \"busy\"}" : "{\"status\": \"ready\"}";
+                if (is_busy) {
+                    body["retry_after"] = admission.retry_after_seconds;
+                    res.set(boost::beast::http::field::retry_after, std::to_string(admission.retry_after_seconds));
+                }
+                res.body() = body.dump();
                 res.prepare_payload();
                 boost::beast::http::write(stream, res);
                 return true;
@@ -332,9 +634,7 @@ void handleSession(tcp::socket socket,
         if (ssl_ctx) {
             ssl::stream<tcp::socket> ssl_stream(std::move(socket), *ssl_ctx);
             ssl_stream.handshake(ssl::stream_base::server);
-            boost::beast::http::read(ssl_stream, buffer, req);
-            
-            if (handle_http_request(ssl_stream)) return;
+            if (!read_request(ssl_stream) || handle_http_request(ssl_stream)) return;
 
             websocket::stream<ssl::stream<tcp::socket>> ws(std::move(ssl_stream));
             auto session = std::make_shared<StreamingSession<websocket::stream<ssl::stream<tcp::socket>>>>(
@@ -342,13 +642,12 @@ void handleSession(tcp::socket socket,
                 whisper_beam_size, whisper_threads, whisper_initial_prompt,
                 session_timeout_sec,
                 whisper_temperature, whisper_temperature_inc,
-                whisper_no_speech_thold, whisper_logprob_thold
+                whisper_no_speech_thold, whisper_logprob_thold,
+                partial_deadline_ms, limiter
             );
             session->run(req);
         } else {
-            boost::beast::http::read(socket, buffer, req);
-
-            if (handle_http_request(socket)) return;
+            if (!read_request(socket) || handle_http_request(socket)) return;
 
             websocket::stream<tcp::socket> ws(std::move(socket));
             auto session = std::make_shared<StreamingSession<websocket::stream<tcp::socket>>>(
@@ -356,7 +655,8 @@ void handleSession(tcp::socket socket,
                 whisper_beam_size, whisper_threads, whisper_initial_prompt,
                 session_timeout_sec,
                 whisper_temperature, whisper_temperature_inc,
-                whisper_no_speech_thold, whisper_logprob_thold
+                whisper_no_speech_thold, whisper_logprob_thold,
+                partial_deadline_ms, limiter
             );
             session->run(req);
         }
@@ -370,6 +670,7 @@ void handleSession(tcp::socket socket,
 int main(int argc, char* argv[]) {
     try {
         loadDotEnv(extractEnvFile(argc, argv));
+        Log::configureFromEnv();
 
         ServerConfig config = parseArgs(argc, argv);
 
@@ -379,12 +680,51 @@ int main(int argc, char* argv[]) {
         bool use_ssl    = !config.cert_path.empty() && !config.key_path.empty();
         bool auth_enabled = !config.auth_api_url.empty();
 
-        Log::info("Model:   " + config.model_path);
+        auto backend = TranscriptionBackend::parse(config.backend);
+        if (!backend) {
+            Log::error("Unknown backend: " + config.backend + " (expected whisper or mock)");
+            return 1;
+        }
+
+        // Before any model load: a replica must be placed as it loads.
+        try {
+            auto numa_mode = NumaPlacement::parseMode(config.numa_placement);
+            auto topology  = config.numa_topology.empty() ? numa::readSysfs() : numa::parseSpec(config.numa_topology);
+            std::string nodes;
+            for (const auto& n : topology.nodes) {
+                nodes += "  node" + std::to_string(n.id) + "=" + std::to_string(n.cpus.size()) + "cpu";
+            }
+            NumaPlacement::instance().configure(numa_mode, topology);
+            if (numa_mode != NumaPlacement::Mode::Off || topology.nodes.size() > 1) {
+                Log::info(std::string("NUMA:    placement=") + NumaPlacement::modeName(numa_mode) +
+                          (topology.simulated ? " (simulated topology)" : "") + nodes);
+            }
+        } catch (const std::invalid_argument& e) {
+            Log::error(std::string("Invalid NUMA configuration: ") + e.what());
+            return 1;
+        }
+
+        ModelCache::LoadMode load_mode;
+        try {
+            load_mode = ModelCache::parseLoadMode(config.model_load);
+        } catch (const std::invalid_argument& e) {
+            Log::error(e.what());
+            return 1;
+        }
+
+        Log::info("Model:   " + config.model_path + "  load=" + ModelCache::loadModeName(load_mode));
+        if (*backend == TranscriptionBackend::Kind::Mock) {
+            Log::warn("Backend: mock (streaming sessions return synthetic text, decode=" +
+                      std::to_string(config.mock_decode_ms) + "ms + " +
+                      std::to_string(config.mock_decode_ms_per_audio_s) + "ms/audio-s, " +
+                      std::to_string(config.mock_words_per_second) + " words/s)");
+        }
         Log::info("Bind:    " + config.bind_address + ":" + std::to_string(config.port));
         Log::info("SSL:     " + std::string(use_ssl ? "enabled" : "disabled"));
         if (auth_enabled) {
             Log::info("Auth:    API " + config.auth_api_url +
                       "  cache=" + std::to_string(config.auth_cache_ttl) + "s" +
+                      "  negative=" + std::to_string(config.auth_negative_cache_ttl) + "s" +
                       "  timeout=" + std::to_string(config.auth_api_timeout) + "s");
         } else {
             Log::info("Auth:    disabled");
@@ -392,21 +732,64 @@ int main(int argc, char* argv[]) {
         Log::info("Limits:  " + std::to_string(config.max_connections) + " total, " +
                   std::to_string(config.max_connections_per_ip) + " per IP");
         Log::info("Whisper: beam_size=" + std::to_string(config.whisper_beam_size) +
-                  "  threads=" + std::to_string(config.whisper_threads) +
-                  "  max_concurrent=" + std::to_string(config.max_concurrent_inference) +
+                  "  threads=" + (config.whisper_threads > 0 ? std::to_string(config.whisper_threads) : "auto") +
+                  "  max_concurrent=" + (config.max_concurrent_inference > 0
+                                             ? std::to_string(config.max_concurrent_inference) : "auto") +
                   "  cache_ttl=" + std::to_string(config.model_cache_ttl) + "s");
         Log::info("Whisper: temperature=" + std::to_string(config.whisper_temperature) +
                   "  temperature_inc=" + std::to_string(config.whisper_temperature_inc) +
                   "  no_speech_thold=" + std::to_string(config.whisper_no_speech_thold) +
                   "  logprob_thold=" + std::to_string(config.whisper_logprob_thold));
+        Log::info("Whisper: partial_deadline=" + std::to_string(config.partial_deadline_ms) + "ms" +
+                  "  max_upload=" + std::to_string(config.max_upload_mb) + "MB");
+        Log::info("Admission: partial_latency_slo=" + std::to_string(config.partial_latency_slo_ms) + "ms" +
+                  "  max_utilization=" + std::to_string(config.admission_max_utilization));
         if (!config.whisper_initial_prompt.empty()) {
             Log::info("Whisper: initial_prompt=\"" + config.whisper_initial_prompt + "\"");
         }
 
         // Configure the model cache and inference limiter
         ModelCache::instance().configure(config.model_cache_ttl);
+        ModelCache::instance().setLoadMode(load_mode);
         InferenceLimiter::instance().setMaxConcurrency(config.max_concurrent_inference);
 
+        MockTranscriptionEngine::Options mock;
+        mock.base_latency_ms             = config.mock_decode_ms;
+        mock.latency_ms_per_audio_second = config.mock_decode_ms_per_audio_s;
+        mock.words_per_second            = config.mock_words_per_second;
+        TranscriptionBackend::instance().configure(*backend, mock);
+
+        if (!config.capture_dir.empty()) {
+            std::filesystem::create_directories(config.capture_dir);
+            CaptureWriter::Config capture;
+            capture.dir = config.capture_dir;
+            CaptureWriter::instance().configure(capture);
+            Log::warn("Capture: recording every session (audio included) to " + config.capture_dir);
+        }
+
+        AdmissionController::Config admission;
+        admission.partial_latency_slo_ms = config.partial_latency_slo_ms;
+        admission.max_utilization        = config.admission_max_utilization;
+        AdmissionController::instance().configure(admission);
+
+        MemoryBudget::Config memory;
+        memory.budget_bytes  = config.memory_budget_mb * 1024 * 1024;
+        memory.queue_timeout = std::chrono::milliseconds(std::max(config.memory_queue_timeout_ms, 0));
+        MemoryBudget::instance().configure(memory);
+        if (config.memory_budget_mb > 0) {
+            Log::info("Memory:  budget=" + std::to_string(config.memory_budget_mb) + "MB" +
+                      "  queue_timeout=" + std::to_string(config.memory_queue_timeout_ms) + "ms");
+        }
+
+        // After InferenceLimiter and MemoryBudget: auto values override theirs, and are
+        // re-applied if the container's limits change.
+        AutoSizing::Config sizing;
+        sizing.auto_threads     = config.whisper_threads <= 0;
+        sizing.auto_concurrency = config.max_concurrent_inference <= 0;
+        sizing.auto_memory      = config.memory_budget_auto;
+        sizing.threads          = config.whisper_threads;
+        AutoSizing::instance().configure(sizing);
+
         std::shared_ptr<ssl::context> ssl_ctx;
         if (use_ssl) {
             try {
@@ -434,9 +817,23 @@ int main(int argc, char* argv[]) {
         auth_config.api_base_url      = config.auth_api_url;
         auth_config.api_secret_key    = config.auth_api_secret;
         auth_config.cache_ttl_seconds = config.auth_cache_ttl;
+        auth_config.negative_cache_ttl_seconds = config.auth_negative_cache_ttl;
+        auth_config.cache_max_entries = config.auth_cache_max_entries;
         auth_config.timeout_seconds   = config.auth_api_timeout;
+        auth_config.pool_size         = config.auth_api_pool_size;
         auto auth_manager = std::make_shared<AuthManager>(auth_config);
 
+        TranscribeEndpoint::Config offline_config;
+        offline_config.model_path             = config.model_path;
+        offline_config.decode.n_threads       = config.whisper_threads; // 0 = AutoSizing::threads() per request
+        offline_config.decode.beam_size       = config.whisper_beam_size;
+        offline_config.decode.initial_prompt  = config.whisper_initial_prompt;
+        offline_config.decode.temperature     = config.whisper_temperature;
+        offline_config.decode.temperature_inc = config.whisper_temperature_inc;
+        offline_config.decode.no_speech_thold = config.whisper_no_speech_thold;
+        offline_config.decode.logprob_thold   = config.whisper_logprob_thold;
+        auto transcribe_endpoint = std::make_shared<TranscribeEndpoint>(offline_config, auth_manager, limiter);
+
         Log::info("Listening on " + std::string(use_ssl ? "wss" : "ws") +
                   "://" + config.bind_address + ":" + std::to_string(config.port));
 
@@ -487,13 +884,16 @@ int main(int argc, char* argv[]) {
                             config.model_path,
                             auth_manager,
                             config.whisper_beam_size,
-                            config.whisper_threads,
+                            AutoSizing::instance().threads(),
                             config.whisper_initial_prompt,
                             config.session_timeout_sec,
                             config.whisper_temperature,
                             config.whisper_temperature_inc,
                             config.whisper_no_speech_thold,
                             config.whisper_logprob_thold,
+                            config.partial_deadline_ms,
+                            transcribe_endpoint,
+                            config.max_upload_mb * 1024 * 1024,
                             ssl_ctx);
             } catch (const std::exception& e) {
                 limiter->release(client_ip);
@@ -529,6 +929,7 @@ int main(int argc, char* argv[]) {
 
         ioc.stop();
         if (ioc_thread.joinable()) ioc_thread.join();
+        CaptureWriter::instance().drain(); // closed sessions' last capture buffers
         all_joined = true; // disarm watchdog only after all threads are joined
 
         Log::info("Graceful shutdown complete.");
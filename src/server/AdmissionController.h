@@ -0,0 +1,181 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <string>
+#include "whisper/InferenceLimiter.h"
+#include "whisper/LoadEstimator.h"
+
+/**
+ * @brief Load shedding based on measured inference capacity.
+ *
+ * The static limits (MAX_CONNECTIONS, MAX_CONCURRENT_INFERENCE) say nothing
+ * about whether one more session fits: that depends on the model, the audio
+ * and the hardware. This controller asks the LoadEstimator what the admitted
+ * sessions actually cost and predicts the load and p90 partial latency with
+ * one more of them:
+ *
+ *   per_session = (load - offline_load) / active_sessions   (slot-seconds per wall-second)
+ *   u'          = (load + per_session) / slots
+ *   latency'    = decode_p90 + wait_p90 * (1 - u) / (1 - u')
+ *
+ * (queue wait grows like 1 / (1 - u)). A session is admitted while u' stays
+ * under max_utilization and latency' under the partial-latency SLO; otherwise
+ * the client is told to retry later. Until min_samples decodes are in the
+ * window there is nothing to measure and everyone is admitted.
+ *
+ * Offline uploads pass the same check (they take slots from the partials) but
+ * hold an Upload ticket: they are not sessions, and their chunks are left out
+ * of the per-session cost.
+ *
+ * Thread-safe.
+ */
+class AdmissionController {
+public:
+    struct Config {
+        int    partial_latency_slo_ms = 2000; // p90 partial latency target (0 = admission control off)
+        double max_utilization = 0.85;        // busy slots / total slots with the new session
+        size_t min_samples = 20;              // decodes in the window before shedding kicks in
+        int    retry_after_seconds = 5;       // hint sent with a rejection
+    };
+
+    struct Decision {
+        bool        admit = true;
+        double      headroom = 1.0;              // 0..1 left before the first limit; < 0 = over it
+        double      utilization = 0.0;           // current load / slots
+        double      predicted_utilization = 0.0; // with one more session
+        double      predicted_latency_ms = 0.0;  // p90 partial latency with one more session
+        int         retry_after_seconds = 0;     // set when !admit
+        std::string reason;                      // "utilization" | "latency" when !admit
+    };
+
+    static AdmissionController& instance() {
+        static AdmissionController inst;
+        return inst;
+    }
+
+    AdmissionController() = default;
+
+    // Non-copyable
+    AdmissionController(const AdmissionController&) = delete;
+    AdmissionController& operator=(const AdmissionController&) = delete;
+
+    void configure(const Config& config) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        config_ = config;
+    }
+
+    Config config() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return config_;
+    }
+
+    /**
+     * @brief Pure admission rule (no singletons), see the class comment.
+     * @param active_sessions  sessions currently admitted (the load's source)
+     * @param slots            inference slots (MAX_CONCURRENT_INFERENCE)
+     */
+    static Decision decide(const LoadEstimator::Snapshot& s, int active_sessions, int slots,
+                           const Config& cfg) {
+        Decision d;
+        if (slots <= 0) return d;
+
+        const double u = s.load / slots;
+        const double per_session = std::max(s.load - s.offline_load, 0.0) / std::max(active_sessions, 1);
+        const double u_next = (s.load + per_session) / slots;
+        d.utilization = u;
+        d.predicted_utilization = u_next;
+
+        double latency = std::numeric_limits<double>::infinity();
+        if (u_next < 1.0) {
+            latency = s.decode_p90 + s.queue_wait_p90 * (1.0 - u) / (1.0 - u_next);
+        }
+        d.predicted_latency_ms = std::min(latency * 1000.0, 1e9);
+
+        if (cfg.partial_latency_slo_ms <= 0) return d;
+
+        const double max_util = std::clamp(cfg.max_utilization, 0.01, 1.0);
+        const double slo = cfg.partial_latency_slo_ms / 1000.0;
+        const double util_headroom = 1.0 - u_next / max_util;
+        // Without partial decodes in the window only the utilization limit applies.
+        const double latency_headroom = s.latency_samples > 0 ? 1.0 - latency / slo : 1.0;
+        d.headroom = std::clamp(std::min(util_headroom, latency_headroom), -1.0, 1.0);
+
+        if (s.samples < cfg.min_samples) return d; // cold start: no evidence to shed on
+
+        if (util_headroom < 0) {
+            d.admit = false;
+            d.reason = "utilization";
+        } else if (latency_headroom < 0) {
+            d.admit = false;
+            d.reason = "latency";
+        }
+        if (!d.admit) d.retry_after_seconds = std::max(1, cfg.retry_after_seconds);
+        return d;
+    }
+
+    /// Decision for one more session right now (no side effects).
+    Decision evaluate() const {
+        return decide(LoadEstimator::instance().snapshot(), active_.load(),
+                      InferenceLimiter::instance().maxConcurrency(), config());
+    }
+
+    /// evaluate() and count the outcome; callers hold a Ticket while admitted.
+    Decision tryAdmit() {
+        Decision d = evaluate();
+        (d.admit ? admitted_ : rejected_).fetch_add(1, std::memory_order_relaxed);
+        return d;
+    }
+
+    /// Count a refusal taken on evaluate() alone (an upload shed before its body is read).
+    void countRejected() { rejected_.fetch_add(1, std::memory_order_relaxed); }
+
+    int activeSessions() const { return active_.load(); }
+    int activeUploads() const { return uploads_.load(); }
+
+    enum class Kind { Session, Upload };
+
+    // RAII: counts an admitted session (or upload) while alive
+    class Ticket {
+    public:
+        explicit Ticket(AdmissionController& ctl = AdmissionController::instance()) : Ticket(Kind::Session, ctl) {}
+        explicit Ticket(Kind kind, AdmissionController& ctl = AdmissionController::instance())
+            : count_(kind == Kind::Upload ? ctl.uploads_ : ctl.active_) {
+            count_.fetch_add(1);
+        }
+        ~Ticket() { count_.fetch_sub(1); }
+        Ticket(const Ticket&) = delete;
+        Ticket& operator=(const Ticket&) = delete;
+    private:
+        std::atomic<int>& count_;
+    };
+
+    /**
+     * @brief Get telemetry metrics in Prometheus format
+     */
+    std::string getMetrics() const {
+        auto s = LoadEstimator::instance().snapshot();
+        int active = active_.load();
+        Decision d = decide(s, active, InferenceLimiter::instance().maxConcurrency(), config());
+        double session_load = active > 0 ? std::max(s.load - s.offline_load, 0.0) / active : 0.0;
+        return "transcription_admitted_sessions " + std::to_string(active) + "\n" +
+               "transcription_admitted_uploads " + std::to_string(uploads_.load()) + "\n" +
+               "transcription_admission_admitted_total " + std::to_string(admitted_.load()) + "\n" +
+               "transcription_admission_rejected_total " + std::to_string(rejected_.load()) + "\n" +
+               "transcription_admission_headroom " + std::to_string(d.headroom) + "\n" +
+               "transcription_inference_utilization " + std::to_string(d.utilization) + "\n" +
+               "transcription_session_inference_load " + std::to_string(session_load) + "\n" +
+               "transcription_partial_latency_p90_seconds " + std::to_string(s.latency_p90) + "\n" +
+               "transcription_inference_queue_wait_p90_seconds " + std::to_string(s.queue_wait_p90) + "\n";
+    }
+
+private:
+    mutable std::mutex mutex_;
+    Config config_;
+    std::atomic<int> active_{0};
+    std::atomic<int> uploads_{0};
+    std::atomic<uint64_t> admitted_{0};
+    std::atomic<uint64_t> rejected_{0};
+};
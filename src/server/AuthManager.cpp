@@ -2,8 +2,10 @@
 #include "log/Log.h"
 
 AuthManager::AuthManager(const ApiAuthConfig& config)
-    : auth_enabled_(!config.api_base_url.empty() || !config.static_token.empty()),
+    : cache_(config.cache_max_entries, config.api_base_url.empty() ? 0 : 30),
+      auth_enabled_(!config.api_base_url.empty() || !config.static_token.empty()),
       cache_ttl_seconds_(config.cache_ttl_seconds),
+      negative_cache_ttl_seconds_(config.negative_cache_ttl_seconds),
       static_token_(config.static_token) {
     if (!config.api_base_url.empty()) {
         api_client_ = std::make_unique<ApiAuthClient>(config);
@@ -16,6 +18,12 @@ AuthManager::AuthManager(const ApiAuthConfig& config)
     }
 }
 
+AuthManager::~AuthManager() {
+    // Stop the client first: requests still pending report back into
+    // cache_ and inflight_, which must still be alive.
+    api_client_.reset();
+}
+
 // static
 bool AuthManager::constantTimeEqual(const std::string& a, const std::string& b) {
     if (a.size() != b.size()) return false;
@@ -31,38 +39,101 @@ bool AuthManager::isAuthEnabled() const {
 }
 
 bool AuthManager::validate(const std::string& token) {
+    return validateAsync(token).get().allowed;
+}
+
+AuthDecision AuthManager::authorize(const std::string& token) {
+    return validateAsync(token).get();
+}
+
+std::future<AuthDecision> AuthManager::validateAsync(const std::string& token) {
+    auto ready = [](bool allowed, const ClientPolicy& policy = {}) {
+        std::promise<AuthDecision> p;
+        p.set_value(AuthDecision{allowed, policy});
+        return p.get_future();
+    };
+
     if (!auth_enabled_) {
-        return true;
+        return ready(true);
     }
 
     // Static token mode — constant-time comparison, no API call, no cache.
     if (!static_token_.empty()) {
         bool ok = constantTimeEqual(token, static_token_);
         Log::debug(std::string("Static token auth: ") + (ok ? "ok" : "denied"));
-        return ok;
+        return ready(ok);
     }
 
     const std::string masked = Log::maskKey(token);
 
     // Cache hit?
-    auto cached = cache_.get(token);
-    if (cached.has_value()) {
-        Log::debug("Auth cache hit key=" + masked + " valid=" + (cached.value() ? "true" : "false"));
-        return cached.value();
+    auto cached = cache_.lookup(token);
+    if (cached.valid.has_value()) {
+        Log::debug("Auth cache hit key=" + masked + " valid=" + (*cached.valid ? "true" : "false"));
+        if (cached.refresh) {
+            // Stale-while-revalidate: serve the verdict, refresh in the background.
+            Log::debug("Auth cache entry near expiry key=" + masked + ", refreshing");
+            refreshes_.fetch_add(1, std::memory_order_relaxed);
+            query(token);
+        }
+        return ready(*cached.valid, cached.policy);
     }
 
     Log::debug("Auth cache miss key=" + masked + ", querying API");
-    AuthResult result = api_client_->validate(token);
+    // The request is already in flight; the deferred part only waits for it.
+    return std::async(std::launch::deferred, [pending = query(token)]() {
+        return pending.get();
+    });
+}
+
+std::shared_future<AuthDecision> AuthManager::query(const std::string& token) {
+    auto promise = std::make_shared<std::promise<AuthDecision>>();
+    std::shared_future<AuthDecision> pending;
+    {
+        std::lock_guard<std::mutex> lock(inflight_mutex_);
+        auto it = inflight_.find(token);
+        if (it != inflight_.end()) {
+            joined_.fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+        pending = promise->get_future().share();
+        inflight_.emplace(token, pending);
+    }
+
+    api_client_->validateAsync(token, [this, token, promise](AuthResult result, const ClientPolicy& policy) {
+        promise->set_value(onApiResult(token, result, policy));
+    });
+    return pending;
+}
+
+// Runs on the API client's I/O thread.
+AuthDecision AuthManager::onApiResult(const std::string& token, AuthResult result, const ClientPolicy& policy) {
+    const std::string masked = Log::maskKey(token);
+    AuthDecision decision;
 
     if (result == AuthResult::ApiUnavailable) {
+        // Fail closed for waiters; an entry being refreshed stays until it expires.
         Log::warn("Auth API unavailable for key=" + masked + ", denying (fail-closed)");
-        return false;
+        cache_.refreshFailed(token);
+    } else {
+        decision.allowed = (result == AuthResult::Allowed);
+        if (decision.allowed) decision.policy = policy;
+        int ttl = decision.allowed ? cache_ttl_seconds_ : negative_cache_ttl_seconds_;
+        Log::debug("Caching auth result key=" + masked +
+                   " allowed=" + (decision.allowed ? "true" : "false") +
+                   " ttl=" + std::to_string(ttl) + "s");
+        cache_.put(token, decision.allowed, ttl, decision.policy);
     }
 
-    bool allowed = (result == AuthResult::Allowed);
-    Log::debug("Caching auth result key=" + masked +
-               " allowed=" + (allowed ? "true" : "false") +
-               " ttl=" + std::to_string(cache_ttl_seconds_) + "s");
-    cache_.put(token, allowed, cache_ttl_seconds_);
-    return allowed;
+    // Unregister after the cache is filled so no caller misses both.
+    std::lock_guard<std::mutex> lock(inflight_mutex_);
+    inflight_.erase(token);
+    return decision;
+}
+
+std::string AuthManager::getMetrics() const {
+    if (!api_client_) return {};
+    return api_client_->getMetrics() + cache_.getMetrics() +
+           "transcription_auth_singleflight_joined_total " + std::to_string(joined_.load(std::memory_order_relaxed)) + "\n" +
+           "transcription_auth_background_refreshes_total " + std::to_string(refreshes_.load(std::memory_order_relaxed)) + "\n";
 }
@@ -1,22 +1,67 @@
 #pragma once
+#include <atomic>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include "auth/ApiAuthConfig.h"
 #include "auth/ApiAuthClient.h"
 #include "auth/AuthCache.h"
 
+/// Verdict plus the key's limits (defaults when auth is disabled or static).
+struct AuthDecision {
+    bool allowed = false;
+    ClientPolicy policy;
+
+    explicit operator bool() const { return allowed; }
+};
+
 class AuthManager {
 public:
     explicit AuthManager(const ApiAuthConfig& config);
+    ~AuthManager();
+
+    // Non-copyable (API callbacks hold `this`)
+    AuthManager(const AuthManager&) = delete;
+    AuthManager& operator=(const AuthManager&) = delete;
 
     bool isAuthEnabled() const;
     bool validate(const std::string& token);
+    AuthDecision authorize(const std::string& token);
+
+    /**
+     * @brief Start validating a token without blocking.
+     *
+     * Cache hits and static-token checks return a ready future; misses start
+     * the API request immediately so the caller can do other work (e.g.
+     * acquire the model) before get().
+     *
+     * Concurrent misses for the same token share one API request, and a hit
+     * close to expiry is served from the cache while one background request
+     * refreshes it. Denied keys are cached for negative_cache_ttl_seconds.
+     */
+    std::future<AuthDecision> validateAsync(const std::string& token);
+
+    /// Auth API metrics in Prometheus format ("" without an API).
+    std::string getMetrics() const;
 
 private:
+    // Join the in-flight request for token or start one (single-flight).
+    std::shared_future<AuthDecision> query(const std::string& token);
+    AuthDecision onApiResult(const std::string& token, AuthResult result, const ClientPolicy& policy);
+
     std::unique_ptr<ApiAuthClient> api_client_;
     AuthCache cache_;
     bool auth_enabled_;
     int cache_ttl_seconds_;
+    int negative_cache_ttl_seconds_;
+
+    std::mutex inflight_mutex_;
+    std::unordered_map<std::string, std::shared_future<AuthDecision>> inflight_;
+
+    std::atomic<uint64_t> joined_{0};
+    std::atomic<uint64_t> refreshes_{0};
     std::string static_token_; // non-empty = static token mode (no API call)
 
     // Constant-time comparison to resist timing attacks.
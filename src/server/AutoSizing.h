@@ -0,0 +1,208 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "utils/CgroupLimits.h"
+#include "whisper/InferenceLimiter.h"
+#include "MemoryBudget.h"
+#include "log/Log.h"
+
+/**
+ * @brief `auto` sizing of decode threads, inference slots and the memory budget
+ * from the container's limits (WHISPER_THREADS / MAX_CONCURRENT_INFERENCE /
+ * MEMORY_BUDGET_MB = auto).
+ *
+ * Hand-set values that ignore the CPU quota oversubscribe it: 4 slots × 4
+ * threads on a 4-core quota means 16 runnable threads, CFS throttling and
+ * a latency tail of whole periods. plan() keeps slots × threads within the
+ * usable cores (see cgroup::usableCores): threads = cores / 2, clamped to
+ * 1..MAX_AUTO_THREADS, and slots = cores / threads. From 2 to 8 cores that is two
+ * slots with a growing thread count (a partial decodes while another runs);
+ * past that, threads stay at MAX_AUTO_THREADS — whisper scales sublinearly
+ * beyond a few threads — and the extra cores become slots.
+ *
+ * A watcher thread re-reads the cgroup files every `poll_interval` and
+ * re-applies the plan when a limit changes (vertical pod resize, `docker
+ * update`). New slot counts apply at once; a thread count applies to decodes
+ * configured afterwards (new sessions, new uploads).
+ */
+class AutoSizing {
+public:
+    static constexpr int MAX_AUTO_THREADS = 4;
+    /// Share of the cgroup memory limit given to MemoryBudget; the rest covers
+    /// allocator slack, thread stacks, auth cache and connection buffers.
+    static constexpr double MEMORY_BUDGET_FRACTION = 0.9;
+
+    struct Plan {
+        int    cores = 1;               // usable cores the plan was made for
+        int    threads = 1;             // per decode
+        int    concurrency = 1;         // inference slots
+        size_t memory_budget_bytes = 0; // 0 = no memory limit found
+    };
+
+    struct Config {
+        bool auto_threads = false;
+        bool auto_concurrency = false;
+        bool auto_memory = false;
+        int  threads = 4;                           // used when !auto_threads
+        std::chrono::seconds poll_interval{10};     // 0 = evaluate once
+        std::string cgroup_root = "/sys/fs/cgroup";
+        std::string proc_self_cgroup = "/proc/self/cgroup";
+        std::function<int()> affinity_cpus = cgroup::affinityCpus; // tests fake the host
+    };
+
+    static AutoSizing& instance() {
+        static AutoSizing inst;
+        return inst;
+    }
+
+    AutoSizing() = default;
+
+    ~AutoSizing() { stop(); }
+
+    // Non-copyable
+    AutoSizing(const AutoSizing&) = delete;
+    AutoSizing& operator=(const AutoSizing&) = delete;
+
+    /// Threads per decode and slots for `cores` usable cores.
+    static Plan plan(int cores, size_t memory_limit) {
+        Plan p;
+        p.cores       = std::max(cores, 1);
+        p.threads     = std::clamp(p.cores / 2, 1, MAX_AUTO_THREADS);
+        p.concurrency = std::max(p.cores / p.threads, 1);
+        p.memory_budget_bytes = static_cast<size_t>(static_cast<double>(memory_limit) * MEMORY_BUDGET_FRACTION);
+        return p;
+    }
+
+    /**
+     * @brief Evaluate now and apply; start the watcher if anything is auto.
+     * Call once at startup, after the other singletons are configured.
+     */
+    void configure(Config config) {
+        stop();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            config_ = std::move(config);
+            threads_.store(config_.threads > 0 ? config_.threads : 1);
+            have_limits_ = false;
+            stop_ = false;
+        }
+        if (!enabled()) return;
+        evaluate();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (config_.poll_interval.count() > 0) {
+            thread_ = std::thread([this] { run(); });
+        }
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        if (thread_.joinable()) thread_.join();
+    }
+
+    bool enabled() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return config_.auto_threads || config_.auto_concurrency || config_.auto_memory;
+    }
+
+    /// Threads for a decode starting now (fixed WHISPER_THREADS unless auto).
+    int threads() const { return threads_.load(); }
+
+    /**
+     * @brief Re-read the cgroup limits; re-plan and apply if they changed.
+     * @return true if a (new) plan was applied.
+     */
+    bool evaluate() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        const auto limits = cgroup::read(config_.cgroup_root, config_.proc_self_cgroup);
+        const int affinity = config_.affinity_cpus ? config_.affinity_cpus() : cgroup::affinityCpus();
+        const int cores = cgroup::usableCores(limits, affinity);
+        if (have_limits_ && limits == limits_ && cores == plan_.cores) return false;
+
+        const bool first = !have_limits_;
+        limits_ = limits;
+        have_limits_ = true;
+        plan_ = plan(cores, limits.memory_limit);
+        if (!first) ++reevaluations_total_;
+        const Config cfg = config_;
+        const Plan p = plan_;
+        lock.unlock();
+
+        if (cfg.auto_threads) threads_.store(p.threads);
+        if (cfg.auto_concurrency) InferenceLimiter::instance().setMaxConcurrency(p.concurrency);
+        if (cfg.auto_memory) {
+            auto budget = MemoryBudget::instance().config();
+            budget.budget_bytes = p.memory_budget_bytes;
+            MemoryBudget::instance().configure(budget);
+        }
+
+        std::string msg = std::string(first ? "Auto sizing: " : "Auto sizing (limits changed): ") +
+                          "cgroup v" + std::to_string(limits.version) +
+                          "  cpu_quota=" + (limits.cpu_quota > 0 ? std::to_string(limits.cpu_quota) : "none") +
+                          "  cpuset=" + (limits.cpuset_cpus > 0 ? std::to_string(limits.cpuset_cpus) : "-") +
+                          "  affinity=" + std::to_string(affinity) +
+                          "  memory_limit=" + (limits.memory_limit > 0
+                                                   ? std::to_string(limits.memory_limit >> 20) + "MB" : "none") +
+                          " → cores=" + std::to_string(p.cores);
+        if (cfg.auto_threads) msg += "  threads=" + std::to_string(p.threads);
+        if (cfg.auto_concurrency) msg += "  max_concurrent=" + std::to_string(p.concurrency);
+        if (cfg.auto_memory) {
+            msg += "  memory_budget=" + (p.memory_budget_bytes > 0
+                                             ? std::to_string(p.memory_budget_bytes >> 20) + "MB" : std::string("off"));
+        }
+        Log::info(msg);
+        return true;
+    }
+
+    Plan currentPlan() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return plan_;
+    }
+
+    /**
+     * @brief Get telemetry metrics in Prometheus format
+     */
+    std::string getMetrics() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!config_.auto_threads && !config_.auto_concurrency && !config_.auto_memory) return "";
+        return "transcription_cgroup_cpu_quota_cores " + std::to_string(limits_.cpu_quota) + "\n" +
+               "transcription_cgroup_cpuset_cpus " + std::to_string(limits_.cpuset_cpus) + "\n" +
+               "transcription_cgroup_memory_limit_bytes " + std::to_string(limits_.memory_limit) + "\n" +
+               "transcription_auto_cores " + std::to_string(plan_.cores) + "\n" +
+               "transcription_auto_threads " + std::to_string(threads_.load()) + "\n" +
+               "transcription_auto_max_concurrent " + std::to_string(plan_.concurrency) + "\n" +
+               "transcription_auto_reevaluations_total " + std::to_string(reevaluations_total_) + "\n";
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_) {
+            if (cv_.wait_for(lock, config_.poll_interval, [this] { return stop_; })) return;
+            lock.unlock();
+            evaluate();
+            lock.lock();
+        }
+    }
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    Config config_;
+    std::thread thread_;
+    bool stop_ = false;
+    std::atomic<int> threads_{4};
+    bool have_limits_ = false;
+    cgroup::Limits limits_;
+    Plan plan_;
+    uint64_t reevaluations_total_ = 0;
+};
@@ -9,3 +9,12 @@ ConnectionGuard::~ConnectionGuard() {
         limiter_->release(ip_);
     }
 }
+
+TenantGuard::TenantGuard(std::shared_ptr<ConnectionLimiter> limiter, std::string tenant_id)
+    : limiter_(std::move(limiter)), tenant_id_(std::move(tenant_id)) {}
+
+TenantGuard::~TenantGuard() {
+    if (limiter_) {
+        limiter_->releaseTenant(tenant_id_);
+    }
+}
@@ -21,3 +21,20 @@ private:
     std::shared_ptr<ConnectionLimiter> limiter_;
     std::string ip_;
 };
+
+/// Releases a tenant session slot claimed with ConnectionLimiter::tryAcquireTenant().
+class TenantGuard {
+public:
+    TenantGuard(std::shared_ptr<ConnectionLimiter> limiter, std::string tenant_id);
+    ~TenantGuard();
+
+    // Disable copying
+    TenantGuard(const TenantGuard&) = delete;
+    TenantGuard& operator=(const TenantGuard&) = delete;
+
+    const std::string& tenantId() const { return tenant_id_; }
+
+private:
+    std::shared_ptr<ConnectionLimiter> limiter_;
+    std::string tenant_id_;
+};
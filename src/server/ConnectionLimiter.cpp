@@ -1,4 +1,5 @@
 #include "ConnectionLimiter.h"
+#include <algorithm>
 
 ConnectionLimiter::ConnectionLimiter(size_t max_total, size_t max_per_ip)
     : max_total_(max_total), max_per_ip_(max_per_ip), total_(0) {}
@@ -33,8 +34,78 @@ void ConnectionLimiter::release(const std::string& ip) {
     }
 }
 
+bool ConnectionLimiter::tryAcquireTenant(const ClientPolicy& policy) {
+    if (policy.tenant_id.empty()) return true;
+    std::lock_guard<std::mutex> lock(mutex_);
+    TenantState& t = tenants_[policy.tenant_id];
+    if (policy.max_sessions > 0 && t.sessions >= static_cast<size_t>(policy.max_sessions)) {
+        ++tenant_rejections_;
+        return false;
+    }
+    ++t.sessions;
+    return true;
+}
+
+void ConnectionLimiter::releaseTenant(const std::string& tenant_id) {
+    if (tenant_id.empty()) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = tenants_.find(tenant_id);
+    if (it == tenants_.end()) return;
+    if (it->second.sessions > 0) --it->second.sessions;
+    // A metered tenant keeps its bucket so reconnecting does not reset the quota.
+    if (it->second.sessions == 0 && !it->second.metered) {
+        tenants_.erase(it);
+    }
+}
+
+bool ConnectionLimiter::consumeAudio(const ClientPolicy& policy, double seconds, Clock::time_point now) {
+    if (policy.tenant_id.empty() || policy.audio_seconds_per_minute <= 0) return true;
+    std::lock_guard<std::mutex> lock(mutex_);
+    TenantState& t = tenants_[policy.tenant_id];
+    refill(t, policy.audio_seconds_per_minute, now);
+    if (t.balance <= 0.0) {
+        ++quota_rejections_;
+        return false;
+    }
+    t.balance -= seconds;
+    return true;
+}
+
+double ConnectionLimiter::chargeAudio(const ClientPolicy& policy, double seconds, Clock::time_point now) {
+    if (policy.tenant_id.empty() || policy.audio_seconds_per_minute <= 0) return 0.0;
+    std::lock_guard<std::mutex> lock(mutex_);
+    TenantState& t = tenants_[policy.tenant_id];
+    const double capacity = policy.audio_seconds_per_minute;
+    refill(t, capacity, now);
+    t.balance -= seconds;
+    if (t.balance > 0.0) return 0.0;
+    ++quota_throttles_;
+    // Just past zero, so the next charge finds a positive balance.
+    return (-t.balance * 60.0 / capacity) + 0.01;
+}
+
+void ConnectionLimiter::refill(TenantState& t, double capacity, Clock::time_point now) {
+    if (!t.metered) {
+        t.metered  = true;
+        t.balance  = capacity;
+        t.refilled = now;
+    } else if (now > t.refilled) {
+        double elapsed = std::chrono::duration<double>(now - t.refilled).count();
+        t.balance  = std::min(capacity, t.balance + elapsed * capacity / 60.0);
+        t.refilled = now;
+    }
+}
+
 std::string ConnectionLimiter::getMetrics() const {
     std::lock_guard<std::mutex> lock(mutex_);
+    size_t active_tenants = 0;
+    for (const auto& [id, t] : tenants_) {
+        if (t.sessions > 0) ++active_tenants;
+    }
     return "transcription_active_connections " + std::to_string(total_) + "\n" +
-           "transcription_max_connections " + std::to_string(max_total_) + "\n";
+           "transcription_max_connections " + std::to_string(max_total_) + "\n" +
+           "transcription_active_tenants " + std::to_string(active_tenants) + "\n" +
+           "transcription_tenant_session_rejections_total " + std::to_string(tenant_rejections_) + "\n" +
+           "transcription_tenant_quota_rejections_total " + std::to_string(quota_rejections_) + "\n" +
+           "transcription_tenant_quota_throttles_total " + std::to_string(quota_throttles_) + "\n";
 }
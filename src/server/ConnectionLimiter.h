@@ -1,21 +1,69 @@
 #pragma once
+#include <chrono>
+#include <cstdint>
 #include <mutex>
 #include <unordered_map>
 #include <string>
+#include "auth/ClientPolicy.h"
 
 class ConnectionLimiter {
 public:
+    using Clock = std::chrono::steady_clock;
+
     ConnectionLimiter(size_t max_total, size_t max_per_ip);
 
     bool tryAcquire(const std::string& ip);
     void release(const std::string& ip);
 
+    /**
+     * @brief Claim a session slot for the policy's tenant (after auth).
+     * @return false if the tenant already has max_sessions sessions.
+     *         Policies without a tenant id always succeed and need no release.
+     */
+    bool tryAcquireTenant(const ClientPolicy& policy);
+    void releaseTenant(const std::string& tenant_id);
+
+    /**
+     * @brief Charge `seconds` of audio to the tenant's per-minute quota.
+     *
+     * Token bucket holding one minute of quota, refilled continuously. A
+     * request is admitted while the balance is positive and may overdraw it
+     * (a long upload is paid back over the following minutes).
+     * @return false once the balance is exhausted.
+     */
+    bool consumeAudio(const ClientPolicy& policy, double seconds, Clock::time_point now = Clock::now());
+
+    /**
+     * @brief Charge audio already accepted by a streaming session, never refusing it.
+     *
+     * Same bucket as consumeAudio(). A live stream is throttled rather than cut:
+     * the session stops reading until the balance is positive again, and TCP
+     * backpressure holds the client's audio.
+     * @return seconds until the balance is positive (0 while it still is).
+     */
+    double chargeAudio(const ClientPolicy& policy, double seconds, Clock::time_point now = Clock::now());
+
     std::string getMetrics() const;
 
 private:
+    struct TenantState {
+        size_t sessions = 0;
+        bool   metered  = false;   // quota bucket in use (kept across sessions)
+        double balance  = 0.0;     // audio seconds
+        Clock::time_point refilled{};
+    };
+
+    // Caller holds mutex_. Starts the bucket full, then refills it up to `now`.
+    static void refill(TenantState& t, double capacity, Clock::time_point now);
+
     mutable std::mutex mutex_;
     std::unordered_map<std::string, size_t> per_ip_;
     size_t max_total_;
     size_t max_per_ip_;
     size_t total_;
+
+    std::unordered_map<std::string, TenantState> tenants_;
+    uint64_t tenant_rejections_ = 0;
+    uint64_t quota_rejections_  = 0;
+    uint64_t quota_throttles_   = 0;
 };
@@ -0,0 +1,157 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+/**
+ * @brief Process-wide counters for streaming flow control.
+ *
+ * Lock-free (relaxed atomics): updated by every session and read by /metrics.
+ */
+class FlowControlMetrics {
+public:
+    static FlowControlMetrics& instance() {
+        static FlowControlMetrics inst;
+        return inst;
+    }
+
+    void recordGrant() { grants_.fetch_add(1, std::memory_order_relaxed); }
+    void recordStall() { stalls_.fetch_add(1, std::memory_order_relaxed); }
+    void recordStallEnd(double seconds) {
+        stall_ms_.fetch_add(static_cast<uint64_t>(seconds * 1000.0), std::memory_order_relaxed);
+    }
+    /// Audio sent past the advertised limit (clients that ignore credits).
+    void recordOverrun() { overruns_.fetch_add(1, std::memory_order_relaxed); }
+    /// Audio dropped at the engine's high-water mark.
+    void recordDropped(size_t samples) { dropped_samples_.fetch_add(samples, std::memory_order_relaxed); }
+
+    /**
+     * @brief Get telemetry metrics in Prometheus format
+     */
+    std::string getMetrics() const {
+        return "transcription_flow_credit_grants_total " + std::to_string(grants_.load(std::memory_order_relaxed)) + "\n" +
+               "transcription_flow_credit_stalls_total " + std::to_string(stalls_.load(std::memory_order_relaxed)) + "\n" +
+               "transcription_flow_credit_stall_seconds_total " +
+                   std::to_string(stall_ms_.load(std::memory_order_relaxed) / 1000.0) + "\n" +
+               "transcription_flow_credit_overruns_total " + std::to_string(overruns_.load(std::memory_order_relaxed)) + "\n" +
+               "transcription_audio_dropped_seconds_total " +
+                   std::to_string(dropped_samples_.load(std::memory_order_relaxed) / 16000.0) + "\n";
+    }
+
+private:
+    FlowControlMetrics() = default;
+
+    std::atomic<uint64_t> grants_{0};
+    std::atomic<uint64_t> stalls_{0};
+    std::atomic<uint64_t> stall_ms_{0};
+    std::atomic<uint64_t> overruns_{0};
+    std::atomic<uint64_t> dropped_samples_{0};
+};
+
+/**
+ * @brief Credit-based backpressure for one streaming session.
+ *
+ * Credits are cumulative: the server advertises `limit`, the total number of
+ * samples the client may have sent since the session started. It is always
+ * received + (window - buffered), so it only grows as inference drains the
+ * engine buffer, and a client that keeps its own sent-samples counter below
+ * the latest limit can never overflow the buffer, however late the grant
+ * arrives. When credits run out the client holds audio locally: overload
+ * becomes delay instead of lost audio.
+ *
+ * Not thread-safe: the session calls it under its state mutex.
+ */
+class CreditWindow {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @param window_samples  audio the server will hold undecoded (the engine's high-water mark)
+     * @param update_samples  minimum growth worth a `credit` message while the client is not stalled
+     */
+    explicit CreditWindow(size_t window_samples = 16000 * 20, size_t update_samples = 16000)
+        : window_(window_samples), update_(update_samples) {}
+
+    /// Initial grant (sent with `ready`).
+    uint64_t open(size_t buffered) {
+        advertised_ = limitFor(buffered);
+        return advertised_;
+    }
+
+    /**
+     * @brief A re-config replaced the engine, whose buffer now holds `buffered` samples.
+     *
+     * received() carries over, so the limit stays cumulative for the whole
+     * connection and never goes down; only the undecoded part is re-based on
+     * the new buffer (audio the old engine held is gone and frees its room).
+     */
+    uint64_t reopen(size_t buffered, Clock::time_point now = Clock::now()) {
+        advertised_ = std::max(advertised_, limitFor(buffered));
+        if (stalled_since_ && received_ < advertised_) {
+            FlowControlMetrics::instance().recordStallEnd(
+                std::chrono::duration<double>(now - *stalled_since_).count());
+            stalled_since_.reset();
+        }
+        return advertised_;
+    }
+
+    /**
+     * @brief Samples arrived from the client.
+     * @return false if they go past the advertised limit (the client ignored its credits).
+     */
+    bool onAudio(size_t samples, Clock::time_point now = Clock::now()) {
+        bool within = received_ + samples <= advertised_;
+        received_ += samples;
+        if (!within) FlowControlMetrics::instance().recordOverrun();
+        if (received_ >= advertised_ && !stalled_since_) {
+            stalled_since_ = now;
+            FlowControlMetrics::instance().recordStall();
+        }
+        return within;
+    }
+
+    /**
+     * @brief The engine buffer is now `buffered` samples (after a decode).
+     * @return the new limit to advertise, or nullopt when the change is not
+     *         worth a message (less than update_samples and the client still has credit).
+     */
+    std::optional<uint64_t> onDrain(size_t buffered, Clock::time_point now = Clock::now()) {
+        uint64_t limit = limitFor(buffered);
+        if (limit <= advertised_) return std::nullopt; // grants are never revoked
+        if (!stalled_since_ && limit - advertised_ < update_) return std::nullopt;
+
+        advertised_ = limit;
+        FlowControlMetrics::instance().recordGrant();
+        if (stalled_since_ && received_ < advertised_) {
+            FlowControlMetrics::instance().recordStallEnd(
+                std::chrono::duration<double>(now - *stalled_since_).count());
+            stalled_since_.reset();
+        }
+        return advertised_;
+    }
+
+    uint64_t received() const { return received_; }
+    uint64_t limit() const { return advertised_; }
+    bool stalled() const { return stalled_since_.has_value(); }
+    size_t window() const { return window_; }
+
+    /// Credit the client has left, in seconds of 16 kHz audio.
+    double availableSeconds() const {
+        return received_ >= advertised_ ? 0.0 : static_cast<double>(advertised_ - received_) / 16000.0;
+    }
+
+private:
+    uint64_t limitFor(size_t buffered) const {
+        return received_ + (buffered < window_ ? window_ - buffered : 0);
+    }
+
+    size_t window_;
+    size_t update_;
+    uint64_t received_ = 0;
+    uint64_t advertised_ = 0;
+    std::optional<Clock::time_point> stalled_since_;
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include "whisper/TranscriptionEngine.h"
+
+/**
+ * @brief When a session's flush thread runs a decode (StreamingSession::flushLoop).
+ *
+ * Pure logic, no clock of its own: the session passes in its buffer sizes and
+ * the time since the last audio frame, so the same rules can be driven on a
+ * virtual clock (bench/sim).
+ *
+ *  - nothing is decoded below `min_buffer_samples`: Whisper hallucinates badly
+ *    on very short windows;
+ *  - live: a decode is due once a stride of new audio has accumulated (the
+ *    stride comes from PartialCadence), or after `silence_flush` without audio
+ *    while some audio is still undecoded;
+ *  - bulk: only once a full chunk is buffered; handleEnd() takes the tail.
+ */
+class FlushPolicy {
+public:
+    using ms = std::chrono::milliseconds;
+
+    struct Options {
+        ms     poll{200};                     // flush thread sleep between checks (live)
+        ms     bulk_poll{20};                 // bulk is throughput-bound: never wait for the cadence
+        size_t min_buffer_samples = 32000;    // 2s before the first decode
+        ms     silence_flush{400};
+        size_t bulk_chunk_samples = TranscriptionEngine::BULK_MAX_CHUNK_SAMPLES;
+    };
+
+    FlushPolicy() : FlushPolicy(Options{}) {}
+    explicit FlushPolicy(Options opt) : opt_(opt) {}
+
+    ms pollInterval(bool bulk) const { return bulk ? opt_.bulk_poll : opt_.poll; }
+
+    bool hasMinimumBuffer(size_t buffered) const { return buffered >= opt_.min_buffer_samples; }
+
+    /**
+     * @param buffered          samples in the engine buffer now
+     * @param last_transcribed  buffer size right after the previous decode
+     * @param since_audio       time since the last audio frame arrived
+     * @param stride_samples    current partial stride (PartialCadence::strideSamples)
+     */
+    bool due(size_t buffered, size_t last_transcribed, ms since_audio, bool bulk, size_t stride_samples) const {
+        if (!hasMinimumBuffer(buffered)) return false;
+        if (bulk) return buffered >= opt_.bulk_chunk_samples;
+        const size_t fresh = buffered > last_transcribed ? buffered - last_transcribed : 0;
+        return fresh >= stride_samples || (since_audio > opt_.silence_flush && fresh > 0);
+    }
+
+    const Options& options() const { return opt_; }
+
+private:
+    Options opt_;
+};
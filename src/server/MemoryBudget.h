@@ -0,0 +1,232 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/**
+ * @brief Host memory accounting for streaming sessions, with a global budget.
+ *
+ * Every configured session holds an Account: what it reserved up front
+ * (sessionEstimate: a whisper_state, the pre-reserved 30s audio buffer and a
+ * transcript allowance) and what it actually uses per component, updated by the
+ * session as its buffers and transcript grow. A session is charged the larger of
+ * the two. An offline upload (POST /v1/transcribe) holds one too, sized by
+ * uploadEstimate. Memory that belongs to no session (model weights, idle pooled
+ * states) is reported by the caller as `shared_bytes`.
+ *
+ * With a budget set, reserve() admits a session only while
+ * shared + charged + estimate stays within it; otherwise it waits up to
+ * `queue_timeout` for sessions to end, then refuses, so a burst of connections is
+ * turned away before it can take the process out. Budget 0 = accounting only.
+ *
+ * Thread-safe.
+ */
+class MemoryBudget {
+public:
+    enum class Component { State = 0, Audio = 1, Text = 2 };
+    static constexpr size_t COMPONENTS = 3;
+
+    /// 30s float buffer reserved by the engine, as in StreamingWhisperEngine.
+    static constexpr size_t AUDIO_RESERVE_BYTES = 16000 * 30 * sizeof(float);
+    /// Transcript, partial and message strings of a typical session.
+    static constexpr size_t TEXT_ALLOWANCE_BYTES = 256 * 1024;
+    /// Copy of one offline chunk a decode worker preprocesses (SilenceSplitter's 25s maximum).
+    static constexpr size_t CHUNK_COPY_BYTES = 16000 * 25 * sizeof(float);
+
+    struct Config {
+        size_t budget_bytes = 0;                       // 0 = no limit, accounting only
+        std::chrono::milliseconds queue_timeout{0};    // wait for room before refusing
+        int retry_after_seconds = 5;                   // hint sent with a refusal
+    };
+
+    static MemoryBudget& instance() {
+        static MemoryBudget inst;
+        return inst;
+    }
+
+    MemoryBudget() = default;
+
+    // Non-copyable
+    MemoryBudget(const MemoryBudget&) = delete;
+    MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+    void configure(const Config& config) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            config_ = config;
+        }
+        cv_.notify_all();
+    }
+
+    Config config() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return config_;
+    }
+
+    /// Up-front reservation of a session whose engine holds a `state_bytes` decoder state.
+    static size_t sessionEstimate(size_t state_bytes) {
+        return state_bytes + AUDIO_RESERVE_BYTES + TEXT_ALLOWANCE_BYTES;
+    }
+
+    /// Audio held by an offline upload: the request body, its float PCM and one chunk copy per worker.
+    static size_t uploadAudioBytes(size_t body_bytes, size_t pcm_bytes, int workers) {
+        return body_bytes + pcm_bytes + static_cast<size_t>(std::max(workers, 0)) * CHUNK_COPY_BYTES;
+    }
+
+    /// Up-front reservation of an offline upload: its audio plus one leased `state_bytes` state per worker.
+    static size_t uploadEstimate(size_t body_bytes, size_t pcm_bytes, int workers, size_t state_bytes) {
+        return uploadAudioBytes(body_bytes, pcm_bytes, workers) + static_cast<size_t>(std::max(workers, 0)) * state_bytes;
+    }
+
+    /**
+     * @brief One session's memory. Released (and waiters woken) on destruction.
+     */
+    class Account {
+    public:
+        Account(MemoryBudget& budget, size_t reserved) : budget_(budget), reserved_(reserved) {}
+        ~Account() { budget_.close(*this); }
+
+        Account(const Account&) = delete;
+        Account& operator=(const Account&) = delete;
+
+        /// Current size of one component (replaces the previous value).
+        void update(Component c, size_t bytes) { budget_.update(*this, c, bytes); }
+
+        size_t reserved() const { return reserved_; }
+
+        size_t used() const {
+            std::lock_guard<std::mutex> lock(budget_.mutex_);
+            return usedLocked();
+        }
+
+    private:
+        friend class MemoryBudget;
+
+        size_t usedLocked() const {
+            size_t total = 0;
+            for (size_t b : used_) total += b;
+            return total;
+        }
+        size_t chargeLocked() const { return std::max(reserved_, usedLocked()); }
+
+        MemoryBudget& budget_;
+        size_t reserved_;
+        std::array<size_t, COMPONENTS> used_{}; // guarded by budget_.mutex_
+    };
+
+    /**
+     * @brief Admit a session that needs `estimate` bytes.
+     * @param shared_bytes  memory outside any session right now (model, idle states)
+     * @return the session's Account, or nullptr when the budget has no room for it
+     *         within queue_timeout.
+     */
+    std::unique_ptr<Account> reserve(size_t estimate, size_t shared_bytes) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        shared_ = shared_bytes;
+        auto fits = [&] {
+            return config_.budget_bytes == 0 || shared_ + charged_ + estimate <= config_.budget_bytes;
+        };
+        if (!fits()) {
+            if (config_.queue_timeout.count() > 0) {
+                ++queued_total_;
+                ++waiting_;
+                cv_.wait_for(lock, config_.queue_timeout, fits);
+                --waiting_;
+            }
+            if (!fits()) {
+                ++rejected_total_;
+                return nullptr;
+            }
+        }
+        auto account = std::make_unique<Account>(*this, estimate);
+        charged_ += estimate;
+        session_max_ = std::max(session_max_, estimate);
+        ++sessions_;
+        return account;
+    }
+
+    /// Refresh the shared bytes between reservations (a model loaded or unloaded).
+    void updateShared(size_t shared_bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shared_ = shared_bytes;
+        cv_.notify_all();
+    }
+
+    /// Bytes that would still fit (0 if over, SIZE_MAX without a budget).
+    size_t available() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (config_.budget_bytes == 0) return SIZE_MAX;
+        const size_t committed = shared_ + charged_;
+        return committed >= config_.budget_bytes ? 0 : config_.budget_bytes - committed;
+    }
+
+    size_t charged() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return charged_;
+    }
+
+    /**
+     * @brief Get telemetry metrics in Prometheus format
+     */
+    std::string getMetrics() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        static const char* names[COMPONENTS] = {"state", "audio", "text"};
+        std::string out = "transcription_memory_budget_bytes " + std::to_string(config_.budget_bytes) + "\n" +
+                          "transcription_memory_shared_bytes " + std::to_string(shared_) + "\n" +
+                          "transcription_memory_charged_bytes " + std::to_string(charged_) + "\n" +
+                          "transcription_memory_sessions " + std::to_string(sessions_) + "\n" +
+                          "transcription_memory_session_max_bytes " + std::to_string(session_max_) + "\n";
+        for (size_t c = 0; c < COMPONENTS; ++c) {
+            out += std::string("transcription_memory_session_bytes{component=\"") + names[c] + "\"} " +
+                   std::to_string(used_[c]) + "\n";
+        }
+        out += "transcription_memory_waiting " + std::to_string(waiting_) + "\n" +
+               "transcription_memory_queued_total " + std::to_string(queued_total_) + "\n" +
+               "transcription_memory_rejected_total " + std::to_string(rejected_total_) + "\n";
+        return out;
+    }
+
+private:
+    void update(Account& a, Component c, size_t bytes) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const size_t i = static_cast<size_t>(c);
+            const size_t before = a.chargeLocked();
+            used_[i] = used_[i] - a.used_[i] + bytes;
+            a.used_[i] = bytes;
+            const size_t after = a.chargeLocked();
+            charged_ = charged_ - before + after;
+            session_max_ = std::max(session_max_, after);
+            if (after >= before) return;
+        }
+        cv_.notify_all();
+    }
+
+    void close(Account& a) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            charged_ -= a.chargeLocked();
+            for (size_t c = 0; c < COMPONENTS; ++c) used_[c] -= a.used_[c];
+            --sessions_;
+        }
+        cv_.notify_all();
+    }
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    Config config_;
+    size_t shared_ = 0;
+    size_t charged_ = 0;                       // sum of max(reserved, used) over accounts
+    size_t sessions_ = 0;
+    size_t session_max_ = 0;                   // largest charge seen for one session
+    std::array<size_t, COMPONENTS> used_{};    // sum of per-component usage over accounts
+    size_t waiting_ = 0;
+    uint64_t queued_total_ = 0;
+    uint64_t rejected_total_ = 0;
+};
@@ -0,0 +1,140 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Process-wide view of the partial strides in use.
+ *
+ * Lock-free (relaxed atomics): each live session adds its current stride and
+ * the /metrics endpoint reports the average and how many sessions are stretched.
+ */
+class CadenceMetrics {
+public:
+    static CadenceMetrics& instance() {
+        static CadenceMetrics inst;
+        return inst;
+    }
+
+    /// A session's stride changed from old_ms to new_ms (0 = not registered).
+    void update(int64_t old_ms, int64_t new_ms, int64_t min_ms) {
+        if (old_ms == 0) sessions_.fetch_add(1, std::memory_order_relaxed);
+        if (new_ms == 0) sessions_.fetch_sub(1, std::memory_order_relaxed);
+        stride_ms_sum_.fetch_add(new_ms - old_ms, std::memory_order_relaxed);
+        stretched_.fetch_add(static_cast<int>(new_ms > min_ms) - static_cast<int>(old_ms > min_ms),
+                             std::memory_order_relaxed);
+    }
+
+    int64_t sessions() const { return sessions_.load(std::memory_order_relaxed); }
+    int64_t strideSumMs() const { return stride_ms_sum_.load(std::memory_order_relaxed); }
+    int stretched() const { return stretched_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Get telemetry metrics in Prometheus format
+     */
+    std::string getMetrics() const {
+        int64_t sessions = sessions_.load(std::memory_order_relaxed);
+        double avg = sessions > 0
+            ? static_cast<double>(stride_ms_sum_.load(std::memory_order_relaxed)) / sessions / 1000.0 : 0.0;
+        return "transcription_partial_stride_seconds " + std::to_string(avg) + "\n" +
+               "transcription_partial_stride_sessions " + std::to_string(sessions) + "\n" +
+               "transcription_partial_stride_stretched_sessions " +
+                   std::to_string(stretched_.load(std::memory_order_relaxed)) + "\n";
+    }
+
+private:
+    CadenceMetrics() = default;
+
+    std::atomic<int64_t> sessions_{0};
+    std::atomic<int64_t> stride_ms_sum_{0};
+    std::atomic<int>     stretched_{0};
+};
+
+/**
+ * @brief How much new audio a live session waits for before its next partial.
+ *
+ * The target stride is the largest of:
+ *  - the load target: min_stride at `pressure_start` slot utilization, rising
+ *    linearly to max_stride at `pressure_full`;
+ *  - the self target: the session's own decode time / duty_cycle, so that one
+ *    slow session does not hog a slot with back-to-back partials;
+ *  - 1.5x the current stride when the last attempt found no free slot.
+ *
+ * The stride moves towards the target quickly when growing and slowly when
+ * shrinking, so partials thin out evenly under pressure instead of failing
+ * try_acquire at random, and come back gradually when the box idles.
+ *
+ * Not thread-safe: used by the session's flush thread only.
+ */
+class PartialCadence {
+public:
+    using ms = std::chrono::milliseconds;
+
+    struct Options {
+        ms     min_stride{250};
+        ms     max_stride{1000};
+        double pressure_start = 0.5;   // utilization where stretching begins
+        double pressure_full  = 0.9;   // utilization where max_stride is reached
+        double duty_cycle     = 0.5;   // max fraction of wall time one session spends decoding
+        double grow_rate      = 0.5;   // fraction of the gap closed per update when growing
+        double shrink_rate    = 0.2;   // ... and when shrinking
+    };
+
+    PartialCadence() : PartialCadence(Options{}) {}
+    explicit PartialCadence(Options opt) : opt_(opt), stride_ms_(static_cast<double>(opt.min_stride.count())) {}
+
+    ~PartialCadence() {
+        if (published_ms_ != 0) CadenceMetrics::instance().update(published_ms_, 0, opt_.min_stride.count());
+    }
+
+    PartialCadence(const PartialCadence&) = delete;
+    PartialCadence& operator=(const PartialCadence&) = delete;
+
+    /// A partial decode took `seconds` of wall time (smoothed, EWMA).
+    void onDecode(double seconds) {
+        decode_ewma_ = decode_ewma_ == 0.0 ? seconds : 0.7 * decode_ewma_ + 0.3 * seconds;
+    }
+
+    /// A due partial found no free inference slot.
+    void onBusy() { busy_ = true; }
+
+    /**
+     * @brief Recompute the stride.
+     * @param utilization  global busy slots / slots (LoadEstimator load / max concurrency)
+     */
+    ms update(double utilization) {
+        const double lo = static_cast<double>(opt_.min_stride.count());
+        const double hi = static_cast<double>(opt_.max_stride.count());
+
+        double span = std::max(opt_.pressure_full - opt_.pressure_start, 1e-6);
+        double pressure = std::clamp((utilization - opt_.pressure_start) / span, 0.0, 1.0);
+        double target = lo + pressure * (hi - lo);
+        if (opt_.duty_cycle > 0.0) target = std::max(target, decode_ewma_ * 1000.0 / opt_.duty_cycle);
+        if (busy_) target = std::max(target, stride_ms_ * 1.5);
+        busy_ = false;
+        target = std::clamp(target, lo, hi);
+
+        double rate = target > stride_ms_ ? opt_.grow_rate : opt_.shrink_rate;
+        stride_ms_ += rate * (target - stride_ms_);
+        if (std::abs(stride_ms_ - target) < 1.0) stride_ms_ = target;
+
+        int64_t now_ms = static_cast<int64_t>(stride_ms_ + 0.5);
+        CadenceMetrics::instance().update(published_ms_, now_ms, opt_.min_stride.count());
+        published_ms_ = now_ms;
+        return ms(now_ms);
+    }
+
+    ms stride() const { return ms(static_cast<int64_t>(stride_ms_ + 0.5)); }
+    size_t strideSamples() const { return static_cast<size_t>(stride().count()) * 16; } // 16 kHz
+
+private:
+    Options opt_;
+    double  stride_ms_;
+    double  decode_ewma_ = 0.0; // seconds
+    bool    busy_ = false;
+    int64_t published_ms_ = 0;  // contribution to CadenceMetrics (0 = none yet)
+};
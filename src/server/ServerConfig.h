@@ -16,12 +16,16 @@ struct ServerConfig {
     std::string auth_api_url;           // external auth API (takes precedence over auth_token)
     std::string auth_api_secret;        // Authorization: Bearer <...>
     int auth_cache_ttl = 300;           // seconds
+    int auth_negative_cache_ttl = 30;   // seconds, for denied keys
+    size_t auth_cache_max_entries = 10000;
     int auth_api_timeout = 5;           // seconds
+    int auth_api_pool_size = 4;         // idle keep-alive connections to the auth API
 
     int whisper_beam_size = 1;          // beam search size (1 = greedy, fastest for streaming)
-    int whisper_threads = 4;            // threads per transcription
-    int max_concurrent_inference = 4;   // Max simultaneous whisper decodes
+    int whisper_threads = 4;            // threads per transcription (0 = auto, from the cgroup CPU limits)
+    int max_concurrent_inference = 4;   // Max simultaneous whisper decodes (0 = auto)
     int model_cache_ttl = 300;          // seconds to keep model after last session (0 = immediate, -1 = forever)
+    std::string model_load = "read";    // "read" (whisper's ifstream) or "mmap" (page-cache backed, read-ahead)
     std::string whisper_initial_prompt; // optional initial prompt for decoder guidance
 
     // Whisper inference quality/speed tuning
@@ -30,5 +34,25 @@ struct ServerConfig {
     float whisper_no_speech_thold = 0.3f;   // probability threshold to reject non-speech segments
     float whisper_logprob_thold = -0.7f;    // log-prob threshold to reject low-confidence segments (-1.0=disabled)
 
+    int partial_deadline_ms = 3000;     // abort partial-only decodes still running after this (0 = no deadline)
+    int partial_latency_slo_ms = 2000;  // shed new sessions when p90 partial latency would exceed this (0 = off)
+    double admission_max_utilization = 0.85; // shed when busy slots / slots would exceed this
+    size_t max_upload_mb = 100;         // max body size for POST /v1/transcribe (~55 min float32 @ 16kHz)
+    size_t memory_budget_mb = 0;        // model + streaming sessions; new sessions refused beyond it (0 = off)
+    bool memory_budget_auto = false;    // budget = 90% of the cgroup memory limit
+    int memory_queue_timeout_ms = 0;    // wait this long for memory to free up before refusing a session
+
+    // NUMA: "off", "pin" (sessions pinned to a node's CPUs) or "replicate" (+ one model per node)
+    std::string numa_placement = "off";
+    std::string numa_topology;          // simulated nodes, e.g. "0-3;4-7" (empty = /sys/devices/system/node)
+
+    // Streaming backend: "whisper", or "mock" to load-test the server without a model
+    std::string backend = "whisper";
+    double mock_decode_ms = 50.0;             // mock: latency per decode...
+    double mock_decode_ms_per_audio_s = 20.0; // ... plus this per second of decoded audio
+    double mock_words_per_second = 2.5;       // mock: synthetic speech rate
+
+    std::string capture_dir;            // record every session here for replay (empty = off)
+
     int shutdown_timeout_sec = 10;      // max seconds to wait for sessions to close on SIGINT/SIGTERM
 };
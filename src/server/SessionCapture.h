@@ -0,0 +1,235 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "utils/CaptureFile.h"
+#include "log/Log.h"
+
+class SessionCapture;
+
+/**
+ * @brief Background writer for session captures (opt-in, CAPTURE_DIR).
+ *
+ * Sessions never touch the disk: they encode records into a memory buffer and
+ * hand full buffers to this writer's thread, which appends them to the session's
+ * file. If the disk falls behind by more than `max_queued_bytes`, new buffers are
+ * refused and that session's capture stops (the file keeps what was written).
+ *
+ * Thread-safe.
+ */
+class CaptureWriter {
+public:
+    struct Config {
+        std::string dir;                            // empty = capture off
+        size_t max_queued_bytes = 64 * 1024 * 1024; // across all sessions
+    };
+
+    static CaptureWriter& instance() {
+        static CaptureWriter inst;
+        return inst;
+    }
+
+    ~CaptureWriter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        if (thread_.joinable()) thread_.join();
+    }
+
+    // Non-copyable
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    void configure(Config config) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        config_ = std::move(config);
+        if (!config_.dir.empty() && !thread_.joinable()) {
+            thread_ = std::thread([this] { run(); });
+        }
+    }
+
+    bool enabled() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return !config_.dir.empty();
+    }
+
+    /// Start a capture for a session: `<dir>/<session_id>.cap`. nullptr if capture is off
+    /// or the file cannot be created.
+    std::unique_ptr<SessionCapture> open(const std::string& session_id);
+
+    /// Queue bytes for a file. false (nothing queued) when over the backlog limit.
+    bool enqueue(const std::shared_ptr<std::FILE>& file, std::string bytes) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (queued_bytes_ + bytes.size() > config_.max_queued_bytes) {
+                return false;
+            }
+            queued_bytes_ += bytes.size();
+            jobs_.push_back({file, std::move(bytes)});
+        }
+        cv_.notify_one();
+        return true;
+    }
+
+    /// Block until everything queued so far is on disk (tests, shutdown).
+    void drain() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_cv_.wait(lock, [this] { return jobs_.empty() && !writing_; });
+    }
+
+    void recordSession()   { sessions_.fetch_add(1, std::memory_order_relaxed); }
+    void recordAbandoned() { abandoned_.fetch_add(1, std::memory_order_relaxed); }
+
+    /**
+     * @brief Get telemetry metrics in Prometheus format
+     */
+    std::string getMetrics() const {
+        size_t queued;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queued = queued_bytes_;
+        }
+        return "transcription_capture_sessions_total " + std::to_string(sessions_.load(std::memory_order_relaxed)) + "\n" +
+               "transcription_capture_abandoned_total " + std::to_string(abandoned_.load(std::memory_order_relaxed)) + "\n" +
+               "transcription_capture_bytes_written_total " + std::to_string(written_.load(std::memory_order_relaxed)) + "\n" +
+               "transcription_capture_queued_bytes " + std::to_string(queued) + "\n";
+    }
+
+private:
+    CaptureWriter() = default;
+
+    struct Job {
+        std::shared_ptr<std::FILE> file; // closed when its last job is written
+        std::string bytes;
+    };
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            cv_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+            if (jobs_.empty()) return; // stop_ and drained
+
+            Job job = std::move(jobs_.front());
+            jobs_.pop_front();
+            writing_ = true;
+            lock.unlock();
+
+            if (std::fwrite(job.bytes.data(), 1, job.bytes.size(), job.file.get()) != job.bytes.size()) {
+                Log::warn("Session capture write failed");
+            }
+            std::fflush(job.file.get());
+            written_.fetch_add(job.bytes.size(), std::memory_order_relaxed);
+            job.file.reset();
+
+            lock.lock();
+            queued_bytes_ -= job.bytes.size();
+            writing_ = false;
+            if (jobs_.empty()) idle_cv_.notify_all();
+        }
+    }
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable idle_cv_;
+    Config config_;
+    std::deque<Job> jobs_;
+    size_t queued_bytes_ = 0;
+    bool writing_ = false;
+    bool stop_ = false;
+    std::thread thread_;
+
+    std::atomic<uint64_t> sessions_{0};
+    std::atomic<uint64_t> abandoned_{0};
+    std::atomic<uint64_t> written_{0};
+};
+
+/**
+ * @brief One session's capture: timestamps and encodes records, hands them to
+ *        CaptureWriter in FLUSH_BYTES buffers and the remainder on destruction.
+ *
+ * Thread-safe: the receive loop and the flush thread both record.
+ */
+class SessionCapture {
+public:
+    static constexpr size_t FLUSH_BYTES = 64 * 1024;
+
+    SessionCapture(std::shared_ptr<std::FILE> file, const std::string& session_id, std::string path)
+        : file_(std::move(file)), path_(std::move(path)), start_(std::chrono::steady_clock::now()) {
+        const auto unix_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        std::string meta = "{\"session_id\":\"" + session_id + "\",\"started_unix_ms\":" +
+                           std::to_string(unix_ms) + ",\"sample_rate\":16000}";
+        buffer_.assign(capture::MAGIC, sizeof(capture::MAGIC));
+        capture::appendRecord(buffer_, capture::RecordType::Meta, 0, meta.data(), meta.size());
+    }
+
+    ~SessionCapture() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        handOff();
+    }
+
+    SessionCapture(const SessionCapture&) = delete;
+    SessionCapture& operator=(const SessionCapture&) = delete;
+
+    void textIn(const std::string& text)  { record(capture::RecordType::TextIn, text.data(), text.size()); }
+    void audioIn(const void* data, size_t n) { record(capture::RecordType::AudioIn, data, n); }
+    void textOut(const std::string& text) { record(capture::RecordType::TextOut, text.data(), text.size()); }
+
+    const std::string& path() const { return path_; }
+
+private:
+    void record(capture::RecordType type, const void* data, size_t n) {
+        const auto t_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start_).count();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (abandoned_) return;
+        capture::appendRecord(buffer_, type, static_cast<uint64_t>(t_us), data, n);
+        if (buffer_.size() >= FLUSH_BYTES) handOff();
+    }
+
+    // Caller holds mutex_.
+    void handOff() {
+        if (abandoned_ || buffer_.empty()) return;
+        if (!CaptureWriter::instance().enqueue(file_, std::move(buffer_))) {
+            abandoned_ = true;
+            CaptureWriter::instance().recordAbandoned();
+            Log::warn("Capture writer backlog full, stopped capturing " + path_);
+        }
+        buffer_.clear();
+    }
+
+    std::shared_ptr<std::FILE> file_;
+    std::string path_;
+    std::chrono::steady_clock::time_point start_;
+    std::mutex mutex_;
+    std::string buffer_;
+    bool abandoned_ = false;
+};
+
+inline std::unique_ptr<SessionCapture> CaptureWriter::open(const std::string& session_id) {
+    std::string dir;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        dir = config_.dir;
+    }
+    if (dir.empty()) return nullptr;
+
+    std::string path = dir + "/" + session_id + ".cap";
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) {
+        Log::warn("Cannot create session capture " + path);
+        return nullptr;
+    }
+    recordSession();
+    return std::make_unique<SessionCapture>(std::shared_ptr<std::FILE>(f, [](std::FILE* fp) { std::fclose(fp); }),
+                                            session_id, path);
+}
@@ -8,19 +8,32 @@
 #include <vector>
 #include <thread>
 #include <atomic>
+#include <future>
 #include <mutex>
+#include <optional>
 #include <sstream>
 #include <unordered_map>
 #include <nlohmann/json.hpp>
 #include <iostream>
 #include "whisper/StreamingWhisperEngine.h"
 #include "whisper/ModelCache.h"
+#include "whisper/TranscriptionBackend.h"
 #include "server/SessionTracker.h"
 #include "AuthManager.h"
 #include "ConnectionGuard.h"
+#include "ConnectionLimiter.h"
 #include "log/Log.h"
 #include "utils/HallucinationGuard.h"
 #include "whisper/InferenceLimiter.h"
+#include "whisper/CancellationToken.h"
+#include "whisper/LoadEstimator.h"
+#include "whisper/EngineMetrics.h"
+#include "AdmissionController.h"
+#include "FlowControl.h"
+#include "PartialCadence.h"
+#include "FlushPolicy.h"
+#include "SessionCapture.h"
+#include "MemoryBudget.h"
 
 namespace beast = boost::beast;
 namespace websocket = beast::websocket;
@@ -42,7 +55,9 @@ public:
         float whisper_temperature = 0.2f,
         float whisper_temperature_inc = 0.2f,
         float whisper_no_speech_thold = 0.3f,
-        float whisper_logprob_thold = -1.0f
+        float whisper_logprob_thold = -1.0f,
+        int partial_deadline_ms = 3000,
+        std::shared_ptr<ConnectionLimiter> limiter = nullptr
     )
         : ws_(std::move(ws)),
           model_path_(model_path),
@@ -59,6 +74,8 @@ public:
           whisper_temperature_inc_(whisper_temperature_inc),
           whisper_no_speech_thold_(whisper_no_speech_thold),
           whisper_logprob_thold_(whisper_logprob_thold),
+          partial_deadline_ms_(partial_deadline_ms),
+          limiter_(std::move(limiter)),
           model_acquired_(false),
           bytes_received_in_window_(0),
           rate_limit_start_(std::chrono::steady_clock::now()),
@@ -71,6 +88,7 @@ public:
     }
 
     ~StreamingSession() override {
+        session_cancel_.cancel();
         flush_running_ = false;
         if (flush_thread_.joinable()) {
             flush_thread_.join();
@@ -81,6 +99,8 @@ public:
 
     void shutdown() override {
         // Triggered asynchronously by signal handler. We try to close cleanly if we can.
+        // Abort any in-flight decode so its inference slot is freed right away.
+        session_cancel_.cancel();
         boost::system::error_code ec;
         beast::get_lowest_layer(ws_).cancel(ec);
     }
@@ -105,6 +125,23 @@ public:
             ws_.accept(req);
             Log::info("WebSocket handshake accepted", session_id_);
 
+            // Load shedding: refuse up front rather than degrade every session's partials.
+            auto admission = AdmissionController::instance().tryAdmit();
+            if (!admission.admit) {
+                shed(admission);
+                return;
+            }
+            admission_ticket_ = std::make_unique<AdmissionController::Ticket>();
+            // Only admitted sessions are recorded: a shed one would fill CAPTURE_DIR with empty captures.
+            capture_ = CaptureWriter::instance().open(session_id_);
+
+            // NUMA_PLACEMENT: this session decodes on one node, against that node's replica.
+            numa_ = NumaPlacement::instance().assign();
+            if (numa_) {
+                NumaPlacement::instance().pinCurrentThread(numa_->node());
+                model_cache_ = &ModelCache::replica(numa_->replica());
+            }
+
             flush_running_ = true;
             flush_thread_ = std::thread([this]() { this->flushLoop(); });
 
@@ -117,10 +154,12 @@ public:
                         boost::asio::buffers_begin(buffer.data()),
                         boost::asio::buffers_end(buffer.data())
                     );
+                    if (capture_) captureTextIn(message);
                     handleJsonMessage(message);
                 } else {
                     std::vector<unsigned char> data(buffer.size());
                     boost::asio::buffer_copy(boost::asio::buffer(data), buffer.data());
+                    if (capture_) capture_->audioIn(data.data(), data.size());
                     handleBinaryMessage(data);
                 }
             }
@@ -136,15 +175,18 @@ public:
             Log::error(std::string("Unexpected exception: ") + e.what(), session_id_);
         }
 
+        // Client is gone: stop the flush thread's decode (if any) instead of waiting it out.
+        session_cancel_.cancel();
         releaseModel();
     }
 
 private:
     void releaseModel() {
         std::lock_guard<std::mutex> lock(state_mutex_);
+        engine_.reset();
+        memory_.reset();
         if (model_acquired_) {
-            engine_.reset();
-            ModelCache::instance().release();
+            model_cache_->release();
             model_acquired_ = false;
             Log::info("Model reference released", session_id_);
         }
@@ -156,12 +198,24 @@ private:
             std::lock_guard<std::mutex> lock(write_mutex_);
             ws_.text(true);
             ws_.write(net::buffer(str));
+            if (capture_) capture_->textOut(str);
         }
         catch (std::exception& e) {
             Log::error(std::string("Failed to send message: ") + e.what(), session_id_);
         }
     }
 
+    // Captures must not leak credentials: the config token is replaced before recording.
+    void captureTextIn(const std::string& message) {
+        json msg = json::parse(message, nullptr, false);
+        if (msg.is_object() && msg.contains("token")) {
+            msg["token"] = "<redacted>";
+            capture_->textIn(msg.dump());
+        } else {
+            capture_->textIn(message);
+        }
+    }
+
     void sendError(const std::string& message, const std::string& code) {
         json msg = {
             {"type", "error"},
@@ -171,7 +225,46 @@ private:
         sendMessage(msg);
     }
 
-    void sendReady() {
+    void shed(const AdmissionController::Decision& d) {
+        Log::warn("Session shed (" + d.reason + ": predicted utilization=" +
+                  std::to_string(d.predicted_utilization) + ", p90 partial latency=" +
+                  std::to_string(static_cast<int>(d.predicted_latency_ms)) + "ms)", session_id_);
+        json msg = {
+            {"type", "error"},
+            {"message", "Server at capacity, retry later"},
+            {"code", "OVERLOADED"},
+            {"retry_after", d.retry_after_seconds}
+        };
+        sendMessage(msg);
+        beast::error_code ec;
+        ws_.close(websocket::close_reason(websocket::close_code::try_again_later,
+                                          "retry-after=" + std::to_string(d.retry_after_seconds)), ec);
+    }
+
+    void rejectForMemory() {
+        const int retry_after = MemoryBudget::instance().config().retry_after_seconds;
+        Log::warn("Session refused: memory budget exhausted", session_id_);
+        json msg = {
+            {"type", "error"},
+            {"message", "Server memory budget exhausted, retry later"},
+            {"code", "OVERLOADED"},
+            {"retry_after", retry_after}
+        };
+        sendMessage(msg);
+        beast::error_code ec;
+        ws_.close(websocket::close_reason(websocket::close_code::try_again_later,
+                                          "retry-after=" + std::to_string(retry_after)), ec);
+    }
+
+    // Caller holds state_mutex_. The decoder state is fixed; buffer and transcript grow.
+    void accountMemory() {
+        if (!memory_ || !engine_) return;
+        memory_->update(MemoryBudget::Component::Audio, engine_->bufferBytes());
+        memory_->update(MemoryBudget::Component::Text,
+                        full_transcription_.capacity() + raw_transcription_.capacity());
+    }
+
+    void sendReady(uint64_t credit_limit) {
         json msg = {
             {"type", "ready"},
             {"protocol_version", 1},
@@ -179,24 +272,42 @@ private:
             {"config", {
                 {"language", language_},
                 {"sample_rate", 16000},
-                {"beam_size", whisper_beam_size_}
+                {"beam_size", whisper_beam_size_},
+                {"mode", bulk_ ? "bulk" : "live"}
+            }},
+            {"flow_control", {
+                {"window_seconds", static_cast<double>(credits_.window()) / 16000.0},
+                {"limit_samples", credit_limit}
             }}
         };
         sendMessage(msg);
     }
 
-    void processAudioChunk(const std::vector<float>& audio) {
+    void sendCredit(uint64_t limit, double available_seconds) {
+        json msg = {
+            {"type", "credit"},
+            {"limit_samples", limit},
+            {"available_seconds", available_seconds}
+        };
+        sendMessage(msg);
+    }
+
+    // Returns true if the engine kept the chunk (false: not configured, or dropped at the HWM).
+    bool processAudioChunk(const std::vector<float>& audio) {
         std::unique_lock<std::mutex> lock(state_mutex_);
-        if (!configured_ || !engine_) return;
+        if (!configured_ || !engine_) return false;
 
         last_audio_time_ = std::chrono::steady_clock::now();
+        credits_.onAudio(audio.size(), last_audio_time_);
         bool overflow = engine_->processAudioChunk(audio);
+        if (overflow) FlowControlMetrics::instance().recordDropped(audio.size());
         bool should_warn = overflow && !buffer_overflowed_;
         buffer_overflowed_ = overflow;
         lock.unlock();
 
+        // Only reachable by clients that send past their credit limit.
         if (should_warn) {
-            Log::warn("Audio buffer full, dropping incoming audio", session_id_);
+            Log::warn("Audio buffer full, dropping incoming audio (client ignores flow-control credits)", session_id_);
             json warning = {
                 {"type", "warning"},
                 {"code", "buffer_full"},
@@ -205,6 +316,31 @@ private:
             sendMessage(warning);
         }
         // Inference is handled entirely by flushLoop to avoid blocking the receive loop.
+        return !overflow;
+    }
+
+    // Tenant audio quota spent: stop reading for `seconds`, until the bucket refills.
+    // The client's audio waits in TCP buffers (and then in the client) instead of being lost.
+    void throttleForQuota(double seconds) {
+        if (!quota_throttled_) {
+            quota_throttled_ = true;
+            Log::warn("Audio quota exhausted (tenant=" + policy_.tenant_id + "), pausing reads for " +
+                      std::to_string(seconds) + "s", session_id_);
+            json warning = {
+                {"type", "warning"},
+                {"code", "quota_throttled"},
+                {"message", "Audio quota exhausted, audio is accepted at the quota rate"},
+                {"retry_after", seconds}
+            };
+            sendMessage(warning);
+        }
+        using Clock = std::chrono::steady_clock;
+        const auto until = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+        while (!session_cancel_.isCancelled()) {
+            Clock::duration left = until - Clock::now();
+            if (left <= Clock::duration::zero()) break;
+            std::this_thread::sleep_for(std::min<Clock::duration>(left, std::chrono::milliseconds(100)));
+        }
     }
 
     void handleJsonMessage(const std::string& message) {
@@ -276,12 +412,17 @@ private:
         bytes_received_in_window_ += data.size();
 
         if (elapsed_s >= 3) {
-            // Fixed 3-second window: max 600 KB per window (~200 KB/s average).
-            // Note: this is a fixed window, not sliding — resets every 3 seconds.
+            // Fixed 3-second window — not sliding, resets every 3 seconds.
+            // Live: max 600 KB per window (~200 KB/s average).
+            // Bulk: faster than real time is the point, so the cap is in audio-seconds per
+            // wall-second; credits already pace a well-behaved client to the decode speed.
             const size_t MAX_BYTES_PER_WINDOW = 200 * 1024 * 3;
-            if (bytes_received_in_window_ > MAX_BYTES_PER_WINDOW) {
-                Log::warn("Rate limit exceeded (" + std::to_string(bytes_received_in_window_) +
-                          " bytes in " + std::to_string(elapsed_s) + "s)", session_id_);
+            const double window_audio_s = static_cast<double>(bytes_received_in_window_) / (sizeof(float) * 16000.0);
+            bool exceeded = bulk_ ? window_audio_s > BULK_MAX_REALTIME_FACTOR * static_cast<double>(elapsed_s)
+                                  : bytes_received_in_window_ > MAX_BYTES_PER_WINDOW;
+            if (exceeded) {
+                Log::warn("Rate limit exceeded (" + std::to_string(bytes_received_in_window_) + " bytes = " +
+                          std::to_string(window_audio_s) + " audio-s in " + std::to_string(elapsed_s) + "s)", session_id_);
                 boost::system::error_code ec;
                 ws_.close(websocket::close_reason(websocket::close_code::policy_error, "Rate limit exceeded"), ec);
                 return;
@@ -294,7 +435,15 @@ private:
             auto data_ptr = reinterpret_cast<const float*>(data.data());
             size_t size = data.size() / sizeof(float);
             std::vector<float> pcm(data_ptr, data_ptr + size);
-            processAudioChunk(pcm);
+            if (!processAudioChunk(pcm)) return;
+
+            // Tenant audio quota (audio seconds per minute, from the auth API): only audio the
+            // engine kept is charged; once the bucket is empty the session stops reading.
+            if (limiter_) {
+                double wait = limiter_->chargeAudio(policy_, static_cast<double>(size) / 16000.0);
+                if (wait > 0.0) throttleForQuota(wait);
+                else quota_throttled_ = false;
+            }
         }
         catch (std::exception& e) {
             Log::error(std::string("Audio processing failed: ") + e.what(), session_id_);
@@ -305,6 +454,8 @@ private:
     void handleConfig(const json& msg) {
         Log::info("Config message received", session_id_);
         try {
+            std::future<AuthDecision> auth;
+            std::string token;
             if (auth_manager_->isAuthEnabled()) {
                 if (!msg.contains("token") || !msg["token"].is_string()) {
                     Log::warn("Auth failed: missing or invalid 'token' field", session_id_);
@@ -313,63 +464,146 @@ private:
                     return;
                 }
 
-                std::string token = msg["token"];
+                token = msg["token"];
                 Log::debug("Validating token: " + Log::maskKey(token), session_id_);
+                auth = auth_manager_->validateAsync(token);
+            }
 
-                if (!auth_manager_->validate(token)) {
+            // Wait for the auth verdict and admit the key's tenant; on rejection, notify and close.
+            ClientPolicy policy;
+            auto authorized = [&]() {
+                if (!auth.valid()) return true;
+                AuthDecision decision = auth.get();
+                if (!decision) {
                     Log::warn("Auth failed: token rejected (key=" + Log::maskKey(token) + ")", session_id_);
                     sendError("Invalid token", "AUTH_FAILED");
                     ws_.close(websocket::close_code::policy_error);
-                    return;
+                    return false;
                 }
-
-                Log::info("Auth passed (key=" + Log::maskKey(token) + ")", session_id_);
-            }
+                policy = decision.policy;
+                Log::info("Auth passed (key=" + Log::maskKey(token) +
+                          (policy.tenant_id.empty() ? "" : ", tenant=" + policy.tenant_id) +
+                          ", tier=" + tierName(policy.tier) + ")", session_id_);
+                return admitTenant(policy);
+            };
 
             if (msg.contains("language")) {
                 language_ = msg["language"];
             }
 
+            // "live" (default): partials at real-time cadence. "bulk": pre-recorded audio as fast
+            // as compute allows — no partials, large VAD-aligned commits, lowest slot priority.
+            bool bulk = false;
+            if (msg.contains("mode")) {
+                if (!msg["mode"].is_string() || (msg["mode"] != "live" && msg["mode"] != "bulk")) {
+                    sendError("Invalid 'mode' (use \"live\" or \"bulk\")", "CONFIG_ERROR");
+                    return;
+                }
+                bulk = msg["mode"] == "bulk";
+            }
+
             // VAD configure (0.0 = disabled, try a safe 0.4 for long silences only if enabled by client)
             float vad_thold = 0.0f;
             if (msg.contains("vad_thold") && msg["vad_thold"].is_number()) {
                 vad_thold = msg["vad_thold"].get<float>();
             }
 
-            // Acquire model from cache (loads if not already loaded, instant if cached)
-            Log::info("Acquiring model from cache: " + model_path_, session_id_);
-            whisper_context* ctx = ModelCache::instance().acquire(model_path_);
-            
-            {
-                std::lock_guard<std::mutex> lock(state_mutex_);
-                model_acquired_ = true;
+            // The auth round-trip overlaps with engine setup only when the model is already
+            // resident: an unauthenticated client must never trigger a model load.
+            const bool uses_model = TranscriptionBackend::instance().usesModel();
+            if (uses_model && !model_cache_->isLoaded() && !authorized()) {
+                return;
+            }
+
+            std::unique_ptr<TranscriptionEngine> engine;
+            std::unique_ptr<MemoryBudget::Account> memory;
+            if (uses_model) {
+                // Acquire model from cache (loads if not already loaded, instant if cached)
+                Log::info("Acquiring model from cache: " + model_path_, session_id_);
+                whisper_context* ctx = model_cache_->acquire(model_path_);
+
+                // Sizes are only known once the model is loaded; a reconfig keeps its account.
+                if (!memory_) {
+                    auto& cache = *model_cache_;
+                    // Every loaded replica holds its own weights: the budget sees them all.
+                    memory = MemoryBudget::instance().reserve(
+                        MemoryBudget::sessionEstimate(cache.stateBytes()), ModelCache::totalSharedBytes());
+                    if (!memory) {
+                        cache.release();
+                        rejectForMemory();
+                        return;
+                    }
+                }
 
                 // Create engine with shared context (creates its own whisper_state)
-                engine_ = std::make_unique<StreamingWhisperEngine>(ctx);
-                engine_->setLanguage(language_);
-                engine_->setThreads(whisper_threads_);
-                engine_->setBeamSize(whisper_beam_size_);
-                engine_->setVadThreshold(vad_thold);
-                engine_->setTemperature(whisper_temperature_);
-                engine_->setTemperatureInc(whisper_temperature_inc_);
-                engine_->setNoSpeechThreshold(whisper_no_speech_thold_);
-                engine_->setLogprobThreshold(whisper_logprob_thold_);
-                if (!whisper_initial_prompt_.empty()) {
-                    engine_->setInitialPrompt(whisper_initial_prompt_);
+                try {
+                    engine = std::make_unique<StreamingWhisperEngine>(ctx);
+                } catch (...) {
+                    model_cache_->release();
+                    throw;
+                }
+            } else {
+                if (!memory_) {
+                    memory = MemoryBudget::instance().reserve(MemoryBudget::sessionEstimate(0),
+                                                              ModelCache::totalSharedBytes());
+                    if (!memory) {
+                        rejectForMemory();
+                        return;
+                    }
+                }
+                engine = TranscriptionBackend::instance().createMock();
+            }
+            engine->setLanguage(language_);
+            engine->setThreads(whisper_threads_);
+            engine->setBeamSize(whisper_beam_size_);
+            engine->setVadThreshold(vad_thold);
+            engine->setTemperature(whisper_temperature_);
+            engine->setTemperatureInc(whisper_temperature_inc_);
+            engine->setNoSpeechThreshold(whisper_no_speech_thold_);
+            engine->setLogprobThreshold(whisper_logprob_thold_);
+            if (!whisper_initial_prompt_.empty()) {
+                engine->setInitialPrompt(whisper_initial_prompt_);
+            }
+
+            if (auth.valid() && !authorized()) {
+                engine.reset();
+                if (uses_model) model_cache_->release();
+                return;
+            }
+
+            uint64_t credit_limit;
+            {
+                std::lock_guard<std::mutex> lock(state_mutex_);
+                if (uses_model) model_acquired_ = true;
+                engine_ = std::move(engine);
+                if (memory) memory_ = std::move(memory);
+                policy_ = policy;
+                bulk_ = bulk;
+                if (configured_) {
+                    // Re-config: the client's sent-samples counter keeps running.
+                    credit_limit = credits_.reopen(engine_->getBufferSize());
+                } else {
+                    credits_ = CreditWindow(TranscriptionEngine::HIGH_WATER_MARK_SAMPLES);
+                    credit_limit = credits_.open(engine_->getBufferSize());
                 }
 
                 configured_ = true;
                 last_transcribed_size_ = 0;
+                end_requested_         = false;
                 full_transcription_    = "";
                 raw_transcription_     = "";
+                repetition_tracker_.reset();
                 last_audio_time_ = std::chrono::steady_clock::now();
+                if (uses_model) memory_->update(MemoryBudget::Component::State, model_cache_->stateBytes());
+                accountMemory();
             }
 
             Log::info("Session ready (lang=" + language_ +
+                      ", mode=" + (bulk ? "bulk" : "live") +
                       ", beam=" + std::to_string(whisper_beam_size_) +
                       ", vad=" + std::to_string(vad_thold) +
                       ")", session_id_);
-            sendReady();
+            sendReady(credit_limit);
         }
         catch (std::exception& e) {
             Log::error(std::string("Config failed: ") + e.what(), session_id_);
@@ -377,16 +611,50 @@ private:
         }
     }
 
+    // Per-tenant session cap; a re-config by the same tenant keeps its slot.
+    bool admitTenant(const ClientPolicy& policy) {
+        if (!limiter_ || policy.tenant_id.empty()) return true;
+        if (tenant_guard_ && tenant_guard_->tenantId() == policy.tenant_id) return true;
+        if (!limiter_->tryAcquireTenant(policy)) {
+            Log::warn("Tenant session limit reached (tenant=" + policy.tenant_id +
+                      ", max=" + std::to_string(policy.max_sessions) + ")", session_id_);
+            sendError("Too many concurrent sessions for this account", "TENANT_LIMIT");
+            ws_.close(websocket::close_code::try_again_later);
+            return false;
+        }
+        tenant_guard_ = std::make_unique<TenantGuard>(limiter_, policy.tenant_id);
+        return true;
+    }
+
     void handleEnd() {
+        const auto end_received = std::chrono::steady_clock::now();
         Log::info("End-of-stream received, running final transcription", session_id_);
-        
+
+        // The final supersedes any partial still decoding: abort it so it releases
+        // state_mutex_ and its inference slot now instead of finishing stale work.
+        end_requested_ = true;
+        partial_cancel_.cancel();
+
+        bool reused_final = false;
         {
             std::lock_guard<std::mutex> lock(state_mutex_);
             if (engine_) {
-                auto res = engine_->transcribeSlidingWindow(true); // force commit
                 // Note: no hallucination guard here — this is the last chance to capture audio
                 // that the engine still holds in its buffer.
-                full_transcription_ += res.committed_text;
+                if (auto hypothesis = engine_->takeFreshHypothesis()) {
+                    // No audio since the last partial: its text is the final, skip the decode.
+                    reused_final = true;
+                    full_transcription_ += *hypothesis;
+                } else {
+                    // The client is blocked on this one: queue ahead of every partial.
+                    InferenceLimiter::Guard slot(InferenceLimiter::FINAL_PRIORITY);
+                    auto decode_start = std::chrono::steady_clock::now();
+                    auto res = engine_->transcribeSlidingWindow(true, &session_cancel_); // force commit
+                    LoadEstimator::instance().recordDecode(
+                        std::chrono::duration<double>(std::chrono::steady_clock::now() - decode_start).count(),
+                        std::chrono::duration<double>(decode_start - end_received).count(), false);
+                    full_transcription_ += res.committed_text;
+                }
             }
 
             // Fallback: if all flushLoop commits were hallucination-filtered (audio was erased
@@ -405,6 +673,8 @@ private:
                 {"is_final", true}
             };
             sendMessage(msg);
+        EngineMetrics::instance().recordFinal(
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - end_received).count(), reused_final);
 
         try {
             ws_.close(websocket::close_code::normal);
@@ -435,10 +705,18 @@ private:
     StreamType ws_;
     std::string model_path_;
     std::shared_ptr<AuthManager> auth_manager_;
-    std::unique_ptr<StreamingWhisperEngine> engine_;
+    std::unique_ptr<TranscriptionEngine> engine_;
     std::string session_id_;
     bool configured_;
     bool buffer_overflowed_; // true while engine buffer is above 20s HWM
+    bool quota_throttled_ = false; // read loop paused on the tenant quota (warned once per episode)
+    CreditWindow credits_;   // audio the client may send; guarded by state_mutex_
+    std::atomic<bool> bulk_{false}; // mode "bulk": throughput over latency (see handleConfig)
+    PartialCadence cadence_;        // live partial stride; flush thread only
+    const FlushPolicy flush_policy_;
+
+    // Bulk input cap: audio-seconds per wall-second (live sessions use the byte window).
+    static constexpr double BULK_MAX_REALTIME_FACTOR = 100.0;
     size_t last_transcribed_size_;
     std::string language_;
 
@@ -451,6 +729,17 @@ private:
     float whisper_temperature_inc_;
     float whisper_no_speech_thold_;
     float whisper_logprob_thold_;
+    int partial_deadline_ms_;           // 0 = no deadline for partial-only decodes
+
+    // Per-tenant limits (policy from the auth API; defaults = unlimited, standard tier)
+    std::shared_ptr<ConnectionLimiter> limiter_;
+    std::unique_ptr<TenantGuard> tenant_guard_;
+    ClientPolicy policy_;
+    std::unique_ptr<AdmissionController::Ticket> admission_ticket_; // counted in the admitted load
+    std::unique_ptr<SessionCapture> capture_;  // CAPTURE_DIR set: frames and messages recorded for replay
+    std::unique_ptr<MemoryBudget::Account> memory_; // charged against MEMORY_BUDGET_MB while configured
+    std::unique_ptr<NumaPlacement::Lease> numa_;    // node this session decodes on (NUMA_PLACEMENT)
+    ModelCache* model_cache_ = &ModelCache::instance(); // the node's replica with NUMA_PLACEMENT=replicate
     bool model_acquired_;
     
     // Rate limiting & Timeout
@@ -464,19 +753,39 @@ private:
     std::atomic<bool> flush_running_;
     std::chrono::steady_clock::time_point last_audio_time_;
 
+    // Inference cancellation: session_cancel_ stops everything (close / shutdown);
+    // partial_cancel_ is re-armed per flushLoop decode and also stops when superseded.
+    CancellationToken session_cancel_;
+    CancellationToken partial_cancel_{&session_cancel_};
+    std::atomic<bool> end_requested_{false};
+
     // Sliding window logic
     std::string full_transcription_;     // filtered (hallucinations discarded)
     std::string raw_transcription_;      // unfiltered fallback — used when full_ is empty at handleEnd()
+    HallucinationTracker repetition_tracker_; // repetition across accepted commits (flushLoop only)
 
     void flushLoop() {
         // Handles ALL inference, decoupled from the WebSocket receive loop.
-        // Triggers on: 250ms of new audio accumulated, OR 400ms of silence with unprocessed audio.
-        // Does NOT trigger if buffer < 2s: Whisper hallucinates badly on very short windows.
-        const size_t MIN_NEW_SAMPLES    = 4000;  // 250ms @ 16kHz
-        const size_t MIN_BUFFER_SAMPLES = 32000; // 2s minimum before first inference
+        // When a decode is due is flush_policy_'s call: one stride of new audio (250ms,
+        // stretched up to 1s under load by cadence_) or 400ms of silence, never below 2s
+        // of buffer; bulk waits for a full chunk and handleEnd() takes the tail.
+        if (numa_) NumaPlacement::instance().pinCurrentThread(numa_->node());
+
+        // A due partial that finds no free slot is retried next cycle; the time until
+        // it gets one is its queue wait (reported to the LoadEstimator).
+        std::optional<std::chrono::steady_clock::time_point> waiting_since;
+        // Meanwhile it holds a place among the limiter's waiters at its tier.
+        InferenceLimiter::WaitMark due_mark;
+        // Every path that does not attempt the partial drops both: a stale mark would hold
+        // back every lower tier, a stale start would count idle time as queue wait.
+        auto not_waiting = [&] {
+            due_mark.clear();
+            waiting_since.reset();
+        };
 
         while (flush_running_) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            // Bulk is throughput-bound: poll often so a full chunk never waits for the cadence.
+            std::this_thread::sleep_for(flush_policy_.pollInterval(bulk_));
             if (!flush_running_) break;
 
             std::unique_lock<std::mutex> lock(state_mutex_, std::defer_lock);
@@ -484,41 +793,102 @@ private:
                 continue;
             }
 
-            if (!configured_ || !engine_) continue;
+            if (!configured_ || !engine_) {
+                not_waiting();
+                continue;
+            }
 
             size_t current_size = engine_->getBufferSize();
 
-            // Guard: never infer on less than 2s of audio.
-            if (current_size < MIN_BUFFER_SAMPLES) continue;
+            // Guard: never infer on less than 2s of audio (e.g. after a re-config).
+            if (!flush_policy_.hasMinimumBuffer(current_size)) {
+                not_waiting();
+                continue;
+            }
 
             auto now = std::chrono::steady_clock::now();
             auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_audio_time_).count();
 
-            bool enough_new_audio = (current_size - last_transcribed_size_) >= MIN_NEW_SAMPLES;
-            bool silence_flush    = (elapsed_ms > 400) && (current_size > last_transcribed_size_);
+            const bool bulk = bulk_;
+            if (!bulk) {
+                int slots = std::max(InferenceLimiter::instance().maxConcurrency(), 1);
+                cadence_.update(LoadEstimator::instance().load(now) / slots);
+            }
+            if (!flush_policy_.due(current_size, last_transcribed_size_, std::chrono::milliseconds(elapsed_ms),
+                                   bulk, cadence_.strideSamples())) {
+                not_waiting();
+                continue;
+            }
 
-            if (!enough_new_audio && !silence_flush) continue;
+            Log::debug([&] {
+                return "flushLoop inference: new=" + std::to_string(current_size - last_transcribed_size_) +
+                       " silence_ms=" + std::to_string(elapsed_ms);
+            }, session_id_);
+            // Arm the partial's token. A decode that cannot commit (buffer below the commit
+            // window) is only worth finishing while it is fresh, so it gets a deadline.
+            // end_requested_ is checked after reset() so a concurrent handleEnd() cancel is not lost.
+            partial_cancel_.reset();
+            if (end_requested_) {
+                not_waiting();
+                continue;
+            }
+            if (!bulk && partial_deadline_ms_ > 0 && current_size < TranscriptionEngine::COMMIT_WINDOW_SAMPLES) {
+                partial_cancel_.setDeadline(now + std::chrono::milliseconds(partial_deadline_ms_));
+            }
 
-            Log::debug("flushLoop inference: new=" + std::to_string(current_size - last_transcribed_size_) +
-                       " silence_ms=" + std::to_string(elapsed_ms), session_id_);
-            // Non-blocking inference: skip cycle if GPU is saturated.
-            if (!InferenceLimiter::instance().try_acquire()) {
+            // Non-blocking inference: skip cycle if GPU is saturated (for this tier).
+            // Bulk work always runs at the lowest priority so it never delays live partials.
+            const int priority = bulk ? 0 : policy_.priority();
+            if (!InferenceLimiter::instance().try_acquire(priority)) {
                 Log::debug("flushLoop: GPU busy, skipping inference cycle", session_id_);
+                if (!waiting_since) waiting_since = now;
+                if (!bulk) {
+                    cadence_.onBusy();
+                    due_mark.set(priority);
+                }
                 continue;
             }
-            auto res = engine_->transcribeSlidingWindow(false);
+            due_mark.clear();
+            auto decode_start = std::chrono::steady_clock::now();
+            double queue_wait = waiting_since
+                ? std::chrono::duration<double>(decode_start - *waiting_since).count() : 0.0;
+            waiting_since.reset();
+            auto res = bulk ? engine_->transcribeBulkChunk(&partial_cancel_)
+                            : engine_->transcribeSlidingWindow(false, &partial_cancel_);
             InferenceLimiter::instance().release();
+            const double decode_seconds =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - decode_start).count();
+            LoadEstimator::instance().recordDecode(decode_seconds, queue_wait, !bulk && !partial_cancel_.isCancelled());
+            if (!bulk && !partial_cancel_.isCancelled()) cadence_.onDecode(decode_seconds); // deadline hits count too
+
+            if (res.cancelled) {
+                if (partial_cancel_.isCancelled()) {
+                    Log::debug("flushLoop: inference cancelled", session_id_);
+                } else {
+                    // Deadline: wait for the normal stride of new audio before retrying.
+                    Log::debug("flushLoop: partial deadline exceeded, dropped", session_id_);
+                    last_transcribed_size_ = current_size;
+                }
+                continue;
+            }
 
             // If inference drained the buffer below HWM, reset the overflow flag so the
             // next saturation episode triggers a new warning regardless of client audio timing.
-            constexpr size_t HIGH_WATER_MARK = 16000 * 20;
-            if (buffer_overflowed_ && engine_->getBufferSize() < HIGH_WATER_MARK) {
+            if (buffer_overflowed_ && engine_->getBufferSize() < TranscriptionEngine::HIGH_WATER_MARK_SAMPLES) {
                 buffer_overflowed_ = false;
             }
 
             // Hallucination guard: filter loops before updating state or sending to client.
-            bool committed_ok = !res.committed_text.empty() && !isHallucination(res.committed_text);
-            bool partial_ok   = !res.partial_text.empty()   && !isHallucination(res.partial_text);
+            // The tracker also catches loops that span consecutive commits.
+            bool committed_ok = !res.committed_text.empty() && !isHallucination(res.committed_text) &&
+                                !repetition_tracker_.check(res.committed_text);
+            if (committed_ok) {
+                repetition_tracker_.append(res.committed_text);
+            }
+            // A loop-aborted decode ends in the start of the loop — don't show it as a partial.
+            bool partial_ok   = !res.partial_text.empty()   && !res.loop_aborted &&
+                                !isHallucination(res.partial_text) &&
+                                !repetition_tracker_.check(res.partial_text);
 
             if (!res.committed_text.empty()) {
                 // Always accumulate raw — audio was already erased from engine buffer,
@@ -537,6 +907,11 @@ private:
                 last_transcribed_size_ = current_size;
             }
 
+            // The decode may have drained the buffer: hand the freed room back as credit.
+            auto grant = credits_.onDrain(engine_->getBufferSize());
+            double credit_available = credits_.availableSeconds();
+            accountMemory();
+
             if (!res.partial_text.empty() && !partial_ok) {
                 Log::warn("Suppressing hallucinated partial (len=" +
                           std::to_string(res.partial_text.length()) + ")", session_id_);
@@ -553,6 +928,11 @@ private:
                 sendMessage(msg);
                 lock.lock();
             }
+            if (grant) {
+                lock.unlock();
+                sendCredit(*grant, credit_available);
+                lock.lock();
+            }
         }
     }
 };
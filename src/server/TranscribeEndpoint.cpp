@@ -0,0 +1,300 @@
+#include "TranscribeEndpoint.h"
+#include <nlohmann/json.hpp>
+#include <filesystem>
+#include <stdexcept>
+#include <whisper.h>
+#include "AdmissionController.h"
+#include "AutoSizing.h"
+#include "AuthManager.h"
+#include "ConnectionGuard.h"
+#include "ConnectionLimiter.h"
+#include "MemoryBudget.h"
+#include "SessionTracker.h"
+#include "log/Log.h"
+#include "utils/AudioDecoder.h"
+#include "whisper/CancellationToken.h"
+#include "whisper/ModelCache.h"
+#include "whisper/OfflineTranscriber.h"
+
+using json = nlohmann::json;
+namespace http = boost::beast::http;
+
+namespace {
+
+TranscribeEndpoint::Response makeResponse(const TranscribeEndpoint::Request& req,
+                                          http::status status, const std::string& body) {
+    TranscribeEndpoint::Response res;
+    res.version(req.version());
+    res.result(status);
+    res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+    res.set(http::field::content_type, "application/json");
+    res.body() = body;
+    res.prepare_payload();
+    return res;
+}
+
+TranscribeEndpoint::Response errorResponse(const TranscribeEndpoint::Request& req, http::status status,
+                                           const std::string& message, const std::string& code) {
+    return makeResponse(req, status, json{{"error", message}, {"code", code}}.dump());
+}
+
+// 503 for a request shed by the AdmissionController (before or after its body is read).
+TranscribeEndpoint::Response overloadedResponse(const TranscribeEndpoint::Request& req,
+                                                const AdmissionController::Decision& admission) {
+    Log::warn("Offline request shed (" + admission.reason + ")");
+    auto res = makeResponse(req, http::status::service_unavailable,
+                            json{{"error", "Server at capacity, retry later"},
+                                 {"code", "OVERLOADED"},
+                                 {"retry_after", admission.retry_after_seconds}}.dump());
+    res.set(http::field::retry_after, std::to_string(admission.retry_after_seconds));
+    return res;
+}
+
+std::string requestToken(const TranscribeEndpoint::Request& req) {
+    auto auth = req.find(http::field::authorization);
+    if (auth != req.end()) {
+        std::string_view v(auth->value().data(), auth->value().size());
+        constexpr std::string_view bearer = "Bearer ";
+        if (v.size() > bearer.size() && v.substr(0, bearer.size()) == bearer) {
+            return std::string(v.substr(bearer.size()));
+        }
+    }
+    auto key = req.find("X-API-Key");
+    if (key != req.end()) {
+        return std::string(key->value());
+    }
+    return {};
+}
+
+// Registered with SessionTracker so SIGTERM aborts in-flight offline decodes too.
+class OfflineJob : public SessionTracker::SessionBase {
+public:
+    OfflineJob()  { SessionTracker::instance().add(this); }
+    ~OfflineJob() override { SessionTracker::instance().remove(this); }
+    void shutdown() override { cancel.cancel(); }
+
+    CancellationToken cancel;
+};
+
+// Holds a ModelCache reference for the duration of the request.
+class ModelRef {
+public:
+    ModelRef(ModelCache& cache, const std::string& path) : cache(cache), ctx(cache.acquire(path)) {}
+    ~ModelRef() { cache.release(); }
+    ModelRef(const ModelRef&) = delete;
+    ModelRef& operator=(const ModelRef&) = delete;
+
+    ModelCache& cache;
+    whisper_context* ctx;
+};
+
+} // namespace
+
+TranscribeEndpoint::TranscribeEndpoint(Config config, std::shared_ptr<AuthManager> auth_manager,
+                                       std::shared_ptr<ConnectionLimiter> limiter)
+    : config_(std::move(config)), auth_manager_(std::move(auth_manager)), limiter_(std::move(limiter)) {}
+
+bool TranscribeEndpoint::matches(std::string_view target) {
+    return target.substr(0, target.find('?')) == PATH;
+}
+
+std::string TranscribeEndpoint::queryParam(std::string_view target, std::string_view key) {
+    size_t q = target.find('?');
+    if (q == std::string_view::npos) return {};
+    std::string_view query = target.substr(q + 1);
+
+    while (!query.empty()) {
+        size_t amp = query.find('&');
+        std::string_view pair = query.substr(0, amp);
+        size_t eq = pair.find('=');
+        if (pair.substr(0, eq) == key) {
+            return eq == std::string_view::npos ? std::string{} : std::string(pair.substr(eq + 1));
+        }
+        if (amp == std::string_view::npos) break;
+        query.remove_prefix(amp + 1);
+    }
+    return {};
+}
+
+std::optional<TranscribeEndpoint::Response> TranscribeEndpoint::authorize(const Request& req,
+                                                                         ClientPolicy& policy) const {
+    if (!auth_manager_ || !auth_manager_->isAuthEnabled()) return std::nullopt;
+    std::string token = requestToken(req);
+    if (token.empty()) {
+        return errorResponse(req, http::status::unauthorized, "Missing API token", "AUTH_REQUIRED");
+    }
+    AuthDecision decision = auth_manager_->authorize(token);
+    if (!decision) {
+        Log::warn("Offline auth failed: token rejected (key=" + Log::maskKey(token) + ")");
+        return errorResponse(req, http::status::unauthorized, "Invalid token", "AUTH_FAILED");
+    }
+    policy = decision.policy;
+    return std::nullopt;
+}
+
+std::optional<TranscribeEndpoint::Response> TranscribeEndpoint::precheck(const Request& req) const {
+    if (req.method() != http::verb::post) {
+        auto res = errorResponse(req, http::status::method_not_allowed, "Use POST", "METHOD_NOT_ALLOWED");
+        res.set(http::field::allow, "POST");
+        return res;
+    }
+    ClientPolicy policy;
+    if (auto denied = authorize(req, policy)) return denied; // verdict is cached: handle() asks again for free
+
+    // An overloaded node sheds the upload before reading it; handle() admits it for real.
+    auto admission = AdmissionController::instance().evaluate();
+    if (!admission.admit) {
+        AdmissionController::instance().countRejected();
+        return overloadedResponse(req, admission);
+    }
+    return std::nullopt;
+}
+
+TranscribeEndpoint::Response TranscribeEndpoint::handle(const Request& req) const {
+    if (req.method() != http::verb::post) {
+        auto res = errorResponse(req, http::status::method_not_allowed, "Use POST", "METHOD_NOT_ALLOWED");
+        res.set(http::field::allow, "POST");
+        return res;
+    }
+
+    std::string_view target(req.target().data(), req.target().size());
+
+    ClientPolicy policy;
+    if (auto denied = authorize(req, policy)) return std::move(*denied);
+
+    // Same load shedding as streaming sessions: the upload would take slots from their partials.
+    auto admission = AdmissionController::instance().tryAdmit();
+    if (!admission.admit) return overloadedResponse(req, admission);
+    AdmissionController::Ticket admitted(AdmissionController::Kind::Upload);
+
+    std::unique_ptr<TenantGuard> tenant;
+    if (limiter_ && !policy.tenant_id.empty()) {
+        if (!limiter_->tryAcquireTenant(policy)) {
+            return errorResponse(req, http::status::too_many_requests,
+                                 "Too many concurrent sessions for this account", "TENANT_LIMIT");
+        }
+        tenant = std::make_unique<TenantGuard>(limiter_, policy.tenant_id);
+    }
+
+    const std::string& body = req.body();
+    if (body.empty()) {
+        return errorResponse(req, http::status::bad_request, "Empty request body", "EMPTY_AUDIO");
+    }
+
+    // NUMA_PLACEMENT: decode on one node (the chunk workers inherit the pin), on its replica.
+    // The HTTP thread serves the next request too: the pin ends with this one.
+    auto numa = NumaPlacement::instance().assign();
+    std::unique_ptr<NumaPlacement::ScopedPin> pin;
+    if (numa) pin = std::make_unique<NumaPlacement::ScopedPin>(NumaPlacement::instance(), numa->node());
+    ModelCache& cache = ModelCache::replica(numa ? numa->replica() : 0);
+
+    // Memory budget, as for sessions, reserved before the body is decoded: the body, its
+    // float PCM (as large as an f32le body, twice a 16-bit one) and a leased state per worker.
+    // Until the model is loaded the state size is estimated from the file.
+    const int workers = config_.max_parallel > 0 ? config_.max_parallel : OfflineTranscriber::defaultParallelism();
+    size_t state_bytes = cache.stateBytes();
+    if (state_bytes == 0) {
+        std::error_code ec;
+        const auto file_bytes = std::filesystem::file_size(config_.model_path, ec);
+        state_bytes = ModelCache::estimateStateBytes(ec ? 0 : static_cast<size_t>(file_bytes));
+    }
+    const std::string encoding = queryParam(target, "encoding");
+    const bool f32_body = !AudioDecoder::looksLikeWav(body) && (encoding.empty() || encoding == "f32le");
+    const size_t pcm_estimate = f32_body ? body.size() : 2 * body.size();
+    auto memory = MemoryBudget::instance().reserve(
+        MemoryBudget::uploadEstimate(body.size(), pcm_estimate, workers, state_bytes), ModelCache::totalSharedBytes());
+    if (!memory) {
+        const int retry_after = MemoryBudget::instance().config().retry_after_seconds;
+        Log::warn("Offline request refused: memory budget exhausted");
+        auto res = makeResponse(req, http::status::service_unavailable,
+                                json{{"error", "Server memory budget exhausted, retry later"},
+                                     {"code", "OVERLOADED"},
+                                     {"retry_after", retry_after}}.dump());
+        res.set(http::field::retry_after, std::to_string(retry_after));
+        return res;
+    }
+
+    std::vector<float> pcm;
+    try {
+        if (AudioDecoder::looksLikeWav(body)) {
+            pcm = AudioDecoder::decodeWav(body);
+        } else {
+            if (encoding.empty() || encoding == "f32le") {
+                pcm = AudioDecoder::decodeFloat32(body);
+            } else if (encoding == "s16le") {
+                pcm = AudioDecoder::decodePcm16(body);
+            } else {
+                return errorResponse(req, http::status::bad_request,
+                                     "Unsupported encoding '" + encoding + "' (use f32le or s16le)",
+                                     "INVALID_AUDIO");
+            }
+        }
+    } catch (const std::invalid_argument& e) {
+        return errorResponse(req, http::status::bad_request, std::string("Invalid WAV: ") + e.what(), "INVALID_AUDIO");
+    }
+    if (pcm.empty()) {
+        return errorResponse(req, http::status::bad_request, "No audio samples", "EMPTY_AUDIO");
+    }
+    memory->update(MemoryBudget::Component::Audio,
+                   MemoryBudget::uploadAudioBytes(body.size(), pcm.size() * sizeof(float), workers));
+
+    if (limiter_ && !limiter_->consumeAudio(policy, static_cast<double>(pcm.size()) / 16000.0)) {
+        return errorResponse(req, http::status::too_many_requests,
+                             "Audio quota exceeded for this account", "QUOTA_EXCEEDED");
+    }
+
+    OfflineTranscriber::Options opts;
+    opts.decode       = config_.decode;
+    opts.max_parallel = config_.max_parallel;
+    opts.priority     = policy.priority();
+    if (opts.decode.n_threads <= 0) opts.decode.n_threads = AutoSizing::instance().threads();
+    if (std::string lang = queryParam(target, "language"); !lang.empty()) {
+        if (lang != "auto" && whisper_lang_id(lang.c_str()) < 0) {
+            return errorResponse(req, http::status::bad_request, "Unknown language '" + lang + "'", "INVALID_LANGUAGE");
+        }
+        opts.decode.language = lang;
+    }
+
+    std::unique_ptr<ModelRef> model;
+    try {
+        model = std::make_unique<ModelRef>(cache, config_.model_path);
+    } catch (const std::exception& e) {
+        Log::error(std::string("Offline transcription: model unavailable: ") + e.what());
+        return errorResponse(req, http::status::service_unavailable, "Model unavailable", "MODEL_UNAVAILABLE");
+    }
+    // Leased states leave the pool's idle count (shared memory): this account carries them.
+    memory->update(MemoryBudget::Component::State, static_cast<size_t>(workers) * cache.stateBytes());
+
+    OfflineTranscriber::Result result;
+    try {
+        WhisperStatePool* pool = model->cache.statePool();
+        if (!pool) throw std::runtime_error("model state pool unavailable");
+
+        OfflineJob job;
+        result = OfflineTranscriber(*pool, opts).transcribe(pcm, &job.cancel);
+    } catch (const std::exception& e) {
+        Log::error(std::string("Offline transcription failed: ") + e.what());
+        return errorResponse(req, http::status::internal_server_error, e.what(), "TRANSCRIBE_FAILED");
+    }
+
+    if (result.cancelled) {
+        return errorResponse(req, http::status::service_unavailable, "Server shutting down", "SHUTTING_DOWN");
+    }
+
+    json segments = json::array();
+    for (const auto& s : result.segments) {
+        segments.push_back({{"start", s.start}, {"end", s.end}, {"text", s.text}});
+    }
+    json out = {
+        {"text", result.text},
+        {"language", result.language},
+        {"duration", result.audio_seconds},
+        {"processing_time", result.processing_seconds},
+        {"segments", std::move(segments)},
+        {"chunks", result.chunks},
+        {"chunks_decoded", result.chunks_decoded},
+        {"workers", result.workers}
+    };
+    // Segment text may end mid UTF-8 sequence: replace rather than throw.
+    return makeResponse(req, http::status::ok, out.dump(-1, ' ', false, json::error_handler_t::replace));
+}
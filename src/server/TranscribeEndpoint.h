@@ -0,0 +1,70 @@
+#pragma once
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <boost/beast/http.hpp>
+#include <boost/beast/version.hpp>
+#include "whisper/DecodeConfig.h"
+#include "auth/ClientPolicy.h"
+
+class AuthManager;
+class ConnectionLimiter;
+
+/**
+ * @brief HTTP `POST /v1/transcribe`: transcripción offline de un archivo.
+ *
+ * Body: WAV (PCM16 / float32, any rate/channels) or raw mono 16kHz PCM
+ * (`?encoding=f32le`, default — same as WebSocket frames — or `s16le`).
+ * Query: `language` (default: server setting; `auto` to detect).
+ * Auth: `Authorization: Bearer <token>` or `X-API-Key: <token>` when auth is enabled.
+ * The key's tenant limits apply as for WebSocket sessions (one request = one
+ * session; the file's duration is charged to the audio quota) and its tier
+ * sets the priority of the decode workers.
+ *
+ * The audio is split at silences and decoded in parallel (OfflineTranscriber)
+ * on the shared model, within the InferenceLimiter budget. Responds with JSON:
+ * `{"text", "language", "duration", "processing_time", "segments": [{"start", "end", "text"}], ...}`.
+ */
+class TranscribeEndpoint {
+public:
+    using Request  = boost::beast::http::request<boost::beast::http::string_body>;
+    using Response = boost::beast::http::response<boost::beast::http::string_body>;
+
+    static constexpr std::string_view PATH = "/v1/transcribe";
+
+    struct Config {
+        std::string model_path;
+        WhisperDecodeConfig decode;
+        int max_parallel = 0; // 0 = OfflineTranscriber::defaultParallelism()
+    };
+
+    TranscribeEndpoint(Config config, std::shared_ptr<AuthManager> auth_manager,
+                       std::shared_ptr<ConnectionLimiter> limiter = nullptr);
+
+    /// Does the request target this endpoint (ignoring the query string)?
+    static bool matches(std::string_view target);
+
+    /**
+     * @brief Checks that need only the headers (method, API key, admission), run
+     * before the body is read so that unauthenticated clients cannot upload
+     * MAX_UPLOAD_MB and an overloaded node does not read what it will shed.
+     * @return the error to send (the connection is then closed), or nullopt to
+     *         read the body and call handle().
+     */
+    std::optional<Response> precheck(const Request& req) const;
+
+    /// Handle a request whose target matches(). Never throws.
+    Response handle(const Request& req) const;
+
+    /// Value of `key` in the target's query string ("" if absent). No percent-decoding.
+    static std::string queryParam(std::string_view target, std::string_view key);
+
+private:
+    /// Resolve the request's API key to a policy, or the error response.
+    std::optional<Response> authorize(const Request& req, ClientPolicy& policy) const;
+
+    Config config_;
+    std::shared_ptr<AuthManager> auth_manager_;
+    std::shared_ptr<ConnectionLimiter> limiter_;
+};
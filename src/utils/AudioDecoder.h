@@ -0,0 +1,144 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace AudioDecoder {
+
+constexpr uint32_t TARGET_SAMPLE_RATE = 16000;
+
+namespace detail {
+
+inline uint16_t readU16(const char* p) {
+    const auto* b = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<uint16_t>(b[0] | (b[1] << 8));
+}
+
+inline uint32_t readU32(const char* p) {
+    const auto* b = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<uint32_t>(b[0]) | (static_cast<uint32_t>(b[1]) << 8) |
+           (static_cast<uint32_t>(b[2]) << 16) | (static_cast<uint32_t>(b[3]) << 24);
+}
+
+} // namespace detail
+
+/// Does the payload start with a RIFF/WAVE header?
+inline bool looksLikeWav(std::string_view bytes) {
+    return bytes.size() >= 12 && bytes.compare(0, 4, "RIFF") == 0 && bytes.compare(8, 4, "WAVE") == 0;
+}
+
+/**
+ * Linear-interpolation resampler to 16 kHz. Adequate for speech going into
+ * whisper (which works on an 80-bin mel up to 8 kHz); not a high-quality SRC.
+ */
+inline std::vector<float> resampleTo16k(const std::vector<float>& in, uint32_t rate) {
+    if (rate == TARGET_SAMPLE_RATE || in.empty()) return in;
+    const double step = static_cast<double>(rate) / TARGET_SAMPLE_RATE;
+    const size_t n_out = static_cast<size_t>(static_cast<double>(in.size()) / step);
+    std::vector<float> out(n_out);
+    for (size_t i = 0; i < n_out; ++i) {
+        double pos  = i * step;
+        size_t i0   = static_cast<size_t>(pos);
+        size_t i1   = std::min(i0 + 1, in.size() - 1);
+        float  frac = static_cast<float>(pos - static_cast<double>(i0));
+        out[i] = in[i0] + (in[i1] - in[i0]) * frac;
+    }
+    return out;
+}
+
+/// Raw little-endian int16 mono 16 kHz.
+inline std::vector<float> decodePcm16(std::string_view bytes) {
+    std::vector<float> pcm(bytes.size() / 2);
+    for (size_t i = 0; i < pcm.size(); ++i) {
+        pcm[i] = static_cast<float>(static_cast<int16_t>(detail::readU16(bytes.data() + 2 * i))) / 32768.0f;
+    }
+    return pcm;
+}
+
+/// Raw little-endian float32 mono 16 kHz (same framing as WebSocket binary frames).
+inline std::vector<float> decodeFloat32(std::string_view bytes) {
+    std::vector<float> pcm(bytes.size() / 4);
+    if (!pcm.empty()) std::memcpy(pcm.data(), bytes.data(), pcm.size() * 4);
+    return pcm;
+}
+
+/**
+ * Decode a RIFF/WAVE file to 16 kHz mono float32.
+ *
+ * Supports PCM 16-bit and IEEE float 32-bit (also via WAVE_FORMAT_EXTENSIBLE),
+ * any channel count (averaged to mono) and any sample rate (resampled).
+ *
+ * @throws std::invalid_argument on malformed or unsupported input.
+ */
+inline std::vector<float> decodeWav(std::string_view bytes) {
+    using detail::readU16;
+    using detail::readU32;
+
+    if (!looksLikeWav(bytes)) {
+        throw std::invalid_argument("not a RIFF/WAVE file");
+    }
+
+    uint16_t format = 0, channels = 0, bits = 0;
+    uint32_t rate = 0;
+    bool have_fmt = false;
+    std::string_view data;
+
+    size_t pos = 12;
+    while (pos + 8 <= bytes.size()) {
+        std::string_view id = bytes.substr(pos, 4);
+        uint32_t size = readU32(bytes.data() + pos + 4);
+        size_t body = pos + 8;
+        // Streamed WAVs may carry a bogus data size: clamp to what we actually have.
+        size_t avail = std::min<size_t>(size, bytes.size() - body);
+
+        if (id == "fmt ") {
+            if (avail < 16) throw std::invalid_argument("truncated fmt chunk");
+            format   = readU16(bytes.data() + body);
+            channels = readU16(bytes.data() + body + 2);
+            rate     = readU32(bytes.data() + body + 4);
+            bits     = readU16(bytes.data() + body + 14);
+            if (format == 0xFFFE && avail >= 26) { // WAVE_FORMAT_EXTENSIBLE: subformat GUID
+                format = readU16(bytes.data() + body + 24);
+            }
+            have_fmt = true;
+        } else if (id == "data") {
+            data = bytes.substr(body, avail);
+            break;
+        }
+        pos = body + size + (size & 1); // chunks are word-aligned
+    }
+
+    if (!have_fmt) throw std::invalid_argument("missing fmt chunk");
+    if (data.data() == nullptr) throw std::invalid_argument("missing data chunk");
+    if (channels == 0 || rate == 0) throw std::invalid_argument("invalid channel count or sample rate");
+
+    std::vector<float> interleaved;
+    if (format == 1 && bits == 16) {
+        interleaved = decodePcm16(data);
+    } else if (format == 3 && bits == 32) {
+        interleaved = decodeFloat32(data);
+    } else {
+        throw std::invalid_argument("unsupported WAV encoding (format " + std::to_string(format) +
+                                    ", " + std::to_string(bits) + " bits); use PCM16 or float32");
+    }
+
+    std::vector<float> mono;
+    if (channels == 1) {
+        mono = std::move(interleaved);
+    } else {
+        mono.resize(interleaved.size() / channels);
+        for (size_t i = 0; i < mono.size(); ++i) {
+            float sum = 0.0f;
+            for (uint16_t c = 0; c < channels; ++c) sum += interleaved[i * channels + c];
+            mono[i] = sum / channels;
+        }
+    }
+
+    return resampleTo16k(mono, rate);
+}
+
+} // namespace AudioDecoder
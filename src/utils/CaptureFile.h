@@ -0,0 +1,86 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief On-disk format of a session capture (see SessionCapture).
+ *
+ * An 8-byte magic followed by records, appended in arrival order:
+ *
+ *     u8 type | u64 t_us | u32 length | payload[length]      (little-endian)
+ *
+ * t_us is microseconds since the capture was opened. Payloads:
+ *  - Meta:     JSON {session_id, started_unix_ms, sample_rate}; always first
+ *  - TextIn:   a client text frame (config tokens redacted)
+ *  - AudioIn:  a client binary frame, verbatim (float32 PCM, 16 kHz mono)
+ *  - TextOut:  a message the server sent
+ *
+ * The file is append-only, so a crash leaves at most one cut record at the end;
+ * read() keeps everything before it and sets `truncated`.
+ */
+namespace capture {
+
+inline constexpr char MAGIC[8] = {'J', 'T', 'C', 'A', 'P', 'v', '1', '\n'};
+inline constexpr size_t RECORD_HEADER_BYTES = 1 + 8 + 4;
+
+enum class RecordType : uint8_t { Meta = 0, TextIn = 1, AudioIn = 2, TextOut = 3 };
+
+struct Record {
+    RecordType  type;
+    uint64_t    t_us;
+    std::string payload;
+};
+
+struct Capture {
+    std::vector<Record> records;
+    bool truncated = false; // the last record was cut short
+};
+
+/// Append one encoded record to `out`.
+inline void appendRecord(std::string& out, RecordType type, uint64_t t_us, const void* data, size_t n) {
+    char header[RECORD_HEADER_BYTES];
+    header[0] = static_cast<char>(type);
+    for (int i = 0; i < 8; ++i) header[1 + i] = static_cast<char>((t_us >> (8 * i)) & 0xff);
+    const uint32_t len = static_cast<uint32_t>(n);
+    for (int i = 0; i < 4; ++i) header[9 + i] = static_cast<char>((len >> (8 * i)) & 0xff);
+    out.append(header, sizeof(header));
+    out.append(static_cast<const char*>(data), n);
+}
+
+/**
+ * @brief Load a capture file.
+ * @throws std::runtime_error if it cannot be opened or is not a capture
+ */
+inline Capture read(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("Cannot open capture: " + path);
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    if (data.size() < sizeof(MAGIC) || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::runtime_error("Not a session capture: " + path);
+    }
+
+    Capture cap;
+    size_t pos = sizeof(MAGIC);
+    while (pos < data.size()) {
+        if (data.size() - pos < RECORD_HEADER_BYTES) { cap.truncated = true; break; }
+        const auto* p = reinterpret_cast<const unsigned char*>(data.data() + pos);
+        uint64_t t_us = 0;
+        for (int i = 0; i < 8; ++i) t_us |= static_cast<uint64_t>(p[1 + i]) << (8 * i);
+        uint32_t len = 0;
+        for (int i = 0; i < 4; ++i) len |= static_cast<uint32_t>(p[9 + i]) << (8 * i);
+        if (data.size() - pos - RECORD_HEADER_BYTES < len) { cap.truncated = true; break; }
+
+        cap.records.push_back({static_cast<RecordType>(p[0]), t_us,
+                               data.substr(pos + RECORD_HEADER_BYTES, len)});
+        pos += RECORD_HEADER_BYTES + len;
+    }
+    return cap;
+}
+
+} // namespace capture
@@ -0,0 +1,211 @@
+#pragma once
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+/**
+ * @brief CPU and memory limits of this process's cgroup (v1 or v2).
+ *
+ * Reads the files under `root` (normally /sys/fs/cgroup) instead of calling
+ * anything, so tests point it at a fake tree. v2 limits can sit on any
+ * ancestor (a pod slice above the container), so the hierarchy from the
+ * process's own group up to the root is walked and the tightest value wins.
+ */
+namespace cgroup {
+
+struct Limits {
+    int    version = 0;          // 0 = no cgroup filesystem found
+    double cpu_quota = 0.0;      // cores (quota / period); 0 = unlimited
+    int    cpuset_cpus = 0;      // CPUs in the cpuset; 0 = unknown
+    size_t memory_limit = 0;     // bytes; 0 = unlimited
+
+    bool operator==(const Limits& o) const {
+        return version == o.version && cpu_quota == o.cpu_quota &&
+               cpuset_cpus == o.cpuset_cpus && memory_limit == o.memory_limit;
+    }
+    bool operator!=(const Limits& o) const { return !(*this == o); }
+};
+
+/// Number of CPUs in a list such as "0-3,8,10-11" (0 if empty or malformed).
+inline int countCpuList(const std::string& list) {
+    int count = 0;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        range.erase(std::remove_if(range.begin(), range.end(), ::isspace), range.end());
+        if (range.empty()) continue;
+        try {
+            const auto dash = range.find('-');
+            if (dash == std::string::npos) {
+                std::stoi(range);
+                ++count;
+            } else {
+                const int lo = std::stoi(range.substr(0, dash));
+                const int hi = std::stoi(range.substr(dash + 1));
+                if (hi < lo) return 0;
+                count += hi - lo + 1;
+            }
+        } catch (...) {
+            return 0;
+        }
+    }
+    return count;
+}
+
+namespace detail {
+
+inline bool readLine(const std::filesystem::path& p, std::string& out) {
+    std::ifstream in(p);
+    if (!in || !std::getline(in, out)) return false;
+    return true;
+}
+
+// v1 reports "no limit" as a page-rounded INT64_MAX; anything this large is unlimited.
+inline size_t parseMemory(const std::string& v) {
+    if (v.empty() || v == "max") return 0;
+    try {
+        const unsigned long long bytes = std::stoull(v);
+        return bytes >= (1ULL << 60) ? 0 : static_cast<size_t>(bytes);
+    } catch (...) {
+        return 0;
+    }
+}
+
+inline double minPositive(double a, double b) { return a <= 0 ? b : (b <= 0 ? a : std::min(a, b)); }
+inline size_t minPositive(size_t a, size_t b) { return a == 0 ? b : (b == 0 ? a : std::min(a, b)); }
+
+// The process's group for one hierarchy, from /proc/self/cgroup:
+// "0::/pod/ctr" (v2, controller "") or "4:memory:/pod/ctr" (v1). "/" if absent.
+inline std::string groupPath(const std::string& proc_self_cgroup, const std::string& controller) {
+    std::ifstream in(proc_self_cgroup);
+    std::string line;
+    while (std::getline(in, line)) {
+        const auto a = line.find(':');
+        const auto b = a == std::string::npos ? a : line.find(':', a + 1);
+        if (b == std::string::npos) continue;
+        std::stringstream ctls(line.substr(a + 1, b - a - 1));
+        std::string ctl;
+        if (controller.empty() && b == a + 1) return line.substr(b + 1);
+        while (!controller.empty() && std::getline(ctls, ctl, ',')) {
+            if (ctl == controller) return line.substr(b + 1);
+        }
+    }
+    return "/";
+}
+
+// Directories from the process's group up to `mount`, leaf first. Inside a container
+// with its own cgroup namespace the group is the mount root; the leaf is only used
+// when it is visible under the mount.
+inline std::vector<std::filesystem::path> ancestry(const std::filesystem::path& mount, const std::string& group) {
+    std::vector<std::filesystem::path> dirs = {mount};
+    for (const auto& part : std::filesystem::path(group).relative_path()) {
+        if (part.empty()) continue;
+        dirs.push_back(dirs.back() / part);
+    }
+    if (!std::filesystem::is_directory(dirs.back())) dirs.resize(1);
+    return {dirs.rbegin(), dirs.rend()};
+}
+
+inline Limits readV2(const std::filesystem::path& root, const std::string& proc_self_cgroup) {
+    Limits l;
+    l.version = 2;
+    for (const auto& d : ancestry(root, groupPath(proc_self_cgroup, ""))) {
+        std::string v;
+        if (readLine(d / "cpu.max", v)) {
+            std::istringstream is(v);
+            std::string quota;
+            double period = 0;
+            is >> quota >> period;
+            if (quota != "max" && period > 0) {
+                try {
+                    l.cpu_quota = minPositive(l.cpu_quota, std::stod(quota) / period);
+                } catch (...) {}
+            }
+        }
+        if (readLine(d / "memory.max", v)) l.memory_limit = minPositive(l.memory_limit, parseMemory(v));
+        if (l.cpuset_cpus == 0 && readLine(d / "cpuset.cpus.effective", v)) l.cpuset_cpus = countCpuList(v);
+    }
+    return l;
+}
+
+inline Limits readV1(const std::filesystem::path& root, const std::string& proc_self_cgroup) {
+    Limits l;
+    l.version = 1;
+    std::string v;
+    const auto cpu_mount = std::filesystem::is_directory(root / "cpu,cpuacct") ? root / "cpu,cpuacct" : root / "cpu";
+    for (const auto& d : ancestry(cpu_mount, groupPath(proc_self_cgroup, "cpu"))) {
+        std::string quota, period;
+        if (readLine(d / "cpu.cfs_quota_us", quota) && readLine(d / "cpu.cfs_period_us", period)) {
+            try {
+                const double q = std::stod(quota), p = std::stod(period);
+                if (q > 0 && p > 0) l.cpu_quota = minPositive(l.cpu_quota, q / p); // -1 = unlimited
+            } catch (...) {}
+        }
+    }
+    for (const auto& d : ancestry(root / "cpuset", groupPath(proc_self_cgroup, "cpuset"))) {
+        if (readLine(d / "cpuset.effective_cpus", v) || readLine(d / "cpuset.cpus", v)) {
+            l.cpuset_cpus = countCpuList(v);
+            break;
+        }
+    }
+    for (const auto& d : ancestry(root / "memory", groupPath(proc_self_cgroup, "memory"))) {
+        if (readLine(d / "memory.limit_in_bytes", v)) l.memory_limit = minPositive(l.memory_limit, parseMemory(v));
+    }
+    return l;
+}
+
+} // namespace detail
+
+/**
+ * @brief Read the limits under `root`; v2 if root/cgroup.controllers exists, else v1.
+ * Missing files mean "no limit", never an error.
+ */
+inline Limits read(const std::string& root = "/sys/fs/cgroup",
+                   const std::string& proc_self_cgroup = "/proc/self/cgroup") {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    if (fs::exists(fs::path(root) / "cgroup.controllers", ec)) return detail::readV2(root, proc_self_cgroup);
+    if (fs::is_directory(fs::path(root) / "memory", ec) || fs::is_directory(fs::path(root) / "cpu", ec) ||
+        fs::is_directory(fs::path(root) / "cpu,cpuacct", ec)) {
+        return detail::readV1(root, proc_self_cgroup);
+    }
+    return {};
+}
+
+/// CPUs this process may run on (sched affinity), falling back to hardware_concurrency.
+inline int affinityCpus() {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        const int n = CPU_COUNT(&set);
+        if (n > 0) return n;
+    }
+#endif
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/**
+ * @brief Whole cores usable without throttling: the smallest of the quota
+ * (rounded down — a 2.5-core quota throttles a third thread), the cpuset and
+ * the affinity mask. At least 1.
+ */
+inline int usableCores(const Limits& l, int affinity_cpus) {
+    int cores = std::max(affinity_cpus, 1);
+    if (l.cpuset_cpus > 0) cores = std::min(cores, l.cpuset_cpus);
+    if (l.cpu_quota > 0) cores = std::min(cores, static_cast<int>(std::floor(l.cpu_quota)));
+    return std::max(cores, 1);
+}
+
+} // namespace cgroup
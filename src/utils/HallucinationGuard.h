@@ -1,7 +1,102 @@
 #pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <string>
-#include <sstream>
-#include <unordered_map>
+#include <string_view>
+
+namespace hallucination_detail {
+
+// FNV-1a over the token bytes.
+inline uint64_t hashToken(std::string_view w) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (unsigned char c : w) {
+        h ^= c;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+// Order-sensitive bigram key. 0 is reserved for empty table slots.
+inline uint64_t bigramKey(uint64_t a, uint64_t b) {
+    uint64_t k = a * 0x9e3779b97f4a7c15ULL;
+    k ^= b + 0x7f4a7c159e3779b9ULL + (k << 6) + (k >> 2);
+    return k ? k : 1;
+}
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+// Whitespace tokenizer over a string_view (same splitting as `istream >> std::string`).
+class Tokenizer {
+public:
+    explicit Tokenizer(std::string_view text) : text_(text) {}
+
+    bool next(std::string_view& token) {
+        while (pos_ < text_.size() && isSpace(text_[pos_])) ++pos_;
+        if (pos_ >= text_.size()) return false;
+        size_t start = pos_;
+        while (pos_ < text_.size() && !isSpace(text_[pos_])) ++pos_;
+        token = text_.substr(start, pos_ - start);
+        return true;
+    }
+
+private:
+    std::string_view text_;
+    size_t pos_ = 0;
+};
+
+// Fixed-size open-addressing counter keyed by bigram hash. N must be a power of two.
+template <size_t N>
+class BigramTable {
+    static_assert((N & (N - 1)) == 0, "N must be a power of two");
+
+public:
+    // Increment key and return its new count (0 if the table is full).
+    uint32_t add(uint64_t key) {
+        for (size_t i = 0, idx = key & (N - 1); i < N; ++i, idx = (idx + 1) & (N - 1)) {
+            Slot& s = slots_[idx];
+            if (s.key == key) return ++s.count;
+            if (s.key == 0) {
+                s.key   = key;
+                s.count = 1;
+                ++used_;
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    // Decrement key; the slot is kept (count may reach 0) until clear().
+    void remove(uint64_t key) {
+        for (size_t i = 0, idx = key & (N - 1); i < N; ++i, idx = (idx + 1) & (N - 1)) {
+            Slot& s = slots_[idx];
+            if (s.key == 0) return;
+            if (s.key == key) {
+                if (s.count > 0) --s.count;
+                return;
+            }
+        }
+    }
+
+    void clear() {
+        slots_.fill(Slot{});
+        used_ = 0;
+    }
+
+    size_t used() const { return used_; }
+
+private:
+    struct Slot {
+        uint64_t key   = 0;
+        uint32_t count = 0;
+    };
+    std::array<Slot, N> slots_{};
+    size_t used_ = 0;
+};
+
+} // namespace hallucination_detail
 
 /**
  * Detects transcription hallucination loops.
@@ -9,23 +104,120 @@
  *   - Total length > 500 chars (decoder loop filling context)
  *   - 4+ consecutive identical words
  *   - 4+ repeated bigrams
+ *
+ * Allocation-free: tokens are string_views and bigrams are counted by hash
+ * in a fixed table on the stack (500 chars → at most 250 bigrams).
  */
-inline bool isHallucination(const std::string& text) {
+inline bool isHallucination(std::string_view text) {
+    using namespace hallucination_detail;
     if (text.length() > 500) return true;
 
-    std::istringstream ss(text);
-    std::unordered_map<std::string, int> bigrams;
-    std::string prev, cur;
+    Tokenizer tokens(text);
+    BigramTable<512> bigrams;
+    std::string_view prev, cur;
+    uint64_t prev_hash = 0;
+    bool has_prev = false;
     int consec = 0;
 
-    while (ss >> cur) {
-        if (cur == prev) {
+    while (tokens.next(cur)) {
+        if (has_prev && cur == prev) {
             if (++consec >= 4) return true;
         } else {
             consec = 1;
         }
-        if (!prev.empty() && ++bigrams[prev + ' ' + cur] >= 4) return true;
-        prev = cur;
+        uint64_t h = hashToken(cur);
+        if (has_prev && bigrams.add(bigramKey(prev_hash, h)) >= 4) return true;
+        prev      = cur;
+        prev_hash = h;
+        has_prev  = true;
     }
     return false;
 }
+
+/**
+ * Stateful repetition detector across consecutive commits of one session.
+ *
+ * isHallucination() only sees one window at a time, so a decoder that emits
+ * "Gracias." on every commit is never caught. The tracker keeps the last
+ * kWindowBigrams bigram hashes of accepted text and applies the same rules
+ * (4+ identical words in a row, 4+ repeated bigrams) across commit
+ * boundaries. The window is sized to a ~10s commit so the bigram density
+ * matches the single-window rule.
+ *
+ * Not thread-safe; owned by the session's flush thread.
+ */
+class HallucinationTracker {
+public:
+    static constexpr size_t kWindowBigrams = 32;
+
+    /// Would appending 'text' to the history form a loop? Does not modify state.
+    bool check(std::string_view text) const {
+        HallucinationTracker probe(*this);
+        return probe.feed(text);
+    }
+
+    /// Add accepted text to the history. Returns true if it formed a loop.
+    bool append(std::string_view text) { return feed(text); }
+
+    void reset() {
+        bigrams_.clear();
+        ring_head_ = ring_size_ = 0;
+        last_hash_ = 0;
+        has_last_  = false;
+        consec_    = 0;
+    }
+
+private:
+    bool feed(std::string_view text) {
+        using namespace hallucination_detail;
+        Tokenizer tokens(text);
+        std::string_view tok;
+        bool loop = false;
+
+        while (tokens.next(tok)) {
+            uint64_t h = hashToken(tok);
+            if (has_last_ && h == last_hash_) {
+                if (++consec_ >= 4) loop = true;
+            } else {
+                consec_ = 1;
+            }
+            if (has_last_ && pushBigram(bigramKey(last_hash_, h)) >= 4) loop = true;
+            last_hash_ = h;
+            has_last_  = true;
+        }
+        return loop;
+    }
+
+    // Slide the window by one bigram and return the new key's count.
+    uint32_t pushBigram(uint64_t key) {
+        // Evicted keys keep their slot; rebuild before probing chains get long.
+        if (bigrams_.used() > kTableSize / 2) rebuild();
+
+        if (ring_size_ == kWindowBigrams) {
+            bigrams_.remove(ring_[ring_head_]);
+            ring_[ring_head_] = key;
+            ring_head_ = (ring_head_ + 1) % kWindowBigrams;
+        } else {
+            ring_[(ring_head_ + ring_size_) % kWindowBigrams] = key;
+            ++ring_size_;
+        }
+        return bigrams_.add(key);
+    }
+
+    void rebuild() {
+        bigrams_.clear();
+        for (size_t i = 0; i < ring_size_; ++i) {
+            bigrams_.add(ring_[(ring_head_ + i) % kWindowBigrams]);
+        }
+    }
+
+    static constexpr size_t kTableSize = 256;
+
+    hallucination_detail::BigramTable<kTableSize> bigrams_;
+    std::array<uint64_t, kWindowBigrams> ring_{};
+    size_t   ring_head_ = 0;
+    size_t   ring_size_ = 0;
+    uint64_t last_hash_ = 0;
+    bool     has_last_  = false;
+    int      consec_    = 0;
+};
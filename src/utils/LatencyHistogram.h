@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Fixed-bucket latency histogram rendered in Prometheus format.
+ *
+ * Lock-free (relaxed atomics): observe() from any thread, render() from /metrics.
+ * Buckets are upper bounds in seconds; a +Inf bucket is implicit.
+ */
+class LatencyHistogram {
+public:
+    explicit LatencyHistogram(std::vector<double> bounds)
+        : bounds_(std::move(bounds)),
+          counts_(std::make_unique<std::atomic<uint64_t>[]>(bounds_.size() + 1)) {
+        for (size_t i = 0; i <= bounds_.size(); ++i) counts_[i].store(0, std::memory_order_relaxed);
+    }
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void observe(double seconds) {
+        size_t i = 0;
+        while (i < bounds_.size() && seconds > bounds_[i]) ++i;
+        counts_[i].fetch_add(1, std::memory_order_relaxed);
+        sum_us_.fetch_add(static_cast<uint64_t>(seconds > 0 ? seconds * 1e6 : 0), std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+
+    /// `name_bucket{le="..."}` (cumulative), `name_sum` and `name_count` lines.
+    std::string render(const std::string& name) const {
+        std::string out;
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i <= bounds_.size(); ++i) {
+            cumulative += counts_[i].load(std::memory_order_relaxed);
+            std::string le = i < bounds_.size() ? formatBound(bounds_[i]) : "+Inf";
+            out += name + "_bucket{le=\"" + le + "\"} " + std::to_string(cumulative) + "\n";
+        }
+        out += name + "_sum " + std::to_string(sum_us_.load(std::memory_order_relaxed) / 1e6) + "\n";
+        out += name + "_count " + std::to_string(count_.load(std::memory_order_relaxed)) + "\n";
+        return out;
+    }
+
+private:
+    static std::string formatBound(double b) {
+        std::string s = std::to_string(b);
+        s.erase(s.find_last_not_of('0') + 1);
+        if (!s.empty() && s.back() == '.') s.pop_back();
+        return s;
+    }
+
+    std::vector<double> bounds_;
+    std::unique_ptr<std::atomic<uint64_t>[]> counts_;
+    std::atomic<uint64_t> sum_us_{0};
+    std::atomic<uint64_t> count_{0};
+};
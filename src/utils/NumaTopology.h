@@ -0,0 +1,170 @@
+#pragma once
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "utils/CgroupLimits.h"
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief NUMA nodes and their CPUs, and the Linux calls to place a thread on one.
+ *
+ * The topology comes from /sys/devices/system/node, or from a spec string
+ * ("0-3;4-7": node 0 has CPUs 0-3, node 1 has 4-7) so that placement can be
+ * exercised on a single-node box. A simulated topology only pins threads; memory
+ * policy needs real nodes.
+ */
+namespace numa {
+
+struct Node {
+    int id = 0;
+    std::vector<int> cpus;
+};
+
+struct Topology {
+    std::vector<Node> nodes;
+    bool simulated = false;
+
+    /// Node owning `cpu`, or -1.
+    int nodeOfCpu(int cpu) const {
+        for (const auto& n : nodes) {
+            if (std::find(n.cpus.begin(), n.cpus.end(), cpu) != n.cpus.end()) return n.id;
+        }
+        return -1;
+    }
+};
+
+/// CPU ids in a list such as "0-3,8" (see cgroup::countCpuList for the format).
+inline std::vector<int> parseCpuList(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        range.erase(std::remove_if(range.begin(), range.end(), ::isspace), range.end());
+        if (range.empty()) continue;
+        if (cgroup::countCpuList(range) == 0) throw std::invalid_argument("bad CPU list: " + list);
+        const auto dash = range.find('-');
+        const int lo = std::stoi(range.substr(0, dash));
+        const int hi = dash == std::string::npos ? lo : std::stoi(range.substr(dash + 1));
+        for (int c = lo; c <= hi; ++c) cpus.push_back(c);
+    }
+    return cpus;
+}
+
+/**
+ * @brief Simulated topology, nodes separated by ';'.
+ * @throws std::invalid_argument on an empty node or malformed list
+ */
+inline Topology parseSpec(const std::string& spec) {
+    Topology t;
+    t.simulated = true;
+    std::stringstream ss(spec);
+    std::string node;
+    while (std::getline(ss, node, ';')) {
+        Node n;
+        n.id = static_cast<int>(t.nodes.size());
+        n.cpus = parseCpuList(node);
+        if (n.cpus.empty()) throw std::invalid_argument("NUMA node " + std::to_string(n.id) + " has no CPUs");
+        t.nodes.push_back(std::move(n));
+    }
+    if (t.nodes.empty()) throw std::invalid_argument("empty NUMA topology");
+    if (spec.back() == ';') throw std::invalid_argument("NUMA node " + std::to_string(t.nodes.size()) + " has no CPUs");
+    return t;
+}
+
+/// Nodes with CPUs under `root`; a single node with every CPU if sysfs has none.
+inline Topology readSysfs(const std::string& root = "/sys/devices/system/node") {
+    Topology t;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(root, ec)) {
+        const std::string name = entry.path().filename().string();
+        if (name.rfind("node", 0) != 0 || name.size() == 4 ||
+            !std::all_of(name.begin() + 4, name.end(), ::isdigit)) {
+            continue;
+        }
+        std::ifstream in(entry.path() / "cpulist");
+        std::string list;
+        if (!std::getline(in, list)) continue;
+        Node n;
+        n.id = std::stoi(name.substr(4));
+        try {
+            n.cpus = parseCpuList(list);
+        } catch (const std::invalid_argument&) {
+            continue;
+        }
+        if (!n.cpus.empty()) t.nodes.push_back(std::move(n)); // memory-only nodes run nothing
+    }
+    std::sort(t.nodes.begin(), t.nodes.end(), [](const Node& a, const Node& b) { return a.id < b.id; });
+    if (t.nodes.empty()) {
+        Node all;
+        for (int c = 0; c < cgroup::affinityCpus(); ++c) all.cpus.push_back(c);
+        t.nodes.push_back(std::move(all));
+    }
+    return t;
+}
+
+/// CPU the calling thread is running on, or -1.
+inline int currentCpu() {
+#if defined(__linux__)
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
+
+/// CPUs the calling thread may run on now (empty if unknown).
+inline std::vector<int> currentAffinity() {
+    std::vector<int> cpus;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int c = 0; c < CPU_SETSIZE; ++c) {
+            if (CPU_ISSET(c, &set)) cpus.push_back(c);
+        }
+    }
+#endif
+    return cpus;
+}
+
+/// Restrict the calling thread to `cpus` (threads it creates inherit the mask).
+inline bool pinCurrentThread(const std::vector<int>& cpus) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int c : cpus) {
+        if (c >= 0 && c < CPU_SETSIZE) CPU_SET(c, &set);
+    }
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+/**
+ * @brief Allocate the calling thread's new pages on `node` (MPOL_PREFERRED), or
+ * back to the default policy with node < 0. Raw syscall: no libnuma dependency.
+ */
+inline bool preferNode(int node) {
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+    constexpr int MPOL_DEFAULT_ = 0, MPOL_PREFERRED_ = 1;
+    if (node < 0) return syscall(SYS_set_mempolicy, MPOL_DEFAULT_, nullptr, 0) == 0;
+    if (node >= 64) return false;
+    unsigned long mask = 1UL << node;
+    return syscall(SYS_set_mempolicy, MPOL_PREFERRED_, &mask, sizeof(mask) * 8) == 0;
+#else
+    (void)node;
+    return false;
+#endif
+}
+
+} // namespace numa
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+/**
+ * @brief Resident memory of this process, split the way the kernel accounts it.
+ *
+ * RSS alone cannot tell a private copy of the weights from pages shared with
+ * other processes through the page cache: `rss_anon` is private (malloc'd
+ * tensors, KV caches), `rss_file` is file pages mapped in (shared and
+ * reclaimable), and `pss` charges each shared page 1/N to each of the N
+ * processes mapping it — summed over a host's workers it is their real cost.
+ *
+ * Reads /proc/self/status and /proc/self/smaps_rollup (Linux ≥ 4.14); fields
+ * that are missing stay 0. Paths are parameters so tests feed fixtures.
+ */
+namespace procmem {
+
+struct Usage {
+    size_t rss = 0;        // VmRSS
+    size_t rss_anon = 0;   // RssAnon: private heap, stacks
+    size_t rss_file = 0;   // RssFile: mapped file pages
+    size_t rss_shmem = 0;  // RssShmem
+    size_t pss = 0;        // Pss (smaps_rollup)
+};
+
+namespace detail {
+
+// "VmRSS:	  123456 kB" → bytes, when the line starts with `key`.
+inline bool kbField(const std::string& line, const char* key, size_t& out) {
+    const std::string k(key);
+    if (line.compare(0, k.size(), k) != 0 || line.size() <= k.size() || line[k.size()] != ':') return false;
+    std::istringstream is(line.substr(k.size() + 1));
+    unsigned long long kb = 0;
+    if (!(is >> kb)) return false;
+    out = static_cast<size_t>(kb) * 1024;
+    return true;
+}
+
+} // namespace detail
+
+inline Usage read(const std::string& status = "/proc/self/status",
+                  const std::string& smaps_rollup = "/proc/self/smaps_rollup") {
+    Usage u;
+    std::string line;
+    std::ifstream st(status);
+    while (std::getline(st, line)) {
+        detail::kbField(line, "VmRSS", u.rss) || detail::kbField(line, "RssAnon", u.rss_anon) ||
+            detail::kbField(line, "RssFile", u.rss_file) || detail::kbField(line, "RssShmem", u.rss_shmem);
+    }
+    std::ifstream rollup(smaps_rollup);
+    while (std::getline(rollup, line)) {
+        if (detail::kbField(line, "Pss", u.pss)) break;
+    }
+    return u;
+}
+
+/**
+ * @brief Get telemetry metrics in Prometheus format
+ */
+inline std::string getMetrics() {
+    const Usage u = read();
+    if (u.rss == 0) return "";
+    return "transcription_process_rss_bytes{kind=\"anon\"} " + std::to_string(u.rss_anon) + "\n" +
+           "transcription_process_rss_bytes{kind=\"file\"} " + std::to_string(u.rss_file) + "\n" +
+           "transcription_process_rss_bytes{kind=\"shmem\"} " + std::to_string(u.rss_shmem) + "\n" +
+           "transcription_process_pss_bytes " + std::to_string(u.pss) + "\n";
+}
+
+} // namespace procmem
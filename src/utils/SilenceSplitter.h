@@ -0,0 +1,105 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace SilenceSplitter {
+
+struct Chunk {
+    size_t offset = 0;  // samples
+    size_t length = 0;  // samples
+    bool   speech = true; // false = only silence/noise; callers may skip it
+};
+
+struct Options {
+    size_t max_chunk_samples  = 16000 * 25; // stay under whisper's 30s window
+    size_t min_chunk_samples  = 16000 * 5;  // don't cut before this
+    size_t frame_samples      = 320;        // 20ms @ 16kHz
+    float  min_threshold      = 0.003f;     // RMS floor for "silence"
+    float  max_threshold      = 0.02f;      // never call louder frames silent (AudioPreprocessor noise level)
+    float  noise_multiplier   = 3.0f;       // threshold = noise floor (p10 RMS) * multiplier
+    size_t min_speech_frames  = 3;          // chunks with fewer voiced frames are marked !speech
+};
+
+/**
+ * Energy-based VAD splitter for offline transcription.
+ *
+ * Computes per-frame RMS, derives a silence threshold from the noise floor
+ * (10th percentile, clamped to [min_threshold, max_threshold]) and cuts the
+ * audio into chunks of at most max_chunk_samples, each cut placed in the
+ * middle of the longest silent run inside [min, max] from the chunk start
+ * (the quietest, latest frame if there is no silence). Chunks therefore start and end
+ * between words and can be decoded independently and in parallel.
+ *
+ * The chunks cover the input contiguously, in order, without overlap.
+ */
+inline std::vector<Chunk> split(const std::vector<float>& pcm, const Options& opt = {}) {
+    std::vector<Chunk> chunks;
+    if (pcm.empty()) return chunks;
+
+    const size_t frame = std::max<size_t>(opt.frame_samples, 1);
+    const size_t n_frames = (pcm.size() + frame - 1) / frame;
+
+    std::vector<float> rms(n_frames);
+    for (size_t f = 0; f < n_frames; ++f) {
+        size_t b = f * frame, e = std::min(b + frame, pcm.size());
+        double acc = 0.0;
+        for (size_t i = b; i < e; ++i) acc += static_cast<double>(pcm[i]) * pcm[i];
+        rms[f] = static_cast<float>(std::sqrt(acc / static_cast<double>(e - b)));
+    }
+
+    std::vector<float> sorted(rms);
+    std::nth_element(sorted.begin(), sorted.begin() + n_frames / 10, sorted.end());
+    const float threshold = std::clamp(sorted[n_frames / 10] * opt.noise_multiplier,
+                                       opt.min_threshold, opt.max_threshold);
+
+    const size_t max_frames = std::max<size_t>(opt.max_chunk_samples / frame, 1);
+    const size_t min_frames = std::min(opt.min_chunk_samples / frame, max_frames);
+
+    size_t start = 0;
+    while (start < n_frames) {
+        size_t end = n_frames;
+        if (n_frames - start > max_frames) {
+            const size_t lo = start + std::max<size_t>(min_frames, 1);
+            const size_t hi = start + max_frames; // exclusive
+
+            // Longest silent run inside [lo, hi); ties go to the later run.
+            size_t best_len = 0, best_mid = 0, run_start = lo;
+            for (size_t f = lo; f <= hi; ++f) {
+                bool silent = f < hi && rms[f] < threshold;
+                if (silent) continue;
+                size_t len = f - run_start;
+                if (len > 0 && len >= best_len) {
+                    best_len = len;
+                    best_mid = run_start + len / 2;
+                }
+                run_start = f + 1;
+            }
+
+            if (best_len > 0) {
+                end = best_mid;
+            } else {
+                // No pause at all: cut at the quietest frame, latest on ties.
+                end = hi;
+                for (size_t f = hi; f-- > lo;) {
+                    if (end == hi || rms[f] < rms[end]) end = f;
+                }
+            }
+            end = std::max(end, lo);
+        }
+
+        size_t voiced = 0;
+        for (size_t f = start; f < end; ++f) voiced += rms[f] >= threshold;
+
+        Chunk c;
+        c.offset = start * frame;
+        c.length = std::min(end * frame, pcm.size()) - c.offset;
+        c.speech = voiced >= opt.min_speech_frames;
+        chunks.push_back(c);
+        start = end;
+    }
+    return chunks;
+}
+
+} // namespace SilenceSplitter
@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+
+/**
+ * @brief Cooperative stop signal for one inference (or a group of them).
+ *
+ * Polled from whisper's abort / encoder-begin callbacks while a decode runs,
+ * so cancel() can be called from any thread and takes effect within one
+ * ggml graph node. A token may chain to a parent (e.g. a per-partial token
+ * under a per-session token): cancelling the parent stops the child too.
+ *
+ * Thread-safe: all state is atomic.
+ */
+class CancellationToken {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit CancellationToken(const CancellationToken* parent = nullptr)
+        : parent_(parent) {}
+
+    // Non-copyable (referenced by in-flight decodes)
+    CancellationToken(const CancellationToken&) = delete;
+    CancellationToken& operator=(const CancellationToken&) = delete;
+
+    void cancel() { cancelled_.store(true, std::memory_order_release); }
+
+    /// Stop once `deadline` passes. Clock::time_point::max() = no deadline.
+    void setDeadline(Clock::time_point deadline) {
+        deadline_ticks_.store(deadline.time_since_epoch().count(), std::memory_order_release);
+    }
+
+    /// Re-arm for the next inference: clears cancellation and deadline (not the parent's).
+    void reset() {
+        cancelled_.store(false, std::memory_order_release);
+        deadline_ticks_.store(NO_DEADLINE, std::memory_order_release);
+    }
+
+    bool isCancelled() const {
+        return cancelled_.load(std::memory_order_acquire) ||
+               (parent_ && parent_->isCancelled());
+    }
+
+    bool deadlineExceeded() const {
+        auto d = deadline_ticks_.load(std::memory_order_acquire);
+        if (d != NO_DEADLINE && Clock::now().time_since_epoch().count() >= d) return true;
+        return parent_ && parent_->deadlineExceeded();
+    }
+
+    bool shouldStop() const { return isCancelled() || deadlineExceeded(); }
+
+private:
+    static constexpr Clock::rep NO_DEADLINE = Clock::duration::max().count();
+
+    const CancellationToken* parent_;
+    std::atomic<bool> cancelled_{false};
+    std::atomic<Clock::rep> deadline_ticks_{NO_DEADLINE};
+};
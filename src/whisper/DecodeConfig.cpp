@@ -0,0 +1,133 @@
+#include "DecodeConfig.h"
+#include <whisper.h>
+#include <algorithm>
+#include <cmath>
+#include "CancellationToken.h"
+#include "utils/HallucinationGuard.h"
+
+namespace {
+
+// Don't judge repetition on the first few tokens of a sequence.
+constexpr int LOOP_CHECK_MIN_TOKENS = 8;
+// Only the tail of the sequence is checked: a loop shows up in its last tokens, and
+// rebuilding the whole text on every step would make the filter O(n²) in tokens.
+constexpr int LOOP_CHECK_TAIL_TOKENS = 64;
+
+// whisper logits filter: runs once per sampling step (and per beam) with the tokens
+// decoded so far. When their tail matches the HallucinationGuard repetition rules,
+// every logit except EOT is masked so the decoder ends the sequence right away
+// instead of looping until the token budget runs out. Text decoded so far is kept.
+//
+// With beam search whisper calls it concurrently from its decoder threads: the
+// text buffer is per thread and the shared LoopWatch fields are atomics.
+void loopWatchFilter(whisper_context* ctx, whisper_state* /*state*/,
+                     const whisper_token_data* tokens, int n_tokens,
+                     float* logits, void* user_data) {
+    auto* watch = static_cast<LoopWatch*>(user_data);
+    if (n_tokens < LOOP_CHECK_MIN_TOKENS) return;
+
+    thread_local std::string text; // reused across steps, no allocation once warm
+    text.clear();
+    for (int i = std::max(0, n_tokens - LOOP_CHECK_TAIL_TOKENS); i < n_tokens; ++i) {
+        if (tokens[i].id >= watch->eot) continue; // timestamps and special tokens
+        text += whisper_token_to_str(ctx, tokens[i].id);
+    }
+    if (!isHallucination(text)) return;
+
+    std::fill(logits, logits + watch->n_vocab, -INFINITY);
+    logits[watch->eot] = 0.0f;
+
+    bool expected = false;
+    if (watch->triggered.compare_exchange_strong(expected, true)) {
+        // Text tokens only, like the token budget recordLoopAbort() compares against.
+        int text_tokens = 0;
+        for (int i = 0; i < n_tokens; ++i) {
+            if (tokens[i].id < watch->eot) ++text_tokens;
+        }
+        watch->tokens_at_abort.store(text_tokens);
+    }
+}
+
+// Whether whisper must stop now; remembers that it was told to.
+bool stopRequested(CancelWatch* watch) {
+    if (!watch->token->shouldStop()) return false;
+    watch->fired.store(true);
+    return true;
+}
+
+// whisper abort callback: polled between graph nodes during encode/decode.
+bool cancelAbortCallback(void* user_data) {
+    return stopRequested(static_cast<CancelWatch*>(user_data));
+}
+
+// whisper encoder-begin callback: returning false skips the encoder entirely.
+bool cancelEncoderBegin(whisper_context* /*ctx*/, whisper_state* /*state*/, void* user_data) {
+    return !stopRequested(static_cast<CancelWatch*>(user_data));
+}
+
+} // namespace
+
+int audioCtxFor(size_t n_samples) {
+    // Limit encoder cross-attention to the actual audio duration.
+    // whisper default: audio_ctx=1500 (= 30s). Each token = 20ms → 50 tok/s.
+    // For a 5s buffer this saves ~83% of encoder attention work over zero-padded silence.
+    int ctx = static_cast<int>(std::ceil(static_cast<float>(n_samples) / 16000.0f * 50.0f));
+    return std::max(ctx, 64); // floor at 64 tokens (~1.3s)
+}
+
+whisper_full_params makeWhisperParams(const WhisperDecodeConfig& cfg, size_t n_samples) {
+    // Use beam search when beam_size > 1, greedy otherwise
+    whisper_full_params params = (cfg.beam_size > 1)
+        ? whisper_full_default_params(WHISPER_SAMPLING_BEAM_SEARCH)
+        : whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+
+    params.language         = cfg.language.c_str();
+    params.n_threads        = cfg.n_threads;
+    params.print_progress   = false;
+    params.print_timestamps = false;
+    params.print_realtime   = false;
+    params.print_special    = false;
+    params.translate        = false;
+    params.single_segment   = false;
+
+    // Each window must be independent to avoid hallucinated context contaminating next window
+    params.no_context       = true;
+    params.suppress_blank   = true;
+    params.suppress_nst     = true;
+
+    if (cfg.beam_size > 1) {
+        params.beam_search.beam_size = cfg.beam_size;
+    }
+
+    params.temperature      = cfg.temperature;
+    params.temperature_inc  = cfg.temperature_inc;
+    params.no_speech_thold  = cfg.no_speech_thold;
+    params.logprob_thold    = cfg.logprob_thold;
+
+    params.audio_ctx = audioCtxFor(n_samples);
+
+    if (cfg.vad_thold > 0.0f) {
+        params.no_speech_thold = cfg.vad_thold;
+    }
+
+    if (!cfg.initial_prompt.empty()) {
+        params.initial_prompt = cfg.initial_prompt.c_str();
+    }
+
+    return params;
+}
+
+void attachLoopWatch(whisper_full_params& params, LoopWatch& watch, whisper_context* ctx) {
+    watch.eot     = whisper_token_eot(ctx);
+    watch.n_vocab = whisper_n_vocab(ctx);
+    params.logits_filter_callback           = loopWatchFilter;
+    params.logits_filter_callback_user_data = &watch;
+}
+
+void attachCancellation(whisper_full_params& params, CancelWatch& watch) {
+    if (!watch.token) return;
+    params.abort_callback                   = cancelAbortCallback;
+    params.abort_callback_user_data         = &watch;
+    params.encoder_begin_callback           = cancelEncoderBegin;
+    params.encoder_begin_callback_user_data = &watch;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+// Forward declarations
+struct whisper_context;
+struct whisper_full_params;
+class CancellationToken;
+
+/**
+ * @brief Decoder settings shared by the streaming and offline paths.
+ *
+ * Defaults match StreamingWhisperEngine's historical defaults.
+ */
+struct WhisperDecodeConfig {
+    std::string language = "es";
+    std::string initial_prompt;
+    int   n_threads       = 4;
+    int   beam_size       = 5;     // 1 = greedy
+    float vad_thold       = 0.0f;  // > 0 overrides no_speech_thold
+    float temperature     = 0.2f;
+    float temperature_inc = 0.2f;
+    float no_speech_thold = 0.3f;
+    float logprob_thold   = -1.0f;
+};
+
+/**
+ * @brief Encoder context (audio_ctx) used for a window of n_samples.
+ *
+ * Encoder cost scales with it, so it is also the input of the decode-cost
+ * model in the scheduler simulator (bench/sim).
+ */
+int audioCtxFor(size_t n_samples);
+
+/**
+ * @brief Build whisper_full_params for one independent window of n_samples.
+ *
+ * String fields point into `cfg`, which must outlive the decode.
+ */
+whisper_full_params makeWhisperParams(const WhisperDecodeConfig& cfg, size_t n_samples);
+
+/**
+ * @brief Per-decode state for the repetition-loop logits filter.
+ *
+ * Attach with attachLoopWatch(); after the decode, `triggered` tells whether a
+ * sequence was cut short because it matched the HallucinationGuard rules.
+ * Written from whisper's decoder threads with beam search, hence the atomics.
+ */
+struct LoopWatch {
+    int               eot     = 0;
+    int               n_vocab = 0;
+    std::atomic<bool> triggered{false};
+    std::atomic<int>  tokens_at_abort{0}; // text tokens (no timestamps) when first cut
+};
+
+/// Install the repetition-loop logits filter on params (watch must outlive the decode).
+void attachLoopWatch(whisper_full_params& params, LoopWatch& watch, whisper_context* ctx);
+
+/**
+ * @brief Per-decode link between a CancellationToken and whisper's callbacks.
+ *
+ * `fired` is set only when a callback actually told whisper to stop, so a decode
+ * that completed on its own just as the token tripped is not taken for an abort.
+ */
+struct CancelWatch {
+    explicit CancelWatch(const CancellationToken* t) : token(t) {}
+    const CancellationToken* token;
+    std::atomic<bool>        fired{false};
+};
+
+/// Wire the watch's token into whisper's abort and encoder-begin callbacks. No-op if null.
+void attachCancellation(whisper_full_params& params, CancelWatch& watch);
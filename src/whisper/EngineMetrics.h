@@ -0,0 +1,94 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "utils/LatencyHistogram.h"
+
+/**
+ * @brief Process-wide counters for StreamingWhisperEngine decodes.
+ *
+ * Lock-free (relaxed atomics): updated from every session's inference path
+ * and read by the /metrics endpoint.
+ */
+class EngineMetrics {
+public:
+    static EngineMetrics& instance() {
+        static EngineMetrics inst;
+        return inst;
+    }
+
+    /// One whisper_full_with_state() call completed (aborted or not).
+    void recordDecode() {
+        decodes_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// A sliding-window decode was skipped: the window matched the last decoded one.
+    void recordDecodeCacheHit() {
+        cache_hits_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief A decode was cut short because the decoder entered a repetition loop.
+     * @param tokens_emitted  Text tokens generated before the loop was detected.
+     * @param tokens_budget   Max tokens the decoder could have generated for the segment.
+     */
+    void recordLoopAbort(int tokens_emitted, int tokens_budget) {
+        loop_aborts_.fetch_add(1, std::memory_order_relaxed);
+        if (tokens_budget > tokens_emitted) {
+            tokens_saved_.fetch_add(static_cast<uint64_t>(tokens_budget - tokens_emitted),
+                                    std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief A decode was stopped through its CancellationToken.
+     * @param by_cancel  true = explicit cancel (session closed, superseded, shutdown);
+     *                   false = deadline exceeded.
+     */
+    void recordCancelled(bool by_cancel) {
+        (by_cancel ? cancelled_ : deadline_exceeded_).fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief An end-of-stream final was delivered.
+     * @param seconds  client-facing time from the `end` message to the final result
+     * @param reused   true if the last partial hypothesis was reused (no decode)
+     */
+    void recordFinal(double seconds, bool reused) {
+        final_latency_.observe(seconds);
+        if (reused) finals_reused_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t loopAborts() const { return loop_aborts_.load(std::memory_order_relaxed); }
+    uint64_t decodeCacheHits() const { return cache_hits_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Get telemetry metrics in Prometheus format
+     */
+    std::string getMetrics() const {
+        return "transcription_decodes_total " + std::to_string(decodes_.load(std::memory_order_relaxed)) + "\n" +
+               "transcription_decode_cache_hits_total " + std::to_string(cache_hits_.load(std::memory_order_relaxed)) + "\n" +
+               "transcription_decode_loop_aborts_total " + std::to_string(loop_aborts_.load(std::memory_order_relaxed)) + "\n" +
+               "transcription_decode_tokens_saved_total " + std::to_string(tokens_saved_.load(std::memory_order_relaxed)) + "\n" +
+               "transcription_decode_cancelled_total " + std::to_string(cancelled_.load(std::memory_order_relaxed)) + "\n" +
+               "transcription_decode_deadline_exceeded_total " + std::to_string(deadline_exceeded_.load(std::memory_order_relaxed)) + "\n" +
+               "transcription_final_reused_total " + std::to_string(finals_reused_.load(std::memory_order_relaxed)) + "\n" +
+               final_latency_.render("transcription_final_latency_seconds");
+    }
+
+    // Non-copyable
+    EngineMetrics(const EngineMetrics&) = delete;
+    EngineMetrics& operator=(const EngineMetrics&) = delete;
+
+private:
+    EngineMetrics() = default;
+
+    std::atomic<uint64_t> decodes_{0};
+    std::atomic<uint64_t> cache_hits_{0};
+    std::atomic<uint64_t> loop_aborts_{0};
+    std::atomic<uint64_t> tokens_saved_{0};
+    std::atomic<uint64_t> cancelled_{0};
+    std::atomic<uint64_t> deadline_exceeded_{0};
+    std::atomic<uint64_t> finals_reused_{0};
+    LatencyHistogram final_latency_{{0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0}};
+};
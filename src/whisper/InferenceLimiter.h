@@ -1,16 +1,32 @@
 #pragma once
+#include <algorithm>
+#include <array>
 #include <mutex>
 #include <condition_variable>
 #include <iostream>
+#include <string>
 
 /**
  * @brief Singleton for limiting concurrent whisper inference calls.
  * 
  * Prevents GPU OOM and massive latency latency spikes by capping
  * the maximum number of simultaneous whisper_full_with_state() executions.
+ *
+ * Slots are handed out by priority (0 = lowest, PRIORITY_LEVELS-1 = highest;
+ * callers pass the client's PriorityTier): a caller never takes a slot while a
+ * higher-priority caller is waiting, and the lowest priority cannot use the
+ * last reserved_slots slots, so low-tier traffic alone never saturates the box.
+ * End-of-stream finals use FINAL_PRIORITY, above every tier: the client is
+ * blocked waiting for them, while a delayed partial only costs freshness.
+ * Live partials never block: they poll with try_acquire and, while due, hold a
+ * WaitMark so they count as waiters of their tier like a blocking caller would.
  */
 class InferenceLimiter {
 public:
+    static constexpr int PRIORITY_LEVELS  = 4;
+    static constexpr int DEFAULT_PRIORITY = 1;
+    static constexpr int FINAL_PRIORITY   = PRIORITY_LEVELS - 1;
+
     static InferenceLimiter& instance() {
         static InferenceLimiter inst;
         return inst;
@@ -28,36 +44,67 @@ public:
         }
     }
 
+    /**
+     * @brief Slots the lowest priority may not take (clamped to max - 1).
+     */
+    void setReservedSlots(int reserved) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        reserved_slots_ = std::max(0, reserved);
+        cv_.notify_all();
+    }
+
     /**
      * @brief Block until an inference slot is available, then claim it.
      */
-    void acquire() {
+    void acquire(int priority = DEFAULT_PRIORITY) {
+        priority = clampPriority(priority);
         std::unique_lock<std::mutex> lock(mutex_);
-        cv_.wait(lock, [this]() { return active_count_ < max_concurrent_; });
+        ++waiting_[priority];
+        cv_.wait(lock, [this, priority]() { return canTake(priority); });
+        --waiting_[priority];
         ++active_count_;
     }
 
     /**
      * @brief Try to acquire an inference slot without blocking.
-     * @return true if a slot was acquired, false if all slots are taken.
+     * @return true if a slot was acquired, false if all slots this priority
+     *         may use are taken (or a higher priority is waiting for one).
      */
-    bool try_acquire() {
+    bool try_acquire(int priority = DEFAULT_PRIORITY) {
+        priority = clampPriority(priority);
         std::lock_guard<std::mutex> lock(mutex_);
-        if (active_count_ < max_concurrent_) {
+        if (canTake(priority)) {
             ++active_count_;
             return true;
         }
+        ++busy_skips_[priority];
         return false;
     }
 
     /**
-     * @brief Release an inference slot, waking up one waiting thread.
+     * @brief Count a polling caller as waiting at `priority` (see WaitMark).
+     */
+    void addWaiter(int priority) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++waiting_[clampPriority(priority)];
+    }
+
+    void removeWaiter(int priority) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        int& w = waiting_[clampPriority(priority)];
+        if (w > 0) --w;
+        cv_.notify_all();
+    }
+
+    /**
+     * @brief Release an inference slot, waking up the waiting threads.
      */
     void release() {
         std::lock_guard<std::mutex> lock(mutex_);
         if (active_count_ > 0) {
             --active_count_;
-            cv_.notify_one();
+            // Waiters have different predicates (priority): wake them all.
+            cv_.notify_all();
         }
     }
 
@@ -66,8 +113,21 @@ public:
      */
     std::string getMetrics() const {
         std::lock_guard<std::mutex> lock(mutex_);
-        return "transcription_active_inferences " + std::to_string(active_count_) + "\n" +
-               "transcription_max_inferences " + std::to_string(max_concurrent_) + "\n";
+        std::string out = "transcription_active_inferences " + std::to_string(active_count_) + "\n" +
+                          "transcription_max_inferences " + std::to_string(max_concurrent_) + "\n" +
+                          "transcription_reserved_inferences " + std::to_string(effectiveReserved()) + "\n";
+        for (int p = 0; p < PRIORITY_LEVELS; ++p) {
+            const std::string label = "{priority=\"" + std::to_string(p) + "\"}";
+            out += "transcription_inference_waiting" + label + " " + std::to_string(waiting_[p]) + "\n";
+            out += "transcription_inference_busy_skips_total" + label + " " + std::to_string(busy_skips_[p]) + "\n";
+        }
+        return out;
+    }
+
+    /// Current concurrency cap (batch callers size their worker pools to it).
+    int maxConcurrency() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return max_concurrent_;
     }
 
     /**
@@ -78,16 +138,66 @@ public:
         return active_count_ < max_concurrent_;
     }
 
+    /**
+     * @brief The slot rule on its own: may a caller of `priority` take a slot now?
+     *
+     * No slot while a higher priority is waiting; the lowest priority leaves
+     * `reserved` slots free (at most max_concurrent - 1). Used by the limiter
+     * and by the scheduler simulator (bench/sim), which runs it on a virtual clock.
+     */
+    static bool admits(int priority, int active, int max_concurrent, int reserved,
+                       const std::array<int, PRIORITY_LEVELS>& waiting) {
+        priority = clampPriority(priority);
+        int limit = (priority == 0) ? max_concurrent - std::min(reserved, max_concurrent - 1) : max_concurrent;
+        if (active >= limit) return false;
+        for (int p = priority + 1; p < PRIORITY_LEVELS; ++p) {
+            if (waiting[p] > 0) return false;
+        }
+        return true;
+    }
+
     // RAII guard for exception-safe acquire/release
     class Guard {
     public:
-        Guard() { InferenceLimiter::instance().acquire(); }
+        explicit Guard(int priority = DEFAULT_PRIORITY) { InferenceLimiter::instance().acquire(priority); }
         ~Guard() { InferenceLimiter::instance().release(); }
         // Non-copyable/movable
         Guard(const Guard&) = delete;
         Guard& operator=(const Guard&) = delete;
     };
 
+    /**
+     * @brief Presence in the queue for a caller that polls with try_acquire.
+     *
+     * A due live partial that finds no slot retries on its next flush cycle
+     * instead of blocking. While marked it counts in waiting_, so blocking
+     * callers of a lower priority (offline workers, free-tier finals) do not
+     * take the slot it is polling for; its own try_acquire is not held back
+     * (only higher priorities are). Cleared on destruction.
+     */
+    class WaitMark {
+    public:
+        WaitMark() = default;
+        ~WaitMark() { clear(); }
+        WaitMark(const WaitMark&) = delete;
+        WaitMark& operator=(const WaitMark&) = delete;
+
+        void set(int priority) {
+            if (priority_ == priority) return;
+            clear();
+            InferenceLimiter::instance().addWaiter(priority);
+            priority_ = priority;
+        }
+        void clear() {
+            if (priority_ < 0) return;
+            InferenceLimiter::instance().removeWaiter(priority_);
+            priority_ = -1;
+        }
+
+    private:
+        int priority_ = -1;
+    };
+
 private:
     InferenceLimiter() = default;
     ~InferenceLimiter() = default;
@@ -96,8 +206,20 @@ private:
     InferenceLimiter(const InferenceLimiter&) = delete;
     InferenceLimiter& operator=(const InferenceLimiter&) = delete;
 
+    static int clampPriority(int p) { return std::clamp(p, 0, PRIORITY_LEVELS - 1); }
+
+    int effectiveReserved() const { return std::min(reserved_slots_, max_concurrent_ - 1); }
+
+    // Caller holds mutex_.
+    bool canTake(int priority) const {
+        return admits(priority, active_count_, max_concurrent_, reserved_slots_, waiting_);
+    }
+
     mutable std::mutex mutex_;
     std::condition_variable cv_;
     int active_count_ = 0;
     int max_concurrent_ = 4; // Default safe limit for a 8GB GPU
+    int reserved_slots_ = 1; // kept free of the lowest priority (needs max_concurrent_ >= 2)
+    std::array<int, PRIORITY_LEVELS> waiting_{};
+    std::array<uint64_t, PRIORITY_LEVELS> busy_skips_{};
 };
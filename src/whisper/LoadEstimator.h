@@ -0,0 +1,163 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Rolling estimate of how busy the inference slots are.
+ *
+ * Every decode (partial, final, offline chunk) reports its wall time and how
+ * long it waited for an inference slot. Over the last `window` this gives the
+ * aggregate load (decode-seconds per wall-second = average busy slots) and the
+ * p90 partial latency (wait + decode), which AdmissionController turns into
+ * an admit / shed decision.
+ *
+ * Thread-safe.
+ */
+class LoadEstimator {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t MAX_SAMPLES = 4096; // oldest dropped beyond this
+
+    struct Snapshot {
+        size_t samples = 0;          // decodes in the window
+        size_t latency_samples = 0;  // partial decodes in the window
+        double span_seconds = 0.0;   // time covered by the samples
+        double busy_seconds = 0.0;   // sum of decode wall times
+        double load = 0.0;           // busy_seconds / span_seconds (average busy slots)
+        double offline_load = 0.0;   // the share of `load` from offline (upload) chunks
+        double queue_wait_p90 = 0.0; // seconds, partial decodes
+        double decode_p90 = 0.0;     // seconds, partial decodes
+        double latency_p90 = 0.0;    // seconds, wait + decode of partial decodes
+    };
+
+    static LoadEstimator& instance() {
+        static LoadEstimator inst;
+        return inst;
+    }
+
+    explicit LoadEstimator(std::chrono::seconds window = std::chrono::seconds(30))
+        : window_(window) {}
+
+    // Non-copyable
+    LoadEstimator(const LoadEstimator&) = delete;
+    LoadEstimator& operator=(const LoadEstimator&) = delete;
+
+    void setWindow(std::chrono::seconds window) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        window_ = window;
+    }
+
+    /**
+     * @brief One decode finished (or was aborted) after holding a slot.
+     * @param latency_sample  true for streaming partials: counted in the
+     *                        latency percentiles the SLO is checked against.
+     */
+    void recordDecode(double decode_seconds, double queue_wait_seconds, bool latency_sample,
+                      Clock::time_point now = Clock::now()) {
+        push(Sample{now, decode_seconds, queue_wait_seconds, latency_sample, false});
+    }
+
+    /// A chunk of an offline upload: slot load, but not the streaming sessions' (see offline_load).
+    void recordOfflineDecode(double decode_seconds, double queue_wait_seconds, Clock::time_point now = Clock::now()) {
+        push(Sample{now, decode_seconds, queue_wait_seconds, false, true});
+    }
+
+    /// Just the aggregate load (average busy slots), O(1): cheap enough to poll per session.
+    double load(Clock::time_point now = Clock::now()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        prune(now);
+        if (samples_.empty()) return 0.0;
+        return std::max(busy_sum_, 0.0) / spanSeconds(now);
+    }
+
+    Snapshot snapshot(Clock::time_point now = Clock::now()) {
+        std::vector<double> waits, decodes, latencies;
+        Snapshot s;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            prune(now);
+            if (samples_.empty()) return s;
+
+            s.samples = samples_.size();
+            s.span_seconds = spanSeconds(now);
+
+            for (const auto& x : samples_) {
+                s.busy_seconds += x.decode;
+                if (x.offline) s.offline_load += x.decode;
+                if (x.latency_sample) {
+                    waits.push_back(x.wait);
+                    decodes.push_back(x.decode);
+                    latencies.push_back(x.wait + x.decode);
+                }
+            }
+        }
+        s.load            = s.busy_seconds / s.span_seconds;
+        s.offline_load    = s.offline_load / s.span_seconds;
+        s.latency_samples = latencies.size();
+        s.queue_wait_p90  = p90(waits);
+        s.decode_p90      = p90(decodes);
+        s.latency_p90     = p90(latencies);
+        return s;
+    }
+
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        samples_.clear();
+        busy_sum_ = 0.0;
+    }
+
+private:
+    struct Sample {
+        Clock::time_point at;
+        double decode;
+        double wait;
+        bool latency_sample;
+        bool offline;
+    };
+
+    void push(const Sample& sample) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        samples_.push_back(sample);
+        busy_sum_ += sample.decode;
+        if (samples_.size() > MAX_SAMPLES) popFront();
+        prune(sample.at);
+    }
+
+    // Caller holds mutex_.
+    void prune(Clock::time_point now) {
+        while (!samples_.empty() && now - samples_.front().at > window_) {
+            popFront();
+        }
+    }
+
+    void popFront() {
+        busy_sum_ -= samples_.front().decode;
+        samples_.pop_front();
+        if (samples_.empty()) busy_sum_ = 0.0; // no drift across idle periods
+    }
+
+    // A sample ends at `at`; the window it covers starts when the oldest decode began.
+    double spanSeconds(Clock::time_point now) const {
+        const auto& oldest = samples_.front();
+        double span = std::chrono::duration<double>(now - oldest.at).count() + oldest.decode;
+        return std::clamp(span, 1.0, std::chrono::duration<double>(window_).count());
+    }
+
+    static double p90(std::vector<double>& v) {
+        if (v.empty()) return 0.0;
+        size_t k = (v.size() * 9) / 10;
+        if (k >= v.size()) k = v.size() - 1;
+        std::nth_element(v.begin(), v.begin() + k, v.end());
+        return v[k];
+    }
+
+    std::mutex mutex_;
+    std::chrono::seconds window_;
+    std::deque<Sample> samples_;
+    double busy_sum_ = 0.0; // sum of samples_[i].decode
+};
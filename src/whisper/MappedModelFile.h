@@ -0,0 +1,104 @@
+#pragma once
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <whisper.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief A GGML model file mapped read-only, fed to whisper through a
+ * whisper_model_loader (MODEL_LOAD=mmap).
+ *
+ * whisper_init_from_file_with_params streams the file through an ifstream:
+ * every byte is read() into a user buffer and copied again into the tensors.
+ * Here the tensors are filled straight from the page cache, and the whole
+ * file is announced with MADV_WILLNEED, so the kernel reads ahead while
+ * whisper parses the header and allocates its buffers — on a cold cache, disk
+ * time overlaps setup instead of following it. The page cache is shared: N
+ * workers (or a restart) loading the same file read it from disk once.
+ *
+ * What this cannot do: whisper copies the weights into its own backend
+ * buffers, so each process still holds a private copy of the tensors (RssAnon).
+ * Consumed ranges are dropped from this mapping as the load advances, so the
+ * mapping adds at most RELEASE_STRIDE to the process's RSS at any time.
+ *
+ * Valid for one load; not thread-safe.
+ */
+class MappedModelFile {
+public:
+    static constexpr size_t RELEASE_STRIDE = 64u << 20;
+
+    /// @throws std::runtime_error if the file cannot be opened or mapped
+    explicit MappedModelFile(const std::string& path) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) throw std::runtime_error("cannot open model " + path + ": " + std::strerror(errno));
+        struct stat st {};
+        if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            throw std::runtime_error("cannot map model " + path + ": empty or unreadable");
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        void* p = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd); // the mapping keeps the file open
+        if (p == MAP_FAILED) throw std::runtime_error("cannot map model " + path + ": " + std::strerror(errno));
+        data_ = static_cast<const char*>(p);
+        ::madvise(p, size_, MADV_SEQUENTIAL);
+        ::madvise(p, size_, MADV_WILLNEED);
+    }
+
+    ~MappedModelFile() {
+        if (data_) ::munmap(const_cast<char*>(data_), size_);
+    }
+
+    MappedModelFile(const MappedModelFile&) = delete;
+    MappedModelFile& operator=(const MappedModelFile&) = delete;
+
+    size_t size() const { return size_; }
+    size_t position() const { return pos_; }
+
+    /// Loader reading from this mapping; must not outlive it.
+    whisper_model_loader loader() {
+        whisper_model_loader l{};
+        l.context = this;
+        l.read    = &MappedModelFile::read;
+        l.eof     = &MappedModelFile::eof;
+        l.close   = &MappedModelFile::close;
+        return l;
+    }
+
+private:
+    static size_t read(void* ctx, void* output, size_t read_size) {
+        auto* self = static_cast<MappedModelFile*>(ctx);
+        const size_t n = std::min(read_size, self->size_ - self->pos_);
+        std::memcpy(output, self->data_ + self->pos_, n);
+        self->pos_ += n;
+        self->releaseConsumed();
+        return n;
+    }
+
+    static bool eof(void* ctx) {
+        auto* self = static_cast<MappedModelFile*>(ctx);
+        return self->pos_ >= self->size_;
+    }
+
+    static void close(void*) {} // unmapped by the destructor
+
+    // Drop pages already copied out of the mapping (they stay in the page cache).
+    void releaseConsumed() {
+        const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        const size_t upto = pos_ / page * page;
+        if (upto - released_ < RELEASE_STRIDE) return;
+        ::madvise(const_cast<char*>(data_) + released_, upto - released_, MADV_DONTNEED);
+        released_ = upto;
+    }
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    size_t pos_ = 0;
+    size_t released_ = 0;
+};
@@ -0,0 +1,231 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "TranscriptionEngine.h"
+#include "CancellationToken.h"
+#include "EngineMetrics.h"
+#include "NumaPlacement.h"
+
+/**
+ * @brief Motor de transcripción sintético: sin modelo, determinista y con latencia configurable.
+ *
+ * Para tests de StreamingSession y pruebas de carga del servidor (scheduler,
+ * flow control, admisión) en máquinas sin modelo ni CPU para whisper.
+ *
+ * - Texto: la "palabra" k ocupa las muestras [k*spw, (k+1)*spw) del stream
+ *   (spw = 16000 / words_per_second), así que el texto depende solo de cuánto
+ *   audio llegó, no del contenido, del troceado en chunks ni del timing.
+ *   Sin vocabulario las palabras son "w0 w1 w2 ...": únicas, para que el
+ *   HallucinationGuard nunca las filtre como repeticiones.
+ * - Latencia: cada decodificación duerme base_latency_ms + latency_ms_per_audio_second
+ *   por segundo de ventana, en pasos cortos que respetan el CancellationToken.
+ * - Buffer: solo cuenta muestras, con el mismo high-water mark, ventana de commit
+ *   (confirma todo menos los últimos 2s), modo bulk y reutilización del último
+ *   parcial que StreamingWhisperEngine.
+ *
+ * Thread-safe.
+ */
+class MockTranscriptionEngine : public TranscriptionEngine {
+public:
+    struct Options {
+        double base_latency_ms = 50.0;              // per decode
+        double latency_ms_per_audio_second = 20.0;  // ... plus this per second of decoded audio
+        double words_per_second = 2.5;
+        size_t commit_window_samples = COMMIT_WINDOW_SAMPLES; // otro valor solo para simular políticas
+        std::vector<std::string> vocabulary;        // word k = vocabulary[k % size]; empty = "w<k>"
+    };
+
+    MockTranscriptionEngine() : MockTranscriptionEngine(Options{}) {}
+    explicit MockTranscriptionEngine(Options opt)
+        : opt_(std::move(opt)),
+          samples_per_word_(static_cast<uint64_t>(16000.0 / std::max(opt_.words_per_second, 0.01))) {}
+
+    // No copiable
+    MockTranscriptionEngine(const MockTranscriptionEngine&) = delete;
+    MockTranscriptionEngine& operator=(const MockTranscriptionEngine&) = delete;
+
+    bool processAudioChunk(const std::vector<float>& pcm_data) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (size_ >= HIGH_WATER_MARK_SAMPLES) {
+            return true;
+        }
+        hypothesis_.reset();
+        size_ += pcm_data.size();
+        if (size_ > MAX_BUFFER_SAMPLES) { // same 30s hard cap as the real buffer
+            start_ += size_ - MAX_BUFFER_SAMPLES;
+            size_ = MAX_BUFFER_SAMPLES;
+        }
+        return false;
+    }
+
+    TranscribeResult transcribeSlidingWindow(bool force_commit = false,
+                                             const CancellationToken* cancel = nullptr) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        TranscribeResult res;
+        if (size_ == 0) {
+            return res;
+        }
+
+        const uint64_t end = start_ + size_;
+        if (decoded_start_ == start_ && decoded_end_ == end) {
+            EngineMetrics::instance().recordDecodeCacheHit();
+        } else {
+            if (!simulateDecode(size_, cancel, res)) {
+                return res;
+            }
+            decoded_start_ = start_;
+            decoded_end_   = end;
+        }
+        hypothesis_.reset();
+
+        if (force_commit) {
+            res.committed_text = words(start_, end);
+            erase(size_);
+            return res;
+        }
+
+        if (size_ >= opt_.commit_window_samples && size_ > 32000) {
+            // Commit whole words ending before the last 2s; the rest stays as the overlap.
+            const uint64_t cut = wordFloor(end - 32000);
+            if (cut > start_) {
+                res.committed_text = words(start_, cut);
+                res.partial_text   = words(cut, end);
+                erase(static_cast<size_t>(cut - start_));
+            } else {
+                // No word boundary in the window (words_per_second < 0.125): keep draining.
+                erase(size_ - 32000);
+            }
+            return res;
+        }
+
+        res.partial_text = words(start_, end);
+        hypothesis_ = res.partial_text;
+        return res;
+    }
+
+    TranscribeResult transcribeBulkChunk(const CancellationToken* cancel = nullptr) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        TranscribeResult res;
+        if (size_ == 0) {
+            return res;
+        }
+
+        // Cut at the last word boundary in the chunk, as SilenceSplitter cuts at a pause.
+        const size_t chunk = std::min(size_, BULK_MAX_CHUNK_SAMPLES);
+        uint64_t cut = wordFloor(start_ + chunk);
+        if (cut <= start_) cut = start_ + chunk;
+
+        if (!simulateDecode(static_cast<size_t>(cut - start_), cancel, res)) {
+            return res;
+        }
+        res.committed_text = words(start_, cut);
+        hypothesis_.reset();
+        erase(static_cast<size_t>(cut - start_));
+        return res;
+    }
+
+    std::optional<std::string> takeFreshHypothesis() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!hypothesis_ || size_ == 0) {
+            return std::nullopt;
+        }
+        std::optional<std::string> text = std::move(hypothesis_);
+        hypothesis_.reset();
+        erase(size_);
+        return text;
+    }
+
+    void reset(size_t keep_samples = 0) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        hypothesis_.reset();
+        erase(keep_samples == 0 || keep_samples >= size_ ? size_ : size_ - keep_samples);
+    }
+
+    size_t getBufferSize() const override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return size_;
+    }
+
+    // No guarda el audio: informa lo que reserva el motor real (30s), para que la
+    // contabilidad de memoria de una prueba de carga con mock sea realista.
+    size_t bufferBytes() const override { return MAX_BUFFER_SAMPLES * sizeof(float); }
+
+    // Decode parameters do not change the synthetic text.
+    void setLanguage(const std::string&) override {}
+    void setThreads(int) override {}
+    void setBeamSize(int) override {}
+    void setInitialPrompt(const std::string&) override {}
+    void setVadThreshold(float) override {}
+    void setTemperature(float) override {}
+    void setTemperatureInc(float) override {}
+    void setNoSpeechThreshold(float) override {}
+    void setLogprobThreshold(float) override {}
+
+    bool isReady() const override { return true; }
+
+    /// Text the mock produces for stream samples [from, to): words that start in the range.
+    std::string textFor(uint64_t from, uint64_t to) const {
+        return words(from, to);
+    }
+
+    const Options& options() const { return opt_; }
+
+private:
+    static constexpr size_t MAX_BUFFER_SAMPLES = 16000 * 30;
+
+    // Sleep for the configured decode time (caller holds mutex_, as a real decode
+    // holds the buffer). Returns false (res.cancelled set) if the token stopped it.
+    bool simulateDecode(size_t n_samples, const CancellationToken* cancel, TranscribeResult& res) const {
+        using Clock = std::chrono::steady_clock;
+        const double ms = opt_.base_latency_ms + opt_.latency_ms_per_audio_second * (n_samples / 16000.0);
+        const auto until = Clock::now() + std::chrono::microseconds(static_cast<int64_t>(ms * 1000.0));
+        for (auto now = Clock::now(); now < until; now = Clock::now()) {
+            if (cancel && cancel->shouldStop()) {
+                EngineMetrics::instance().recordCancelled(cancel->isCancelled());
+                res.cancelled = true;
+                return false;
+            }
+            std::this_thread::sleep_for(std::min<Clock::duration>(until - now, std::chrono::milliseconds(5)));
+        }
+        EngineMetrics::instance().recordDecode();
+        // Sin modelo: cuenta para el throughput por nodo, nunca como acceso remoto.
+        NumaPlacement::instance().recordDecode(nullptr, n_samples / 16000.0, ms / 1000.0);
+        return true;
+    }
+
+    // Last word boundary at or before stream position `pos`.
+    uint64_t wordFloor(uint64_t pos) const { return pos / samples_per_word_ * samples_per_word_; }
+
+    // Words starting in [from, to). A word cut by `to` is included, as whisper would
+    // transcribe it; commits cut at word boundaries, so no word is emitted twice.
+    std::string words(uint64_t from, uint64_t to) const {
+        std::string out;
+        for (uint64_t k = (from + samples_per_word_ - 1) / samples_per_word_; k * samples_per_word_ < to; ++k) {
+            out += ' ';
+            out += opt_.vocabulary.empty() ? "w" + std::to_string(k)
+                                           : opt_.vocabulary[k % opt_.vocabulary.size()];
+        }
+        return out;
+    }
+
+    void erase(size_t n) {
+        n = std::min(n, size_);
+        start_ += n;
+        size_  -= n;
+    }
+
+    Options  opt_;
+    uint64_t samples_per_word_;
+
+    mutable std::mutex mutex_;
+    uint64_t start_ = 0;   // stream position of the first buffered sample
+    size_t   size_  = 0;   // buffered samples (the audio itself is not kept)
+    uint64_t decoded_start_ = 0, decoded_end_ = 0; // window of the last decode
+    std::optional<std::string> hypothesis_;
+};
@@ -1,11 +1,26 @@
 #pragma once
 #include <string>
+#include <chrono>
+#include <cstdint>
 #include <mutex>
+#include <stdexcept>
 #include <thread>
 #include <atomic>
+#include <algorithm>
+#include <filesystem>
 #include <functional>
 #include <iostream>
+#include <memory>
+#include <vector>
 #include <whisper.h>
+#include "WhisperStatePool.h"
+#include "NumaPlacement.h"
+#include "MappedModelFile.h"
+#include "utils/ProcessMemory.h"
+#include "log/Log.h"
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
 
 /**
  * @brief Singleton cache for the whisper model context.
@@ -18,14 +33,54 @@
  *
  * Sessions create their own whisper_state via whisper_init_state() for
  * thread-safe concurrent inference on the shared (read-only) model weights.
+ * Batch callers (offline /v1/transcribe) borrow states from statePool() instead.
+ *
+ * With NUMA_PLACEMENT=replicate there is one cache per NUMA node (replica(n),
+ * instance() being replica 0), each loading its own copy of the weights on its
+ * node; sessions use the replica of the node they were placed on.
+ *
+ * MODEL_LOAD picks how the file is read: `read` (whisper's own ifstream) or
+ * `mmap` (MappedModelFile). Every load is timed and its RSS cost recorded.
  */
 class ModelCache {
 public:
+    enum class LoadMode { Read, Mmap };
+
+    /// @throws std::invalid_argument
+    static LoadMode parseLoadMode(const std::string& s) {
+        if (s == "read") return LoadMode::Read;
+        if (s == "mmap") return LoadMode::Mmap;
+        throw std::invalid_argument("model load mode must be read or mmap: " + s);
+    }
+
+    static const char* loadModeName(LoadMode m) { return m == LoadMode::Mmap ? "mmap" : "read"; }
+
     static ModelCache& instance() {
         static ModelCache inst;
         return inst;
     }
 
+    /**
+     * @brief Cache for NUMA node index `node` (0 = instance()). Created on first use
+     * with instance()'s TTL and idle-state settings.
+     */
+    static ModelCache& replica(int node) {
+        if (node <= 0) return instance();
+        auto& registry = replicas();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        if (registry.caches.size() < static_cast<size_t>(node)) registry.caches.resize(node);
+        auto& r = registry.caches[node - 1];
+        if (!r) {
+            r.reset(new ModelCache());
+            r->node_ = node;
+            std::lock_guard<std::mutex> base(instance().mutex_);
+            r->ttl_seconds_ = instance().ttl_seconds_;
+            r->max_idle_states_ = instance().max_idle_states_;
+            r->load_mode_ = instance().load_mode_;
+        }
+        return *r;
+    }
+
     /**
      * @brief Configure the cache before first use.
      * @param ttl_seconds  Seconds to keep the model after the last release().
@@ -62,6 +117,8 @@ public:
         // Different model requested while one is loaded — unload first
         if (ctx_) {
             std::cout << "[ModelCache] Unloading previous model: " << loaded_path_ << std::endl;
+            pool_.reset();
+            NumaPlacement::instance().unregisterModel(ctx_);
             whisper_free(ctx_);
             ctx_ = nullptr;
             loaded_path_.clear();
@@ -73,17 +130,118 @@ public:
         cparams.use_gpu    = use_gpu;
         cparams.flash_attn = true;
 
-        ctx_ = whisper_init_from_file_with_params(model_path.c_str(), cparams);
+        // A replica is loaded on its node: weights and the probe state are first
+        // touched by a thread pinned there, with memory preferring that node.
+        auto& numa = NumaPlacement::instance();
+        std::unique_ptr<NumaPlacement::ScopedLoad> placement;
+        if (numa.mode() == NumaPlacement::Mode::Replicate) {
+            placement = std::make_unique<NumaPlacement::ScopedLoad>(numa, node_);
+        }
+
+        const auto t0 = std::chrono::steady_clock::now();
+        const procmem::Usage rss0 = procmem::read();
+        const size_t heap0 = heapBytes();
+        if (load_mode_ == LoadMode::Mmap) {
+            try {
+                MappedModelFile file(model_path);
+                whisper_model_loader loader = file.loader();
+                ctx_ = whisper_init_with_params(&loader, cparams);
+            } catch (const std::runtime_error& e) {
+                throw std::runtime_error(std::string("[ModelCache] ") + e.what());
+            }
+        } else {
+            ctx_ = whisper_init_from_file_with_params(model_path.c_str(), cparams);
+        }
         if (!ctx_) {
             throw std::runtime_error("[ModelCache] Failed to load whisper model: " + model_path);
         }
+        const size_t heap1 = heapBytes();
+        // After the mapping is gone: what the weights cost this process for good.
+        const procmem::Usage rss1 = procmem::read();
+        load_seconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        load_rss_bytes_ = rss1.rss > rss0.rss ? rss1.rss - rss0.rss : 0;
+        ++loads_total_;
+        last_load_mode_ = load_mode_;
 
         loaded_path_ = model_path;
         ref_count_ = 1;
-        std::cout << "[ModelCache] Model loaded successfully" << std::endl;
+        pool_ = std::make_unique<WhisperStatePool>(ctx_, max_idle_states_);
+
+        // Size one whisper_state (KV caches + compute buffers) for MemoryBudget; the
+        // probe is not wasted, it becomes the pool's first idle state.
+        whisper_state* probe = pool_->acquire();
+        const size_t heap2 = heapBytes();
+        pool_->release(probe);
+        model_bytes_ = heap1 > heap0 ? heap1 - heap0 : 0;
+        state_bytes_ = heap2 > heap1 ? heap2 - heap1 : 0;
+        // The heap counters are process-wide: a session freeing memory during the load
+        // (or no mallinfo2) leaves a delta of 0, and the budget would count the model as free.
+        if (model_bytes_ == 0 || state_bytes_ == 0) {
+            std::error_code ec;
+            const auto file_size = std::filesystem::file_size(model_path, ec);
+            const size_t file_bytes = ec ? 0 : static_cast<size_t>(file_size);
+            Log::warn("[ModelCache] Heap delta of the load not usable (weights " + std::to_string(model_bytes_ >> 20) +
+                      " MB, state " + std::to_string(state_bytes_ >> 20) +
+                      " MB); falling back to estimates from the file size (" + std::to_string(file_bytes >> 20) + " MB)");
+            if (model_bytes_ == 0) model_bytes_ = estimateModelBytes(file_bytes);
+            if (state_bytes_ == 0) state_bytes_ = estimateStateBytes(file_bytes);
+        }
+
+        const int home = placement ? node_ : numa.currentNode();
+        numa.registerModel(ctx_, home);
+
+        std::cout << "[ModelCache] Model loaded successfully in " << static_cast<int>(load_seconds_ * 1000)
+                  << " ms via " << loadModeName(load_mode_) << " (weights " << (model_bytes_ >> 20)
+                  << " MB, state " << (state_bytes_ >> 20) << " MB in host memory, RSS +"
+                  << (load_rss_bytes_ >> 20) << " MB";
+        if (home >= 0 && numa.nodeCount() > 1) {
+            std::cout << ", NUMA node index " << home
+                      << (placement && placement->memoryBound() ? " (memory bound)" : "");
+        }
+        std::cout << ")" << std::endl;
         return ctx_;
     }
 
+    /**
+     * @brief Pool of reusable whisper_states for the loaded model.
+     *
+     * Only valid while the caller holds a reference from acquire(); null if
+     * no model is loaded.
+     */
+    WhisperStatePool* statePool() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pool_.get();
+    }
+
+    /// Idle whisper_states kept by statePool() (applies from the next model load).
+    void setMaxIdleStates(size_t n) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        max_idle_states_ = n;
+    }
+
+    /// How the next load reads the model file.
+    void setLoadMode(LoadMode mode) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        load_mode_ = mode;
+    }
+
+    LoadMode loadMode() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return load_mode_;
+    }
+
+    /// Wall time of the last load (0 before the first).
+    double loadSeconds() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return load_seconds_;
+    }
+
+    /// Process RSS growth over the last load of the weights (0 before the first).
+    size_t loadRssBytes() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return load_rss_bytes_;
+    }
+
     /**
      * @brief Release a reference to the model.
      *
@@ -122,6 +280,46 @@ public:
         return ref_count_;
     }
 
+    /// Upper-bound fallbacks when the load cannot be measured: the weights are
+    /// at most the file (quantized or not, whisper keeps the file's types), and a
+    /// state (KV caches + compute buffers) is taken as a quarter of it, 64 MB at least.
+    static constexpr size_t STATE_ESTIMATE_MIN_BYTES = 64u << 20;
+    static size_t estimateModelBytes(size_t file_bytes) { return file_bytes; }
+    static size_t estimateStateBytes(size_t file_bytes) {
+        return std::max(STATE_ESTIMATE_MIN_BYTES, file_bytes / 4);
+    }
+
+    /// Host memory of the loaded weights, measured at load (estimated if not measurable; 0 if not loaded).
+    size_t modelBytes() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return ctx_ ? model_bytes_ : 0;
+    }
+
+    /// Host memory of one whisper_state for the loaded model, measured at load (or estimated).
+    size_t stateBytes() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return ctx_ ? state_bytes_ : 0;
+    }
+
+    /// Memory held on behalf of no particular session: weights plus idle pooled states
+    /// (a leased state is charged to the upload holding it).
+    size_t sharedBytes() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!ctx_) return 0;
+        return model_bytes_ + (pool_ ? pool_->idleCount() : 0) * state_bytes_;
+    }
+
+    /// sharedBytes() of instance() and every replica: each node holds its own weights.
+    static size_t totalSharedBytes() {
+        size_t total = instance().sharedBytes();
+        auto& registry = replicas();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (const auto& r : registry.caches) {
+            if (r) total += r->sharedBytes();
+        }
+        return total;
+    }
+
     /// Whether a model is currently loaded.
     bool isLoaded() const {
         std::lock_guard<std::mutex> lock(mutex_);
@@ -134,7 +332,14 @@ public:
     std::string getMetrics() const {
         std::lock_guard<std::mutex> lock(mutex_);
         return "transcription_model_loaded " + std::to_string(ctx_ ? 1 : 0) + "\n" +
-               "transcription_model_ref_count " + std::to_string(ref_count_) + "\n";
+               "transcription_model_ref_count " + std::to_string(ref_count_) + "\n" +
+               "transcription_model_idle_states " + std::to_string(pool_ ? pool_->idleCount() : 0) + "\n" +
+               "transcription_model_bytes " + std::to_string(ctx_ ? model_bytes_ : 0) + "\n" +
+               "transcription_model_state_bytes " + std::to_string(ctx_ ? state_bytes_ : 0) + "\n" +
+               "transcription_model_loads_total " + std::to_string(loads_total_) + "\n" +
+               "transcription_model_load_seconds{mode=\"" + loadModeName(last_load_mode_) + "\"} " +
+               std::to_string(load_seconds_) + "\n" +
+               "transcription_model_load_rss_bytes " + std::to_string(load_rss_bytes_) + "\n";
     }
 
     // Non-copyable
@@ -143,6 +348,7 @@ public:
 
     ~ModelCache() {
         cancelUnloadLocked();
+        pool_.reset();
         if (ctx_) {
             whisper_free(ctx_);
             ctx_ = nullptr;
@@ -152,9 +358,32 @@ public:
 private:
     ModelCache() = default;
 
+    // Caches of nodes 1..N (node 0 is instance()); lock order: registry, then a cache.
+    struct Replicas {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ModelCache>> caches;
+    };
+    static Replicas& replicas() {
+        static Replicas registry;
+        return registry;
+    }
+
+    // Bytes handed out by the C allocator (glibc only, 0 elsewhere). ggml's CPU buffers
+    // come from malloc, so a delta around a load measures it; GPU buffers are not seen.
+    static size_t heapBytes() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+        struct mallinfo2 mi = mallinfo2();
+        return mi.uordblks + mi.hblkhd;
+#else
+        return 0;
+#endif
+    }
+
     void unloadLocked() {
         if (ctx_) {
             std::cout << "[ModelCache] Unloading model: " << loaded_path_ << std::endl;
+            pool_.reset();
+            NumaPlacement::instance().unregisterModel(ctx_);
             whisper_free(ctx_);
             ctx_ = nullptr;
             loaded_path_.clear();
@@ -186,7 +415,17 @@ private:
 
     mutable std::mutex mutex_;
     whisper_context* ctx_ = nullptr;
+    std::unique_ptr<WhisperStatePool> pool_; // freed before ctx_
+    size_t max_idle_states_ = 4;
     std::string loaded_path_;
+    int node_ = 0;           // NUMA node index this replica is placed on
+    size_t model_bytes_ = 0; // host memory of the weights, measured at load
+    size_t state_bytes_ = 0; // ... and of one whisper_state
+    LoadMode load_mode_ = LoadMode::Read;
+    LoadMode last_load_mode_ = LoadMode::Read;
+    double load_seconds_ = 0.0;   // last load, wall time
+    size_t load_rss_bytes_ = 0;   // last load, RSS growth
+    uint64_t loads_total_ = 0;
     int ref_count_ = 0;
     int ttl_seconds_ = 300; // default 5 minutes
     std::atomic<bool> unload_pending_{false};
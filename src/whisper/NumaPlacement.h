@@ -0,0 +1,303 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "utils/NumaTopology.h"
+#include "log/Log.h"
+
+/**
+ * @brief Where inference runs on a multi-socket box (NUMA_PLACEMENT).
+ *
+ *  - off:       threads go wherever the scheduler puts them; decodes are still
+ *               attributed to the node they started on, to measure the problem.
+ *  - pin:       each session is leased the node with the fewest sessions and its
+ *               decoding threads are pinned to that node's CPUs (whisper's worker
+ *               threads inherit the mask). One model, loaded where the first
+ *               session ran.
+ *  - replicate: as pin, plus one model replica per node (ModelCache::replica),
+ *               loaded by a thread pinned to the node with its memory policy
+ *               preferring that node, so weights are local to the sessions
+ *               routed there.
+ *
+ * Nodes are addressed by index into the topology (replica i lives on node i);
+ * metrics carry the kernel node id. A decode is "remote" when the thread that
+ * ran it and the model it read belong to different nodes — a proxy for
+ * cross-socket traffic, without hardware counters.
+ *
+ * Thread-safe.
+ */
+class NumaPlacement {
+public:
+    enum class Mode { Off, Pin, Replicate };
+
+    /// @throws std::invalid_argument
+    static Mode parseMode(const std::string& s) {
+        if (s == "off") return Mode::Off;
+        if (s == "pin") return Mode::Pin;
+        if (s == "replicate") return Mode::Replicate;
+        throw std::invalid_argument("NUMA placement must be off, pin or replicate: " + s);
+    }
+
+    static const char* modeName(Mode m) {
+        switch (m) {
+            case Mode::Pin:       return "pin";
+            case Mode::Replicate: return "replicate";
+            default:              return "off";
+        }
+    }
+
+    static NumaPlacement& instance() {
+        static NumaPlacement inst;
+        return inst;
+    }
+
+    NumaPlacement() = default;
+
+    // Non-copyable
+    NumaPlacement(const NumaPlacement&) = delete;
+    NumaPlacement& operator=(const NumaPlacement&) = delete;
+
+    /// Set mode and topology; counters start over.
+    void configure(Mode mode, numa::Topology topology) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        mode_ = mode;
+        topology_ = std::move(topology);
+        nodes_.assign(topology_.nodes.size(), NodeStats{});
+        pin_failed_ = false;
+    }
+
+    Mode mode() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return mode_;
+    }
+
+    size_t nodeCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return topology_.nodes.size();
+    }
+
+    /**
+     * @brief A session's node, held for the session's lifetime.
+     */
+    class Lease {
+    public:
+        Lease(NumaPlacement& p, int node, bool replicate) : placement_(p), node_(node), replicate_(replicate) {}
+        ~Lease() { placement_.leave(node_); }
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        int node() const { return node_; }
+        /// ModelCache replica to use: the node's own in replicate mode, else the single model.
+        int replica() const { return replicate_ ? node_ : 0; }
+
+    private:
+        NumaPlacement& placement_;
+        int node_;
+        bool replicate_;
+    };
+
+    /// Lease the node with the fewest sessions (lowest index on ties); nullptr when off.
+    std::unique_ptr<Lease> assign() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (mode_ == Mode::Off || nodes_.empty()) return nullptr;
+        size_t best = 0;
+        for (size_t i = 1; i < nodes_.size(); ++i) {
+            if (nodes_[i].sessions < nodes_[best].sessions) best = i;
+        }
+        ++nodes_[best].sessions;
+        return std::make_unique<Lease>(*this, static_cast<int>(best), mode_ == Mode::Replicate);
+    }
+
+    /**
+     * @brief Pin the calling thread to a node's CPUs. Threads it creates afterwards
+     * (whisper's compute workers) inherit the mask. Failure is logged once and
+     * the thread keeps running unpinned.
+     */
+    void pinCurrentThread(int node) {
+        std::vector<int> cpus;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (node < 0 || static_cast<size_t>(node) >= topology_.nodes.size()) return;
+            cpus = topology_.nodes[node].cpus;
+        }
+        if (numa::pinCurrentThread(cpus)) {
+            pinnedSlot() = node;
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!pin_failed_) {
+            pin_failed_ = true;
+            Log::warn("NUMA: could not pin to node " + std::to_string(topology_.nodes[node].id) +
+                      " CPUs (not in this process's affinity mask?) — running unpinned");
+        }
+    }
+
+    /// Node the calling thread was pinned to, or -1.
+    static int pinnedNode() { return pinnedSlot(); }
+
+    /// Node the calling thread runs on: its pinned node, else the node of its current CPU.
+    int currentNode() const {
+        if (pinnedSlot() >= 0) return pinnedSlot();
+        const int cpu = numa::currentCpu();
+        std::lock_guard<std::mutex> lock(mutex_);
+        return indexOfCpuLocked(cpu);
+    }
+
+    /**
+     * @brief Pins the calling thread to a node for a scope, for work that runs on a
+     * borrowed thread (an upload on the HTTP thread); the previous affinity mask
+     * and pinned node are restored on destruction.
+     */
+    class ScopedPin {
+    public:
+        ScopedPin(NumaPlacement& p, int node) : saved_cpus_(numa::currentAffinity()), saved_pin_(pinnedSlot()) {
+            p.pinCurrentThread(node);
+        }
+        ~ScopedPin() {
+            if (!saved_cpus_.empty()) numa::pinCurrentThread(saved_cpus_);
+            pinnedSlot() = saved_pin_;
+        }
+
+        ScopedPin(const ScopedPin&) = delete;
+        ScopedPin& operator=(const ScopedPin&) = delete;
+
+    private:
+        std::vector<int> saved_cpus_;
+        int saved_pin_;
+    };
+
+    /**
+     * @brief Load-time placement of a replica: pins the loading thread to the node
+     * and prefers its memory for new pages; both undone on destruction.
+     * Memory policy is skipped for a simulated topology (the nodes do not exist).
+     */
+    class ScopedLoad {
+    public:
+        ScopedLoad(NumaPlacement& p, int node) : pin_(p, node) {
+            bool simulated;
+            {
+                std::lock_guard<std::mutex> lock(p.mutex_);
+                simulated = p.topology_.simulated;
+                if (node >= 0 && static_cast<size_t>(node) < p.topology_.nodes.size()) {
+                    kernel_node_ = p.topology_.nodes[node].id;
+                }
+            }
+            if (!simulated && kernel_node_ >= 0) policy_set_ = numa::preferNode(kernel_node_);
+        }
+        ~ScopedLoad() {
+            if (policy_set_) numa::preferNode(-1);
+        }
+
+        ScopedLoad(const ScopedLoad&) = delete;
+        ScopedLoad& operator=(const ScopedLoad&) = delete;
+
+        /// Whether the memory policy was applied (real topology, kernel accepted it).
+        bool memoryBound() const { return policy_set_; }
+
+    private:
+        ScopedPin pin_;
+        int kernel_node_ = -1;
+        bool policy_set_ = false;
+    };
+
+    /// A model (context) now lives on `node` (-1 = unknown).
+    void registerModel(const void* ctx, int node) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        models_[ctx] = node;
+    }
+
+    void unregisterModel(const void* ctx) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        models_.erase(ctx);
+    }
+
+    /// One finished decode on `ctx`, run by the calling thread.
+    void recordDecode(const void* ctx, double audio_seconds, double decode_seconds) {
+        const int pinned = pinnedSlot();
+        const int cpu = pinned >= 0 ? -1 : numa::currentCpu();
+        std::lock_guard<std::mutex> lock(mutex_);
+        const int node = pinned >= 0 ? pinned : indexOfCpuLocked(cpu);
+        if (node < 0 || static_cast<size_t>(node) >= nodes_.size()) return;
+        NodeStats& s = nodes_[node];
+        ++s.decodes;
+        s.audio_seconds += audio_seconds;
+        s.decode_seconds += decode_seconds;
+        auto it = models_.find(ctx);
+        if (it != models_.end() && it->second >= 0 && it->second != node) ++s.remote_decodes;
+    }
+
+    /// Share of decodes that read a model on another node (0 with no decodes).
+    double remoteRatio() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t total = 0, remote = 0;
+        for (const auto& s : nodes_) {
+            total += s.decodes;
+            remote += s.remote_decodes;
+        }
+        return total ? static_cast<double>(remote) / static_cast<double>(total) : 0.0;
+    }
+
+    /**
+     * @brief Get telemetry metrics in Prometheus format
+     */
+    std::string getMetrics() const {
+        const double ratio = remoteRatio();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (nodes_.empty()) return "";
+        std::string out = "transcription_numa_nodes " + std::to_string(nodes_.size()) + "\n" +
+                          "transcription_numa_models " + std::to_string(models_.size()) + "\n" +
+                          "transcription_numa_remote_ratio " + std::to_string(ratio) + "\n";
+        for (size_t i = 0; i < nodes_.size(); ++i) {
+            const std::string label = "{node=\"" + std::to_string(topology_.nodes[i].id) + "\"} ";
+            const NodeStats& s = nodes_[i];
+            out += "transcription_numa_sessions" + label + std::to_string(s.sessions) + "\n" +
+                   "transcription_numa_decodes_total" + label + std::to_string(s.decodes) + "\n" +
+                   "transcription_numa_remote_decodes_total" + label + std::to_string(s.remote_decodes) + "\n" +
+                   "transcription_numa_audio_seconds_total" + label + std::to_string(s.audio_seconds) + "\n" +
+                   "transcription_numa_decode_seconds_total" + label + std::to_string(s.decode_seconds) + "\n";
+        }
+        return out;
+    }
+
+private:
+    struct NodeStats {
+        int      sessions = 0;
+        uint64_t decodes = 0;
+        uint64_t remote_decodes = 0;
+        double   audio_seconds = 0.0;
+        double   decode_seconds = 0.0;
+    };
+
+    static int& pinnedSlot() {
+        thread_local int node = -1;
+        return node;
+    }
+
+    int indexOfCpuLocked(int cpu) const {
+        const int id = topology_.nodeOfCpu(cpu);
+        for (size_t i = 0; i < topology_.nodes.size(); ++i) {
+            if (topology_.nodes[i].id == id) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    void leave(int node) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (node >= 0 && static_cast<size_t>(node) < nodes_.size() && nodes_[node].sessions > 0) {
+            --nodes_[node].sessions;
+        }
+    }
+
+    mutable std::mutex mutex_;
+    Mode mode_ = Mode::Off;
+    numa::Topology topology_;
+    std::vector<NodeStats> nodes_;
+    std::unordered_map<const void*, int> models_;
+    bool pin_failed_ = false;
+};
@@ -0,0 +1,169 @@
+#include "OfflineTranscriber.h"
+#include <whisper.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include "CancellationToken.h"
+#include "EngineMetrics.h"
+#include "InferenceLimiter.h"
+#include "LoadEstimator.h"
+#include "NumaPlacement.h"
+#include "WhisperStatePool.h"
+#include "log/Log.h"
+#include "utils/AudioPreprocessor.h"
+
+namespace {
+
+bool isBlank(const std::string& s) {
+    return s.find_first_not_of(" \t\r\n") == std::string::npos;
+}
+
+} // namespace
+
+OfflineTranscriber::OfflineTranscriber(WhisperStatePool& pool, Options opts)
+    : pool_(pool), opts_(std::move(opts)) {}
+
+int OfflineTranscriber::defaultParallelism() {
+    return std::max(InferenceLimiter::instance().maxConcurrency() - 1, 1);
+}
+
+OfflineTranscriber::Result OfflineTranscriber::transcribe(const std::vector<float>& pcm,
+                                                          const CancellationToken* cancel) const {
+    const auto t_start = std::chrono::steady_clock::now();
+    whisper_context* ctx = pool_.context();
+
+    Result res;
+    res.audio_seconds = static_cast<double>(pcm.size()) / 16000.0;
+    res.language      = opts_.decode.language;
+
+    const std::vector<SilenceSplitter::Chunk> chunks = SilenceSplitter::split(pcm, opts_.split);
+    res.chunks = chunks.size();
+
+    std::vector<size_t> speech;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        if (chunks[i].speech) speech.push_back(i);
+    }
+    res.chunks_decoded = speech.size();
+
+    int max_parallel = opts_.max_parallel > 0 ? opts_.max_parallel : defaultParallelism();
+    res.workers = static_cast<int>(std::min<size_t>(speech.size(), std::max(max_parallel, 1)));
+
+    std::vector<std::vector<Segment>> per_chunk(speech.size());
+    std::vector<std::string> detected(speech.size());
+
+    // Child token: the first failing worker cancels its siblings.
+    CancellationToken job(cancel);
+    std::atomic<size_t> next{0};
+    std::atomic<bool> aborted{false}; // a chunk was skipped or cut short
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    // Workers decode on the caller's node: pinned there, they read its model replica.
+    const int numa_node = NumaPlacement::pinnedNode();
+    auto worker = [&]() {
+        if (numa_node >= 0) NumaPlacement::instance().pinCurrentThread(numa_node);
+        try {
+            for (size_t k; (k = next.fetch_add(1)) < speech.size();) {
+                if (job.shouldStop()) {
+                    aborted = true;
+                    return;
+                }
+                const SilenceSplitter::Chunk& c = chunks[speech[k]];
+
+                std::vector<float> audio(pcm.begin() + c.offset, pcm.begin() + c.offset + c.length);
+                float hp_prev_raw = 0.0f, hp_prev_filtered = 0.0f;
+                AudioPreprocessor::process(audio, hp_prev_raw, hp_prev_filtered);
+
+                auto wait_start = std::chrono::steady_clock::now();
+                InferenceLimiter::Guard limit_guard(opts_.priority);
+                WhisperStatePool::Lease state(pool_);
+                auto decode_start = std::chrono::steady_clock::now();
+
+                whisper_full_params params = makeWhisperParams(opts_.decode, audio.size());
+                LoopWatch loop_watch;
+                attachLoopWatch(params, loop_watch, ctx);
+                CancelWatch cancel_watch(&job);
+                attachCancellation(params, cancel_watch);
+
+                int result = whisper_full_with_state(ctx, state.get(), params, audio.data(), audio.size());
+                const double decode_seconds =
+                    std::chrono::duration<double>(std::chrono::steady_clock::now() - decode_start).count();
+                // Offline chunks count towards the slot load, not the partial-latency percentiles.
+                LoadEstimator::instance().recordOfflineDecode(
+                    decode_seconds, std::chrono::duration<double>(decode_start - wait_start).count());
+                const int n_segments = whisper_full_n_segments_from_state(state.get());
+
+                if (cancel_watch.fired.load() && (result != 0 || n_segments == 0)) {
+                    if (cancel && cancel->shouldStop()) {
+                        EngineMetrics::instance().recordCancelled(cancel->isCancelled());
+                    }
+                    aborted = true;
+                    return;
+                }
+                EngineMetrics::instance().recordDecode();
+                NumaPlacement::instance().recordDecode(ctx, static_cast<double>(audio.size()) / 16000.0, decode_seconds);
+
+                if (result != 0) {
+                    throw std::runtime_error("Whisper transcription failed with code: " + std::to_string(result));
+                }
+                if (loop_watch.triggered.load()) {
+                    EngineMetrics::instance().recordLoopAbort(loop_watch.tokens_at_abort.load(), whisper_n_text_ctx(ctx) / 2);
+                    Log::warn("Decoder repetition loop cut after " + std::to_string(loop_watch.tokens_at_abort.load()) +
+                              " tokens (offline chunk " + std::to_string(k) + ")");
+                }
+
+                // Whisper timestamps are in 10ms units, relative to the chunk.
+                const double base = static_cast<double>(c.offset) / 16000.0;
+                for (int i = 0; i < n_segments; ++i) {
+                    const char* text = whisper_full_get_segment_text_from_state(state.get(), i);
+                    if (!text || isBlank(text)) continue;
+                    Segment seg;
+                    seg.start = base + whisper_full_get_segment_t0_from_state(state.get(), i) * 0.01;
+                    seg.end   = base + whisper_full_get_segment_t1_from_state(state.get(), i) * 0.01;
+                    seg.text  = text;
+                    per_chunk[k].push_back(std::move(seg));
+                }
+
+                if (opts_.decode.language == "auto") {
+                    const char* lang = whisper_lang_str(whisper_full_lang_id_from_state(state.get()));
+                    if (lang) detected[k] = lang;
+                }
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) error = std::current_exception();
+            job.cancel();
+        }
+    };
+
+    if (res.workers > 0) {
+        std::vector<std::thread> threads;
+        threads.reserve(res.workers - 1);
+        for (int i = 1; i < res.workers; ++i) threads.emplace_back(worker);
+        worker();
+        for (auto& t : threads) t.join();
+    }
+
+    if (error) std::rethrow_exception(error);
+    res.cancelled = aborted.load();
+
+    for (size_t k = 0; k < per_chunk.size(); ++k) {
+        for (Segment& seg : per_chunk[k]) {
+            res.text += seg.text;
+            res.segments.push_back(std::move(seg));
+        }
+        if (res.language == "auto" && !detected[k].empty()) res.language = detected[k];
+    }
+    size_t first = res.text.find_first_not_of(' ');
+    res.text.erase(0, first == std::string::npos ? res.text.size() : first);
+
+    res.processing_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
+    Log::info("Offline transcription: " + std::to_string(res.audio_seconds) + "s audio, " +
+              std::to_string(res.chunks_decoded) + "/" + std::to_string(res.chunks) + " chunks, " +
+              std::to_string(res.workers) + " workers, " + std::to_string(res.processing_seconds) + "s");
+    return res;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "DecodeConfig.h"
+#include "utils/SilenceSplitter.h"
+
+// Forward declarations
+class WhisperStatePool;
+class CancellationToken;
+
+/**
+ * @brief Transcripción offline (archivo completo) con decodificación paralela.
+ *
+ * Divide el audio en silencios (SilenceSplitter), descarta los chunks sin voz
+ * y decodifica el resto en paralelo: cada worker toma un slot de
+ * InferenceLimiter y un whisper_state del WhisperStatePool, así que el trabajo
+ * batch comparte el mismo presupuesto de inferencia que las sesiones en vivo.
+ * Los segmentos se devuelven en orden con timestamps absolutos.
+ *
+ * Thread-safe: transcribe() no modifica el objeto.
+ */
+class OfflineTranscriber {
+public:
+    struct Segment {
+        double start = 0.0; // seconds from the start of the input
+        double end   = 0.0;
+        std::string text;
+    };
+
+    struct Result {
+        std::vector<Segment> segments;
+        std::string text;              // all segments joined
+        std::string language;          // requested, or detected when "auto"
+        double audio_seconds      = 0.0;
+        double processing_seconds = 0.0;
+        size_t chunks         = 0;     // chunks produced by the splitter
+        size_t chunks_decoded = 0;     // chunks with speech sent to whisper
+        int    workers        = 0;
+        bool   cancelled      = false; // stopped early; segments are incomplete
+    };
+
+    struct Options {
+        WhisperDecodeConfig      decode;
+        SilenceSplitter::Options split;
+        int max_parallel = 0; // 0 = defaultParallelism(): leaves a slot to live sessions
+        int priority = 1;     // InferenceLimiter priority of the workers (client tier)
+    };
+
+    /**
+     * @brief Workers for max_parallel = 0: one less than the inference slots (at
+     * least 1). Workers block on their slot, so they would otherwise take every slot
+     * freed before a live session's partial polls for it again.
+     */
+    static int defaultParallelism();
+
+    /**
+     * @param pool  States for the model to decode with (must outlive this object)
+     */
+    OfflineTranscriber(WhisperStatePool& pool, Options opts);
+
+    /**
+     * @brief Transcribe a complete recording.
+     * @param pcm     Audio PCM float32, 16kHz mono
+     * @param cancel  Token opcional: detiene los workers y aborta las decodificaciones en curso
+     * @throws std::runtime_error si whisper falla en algún chunk
+     */
+    Result transcribe(const std::vector<float>& pcm, const CancellationToken* cancel = nullptr) const;
+
+private:
+    WhisperStatePool& pool_;
+    Options opts_;
+};
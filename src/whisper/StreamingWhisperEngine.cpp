@@ -4,21 +4,18 @@
 #include <cstring>
 #include <cmath>
 #include <algorithm>
+#include <chrono>
 #include "InferenceLimiter.h"
+#include "EngineMetrics.h"
+#include "CancellationToken.h"
+#include "NumaPlacement.h"
 #include "log/Log.h"
 #include "utils/AudioPreprocessor.h"
+#include "utils/SilenceSplitter.h"
 
 StreamingWhisperEngine::StreamingWhisperEngine(whisper_context* shared_ctx)
     : ctx_(shared_ctx),
       state_(nullptr),
-      language_("es"),
-      n_threads_(4),
-      beam_size_(5),
-      vad_thold_(0.0f),
-      temperature_(0.2f),
-      temperature_inc_(0.2f),
-      no_speech_thold_(0.3f),
-      logprob_thold_(-1.0f),
       max_buffer_samples_(16000 * 30) {
 
     if (!ctx_) {
@@ -50,10 +47,10 @@ bool StreamingWhisperEngine::processAudioChunk(const std::vector<float>& pcm_dat
 
     // High-water mark: 20s = 320 000 samples. Drop incoming chunk if buffer is already full.
     // The hard cap (30s) is still enforced below for the overflow path; HWM provides early warning.
-    constexpr size_t HIGH_WATER_MARK = 16000 * 20;
-    if (audio_buffer_.size() >= HIGH_WATER_MARK) {
+    if (audio_buffer_.size() >= HIGH_WATER_MARK_SAMPLES) {
         return true; // chunk dropped — caller should warn the client
     }
+    hypothesis_.reset();
 
     std::vector<float> prepped_data = pcm_data;
     AudioPreprocessor::process(prepped_data, hp_prev_raw_, hp_prev_filtered_);
@@ -77,88 +74,117 @@ bool StreamingWhisperEngine::processAudioChunk(const std::vector<float>& pcm_dat
     return false;
 }
 
-StreamingWhisperEngine::TranscribeResult StreamingWhisperEngine::transcribeSlidingWindow(bool force_commit) {
-    std::lock_guard<std::mutex> lock(buffer_mutex_);
-    
-    TranscribeResult res;
-    if (audio_buffer_.empty()) {
-        return res;
-    }
-    
-    // Use beam search when beam_size > 1, greedy otherwise
-    whisper_full_params params = (beam_size_ > 1)
-        ? whisper_full_default_params(WHISPER_SAMPLING_BEAM_SEARCH)
-        : whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
-
-    params.language         = language_.c_str();
-    params.n_threads        = n_threads_;
-    params.print_progress   = false;
-    params.print_timestamps = false;
-    params.print_realtime   = false;
-    params.print_special    = false;
-    params.translate        = false;
-    params.single_segment   = false;
-
-    // Each window must be independent to avoid hallucinated context contaminating next window
-    params.no_context       = true;
-    params.suppress_blank   = true;
-    params.suppress_nst     = true;
-
-    // Apply beam size (was stored but never used before)
-    if (beam_size_ > 1) {
-        params.beam_search.beam_size = beam_size_;
-    }
+bool StreamingWhisperEngine::decode(size_t n_samples, const CancellationToken* cancel, TranscribeResult& res) {
+    auto cancelled = [&]() {
+        res.cancelled = true;
+        EngineMetrics::instance().recordCancelled(cancel->isCancelled());
+        return false;
+    };
 
-    params.temperature      = temperature_;
-    params.temperature_inc  = temperature_inc_;
-    params.no_speech_thold  = no_speech_thold_;
-    params.logprob_thold    = logprob_thold_;
-
-    // Limit encoder cross-attention to the actual audio duration.
-    // whisper default: audio_ctx=1500 (= 30s). Each token = 20ms → 50 tok/s.
-    // For a 5s buffer this saves ~83% of encoder attention work over zero-padded silence.
-    {
-        int ctx = static_cast<int>(
-            std::ceil(static_cast<float>(audio_buffer_.size()) / 16000.0f * 50.0f));
-        params.audio_ctx = std::max(ctx, 64); // floor at 64 tokens (~1.3s)
-    }
-
-    if (vad_thold_ > 0.0f) {
-        params.no_speech_thold = vad_thold_;
+    if (cancel && cancel->shouldStop()) {
+        return cancelled();
     }
+    
+    whisper_full_params params = makeWhisperParams(config_, n_samples);
 
-    if (!initial_prompt_.empty()) {
-        params.initial_prompt = initial_prompt_.c_str();
-    }
+    // Stop runaway repetition loops while decoding rather than after the fact.
+    LoopWatch loop_watch;
+    attachLoopWatch(params, loop_watch, ctx_);
+    CancelWatch cancel_watch(cancel);
+    attachCancellation(params, cancel_watch);
 
+    const auto decode_start = std::chrono::steady_clock::now();
     int result = whisper_full_with_state(
         ctx_, state_, params,
         audio_buffer_.data(),
-        audio_buffer_.size()
+        static_cast<int>(n_samples)
     );
+    const double decode_seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - decode_start).count();
     
+    // An aborted decode leaves the buffer untouched; the caller decides whether to retry.
+    // (whisper returns an error when aborted mid-graph, but 0 with no segments when the
+    // encoder-begin callback refused to start.) A decode that ran to the end is kept
+    // even if the token tripped meanwhile.
+    if (cancel_watch.fired.load() &&
+        (result != 0 || whisper_full_n_segments_from_state(state_) == 0)) {
+        Log::debug("Inference cancelled (result=" + std::to_string(result) + ")");
+        return cancelled();
+    }
+    EngineMetrics::instance().recordDecode();
+    NumaPlacement::instance().recordDecode(ctx_, static_cast<double>(n_samples) / 16000.0, decode_seconds);
+
     if (result != 0) {
         std::cerr << "[StreamingWhisperEngine] ERROR: Whisper result=" << result << std::endl;
         throw std::runtime_error("Whisper transcription failed with code: " + std::to_string(result));
     }
+
+    if (loop_watch.triggered.load()) {
+        res.loop_aborted = true;
+        EngineMetrics::instance().recordLoopAbort(loop_watch.tokens_at_abort.load(), whisper_n_text_ctx(ctx_) / 2);
+        Log::warn("Decoder repetition loop cut after " + std::to_string(loop_watch.tokens_at_abort.load()) + " tokens");
+    }
     
-    if (language_ == "auto") {
+    if (config_.language == "auto") {
         int id = whisper_full_lang_id_from_state(state_);
         const char* detected = whisper_lang_str(id);
         if (detected && std::string(detected) != "auto") {
-            language_ = detected;
-            Log::info("Auto-detected language locked to: " + language_);
+            config_.language = detected;
+            Log::info("Auto-detected language locked to: " + config_.language);
         }
     }
+    return true;
+}
+
+StreamingWhisperEngine::TranscribeResult StreamingWhisperEngine::transcribeSlidingWindow(bool force_commit,
+                                                                                           const CancellationToken* cancel) {
+    std::lock_guard<std::mutex> lock(buffer_mutex_);
     
-    const int n_segments = whisper_full_n_segments_from_state(state_);
+    TranscribeResult res;
+    if (audio_buffer_.empty()) {
+        return res;
+    }
+
+    // An unchanged buffer (e.g. audio dropped at the high-water mark, or a flush with
+    // nothing new since the last one) decodes to the same segments: reuse them.
+    const size_t n_samples = audio_buffer_.size();
+    const uint64_t fp = fingerprint(audio_buffer_.data(), n_samples);
+    if (last_window_.valid && last_window_.n_samples == n_samples && last_window_.fingerprint == fp) {
+        EngineMetrics::instance().recordDecodeCacheHit();
+        res.loop_aborted = last_window_.loop_aborted;
+    } else {
+        if (!decode(n_samples, cancel, res)) {
+            return res;
+        }
+        last_window_.valid        = true;
+        last_window_.fingerprint  = fp;
+        last_window_.n_samples    = n_samples;
+        last_window_.loop_aborted = res.loop_aborted;
+        last_window_.segments.clear();
+        const int n = whisper_full_n_segments_from_state(state_);
+        for (int i = 0; i < n; ++i) {
+            const char* text = whisper_full_get_segment_text_from_state(state_, i);
+            last_window_.segments.push_back({text ? text : "", whisper_full_get_segment_t1_from_state(state_, i)});
+        }
+    }
+    hypothesis_.reset();
+
+    const auto& segments = last_window_.segments;
+    const int n_segments = static_cast<int>(segments.size());
     
     // We limit max window to ~10 seconds to keep inference time < 100ms
-    const size_t max_window_samples = 16000 * 10;
+    const size_t max_window_samples = COMMIT_WINDOW_SAMPLES;
     
     if (force_commit || audio_buffer_.size() >= max_window_samples) {
         int commit_up_to_segment = -1;
         int64_t commit_t1 = 0;
+
+        // Nothing transcribable in a full window: keep only the 2s overlap so the buffer
+        // keeps draining (flow-control credits only come back as it does).
+        if (n_segments == 0 && !force_commit) {
+            audio_buffer_.erase(audio_buffer_.begin(), audio_buffer_.end() - 32000);
+            return res;
+        }
         
         if (force_commit) {
             commit_up_to_segment = n_segments - 1;
@@ -168,7 +194,7 @@ StreamingWhisperEngine::TranscribeResult StreamingWhisperEngine::transcribeSlidi
             int64_t overlap_bounds_t = (static_cast<int64_t>(audio_buffer_.size()) - 32000) / 160;
             
             for (int i = n_segments - 1; i >= 0; --i) {
-                int64_t t1 = whisper_full_get_segment_t1_from_state(state_, i);
+                int64_t t1 = segments[i].t1;
                 if (t1 < overlap_bounds_t) {
                     commit_up_to_segment = i;
                     commit_t1 = t1;
@@ -180,31 +206,36 @@ StreamingWhisperEngine::TranscribeResult StreamingWhisperEngine::transcribeSlidi
             // we forcefully commit everything except the very last segment.
             if (commit_up_to_segment == -1 && n_segments > 1) {
                 commit_up_to_segment = n_segments - 2;
-                commit_t1 = whisper_full_get_segment_t1_from_state(state_, commit_up_to_segment);
+                commit_t1 = segments[commit_up_to_segment].t1;
+            }
+
+            // A single segment spanning the whole buffer: at the high-water mark commit it
+            // rather than hold the client's audio back indefinitely.
+            if (commit_up_to_segment == -1 && audio_buffer_.size() >= HIGH_WATER_MARK_SAMPLES) {
+                commit_up_to_segment = n_segments - 1;
+                commit_t1 = segments[commit_up_to_segment].t1;
             }
         }
         
         if (commit_up_to_segment >= 0) {
             for (int i = 0; i <= commit_up_to_segment; ++i) {
-                const char* text = whisper_full_get_segment_text_from_state(state_, i);
-                if (text) res.committed_text += text;
+                res.committed_text += segments[i].text;
             }
             for (int i = commit_up_to_segment + 1; i < n_segments; ++i) {
-                const char* text = whisper_full_get_segment_text_from_state(state_, i);
-                if (text) res.partial_text += text;
+                res.partial_text += segments[i].text;
             }
             
             // Shift audio buffer, dropping the committed audio to prevent duplicate transcriptions
             if (commit_t1 > 0) {
                 size_t samples_to_erase = commit_t1 * 160;
-                Log::debug("Committing " + std::to_string(samples_to_erase) + " samples: '" + res.committed_text + "'");
+                Log::debug([&] { return "Committing " + std::to_string(samples_to_erase) + " samples: '" + res.committed_text + "'"; });
                 if (samples_to_erase < audio_buffer_.size()) {
                     audio_buffer_.erase(audio_buffer_.begin(), audio_buffer_.begin() + samples_to_erase);
                 } else {
                     audio_buffer_.clear();
                 }
-            } else if (force_commit) {
-                Log::debug("Force commit, clearing buffer: '" + res.committed_text + "'");
+            } else if (force_commit || audio_buffer_.size() >= HIGH_WATER_MARK_SAMPLES) {
+                Log::debug([&] { return "Force commit, clearing buffer: '" + res.committed_text + "'"; });
                 audio_buffer_.clear();
             }
             
@@ -214,15 +245,72 @@ StreamingWhisperEngine::TranscribeResult StreamingWhisperEngine::transcribeSlidi
     
     // If not committing, all text is partial
     for (int i = 0; i < n_segments; ++i) {
-        const char* text = whisper_full_get_segment_text_from_state(state_, i);
-        if (text) res.partial_text += text;
+        res.partial_text += segments[i].text;
     }
     
-    Log::debug("Partial (n_seg=" + std::to_string(n_segments) + "): '" + res.partial_text + "'");
+    Log::debug([&] { return "Partial (n_seg=" + std::to_string(n_segments) + "): '" + res.partial_text + "'"; });
+
+    // The buffer is untouched: an end-of-stream right now may use this as the final.
+    if (!force_commit) hypothesis_ = res.partial_text;
     
     return res;
 }
 
+StreamingWhisperEngine::TranscribeResult StreamingWhisperEngine::transcribeBulkChunk(const CancellationToken* cancel) {
+    std::lock_guard<std::mutex> lock(buffer_mutex_);
+
+    TranscribeResult res;
+    if (audio_buffer_.empty()) {
+        return res;
+    }
+
+    // Cut at the longest pause in [BULK_MIN, BULK_MAX]: the chunk ends between words,
+    // so all of its text can be committed without a re-decode overlap.
+    SilenceSplitter::Options split;
+    split.min_chunk_samples = BULK_MIN_CHUNK_SAMPLES;
+    split.max_chunk_samples = BULK_MAX_CHUNK_SAMPLES;
+    const SilenceSplitter::Chunk chunk = SilenceSplitter::split(audio_buffer_, split).front();
+
+    if (chunk.speech) {
+        if (!decode(chunk.length, cancel, res)) {
+            return res;
+        }
+        const int n_segments = whisper_full_n_segments_from_state(state_);
+        for (int i = 0; i < n_segments; ++i) {
+            const char* text = whisper_full_get_segment_text_from_state(state_, i);
+            if (text) res.committed_text += text;
+        }
+    }
+
+    hypothesis_.reset();
+    Log::debug([&] { return "Bulk commit of " + std::to_string(chunk.length) + " samples" +
+                            (chunk.speech ? "" : " (no speech, skipped)") + ": '" + res.committed_text + "'"; });
+    audio_buffer_.erase(audio_buffer_.begin(), audio_buffer_.begin() + chunk.length);
+    return res;
+}
+
+uint64_t StreamingWhisperEngine::fingerprint(const float* data, size_t n) {
+    // FNV-1a over 32-bit words: ~0.1 ms for a 10s window, against a decode of 100+ ms.
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t w;
+        std::memcpy(&w, data + i, sizeof(w));
+        h = (h ^ w) * 1099511628211ull;
+    }
+    return h;
+}
+
+std::optional<std::string> StreamingWhisperEngine::takeFreshHypothesis() {
+    std::lock_guard<std::mutex> lock(buffer_mutex_);
+    if (!hypothesis_ || audio_buffer_.empty()) {
+        return std::nullopt;
+    }
+    std::optional<std::string> text = std::move(hypothesis_);
+    hypothesis_.reset();
+    audio_buffer_.clear();
+    return text;
+}
+
 std::string StreamingWhisperEngine::transcribe(size_t start_offset) {
     // Legacy mapping — uses blocking Guard for direct callers (e.g. tests).
     InferenceLimiter::Guard limit_guard;
@@ -231,6 +319,7 @@ std::string StreamingWhisperEngine::transcribe(size_t start_offset) {
 
 void StreamingWhisperEngine::reset(size_t keep_samples) {
     std::lock_guard<std::mutex> lock(buffer_mutex_);
+    hypothesis_.reset();
     if (keep_samples == 0 || keep_samples >= audio_buffer_.size()) {
         audio_buffer_.clear();
     } else {
@@ -243,44 +332,63 @@ size_t StreamingWhisperEngine::getBufferSize() const {
     return audio_buffer_.size();
 }
 
+size_t StreamingWhisperEngine::bufferBytes() const {
+    std::lock_guard<std::mutex> lock(buffer_mutex_);
+    return audio_buffer_.capacity() * sizeof(float);
+}
+
+void StreamingWhisperEngine::invalidateDecodeCache() {
+    std::lock_guard<std::mutex> lock(buffer_mutex_);
+    last_window_.valid = false;
+    hypothesis_.reset();
+}
+
 void StreamingWhisperEngine::setLanguage(const std::string& lang) {
-    language_ = lang;
+    invalidateDecodeCache();
+    config_.language = lang;
 }
 
 void StreamingWhisperEngine::setThreads(int n_threads) {
     if (n_threads > 0) {
-        n_threads_ = n_threads;
+        config_.n_threads = n_threads;
     }
 }
 
 void StreamingWhisperEngine::setBeamSize(int beam_size) {
+    invalidateDecodeCache();
     if (beam_size > 0) {
-        beam_size_ = beam_size;
+        config_.beam_size = beam_size;
     }
 }
 
 void StreamingWhisperEngine::setInitialPrompt(const std::string& prompt) {
-    initial_prompt_ = prompt;
+    invalidateDecodeCache();
+    config_.initial_prompt = prompt;
 }
 
 void StreamingWhisperEngine::setVadThreshold(float vad_thold) {
-    vad_thold_ = vad_thold;
+    invalidateDecodeCache();
+    config_.vad_thold = vad_thold;
 }
 
 void StreamingWhisperEngine::setTemperature(float temperature) {
-    temperature_ = temperature;
+    invalidateDecodeCache();
+    config_.temperature = temperature;
 }
 
 void StreamingWhisperEngine::setTemperatureInc(float temperature_inc) {
-    temperature_inc_ = temperature_inc;
+    invalidateDecodeCache();
+    config_.temperature_inc = temperature_inc;
 }
 
 void StreamingWhisperEngine::setNoSpeechThreshold(float no_speech_thold) {
-    no_speech_thold_ = no_speech_thold;
+    invalidateDecodeCache();
+    config_.no_speech_thold = no_speech_thold;
 }
 
 void StreamingWhisperEngine::setLogprobThreshold(float logprob_thold) {
-    logprob_thold_ = logprob_thold;
+    invalidateDecodeCache();
+    config_.logprob_thold = logprob_thold;
 }
 
 bool StreamingWhisperEngine::isReady() const {
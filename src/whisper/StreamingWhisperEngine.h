@@ -1,12 +1,17 @@
 #pragma once
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include "DecodeConfig.h"
+#include "TranscriptionEngine.h"
 
 // Forward declarations
 struct whisper_context;
 struct whisper_state;
+class CancellationToken;
 
 /**
  * @brief Motor de transcripción en streaming usando whisper.cpp
@@ -17,7 +22,7 @@ struct whisper_state;
  *
  * Thread-safe: puede ser usado desde múltiples threads.
  */
-class StreamingWhisperEngine {
+class StreamingWhisperEngine : public TranscriptionEngine {
 public:
     /**
      * @brief Constructor con contexto compartido
@@ -26,7 +31,7 @@ public:
      */
     explicit StreamingWhisperEngine(whisper_context* shared_ctx);
     
-    ~StreamingWhisperEngine();
+    ~StreamingWhisperEngine() override;
     
     // No copiable
     StreamingWhisperEngine(const StreamingWhisperEngine&) = delete;
@@ -37,20 +42,36 @@ public:
      * @param pcm_data Audio en formato PCM float32, rango [-1.0, 1.0], 16kHz mono
      * @return true if the chunk was dropped because the buffer is at the 20s high-water mark.
      */
-    bool processAudioChunk(const std::vector<float>& pcm_data);
-    
-    
-    struct TranscribeResult {
-        std::string partial_text;
-        std::string committed_text;
-    };
+    bool processAudioChunk(const std::vector<float>& pcm_data) override;
 
     /**
      * @brief Interpreta el audio y recorta los segmentos completados de forma segura
      * @param force_commit Si es true, vuelca todo el texto a committed y vacía el buffer
+     * @param cancel       Token opcional: si se cancela o vence su deadline, la decodificación
+     *                     se aborta (vía abort callback de whisper) y se devuelve `cancelled`
      * @return `TranscribeResult` con el texto estable (commited) y el texto en vuelo (partial)
      */
-    TranscribeResult transcribeSlidingWindow(bool force_commit = false);
+    TranscribeResult transcribeSlidingWindow(bool force_commit = false,
+                                             const CancellationToken* cancel = nullptr) override;
+
+    /**
+     * @brief Modo bulk: decodifica el primer bloque del buffer, cortado en una pausa
+     *        (SilenceSplitter) de como mucho BULK_MAX_CHUNK_SAMPLES, y lo confirma entero.
+     *
+     * Sin parciales ni solapamiento: cada muestra se decodifica una sola vez. Un bloque
+     * sin voz se descarta sin decodificar.
+     * @return todo el texto en `committed_text`; `cancelled` deja el buffer intacto
+     */
+    TranscribeResult transcribeBulkChunk(const CancellationToken* cancel = nullptr) override;
+
+    /**
+     * @brief Reutilizar el último parcial como final si no ha llegado audio desde entonces.
+     *
+     * Un parcial que no confirmó nada decodificó exactamente el buffer actual, así
+     * que transcribeSlidingWindow(true) daría el mismo texto. Si sigue vigente, vacía el
+     * buffer (como el force commit) y lo devuelve; si no, nullopt y hay que decodificar.
+     */
+    std::optional<std::string> takeFreshHypothesis() override;
 
     // Mantenemos transcribe por compatibilidad con tests (equivale a transcribeSlidingWindow(true).committed_text)
     std::string transcribe(size_t start_offset = 0);
@@ -59,53 +80,54 @@ public:
      * @brief Limpiar el buffer de audio completamente o hasta un límite
      * @param keep_samples Cantidad de samples a conservar del final (ventana deslizante)
      */
-    void reset(size_t keep_samples = 0);
+    void reset(size_t keep_samples = 0) override;
     
     /**
      * @brief Obtener tamaño actual del buffer en samples
      */
-    size_t getBufferSize() const;
+    size_t getBufferSize() const override;
+    size_t bufferBytes() const override;
     
     /**
      * @brief Configurar idioma de transcripción
      * @param lang Código de idioma (ej: "es", "en", "auto")
      */
-    void setLanguage(const std::string& lang);
+    void setLanguage(const std::string& lang) override;
     
     /**
      * @brief Configurar número de threads para transcripción
      * @param n_threads Número de threads (default: 4)
      */
-    void setThreads(int n_threads);
+    void setThreads(int n_threads) override;
 
     /**
      * @brief Configurar tamaño de beam para beam search
      * @param beam_size Tamaño del beam (default: 5). 1 = greedy.
      */
-    void setBeamSize(int beam_size);
+    void setBeamSize(int beam_size) override;
 
     /**
      * @brief Configurar prompt inicial para guiar la transcripción
      * @param prompt Texto de contexto (ej: "Transcripción en español")
      */
-    void setInitialPrompt(const std::string& prompt);
+    void setInitialPrompt(const std::string& prompt) override;
 
     /**
      * @brief Configurar umbral VAD (Voice Activity Detection)
      * @param vad_thold Umbral de VAD (default: 0.0f = autodetect)
      *        > 0.0 activa VAD (ej: 0.6f). Si es muy alto, recorta palabras.
      */
-    void setVadThreshold(float vad_thold);
+    void setVadThreshold(float vad_thold) override;
 
-    void setTemperature(float temperature);
-    void setTemperatureInc(float temperature_inc);
-    void setNoSpeechThreshold(float no_speech_thold);
-    void setLogprobThreshold(float logprob_thold);
+    void setTemperature(float temperature) override;
+    void setTemperatureInc(float temperature_inc) override;
+    void setNoSpeechThreshold(float no_speech_thold) override;
+    void setLogprobThreshold(float logprob_thold) override;
     
     /**
      * @brief Verificar si el engine está listo
      */
-    bool isReady() const;
+    bool isReady() const override;
     
     /**
      * @brief Convertir audio PCM int16 a float32
@@ -118,21 +140,42 @@ public:
     static std::vector<float> convertBytesToFloat32(const std::vector<uint8_t>& bytes);
 
 private:
+    // Run whisper on the first n_samples of the buffer (caller holds buffer_mutex_).
+    // Returns false (res.cancelled set) if the token stopped it; throws on whisper errors.
+    bool decode(size_t n_samples, const CancellationToken* cancel, TranscribeResult& res);
+
+    // Decode parameters changed: cached results no longer apply.
+    void invalidateDecodeCache();
+
+    // Cheap content hash of a window (FNV-1a over the raw samples).
+    static uint64_t fingerprint(const float* data, size_t n);
+
+    // Segments of the last sliding-window decode, keyed by a fingerprint of the exact
+    // window they came from (caller holds buffer_mutex_).
+    struct Segment {
+        std::string text;
+        int64_t     t1; // end, in 10 ms units
+    };
+    struct DecodedWindow {
+        bool     valid = false;
+        uint64_t fingerprint = 0;
+        size_t   n_samples = 0;
+        bool     loop_aborted = false;
+        std::vector<Segment> segments;
+    };
+
     whisper_context* ctx_;       // Shared, NOT owned
     whisper_state*   state_;     // Owned, per-session
     std::vector<float> audio_buffer_;
     mutable std::mutex buffer_mutex_;
+
+    // Text of the last partial that decoded the whole current buffer; any change to
+    // audio_buffer_ clears it (caller holds buffer_mutex_).
+    std::optional<std::string> hypothesis_;
+    DecodedWindow last_window_;
     
     // Configuration
-    std::string language_;
-    std::string initial_prompt_;
-    int n_threads_;
-    int beam_size_;
-    float vad_thold_;
-    float temperature_;
-    float temperature_inc_;
-    float no_speech_thold_;
-    float logprob_thold_;
+    WhisperDecodeConfig config_;
     int max_buffer_samples_; // Max samples in buffer (30s @ 16kHz)
 
     // High-pass filter state (per-instance, not static)
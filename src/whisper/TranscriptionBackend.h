@@ -0,0 +1,63 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include "MockTranscriptionEngine.h"
+
+/**
+ * @brief Process-wide choice of what backs streaming sessions.
+ *
+ * `whisper` (default): a StreamingWhisperEngine on the ModelCache context.
+ * `mock`: a MockTranscriptionEngine per session — no model is loaded, so the
+ * server can be load-tested (scheduler, flow control, admission) on any box.
+ *
+ * Thread-safe. Configured once at startup (tests may reconfigure between cases).
+ */
+class TranscriptionBackend {
+public:
+    enum class Kind { Whisper, Mock };
+
+    static TranscriptionBackend& instance() {
+        static TranscriptionBackend inst;
+        return inst;
+    }
+
+    void configure(Kind kind, MockTranscriptionEngine::Options mock = {}) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        kind_ = kind;
+        mock_ = std::move(mock);
+    }
+
+    Kind kind() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return kind_;
+    }
+
+    /// false for the mock: sessions must not touch the ModelCache.
+    bool usesModel() const { return kind() == Kind::Whisper; }
+
+    std::unique_ptr<TranscriptionEngine> createMock() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return std::make_unique<MockTranscriptionEngine>(mock_);
+    }
+
+    static std::optional<Kind> parse(const std::string& name) {
+        if (name == "whisper") return Kind::Whisper;
+        if (name == "mock") return Kind::Mock;
+        return std::nullopt;
+    }
+
+    static const char* name(Kind kind) { return kind == Kind::Mock ? "mock" : "whisper"; }
+
+    // Non-copyable
+    TranscriptionBackend(const TranscriptionBackend&) = delete;
+    TranscriptionBackend& operator=(const TranscriptionBackend&) = delete;
+
+private:
+    TranscriptionBackend() = default;
+
+    mutable std::mutex mutex_;
+    Kind kind_ = Kind::Whisper;
+    MockTranscriptionEngine::Options mock_;
+};
@@ -0,0 +1,102 @@
+#pragma once
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+class CancellationToken;
+
+/**
+ * @brief Lo que una sesión de streaming necesita de un motor de transcripción.
+ *
+ * StreamingWhisperEngine es la implementación real; MockTranscriptionEngine
+ * imita su contrato (ventana de commit, high-water mark, modo bulk, reutilización
+ * del último parcial) sin modelo, para tests y pruebas de carga del servidor.
+ *
+ * Las implementaciones deben ser thread-safe.
+ */
+class TranscriptionEngine {
+public:
+    struct TranscribeResult {
+        std::string partial_text;
+        std::string committed_text;
+        bool loop_aborted = false; // decoder was stopped early on a repetition loop; text is partial
+        bool cancelled    = false; // stopped by the cancellation token/deadline; no text, buffer untouched
+    };
+
+    /// Buffer size from which transcribeSlidingWindow() commits segments (10s @ 16kHz).
+    static constexpr size_t COMMIT_WINDOW_SAMPLES = 16000 * 10;
+
+    /// processAudioChunk() drops chunks once the buffer holds this much (20s @ 16kHz);
+    /// streaming sessions advertise it as the client's flow-control window.
+    static constexpr size_t HIGH_WATER_MARK_SAMPLES = 16000 * 20;
+
+    /// Bulk mode: chunks are cut at a pause between these sizes (8–18s @ 16kHz).
+    static constexpr size_t BULK_MIN_CHUNK_SAMPLES = 16000 * 8;
+    static constexpr size_t BULK_MAX_CHUNK_SAMPLES = 16000 * 18;
+
+    virtual ~TranscriptionEngine() = default;
+
+    /**
+     * @brief Agregar chunk de audio al buffer.
+     * @param pcm_data Audio en formato PCM float32, rango [-1.0, 1.0], 16kHz mono
+     * @return true if the chunk was dropped because the buffer is at the 20s high-water mark.
+     */
+    virtual bool processAudioChunk(const std::vector<float>& pcm_data) = 0;
+
+    /**
+     * @brief Interpreta el audio y recorta los segmentos completados de forma segura
+     * @param force_commit Si es true, vuelca todo el texto a committed y vacía el buffer
+     * @param cancel       Token opcional: si se cancela o vence su deadline, la decodificación
+     *                     se aborta y se devuelve `cancelled`
+     * @return `TranscribeResult` con el texto estable (commited) y el texto en vuelo (partial)
+     */
+    virtual TranscribeResult transcribeSlidingWindow(bool force_commit = false,
+                                                     const CancellationToken* cancel = nullptr) = 0;
+
+    /**
+     * @brief Modo bulk: decodifica el primer bloque del buffer (como mucho
+     *        BULK_MAX_CHUNK_SAMPLES) y lo confirma entero.
+     * @return todo el texto en `committed_text`; `cancelled` deja el buffer intacto
+     */
+    virtual TranscribeResult transcribeBulkChunk(const CancellationToken* cancel = nullptr) = 0;
+
+    /**
+     * @brief Reutilizar el último parcial como final si no ha llegado audio desde entonces.
+     * @return el texto (y el buffer queda vacío), o nullopt si hay que decodificar.
+     */
+    virtual std::optional<std::string> takeFreshHypothesis() = 0;
+
+    /**
+     * @brief Limpiar el buffer de audio completamente o hasta un límite
+     * @param keep_samples Cantidad de samples a conservar del final (ventana deslizante)
+     */
+    virtual void reset(size_t keep_samples = 0) = 0;
+
+    /**
+     * @brief Obtener tamaño actual del buffer en samples
+     */
+    virtual size_t getBufferSize() const = 0;
+
+    /**
+     * @brief Memoria del buffer de audio en bytes (capacidad reservada, no solo ocupada),
+     *        para la contabilidad de MemoryBudget
+     */
+    virtual size_t bufferBytes() const = 0;
+
+    // Parámetros de decodificación (ver WhisperDecodeConfig)
+    virtual void setLanguage(const std::string& lang) = 0;
+    virtual void setThreads(int n_threads) = 0;
+    virtual void setBeamSize(int beam_size) = 0;
+    virtual void setInitialPrompt(const std::string& prompt) = 0;
+    virtual void setVadThreshold(float vad_thold) = 0;
+    virtual void setTemperature(float temperature) = 0;
+    virtual void setTemperatureInc(float temperature_inc) = 0;
+    virtual void setNoSpeechThreshold(float no_speech_thold) = 0;
+    virtual void setLogprobThreshold(float logprob_thold) = 0;
+
+    /**
+     * @brief Verificar si el engine está listo
+     */
+    virtual bool isReady() const = 0;
+};
@@ -0,0 +1,104 @@
+#pragma once
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include <whisper.h>
+
+/**
+ * @brief Reusable whisper_state objects for one whisper_context.
+ *
+ * whisper_init_state() allocates the KV caches and compute buffers (tens of MB
+ * for small/medium models), so batch paths that decode many short chunks take
+ * states from the pool instead of creating one per chunk. Up to max_idle states
+ * are kept between uses; the rest are freed on release().
+ *
+ * Thread-safe. Must be destroyed before its whisper_context is freed.
+ */
+class WhisperStatePool {
+public:
+    explicit WhisperStatePool(whisper_context* ctx, size_t max_idle = 4)
+        : ctx_(ctx), max_idle_(max_idle) {
+        if (!ctx_) {
+            throw std::runtime_error("[WhisperStatePool] Null whisper context");
+        }
+    }
+
+    ~WhisperStatePool() {
+        for (whisper_state* s : idle_) whisper_free_state(s);
+    }
+
+    // Non-copyable
+    WhisperStatePool(const WhisperStatePool&) = delete;
+    WhisperStatePool& operator=(const WhisperStatePool&) = delete;
+
+    /**
+     * @brief Take an idle state, or create one if none is available.
+     * @throws std::runtime_error if whisper_init_state() fails.
+     */
+    whisper_state* acquire() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!idle_.empty()) {
+                whisper_state* s = idle_.back();
+                idle_.pop_back();
+                return s;
+            }
+        }
+        // Allocate outside the lock: init_state takes a while for larger models.
+        whisper_state* s = whisper_init_state(ctx_);
+        if (!s) {
+            throw std::runtime_error("[WhisperStatePool] Failed to create whisper state");
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++created_;
+        return s;
+    }
+
+    /// Return a state obtained from acquire().
+    void release(whisper_state* s) {
+        if (!s) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (idle_.size() < max_idle_) {
+                idle_.push_back(s);
+                return;
+            }
+        }
+        whisper_free_state(s);
+    }
+
+    whisper_context* context() const { return ctx_; }
+
+    size_t idleCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return idle_.size();
+    }
+
+    /// Total states allocated over the pool's lifetime.
+    size_t createdCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return created_;
+    }
+
+    // RAII lease for exception-safe acquire/release
+    class Lease {
+    public:
+        explicit Lease(WhisperStatePool& pool) : pool_(pool), state_(pool.acquire()) {}
+        ~Lease() { pool_.release(state_); }
+        whisper_state* get() const { return state_; }
+        // Non-copyable/movable
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+    private:
+        WhisperStatePool& pool_;
+        whisper_state*    state_;
+    };
+
+private:
+    whisper_context* ctx_;
+    size_t max_idle_;
+    mutable std::mutex mutex_;
+    std::vector<whisper_state*> idle_;
+    size_t created_ = 0;
+};
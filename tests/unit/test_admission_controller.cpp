@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+#include "server/AdmissionController.h"
+#include "whisper/LoadEstimator.h"
+#include <chrono>
+
+using namespace std::chrono_literals;
+using Clock = LoadEstimator::Clock;
+
+// ---------------------------------------------------------------------------
+// LoadEstimator — instancias propias con tiempos inyectados
+// ---------------------------------------------------------------------------
+
+TEST(LoadEstimatorTest, EmptyWindowHasNoLoad) {
+    LoadEstimator est;
+    auto s = est.snapshot();
+    EXPECT_EQ(s.samples, 0u);
+    EXPECT_DOUBLE_EQ(s.load, 0.0);
+    EXPECT_DOUBLE_EQ(s.latency_p90, 0.0);
+}
+
+TEST(LoadEstimatorTest, LoadIsBusySecondsPerWallSecond) {
+    LoadEstimator est(30s);
+    auto t0 = Clock::now();
+    // 10 decodes de 0.5s repartidos en 10s → 5 slot-segundos en ~10s = 0.5 slots ocupados
+    for (int i = 0; i < 10; ++i) {
+        est.recordDecode(0.5, 0.0, true, t0 + std::chrono::seconds(i + 1));
+    }
+    auto s = est.snapshot(t0 + 10s);
+    EXPECT_EQ(s.samples, 10u);
+    EXPECT_DOUBLE_EQ(s.busy_seconds, 5.0);
+    EXPECT_NEAR(s.load, 5.0 / 9.5, 1e-9); // span = 9s desde el primero + su decode
+}
+
+TEST(LoadEstimatorTest, PercentilesOnlyUsePartialSamples) {
+    LoadEstimator est;
+    auto t0 = Clock::now();
+    for (int i = 0; i < 10; ++i) {
+        est.recordDecode(0.1 * (i + 1), 0.05, true, t0);
+    }
+    est.recordDecode(30.0, 5.0, false, t0); // chunk offline: carga, pero no latencia
+    auto s = est.snapshot(t0);
+    EXPECT_EQ(s.samples, 11u);
+    EXPECT_EQ(s.latency_samples, 10u);
+    EXPECT_NEAR(s.decode_p90, 1.0, 1e-9);
+    EXPECT_NEAR(s.queue_wait_p90, 0.05, 1e-9);
+    EXPECT_NEAR(s.latency_p90, 1.05, 1e-9);
+}
+
+TEST(LoadEstimatorTest, OldSamplesLeaveTheWindow) {
+    LoadEstimator est(10s);
+    auto t0 = Clock::now();
+    est.recordDecode(1.0, 0.0, true, t0);
+    est.recordDecode(1.0, 0.0, true, t0 + 8s);
+    EXPECT_EQ(est.snapshot(t0 + 9s).samples, 2u);
+    EXPECT_EQ(est.snapshot(t0 + 15s).samples, 1u);
+    EXPECT_EQ(est.snapshot(t0 + 30s).samples, 0u);
+}
+
+TEST(LoadEstimatorTest, SampleCountIsBounded) {
+    LoadEstimator est(3600s);
+    auto t0 = Clock::now();
+    for (size_t i = 0; i < LoadEstimator::MAX_SAMPLES + 100; ++i) {
+        est.recordDecode(0.01, 0.0, true, t0);
+    }
+    EXPECT_EQ(est.snapshot(t0).samples, LoadEstimator::MAX_SAMPLES);
+}
+
+// ---------------------------------------------------------------------------
+// AdmissionController::decide — regla pura
+// ---------------------------------------------------------------------------
+
+namespace {
+
+LoadEstimator::Snapshot loadOf(double load, double decode_p90, double wait_p90, size_t samples = 100) {
+    LoadEstimator::Snapshot s;
+    s.samples = samples;
+    s.latency_samples = samples;
+    s.load = load;
+    s.decode_p90 = decode_p90;
+    s.queue_wait_p90 = wait_p90;
+    s.latency_p90 = decode_p90 + wait_p90;
+    return s;
+}
+
+} // namespace
+
+TEST(AdmissionControllerTest, AdmitsWhenIdle) {
+    AdmissionController::Config cfg;
+    auto d = AdmissionController::decide(LoadEstimator::Snapshot{}, 0, 4, cfg);
+    EXPECT_TRUE(d.admit);
+    EXPECT_GT(d.headroom, 0.9);
+}
+
+TEST(AdmissionControllerTest, AdmitsWhileThereIsRoom) {
+    AdmissionController::Config cfg;
+    // 2 sesiones ocupan 1 slot de 4: con una más, 1.5 / 4 = 0.375
+    auto d = AdmissionController::decide(loadOf(1.0, 0.3, 0.0), 2, 4, cfg);
+    EXPECT_TRUE(d.admit);
+    EXPECT_NEAR(d.utilization, 0.25, 1e-9);
+    EXPECT_NEAR(d.predicted_utilization, 0.375, 1e-9);
+    EXPECT_NEAR(d.headroom, 1.0 - 0.375 / 0.85, 1e-9);
+}
+
+TEST(AdmissionControllerTest, ShedsWhenUtilizationWouldExceedLimit) {
+    AdmissionController::Config cfg;
+    // 6 sesiones ocupan 3 slots de 4: con una más, 3.5 / 4 = 0.875 > 0.85
+    auto d = AdmissionController::decide(loadOf(3.0, 0.3, 0.0), 6, 4, cfg);
+    EXPECT_FALSE(d.admit);
+    EXPECT_EQ(d.reason, "utilization");
+    EXPECT_EQ(d.retry_after_seconds, cfg.retry_after_seconds);
+    EXPECT_LT(d.headroom, 0.0);
+}
+
+TEST(AdmissionControllerTest, ShedsWhenPredictedLatencyBreaksSlo) {
+    AdmissionController::Config cfg;
+    cfg.partial_latency_slo_ms = 1000;
+    cfg.max_utilization = 1.0;
+    // u = 0.5 → u' = 0.75: la espera de 0.5s se dobla → 0.4 + 1.0 = 1.4s > 1s
+    auto d = AdmissionController::decide(loadOf(2.0, 0.4, 0.5), 2, 4, cfg);
+    EXPECT_FALSE(d.admit);
+    EXPECT_EQ(d.reason, "latency");
+    EXPECT_NEAR(d.predicted_latency_ms, 1400.0, 1e-6);
+
+    // La misma carga con un SLO holgado entra
+    cfg.partial_latency_slo_ms = 2000;
+    EXPECT_TRUE(AdmissionController::decide(loadOf(2.0, 0.4, 0.5), 2, 4, cfg).admit);
+}
+
+TEST(AdmissionControllerTest, SaturatedSlotsMeanUnboundedLatency) {
+    AdmissionController::Config cfg;
+    cfg.max_utilization = 1.0;
+    auto d = AdmissionController::decide(loadOf(4.0, 0.3, 0.1), 4, 4, cfg);
+    EXPECT_FALSE(d.admit);
+    EXPECT_GE(d.predicted_latency_ms, 1e9);
+}
+
+TEST(AdmissionControllerTest, ColdStartAdmitsWithoutEnoughSamples) {
+    AdmissionController::Config cfg;
+    auto d = AdmissionController::decide(loadOf(3.5, 1.0, 2.0, cfg.min_samples - 1), 6, 4, cfg);
+    EXPECT_TRUE(d.admit);
+    EXPECT_LT(d.headroom, 0.0); // el headroom se informa igualmente
+}
+
+TEST(AdmissionControllerTest, DisabledSloAlwaysAdmits) {
+    AdmissionController::Config cfg;
+    cfg.partial_latency_slo_ms = 0;
+    EXPECT_TRUE(AdmissionController::decide(loadOf(4.0, 1.0, 2.0), 4, 4, cfg).admit);
+}
+
+TEST(AdmissionControllerTest, TicketCountsAdmittedSessions) {
+    AdmissionController ctl;
+    EXPECT_EQ(ctl.activeSessions(), 0);
+    {
+        AdmissionController::Ticket a(ctl);
+        AdmissionController::Ticket b(ctl);
+        EXPECT_EQ(ctl.activeSessions(), 2);
+    }
+    EXPECT_EQ(ctl.activeSessions(), 0);
+}
+
+TEST(AdmissionControllerTest, UploadsAreNotCountedAsSessions) {
+    AdmissionController ctl;
+    {
+        AdmissionController::Ticket session(ctl);
+        AdmissionController::Ticket upload(AdmissionController::Kind::Upload, ctl);
+        EXPECT_EQ(ctl.activeSessions(), 1);
+        EXPECT_EQ(ctl.activeUploads(), 1);
+        EXPECT_NE(ctl.getMetrics().find("transcription_admitted_uploads 1"), std::string::npos);
+    }
+    EXPECT_EQ(ctl.activeUploads(), 0);
+}
+
+TEST(AdmissionControllerTest, OfflineLoadIsNotChargedToSessions) {
+    AdmissionController::Config cfg;
+    // 3 slots ocupados, 2 de ellos por un upload: cada sesión cuesta 0.5, no 1.5
+    auto s = loadOf(3.0, 0.3, 0.0);
+    s.offline_load = 2.0;
+    auto d = AdmissionController::decide(s, 2, 4, cfg);
+    EXPECT_NEAR(d.predicted_utilization, 3.5 / 4, 1e-9);
+    EXPECT_FALSE(d.admit); // 0.875 > 0.85
+
+    s.offline_load = 0.0;
+    EXPECT_NEAR(AdmissionController::decide(s, 2, 4, cfg).predicted_utilization, 4.5 / 4, 1e-9);
+}
+
+TEST(LoadEstimatorTest, OfflineChunksAreSeparatedInTheLoad) {
+    LoadEstimator est;
+    auto t0 = Clock::now();
+    est.recordDecode(1.0, 0.0, true, t0);
+    est.recordOfflineDecode(3.0, 0.0, t0);
+    auto s = est.snapshot(t0);
+    EXPECT_EQ(s.latency_samples, 1u);
+    EXPECT_NEAR(s.offline_load, s.load * 3.0 / 4.0, 1e-9);
+}
+
+TEST(AdmissionControllerTest, MetricsExposeHeadroomAndRejections) {
+    AdmissionController ctl;
+    std::string m = ctl.getMetrics();
+    EXPECT_NE(m.find("transcription_admission_headroom "), std::string::npos);
+    EXPECT_NE(m.find("transcription_admission_rejected_total 0"), std::string::npos);
+    EXPECT_NE(m.find("transcription_partial_latency_p90_seconds "), std::string::npos);
+}
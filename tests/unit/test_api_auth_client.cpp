@@ -0,0 +1,399 @@
+#include <gtest/gtest.h>
+#include "auth/ApiAuthClient.h"
+#include "server/AuthManager.h"
+#include <boost/asio.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace asio  = boost::asio;
+namespace beast = boost::beast;
+namespace http  = beast::http;
+using tcp = asio::ip::tcp;
+
+/**
+ * Servidor de auth mínimo en 127.0.0.1 (HTTP/1.1 keep-alive).
+ * Responde según X-API-Key:
+ *   good → 200 {"is_active":true}     inactive → 200 {"is_active":false}
+ *   bad  → 401                         garbage  → 200 con JSON inválido
+ *   slow → 200 tras 1.5 s              delay    → 200 tras 200 ms
+ *   tenant → 200 con política (tenant_id, tier, max_sessions, audio_seconds_per_minute)
+ *   typos  → 200 con campos de política de tipo incorrecto
+ *   otro → 500
+ * Con close_after_response cierra el socket tras cada respuesta sin avisar
+ * (simula el idle timeout del servidor en una conexión del pool).
+ */
+class StubAuthServer {
+public:
+    explicit StubAuthServer(bool close_after_response = false)
+        : close_after_response_(close_after_response),
+          acceptor_(ioc_, tcp::endpoint(asio::ip::make_address("127.0.0.1"), 0)) {
+        accept();
+        thread_ = std::thread([this] { ioc_.run(); });
+    }
+
+    ~StubAuthServer() {
+        ioc_.stop();
+        thread_.join();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& s : sockets_) {
+                beast::error_code ec;
+                s->shutdown(tcp::socket::shutdown_both, ec);
+            }
+        }
+        for (auto& t : workers_) t.join();
+    }
+
+    std::string url(const std::string& path = "/api") const {
+        return "http://127.0.0.1:" + std::to_string(acceptor_.local_endpoint().port()) + path;
+    }
+
+    int connections() const { return connections_.load(); }
+    int requests() const { return requests_.load(); }
+
+    std::string lastTarget() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return last_target_;
+    }
+    std::string lastAuthorization() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return last_authorization_;
+    }
+    std::string lastHost() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return last_host_;
+    }
+
+private:
+    void accept() {
+        acceptor_.async_accept([this](beast::error_code ec, tcp::socket socket) {
+            if (ec) return;
+            connections_++;
+            auto s = std::make_shared<tcp::socket>(std::move(socket));
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                sockets_.push_back(s);
+                workers_.emplace_back([this, s] { serve(*s); });
+            }
+            accept();
+        });
+    }
+
+    void serve(tcp::socket& socket) {
+        beast::flat_buffer buffer;
+        for (;;) {
+            http::request<http::string_body> req;
+            beast::error_code ec;
+            http::read(socket, buffer, req, ec);
+            if (ec) return;
+            requests_++;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                last_target_        = std::string(req.target());
+                last_authorization_ = std::string(req[http::field::authorization]);
+                last_host_          = std::string(req[http::field::host]);
+            }
+
+            const std::string key(req["X-API-Key"]);
+            http::response<http::string_body> res{http::status::ok, req.version()};
+            if (key == "good" || key == "slow" || key == "delay") {
+                if (key == "slow")  std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+                if (key == "delay") std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                res.body() = R"({"is_active":true})";
+            } else if (key == "tenant") {
+                res.body() = R"({"is_active":true,"tenant_id":"acme","tier":"Premium",)"
+                             R"("max_sessions":3,"audio_seconds_per_minute":120.5})";
+            } else if (key == "typos") {
+                res.body() = R"({"is_active":true,"tenant_id":42,"tier":"gold",)"
+                             R"("max_sessions":"3","audio_seconds_per_minute":-5})";
+            } else if (key == "inactive") {
+                res.body() = R"({"is_active":false})";
+            } else if (key == "bad") {
+                res.result(http::status::unauthorized);
+            } else if (key == "garbage") {
+                res.body() = "not json";
+            } else {
+                res.result(http::status::internal_server_error);
+            }
+            res.keep_alive(req.keep_alive());
+            res.prepare_payload();
+            http::write(socket, res, ec);
+            if (ec || !req.keep_alive()) return;
+
+            if (close_after_response_) {
+                socket.shutdown(tcp::socket::shutdown_both, ec);
+                socket.close(ec);
+                return;
+            }
+        }
+    }
+
+    bool close_after_response_;
+    asio::io_context ioc_;
+    tcp::acceptor acceptor_;
+    std::thread thread_;
+
+    std::mutex mutex_;
+    std::vector<std::shared_ptr<tcp::socket>> sockets_;
+    std::vector<std::thread> workers_;
+    std::string last_target_, last_authorization_, last_host_;
+
+    std::atomic<int> connections_{0};
+    std::atomic<int> requests_{0};
+};
+
+static ApiAuthConfig clientConfig(const std::string& url, int timeout_seconds = 2) {
+    ApiAuthConfig cfg;
+    cfg.api_base_url    = url;
+    cfg.api_secret_key  = "secret";
+    cfg.timeout_seconds = timeout_seconds;
+    return cfg;
+}
+
+// Valor de una métrica Prometheus ("name value\n")
+static uint64_t metric(const std::string& text, const std::string& name) {
+    auto pos = text.find(name + " ");
+    if (pos == std::string::npos) return UINT64_MAX;
+    return std::stoull(text.substr(pos + name.size() + 1));
+}
+
+TEST(ApiAuthClientTest, MapsResponsesToResults) {
+    StubAuthServer server;
+    ApiAuthClient client(clientConfig(server.url()));
+
+    EXPECT_EQ(client.validate("good"),     AuthResult::Allowed);
+    EXPECT_EQ(client.validate("inactive"), AuthResult::Denied);
+    EXPECT_EQ(client.validate("bad"),      AuthResult::Denied);
+    EXPECT_EQ(client.validate("garbage"),  AuthResult::ApiUnavailable);
+    EXPECT_EQ(client.validate("other"),    AuthResult::ApiUnavailable);
+}
+
+TEST(ApiAuthClientTest, SendsClientRequestWithSecretAndHostPort) {
+    StubAuthServer server;
+    // La barra final del base URL no debe duplicarse
+    ApiAuthClient client(clientConfig(server.url("/api/")));
+
+    ASSERT_EQ(client.validate("good"), AuthResult::Allowed);
+    EXPECT_EQ(server.lastTarget(), "/api/client");
+    EXPECT_EQ(server.lastAuthorization(), "Bearer secret");
+    EXPECT_EQ(server.lastHost().rfind("127.0.0.1:", 0), 0u);
+}
+
+TEST(ApiAuthClientTest, SequentialRequestsReuseOneConnection) {
+    StubAuthServer server;
+    ApiAuthClient client(clientConfig(server.url()));
+
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_EQ(client.validate("good"), AuthResult::Allowed);
+    }
+    EXPECT_EQ(server.connections(), 1);
+    EXPECT_EQ(server.requests(), 5);
+
+    auto m = client.getMetrics();
+    EXPECT_EQ(metric(m, "transcription_auth_api_requests_total"), 5u);
+    EXPECT_EQ(metric(m, "transcription_auth_api_connections_opened_total"), 1u);
+    EXPECT_EQ(metric(m, "transcription_auth_api_connections_reused_total"), 4u);
+    EXPECT_EQ(metric(m, "transcription_auth_api_dns_lookups_total"), 1u);
+}
+
+TEST(ApiAuthClientTest, ConcurrentRequestsShareOneDnsLookup) {
+    StubAuthServer server;
+    ApiAuthClient client(clientConfig(server.url()));
+
+    std::vector<std::future<AuthResult>> pending;
+    for (int i = 0; i < 16; ++i) {
+        pending.push_back(client.validateAsync(i % 2 ? "good" : "inactive"));
+    }
+    for (int i = 0; i < 16; ++i) {
+        EXPECT_EQ(pending[i].get(), i % 2 ? AuthResult::Allowed : AuthResult::Denied);
+    }
+    EXPECT_EQ(server.requests(), 16);
+    EXPECT_EQ(metric(client.getMetrics(), "transcription_auth_api_dns_lookups_total"), 1u);
+
+    // Pool lleno (pool_size=4): la siguiente ronda no abre conexiones nuevas
+    int before = server.connections();
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(client.validate("good"), AuthResult::Allowed);
+    }
+    EXPECT_EQ(server.connections(), before);
+}
+
+TEST(ApiAuthClientTest, StalePooledConnectionIsRetriedOnFreshOne) {
+    StubAuthServer server(/*close_after_response=*/true);
+    ApiAuthClient client(clientConfig(server.url()));
+
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(client.validate("good"), AuthResult::Allowed);
+    }
+    EXPECT_EQ(server.requests(), 3);
+    EXPECT_EQ(server.connections(), 3);
+}
+
+TEST(ApiAuthClientTest, TimeoutReturnsApiUnavailable) {
+    StubAuthServer server;
+    ApiAuthClient client(clientConfig(server.url(), /*timeout_seconds=*/1));
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(client.validate("slow"), AuthResult::ApiUnavailable);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(1400));
+
+    // La conexión expirada no vuelve al pool: la siguiente petición funciona
+    EXPECT_EQ(client.validate("good"), AuthResult::Allowed);
+}
+
+TEST(ApiAuthClientTest, UnreachableServerReturnsApiUnavailable) {
+    std::string url;
+    {
+        asio::io_context ioc;
+        tcp::acceptor a(ioc, tcp::endpoint(asio::ip::make_address("127.0.0.1"), 0));
+        url = "http://127.0.0.1:" + std::to_string(a.local_endpoint().port());
+    } // puerto cerrado
+    ApiAuthClient client(clientConfig(url));
+    EXPECT_EQ(client.validate("good"), AuthResult::ApiUnavailable);
+}
+
+TEST(ApiAuthClientTest, InvalidUrlReturnsApiUnavailable) {
+    ApiAuthClient client(clientConfig("ftp://nope"));
+    EXPECT_EQ(client.validate("good"), AuthResult::ApiUnavailable);
+}
+
+TEST(ApiAuthClientTest, DestructorResolvesPendingFutures) {
+    StubAuthServer server;
+    std::future<AuthResult> pending;
+    {
+        ApiAuthClient client(clientConfig(server.url(), /*timeout_seconds=*/5));
+        pending = client.validateAsync("slow");
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    ASSERT_EQ(pending.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    EXPECT_EQ(pending.get(), AuthResult::ApiUnavailable);
+}
+
+TEST(AuthManagerAsyncTest, MissQueriesApiOnceThenServesFromCache) {
+    StubAuthServer server;
+    AuthManager auth(clientConfig(server.url()));
+
+    auto first = auth.validateAsync("good");
+    EXPECT_TRUE(first.get());
+    EXPECT_EQ(server.requests(), 1);
+
+    auto cached = auth.validateAsync("good");
+    EXPECT_EQ(cached.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    EXPECT_TRUE(cached.get());
+    EXPECT_EQ(server.requests(), 1);
+
+    EXPECT_FALSE(auth.validate("bad"));
+    EXPECT_FALSE(auth.validate("garbage")); // fail-closed
+    EXPECT_NE(auth.getMetrics().find("transcription_auth_api_requests_total 3"), std::string::npos);
+}
+
+TEST(AuthManagerAsyncTest, ConcurrentMissesShareOneRequest) {
+    StubAuthServer server;
+    AuthManager auth(clientConfig(server.url()));
+
+    std::vector<std::future<AuthDecision>> pending;
+    for (int i = 0; i < 50; ++i) {
+        pending.push_back(auth.validateAsync("delay"));
+    }
+    for (auto& f : pending) {
+        EXPECT_TRUE(f.get());
+    }
+    EXPECT_EQ(server.requests(), 1);
+    EXPECT_NE(auth.getMetrics().find("transcription_auth_singleflight_joined_total 49"), std::string::npos);
+
+    // Un fallo compartido se reporta a todos (fail-closed) y no se cachea
+    std::vector<std::future<AuthDecision>> failing;
+    for (int i = 0; i < 5; ++i) {
+        failing.push_back(auth.validateAsync("other"));
+    }
+    for (auto& f : failing) {
+        EXPECT_FALSE(f.get());
+    }
+    EXPECT_EQ(server.requests(), 2);
+    EXPECT_FALSE(auth.validate("other"));
+    EXPECT_EQ(server.requests(), 3);
+}
+
+TEST(AuthManagerAsyncTest, DeniedKeysUseNegativeTtl) {
+    StubAuthServer server;
+    ApiAuthConfig cfg = clientConfig(server.url());
+    cfg.cache_ttl_seconds          = 300;
+    cfg.negative_cache_ttl_seconds = 1;
+    AuthManager auth(cfg);
+
+    EXPECT_FALSE(auth.validate("bad"));
+    EXPECT_FALSE(auth.validate("bad"));
+    EXPECT_EQ(server.requests(), 1);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    EXPECT_FALSE(auth.validate("bad"));
+    EXPECT_EQ(server.requests(), 2);
+}
+
+TEST(AuthManagerAsyncTest, EntryNearExpiryIsRefreshedInBackground) {
+    StubAuthServer server;
+    ApiAuthConfig cfg = clientConfig(server.url());
+    cfg.cache_ttl_seconds = 1; // ventana de refresco: últimos 200 ms
+    AuthManager auth(cfg);
+
+    EXPECT_TRUE(auth.validate("delay"));
+    EXPECT_EQ(server.requests(), 1);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(850));
+    // Servido desde caché aunque el refresco (200 ms) siga en vuelo
+    auto hit = auth.validateAsync("delay");
+    EXPECT_EQ(hit.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    EXPECT_TRUE(hit.get());
+
+    // Solo un refresco por ventana
+    EXPECT_TRUE(auth.validate("delay"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+    EXPECT_EQ(server.requests(), 2);
+
+    // La entrada original ya habría expirado: el refresco la renovó
+    auto renewed = auth.validateAsync("delay");
+    EXPECT_EQ(renewed.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    EXPECT_TRUE(renewed.get());
+    EXPECT_EQ(server.requests(), 2);
+    EXPECT_NE(auth.getMetrics().find("transcription_auth_background_refreshes_total 1"), std::string::npos);
+}
+
+TEST(AuthManagerAsyncTest, PolicyFromApiIsReturnedAndCached) {
+    StubAuthServer server;
+    AuthManager auth(clientConfig(server.url()));
+
+    AuthDecision first = auth.authorize("tenant");
+    ASSERT_TRUE(first.allowed);
+    EXPECT_EQ(first.policy.tenant_id, "acme");
+    EXPECT_EQ(first.policy.tier, PriorityTier::Premium);
+    EXPECT_EQ(first.policy.max_sessions, 3);
+    EXPECT_DOUBLE_EQ(first.policy.audio_seconds_per_minute, 120.5);
+
+    AuthDecision cached = auth.authorize("tenant");
+    EXPECT_EQ(server.requests(), 1);
+    EXPECT_EQ(cached.policy.tenant_id, "acme");
+    EXPECT_EQ(cached.policy.tier, PriorityTier::Premium);
+}
+
+TEST(AuthManagerAsyncTest, MissingOrMalformedPolicyFieldsKeepDefaults) {
+    StubAuthServer server;
+    AuthManager auth(clientConfig(server.url()));
+
+    AuthDecision plain = auth.authorize("good");
+    ASSERT_TRUE(plain.allowed);
+    EXPECT_TRUE(plain.policy.tenant_id.empty());
+    EXPECT_EQ(plain.policy.tier, PriorityTier::Standard);
+    EXPECT_EQ(plain.policy.max_sessions, 0);
+
+    AuthDecision typos = auth.authorize("typos");
+    ASSERT_TRUE(typos.allowed);
+    EXPECT_EQ(typos.policy.tenant_id, "42");
+    EXPECT_EQ(typos.policy.tier, PriorityTier::Standard);
+    EXPECT_EQ(typos.policy.max_sessions, 0);
+    EXPECT_DOUBLE_EQ(typos.policy.audio_seconds_per_minute, 0.0);
+}
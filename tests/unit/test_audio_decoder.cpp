@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include "utils/AudioDecoder.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Helper: construye un archivo WAV en memoria
+static void putU16(std::string& s, uint16_t v) { s.push_back(char(v & 0xFF)); s.push_back(char(v >> 8)); }
+static void putU32(std::string& s, uint32_t v) { for (int i = 0; i < 4; ++i) s.push_back(char((v >> (8 * i)) & 0xFF)); }
+
+static std::string makeWav(uint16_t format, uint16_t channels, uint32_t rate, uint16_t bits,
+                           const std::string& data, const std::string& extra_chunk = "") {
+    std::string fmt;
+    putU16(fmt, format);
+    putU16(fmt, channels);
+    putU32(fmt, rate);
+    putU32(fmt, rate * channels * bits / 8);
+    putU16(fmt, static_cast<uint16_t>(channels * bits / 8));
+    putU16(fmt, bits);
+
+    std::string body = "WAVE";
+    body += "fmt ";
+    putU32(body, static_cast<uint32_t>(fmt.size()));
+    body += fmt;
+    body += extra_chunk;
+    body += "data";
+    putU32(body, static_cast<uint32_t>(data.size()));
+    body += data;
+
+    std::string wav = "RIFF";
+    putU32(wav, static_cast<uint32_t>(body.size()));
+    return wav + body;
+}
+
+static std::string pcm16(const std::vector<int16_t>& v) {
+    std::string s;
+    for (int16_t x : v) putU16(s, static_cast<uint16_t>(x));
+    return s;
+}
+
+static std::string f32(const std::vector<float>& v) {
+    std::string s(v.size() * 4, '\0');
+    std::memcpy(&s[0], v.data(), s.size());
+    return s;
+}
+
+// --- Detección ---
+
+TEST(AudioDecoder, DetectsWavHeader) {
+    EXPECT_TRUE(AudioDecoder::looksLikeWav(makeWav(1, 1, 16000, 16, pcm16({0}))));
+    EXPECT_FALSE(AudioDecoder::looksLikeWav(f32({0.1f, 0.2f, 0.3f})));
+    EXPECT_FALSE(AudioDecoder::looksLikeWav("RIFF"));
+}
+
+// --- Formatos soportados ---
+
+TEST(AudioDecoder, DecodesPcm16Mono) {
+    auto pcm = AudioDecoder::decodeWav(makeWav(1, 1, 16000, 16, pcm16({0, 16384, -32768})));
+    ASSERT_EQ(pcm.size(), 3u);
+    EXPECT_FLOAT_EQ(pcm[0], 0.0f);
+    EXPECT_FLOAT_EQ(pcm[1], 0.5f);
+    EXPECT_FLOAT_EQ(pcm[2], -1.0f);
+}
+
+TEST(AudioDecoder, DecodesFloat32) {
+    auto pcm = AudioDecoder::decodeWav(makeWav(3, 1, 16000, 32, f32({0.25f, -0.75f})));
+    ASSERT_EQ(pcm.size(), 2u);
+    EXPECT_FLOAT_EQ(pcm[0], 0.25f);
+    EXPECT_FLOAT_EQ(pcm[1], -0.75f);
+}
+
+TEST(AudioDecoder, DownmixesStereoToMono) {
+    auto pcm = AudioDecoder::decodeWav(makeWav(3, 2, 16000, 32, f32({0.5f, -0.5f, 1.0f, 0.0f})));
+    ASSERT_EQ(pcm.size(), 2u);
+    EXPECT_FLOAT_EQ(pcm[0], 0.0f);
+    EXPECT_FLOAT_EQ(pcm[1], 0.5f);
+}
+
+TEST(AudioDecoder, ResamplesTo16k) {
+    std::vector<float> in(8000, 0.5f); // 1s @ 8kHz
+    auto pcm = AudioDecoder::decodeWav(makeWav(3, 1, 8000, 32, f32(in)));
+    EXPECT_EQ(pcm.size(), 16000u);
+    EXPECT_FLOAT_EQ(pcm[12345], 0.5f);
+}
+
+TEST(AudioDecoder, AcceptsExtensibleFormat) {
+    // WAVE_FORMAT_EXTENSIBLE con subformato PCM (0x0001)
+    std::string fmt;
+    putU16(fmt, 0xFFFE); putU16(fmt, 1); putU32(fmt, 16000); putU32(fmt, 32000);
+    putU16(fmt, 2); putU16(fmt, 16); putU16(fmt, 22); putU16(fmt, 16); putU32(fmt, 4);
+    putU16(fmt, 1); fmt += std::string(14, '\0');
+
+    std::string body = "WAVEfmt ";
+    putU32(body, static_cast<uint32_t>(fmt.size()));
+    body += fmt + "data";
+    std::string data = pcm16({16384});
+    putU32(body, static_cast<uint32_t>(data.size()));
+    body += data;
+    std::string wav = "RIFF";
+    putU32(wav, static_cast<uint32_t>(body.size()));
+
+    auto pcm = AudioDecoder::decodeWav(wav + body);
+    ASSERT_EQ(pcm.size(), 1u);
+    EXPECT_FLOAT_EQ(pcm[0], 0.5f);
+}
+
+TEST(AudioDecoder, SkipsUnknownChunksWithPadding) {
+    std::string list = "LIST";
+    putU32(list, 3);
+    list += "abc";
+    list.push_back('\0'); // word alignment
+    auto pcm = AudioDecoder::decodeWav(makeWav(1, 1, 16000, 16, pcm16({16384, 0}), list));
+    ASSERT_EQ(pcm.size(), 2u);
+    EXPECT_FLOAT_EQ(pcm[0], 0.5f);
+}
+
+TEST(AudioDecoder, ClampsOversizedDataChunk) {
+    // Streams escritos sin conocer la longitud final suelen declarar 0xFFFFFFFF
+    std::string wav = makeWav(1, 1, 16000, 16, pcm16({100, 200, 300}));
+    wav.replace(wav.size() - 6 - 4, 4, std::string(4, '\xFF'));
+    EXPECT_EQ(AudioDecoder::decodeWav(wav).size(), 3u);
+}
+
+// --- Errores ---
+
+TEST(AudioDecoder, RejectsUnsupportedEncoding) {
+    EXPECT_THROW(AudioDecoder::decodeWav(makeWav(1, 1, 16000, 8, std::string(10, '\x80'))), std::invalid_argument);
+    EXPECT_THROW(AudioDecoder::decodeWav(makeWav(6, 1, 8000, 8, std::string(10, '\x00'))), std::invalid_argument);
+}
+
+TEST(AudioDecoder, RejectsMalformedFiles) {
+    EXPECT_THROW(AudioDecoder::decodeWav("not a wav file"), std::invalid_argument);
+
+    std::string no_data = makeWav(1, 1, 16000, 16, "");
+    no_data.resize(no_data.size() - 8); // drop the data chunk header
+    EXPECT_THROW(AudioDecoder::decodeWav(no_data), std::invalid_argument);
+
+    EXPECT_THROW(AudioDecoder::decodeWav(makeWav(1, 0, 16000, 16, pcm16({1}))), std::invalid_argument);
+}
+
+// --- PCM raw ---
+
+TEST(AudioDecoder, RawDecodersIgnoreTrailingPartialSample) {
+    EXPECT_EQ(AudioDecoder::decodePcm16(pcm16({1, 2, 3}) + "x").size(), 3u);
+    EXPECT_EQ(AudioDecoder::decodeFloat32(f32({0.1f, 0.2f}) + "xyz").size(), 2u);
+    EXPECT_FLOAT_EQ(AudioDecoder::decodeFloat32(f32({0.1f}))[0], 0.1f);
+}
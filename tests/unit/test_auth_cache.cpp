@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include "auth/AuthCache.h"
+#include <chrono>
+#include <thread>
+
+TEST(AuthCacheTest, MissThenHit) {
+    AuthCache cache;
+    EXPECT_FALSE(cache.lookup("k").valid.has_value());
+
+    cache.put("k", true, 60);
+    auto hit = cache.lookup("k");
+    ASSERT_TRUE(hit.valid.has_value());
+    EXPECT_TRUE(*hit.valid);
+    EXPECT_FALSE(hit.refresh);
+
+    cache.put("denied", false, 60);
+    EXPECT_EQ(cache.lookup("denied").valid, std::optional<bool>(false));
+}
+
+TEST(AuthCacheTest, ExpiredEntryIsAMiss) {
+    AuthCache cache;
+    cache.put("k", true, 0);
+    EXPECT_FALSE(cache.lookup("k").valid.has_value());
+}
+
+TEST(AuthCacheTest, RefreshIsClaimedOncePerWindow) {
+    AuthCache cache;
+    cache.put("k", true, 1); // refresco a partir de 800 ms
+    EXPECT_FALSE(cache.lookup("k").refresh);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(850));
+    auto first = cache.lookup("k");
+    EXPECT_TRUE(first.valid.value_or(false));
+    EXPECT_TRUE(first.refresh);
+    EXPECT_FALSE(cache.lookup("k").refresh);
+
+    // Refresco fallido: el siguiente lookup lo reintenta
+    cache.refreshFailed("k");
+    EXPECT_TRUE(cache.lookup("k").refresh);
+
+    // Refresco correcto: nueva ventana completa
+    cache.put("k", true, 1);
+    EXPECT_FALSE(cache.lookup("k").refresh);
+}
+
+TEST(AuthCacheTest, UniqueKeyFloodStaysBounded) {
+    AuthCache cache(/*max_entries=*/160, /*sweep_interval_seconds=*/0);
+    for (int i = 0; i < 10000; ++i) {
+        cache.put("attacker-" + std::to_string(i), false, 60);
+    }
+    EXPECT_LE(cache.size(), cache.capacity());
+    EXPECT_GE(cache.capacity(), 160u);
+    EXPECT_NE(cache.getMetrics().find("transcription_auth_cache_evictions_total"), std::string::npos);
+}
+
+TEST(AuthCacheTest, RecentlyUsedEntrySurvivesEviction) {
+    AuthCache cache(/*max_entries=*/AuthCache::SHARDS * 4, /*sweep_interval_seconds=*/0);
+    cache.put("tenant-key", true, 60);
+    for (int i = 0; i < 2000; ++i) {
+        cache.put("flood-" + std::to_string(i), false, 60);
+        cache.lookup("tenant-key"); // usada continuamente → nunca es la LRU
+    }
+    EXPECT_EQ(cache.lookup("tenant-key").valid, std::optional<bool>(true));
+}
+
+TEST(AuthCacheTest, SweepRemovesExpiredEntries) {
+    AuthCache cache(1000, 0);
+    for (int i = 0; i < 50; ++i) cache.put("short-" + std::to_string(i), true, 0);
+    for (int i = 0; i < 10; ++i) cache.put("long-" + std::to_string(i), true, 60);
+    EXPECT_EQ(cache.size(), 60u);
+
+    EXPECT_EQ(cache.sweepExpired(), 50u);
+    EXPECT_EQ(cache.size(), 10u);
+    EXPECT_NE(cache.getMetrics().find("transcription_auth_cache_expired_total 50"), std::string::npos);
+}
+
+TEST(AuthCacheTest, BackgroundSweeperRuns) {
+    AuthCache cache(1000, /*sweep_interval_seconds=*/1);
+    cache.put("k", true, 0);
+    EXPECT_EQ(cache.size(), 1u);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1300));
+    EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST(AuthCacheTest, CountsHitsAndMisses) {
+    AuthCache cache(1000, 0);
+    cache.lookup("a");
+    cache.put("a", true, 60);
+    cache.lookup("a");
+    cache.lookup("a");
+    auto m = cache.getMetrics();
+    EXPECT_NE(m.find("transcription_auth_cache_hits_total 2\n"), std::string::npos);
+    EXPECT_NE(m.find("transcription_auth_cache_misses_total 1\n"), std::string::npos);
+    EXPECT_NE(m.find("transcription_auth_cache_entries 1\n"), std::string::npos);
+}
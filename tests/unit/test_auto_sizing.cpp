@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+#include "server/AutoSizing.h"
+#include "utils/CgroupLimits.h"
+#include <unistd.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+class AutoSizingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        root_ = fs::temp_directory_path() / ("cgroup-test-" + std::to_string(::getpid()));
+        fs::remove_all(root_);
+        fs::create_directories(root_);
+        proc_ = (root_ / "proc-self-cgroup").string();
+        saved_slots_ = InferenceLimiter::instance().maxConcurrency();
+    }
+
+    void TearDown() override {
+        AutoSizing::instance().configure({});
+        InferenceLimiter::instance().setMaxConcurrency(saved_slots_);
+        MemoryBudget::instance().configure({});
+        fs::remove_all(root_);
+    }
+
+    void write(const fs::path& rel, const std::string& content) {
+        fs::create_directories((root_ / rel).parent_path());
+        std::ofstream(root_ / rel) << content << "\n";
+    }
+
+    // Árbol v2 con el proceso en /pod/ctr.
+    void makeV2() {
+        write("cgroup.controllers", "cpuset cpu memory");
+        write("proc-self-cgroup", "0::/pod/ctr");
+        fs::create_directories(root_ / "pod" / "ctr");
+    }
+
+    AutoSizing::Config config(int host_cpus) {
+        AutoSizing::Config cfg;
+        cfg.auto_threads = true;
+        cfg.auto_concurrency = true;
+        cfg.poll_interval = 0s;
+        cfg.cgroup_root = root_.string();
+        cfg.proc_self_cgroup = proc_;
+        cfg.affinity_cpus = [host_cpus] { return host_cpus; };
+        return cfg;
+    }
+
+    fs::path root_;
+    std::string proc_;
+    int saved_slots_ = 4;
+};
+
+// ─── Lectura de cgroups ──────────────────────────────────────────────────────
+
+TEST_F(AutoSizingTest, CountsCpuLists) {
+    EXPECT_EQ(cgroup::countCpuList("0-3"), 4);
+    EXPECT_EQ(cgroup::countCpuList("0-3,8,10-11"), 7);
+    EXPECT_EQ(cgroup::countCpuList(" 5 "), 1);
+    EXPECT_EQ(cgroup::countCpuList(""), 0);
+    EXPECT_EQ(cgroup::countCpuList("3-1"), 0);
+    EXPECT_EQ(cgroup::countCpuList("a-b"), 0);
+}
+
+TEST_F(AutoSizingTest, ReadsV2TightestLimitUpTheHierarchy) {
+    makeV2();
+    write("pod/cpu.max", "250000 100000");          // 2.5 cores en el pod
+    write("pod/ctr/cpu.max", "max 100000");         // el contenedor no limita
+    write("pod/memory.max", "8589934592");
+    write("pod/ctr/memory.max", "2147483648");      // 2 GB, más estricto
+    write("pod/ctr/cpuset.cpus.effective", "0-7");
+
+    auto l = cgroup::read(root_.string(), proc_);
+    EXPECT_EQ(l.version, 2);
+    EXPECT_DOUBLE_EQ(l.cpu_quota, 2.5);
+    EXPECT_EQ(l.cpuset_cpus, 8);
+    EXPECT_EQ(l.memory_limit, 2147483648u);
+    EXPECT_EQ(cgroup::usableCores(l, 16), 2); // la cuota se redondea hacia abajo
+}
+
+TEST_F(AutoSizingTest, ReadsV1) {
+    write("cpu,cpuacct/cpu.cfs_quota_us", "400000");
+    write("cpu,cpuacct/cpu.cfs_period_us", "100000");
+    write("cpuset/cpuset.cpus", "0-1");
+    write("memory/memory.limit_in_bytes", "9223372036854771712"); // sin límite
+
+    auto l = cgroup::read(root_.string(), proc_);
+    EXPECT_EQ(l.version, 1);
+    EXPECT_DOUBLE_EQ(l.cpu_quota, 4.0);
+    EXPECT_EQ(l.cpuset_cpus, 2);
+    EXPECT_EQ(l.memory_limit, 0u);
+    EXPECT_EQ(cgroup::usableCores(l, 16), 2); // el cpuset manda
+
+    // Grupo propio visible bajo el punto de montaje (sin namespace de cgroup).
+    write("proc-self-cgroup", "5:memory:/jobs/a\n3:cpu,cpuacct:/jobs/a\n0::/");
+    write("memory/jobs/a/memory.limit_in_bytes", "536870912");
+    write("cpu,cpuacct/jobs/a/cpu.cfs_quota_us", "-1");
+    write("cpu,cpuacct/jobs/a/cpu.cfs_period_us", "100000");
+    l = cgroup::read(root_.string(), proc_);
+    EXPECT_EQ(l.memory_limit, 536870912u);
+    EXPECT_DOUBLE_EQ(l.cpu_quota, 4.0); // heredada del padre
+}
+
+TEST_F(AutoSizingTest, NoCgroupMeansNoLimits) {
+    auto l = cgroup::read((root_ / "missing").string(), proc_);
+    EXPECT_EQ(l.version, 0);
+    EXPECT_EQ(cgroup::usableCores(l, 6), 6);
+    EXPECT_EQ(cgroup::usableCores(l, 0), 1);
+}
+
+// ─── Plan ────────────────────────────────────────────────────────────────────
+
+TEST_F(AutoSizingTest, PlanNeverOversubscribes) {
+    for (int cores = 1; cores <= 64; ++cores) {
+        auto p = AutoSizing::plan(cores, 0);
+        EXPECT_LE(p.threads * p.concurrency, cores) << cores;
+        EXPECT_GE(p.threads, 1);
+        EXPECT_LE(p.threads, AutoSizing::MAX_AUTO_THREADS);
+    }
+    auto four = AutoSizing::plan(4, 0);
+    EXPECT_EQ(four.threads, 2);
+    EXPECT_EQ(four.concurrency, 2);
+    auto sixteen = AutoSizing::plan(16, 0);
+    EXPECT_EQ(sixteen.threads, 4);
+    EXPECT_EQ(sixteen.concurrency, 4);
+    EXPECT_EQ(AutoSizing::plan(1, 0).concurrency, 1);
+}
+
+TEST_F(AutoSizingTest, PlanLeavesMemoryHeadroom) {
+    EXPECT_EQ(AutoSizing::plan(4, 1000).memory_budget_bytes, 900u);
+    EXPECT_EQ(AutoSizing::plan(4, 0).memory_budget_bytes, 0u);
+}
+
+// ─── Aplicación y reevaluación ───────────────────────────────────────────────
+
+TEST_F(AutoSizingTest, AppliesPlanAndReactsToQuotaChange) {
+    makeV2();
+    write("pod/ctr/cpu.max", "400000 100000");
+    write("pod/ctr/memory.max", "1048576000");
+
+    auto cfg = config(32);
+    cfg.auto_memory = true;
+    AutoSizing::instance().configure(cfg);
+    EXPECT_EQ(AutoSizing::instance().threads(), 2);
+    EXPECT_EQ(InferenceLimiter::instance().maxConcurrency(), 2);
+    EXPECT_EQ(MemoryBudget::instance().config().budget_bytes, 943718400u);
+
+    EXPECT_FALSE(AutoSizing::instance().evaluate()); // nada cambió
+
+    write("pod/ctr/cpu.max", "1600000 100000");     // resize vertical a 16 cores
+    EXPECT_TRUE(AutoSizing::instance().evaluate());
+    EXPECT_EQ(AutoSizing::instance().threads(), 4);
+    EXPECT_EQ(InferenceLimiter::instance().maxConcurrency(), 4);
+    EXPECT_NE(AutoSizing::instance().getMetrics().find("transcription_auto_reevaluations_total 1\n"),
+              std::string::npos);
+}
+
+TEST_F(AutoSizingTest, FixedValuesAreLeftAlone) {
+    makeV2();
+    write("pod/ctr/cpu.max", "100000 100000");
+    InferenceLimiter::instance().setMaxConcurrency(7);
+
+    auto cfg = config(8);
+    cfg.auto_concurrency = false;
+    cfg.auto_threads = false;
+    cfg.threads = 3;
+    AutoSizing::instance().configure(cfg);
+    EXPECT_FALSE(AutoSizing::instance().enabled());
+    EXPECT_EQ(AutoSizing::instance().threads(), 3);
+    EXPECT_EQ(InferenceLimiter::instance().maxConcurrency(), 7);
+    EXPECT_EQ(AutoSizing::instance().getMetrics(), "");
+
+    cfg.auto_threads = true;                         // sólo threads en auto
+    AutoSizing::instance().configure(cfg);
+    EXPECT_EQ(AutoSizing::instance().threads(), 1);
+    EXPECT_EQ(InferenceLimiter::instance().maxConcurrency(), 7);
+}
+
+TEST_F(AutoSizingTest, WatcherPicksUpChanges) {
+    makeV2();
+    write("pod/ctr/cpu.max", "100000 100000");
+    auto cfg = config(32);
+    cfg.poll_interval = 1s;
+    AutoSizing::instance().configure(cfg);
+    EXPECT_EQ(InferenceLimiter::instance().maxConcurrency(), 1);
+
+    write("pod/ctr/cpu.max", "800000 100000");
+    auto deadline = std::chrono::steady_clock::now() + 3s;
+    // Los slots son lo último que se aplica.
+    while (InferenceLimiter::instance().maxConcurrency() != 2 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(20ms);
+    }
+    EXPECT_EQ(AutoSizing::instance().currentPlan().cores, 8);
+    EXPECT_EQ(InferenceLimiter::instance().maxConcurrency(), 2); // 8 cores: 4 threads × 2
+    EXPECT_EQ(AutoSizing::instance().threads(), 4);
+}
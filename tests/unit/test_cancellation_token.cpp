@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include "whisper/CancellationToken.h"
+#include <chrono>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+TEST(CancellationToken, FreshTokenDoesNotStop) {
+    CancellationToken token;
+    EXPECT_FALSE(token.isCancelled());
+    EXPECT_FALSE(token.deadlineExceeded());
+    EXPECT_FALSE(token.shouldStop());
+}
+
+TEST(CancellationToken, CancelStops) {
+    CancellationToken token;
+    token.cancel();
+    EXPECT_TRUE(token.isCancelled());
+    EXPECT_TRUE(token.shouldStop());
+}
+
+TEST(CancellationToken, PastDeadlineStopsWithoutCancel) {
+    CancellationToken token;
+    token.setDeadline(CancellationToken::Clock::now() - 1ms);
+    EXPECT_FALSE(token.isCancelled());
+    EXPECT_TRUE(token.deadlineExceeded());
+    EXPECT_TRUE(token.shouldStop());
+}
+
+TEST(CancellationToken, FutureDeadlineExpires) {
+    CancellationToken token;
+    token.setDeadline(CancellationToken::Clock::now() + 20ms);
+    EXPECT_FALSE(token.shouldStop());
+    std::this_thread::sleep_for(30ms);
+    EXPECT_TRUE(token.shouldStop());
+}
+
+TEST(CancellationToken, ResetRearmsToken) {
+    CancellationToken token;
+    token.cancel();
+    token.setDeadline(CancellationToken::Clock::now() - 1ms);
+    token.reset();
+    EXPECT_FALSE(token.shouldStop());
+}
+
+TEST(CancellationToken, ParentCancelStopsChild) {
+    CancellationToken parent;
+    CancellationToken child(&parent);
+    EXPECT_FALSE(child.shouldStop());
+    parent.cancel();
+    EXPECT_TRUE(child.isCancelled());
+    // reset() on the child does not clear the parent
+    child.reset();
+    EXPECT_TRUE(child.shouldStop());
+}
+
+TEST(CancellationToken, ChildCancelDoesNotStopParent) {
+    CancellationToken parent;
+    CancellationToken child(&parent);
+    child.cancel();
+    EXPECT_FALSE(parent.shouldStop());
+}
+
+TEST(CancellationToken, CancelFromAnotherThreadIsVisible) {
+    CancellationToken token;
+    std::thread t([&] { token.cancel(); });
+    t.join();
+    EXPECT_TRUE(token.shouldStop());
+}
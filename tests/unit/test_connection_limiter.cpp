@@ -55,6 +55,98 @@ TEST(ConnectionLimiter, MetricsContainExpectedKey) {
     EXPECT_NE(m.find("transcription_active_connections"), std::string::npos);
 }
 
+// ─── Límites por tenant (política del auth API) ─────────────────────────────
+
+static ClientPolicy tenantPolicy(const std::string& id, int max_sessions, double quota = 0) {
+    ClientPolicy p;
+    p.tenant_id = id;
+    p.max_sessions = max_sessions;
+    p.audio_seconds_per_minute = quota;
+    return p;
+}
+
+TEST(ConnectionLimiter, EnforcesTenantSessionLimit) {
+    auto lim = std::make_shared<ConnectionLimiter>(100, 100);
+    auto free_tenant = tenantPolicy("acme", 2);
+    EXPECT_TRUE(lim->tryAcquireTenant(free_tenant));
+    EXPECT_TRUE(lim->tryAcquireTenant(free_tenant));
+    EXPECT_FALSE(lim->tryAcquireTenant(free_tenant));
+
+    // Otros tenants no se ven afectados
+    EXPECT_TRUE(lim->tryAcquireTenant(tenantPolicy("globex", 1)));
+
+    lim->releaseTenant("acme");
+    EXPECT_TRUE(lim->tryAcquireTenant(free_tenant));
+    EXPECT_NE(lim->getMetrics().find("transcription_tenant_session_rejections_total 1"), std::string::npos);
+}
+
+TEST(ConnectionLimiter, PolicyWithoutTenantIsNotTracked) {
+    auto lim = std::make_shared<ConnectionLimiter>(100, 100);
+    ClientPolicy anonymous;
+    anonymous.max_sessions = 1;
+    EXPECT_TRUE(lim->tryAcquireTenant(anonymous));
+    EXPECT_TRUE(lim->tryAcquireTenant(anonymous));
+    EXPECT_TRUE(lim->consumeAudio(anonymous, 1e6));
+}
+
+TEST(ConnectionLimiter, AudioQuotaRefillsPerMinute) {
+    auto lim = std::make_shared<ConnectionLimiter>(100, 100);
+    auto p = tenantPolicy("acme", 0, /*quota=*/60.0); // 60 s/min = 1 s/s
+    auto t0 = ConnectionLimiter::Clock::now();
+
+    EXPECT_TRUE(lim->consumeAudio(p, 50.0, t0));
+    EXPECT_TRUE(lim->consumeAudio(p, 20.0, t0));  // saldo positivo → admite y queda en -10
+    EXPECT_FALSE(lim->consumeAudio(p, 1.0, t0));
+    EXPECT_FALSE(lim->consumeAudio(p, 1.0, t0 + std::chrono::seconds(10))); // saldo 0
+    EXPECT_TRUE(lim->consumeAudio(p, 1.0, t0 + std::chrono::seconds(11)));
+    EXPECT_NE(lim->getMetrics().find("transcription_tenant_quota_rejections_total 2"), std::string::npos);
+}
+
+TEST(ConnectionLimiter, ChargeAudioThrottlesInsteadOfRefusing) {
+    auto lim = std::make_shared<ConnectionLimiter>(100, 100);
+    auto p = tenantPolicy("acme", 0, /*quota=*/60.0); // 1 s/s
+    auto t0 = ConnectionLimiter::Clock::now();
+
+    EXPECT_DOUBLE_EQ(lim->chargeAudio(p, 50.0, t0), 0.0);
+    double wait = lim->chargeAudio(p, 20.0, t0); // saldo -10 → 10 s hasta volver a positivo
+    EXPECT_GT(wait, 10.0);
+    EXPECT_LT(wait, 10.1);
+    // Tras la espera el saldo es positivo: el siguiente chunk se acepta sin pausa
+    auto after = t0 + std::chrono::duration_cast<ConnectionLimiter::Clock::duration>(std::chrono::duration<double>(wait));
+    EXPECT_TRUE(lim->consumeAudio(p, 0.001, after));
+    EXPECT_NE(lim->getMetrics().find("transcription_tenant_quota_throttles_total 1"), std::string::npos);
+    EXPECT_NE(lim->getMetrics().find("transcription_tenant_quota_rejections_total 0"), std::string::npos);
+
+    ClientPolicy anonymous;
+    EXPECT_DOUBLE_EQ(lim->chargeAudio(anonymous, 1e6), 0.0);
+}
+
+TEST(ConnectionLimiter, QuotaSurvivesReconnect) {
+    auto lim = std::make_shared<ConnectionLimiter>(100, 100);
+    auto p = tenantPolicy("acme", 1, 30.0);
+    auto t0 = ConnectionLimiter::Clock::now();
+
+    ASSERT_TRUE(lim->tryAcquireTenant(p));
+    EXPECT_TRUE(lim->consumeAudio(p, 40.0, t0));
+    lim->releaseTenant("acme");
+
+    ASSERT_TRUE(lim->tryAcquireTenant(p));
+    EXPECT_FALSE(lim->consumeAudio(p, 1.0, t0));
+    lim->releaseTenant("acme");
+}
+
+TEST(TenantGuard, ReleasesTenantSlotOnDestruction) {
+    auto lim = std::make_shared<ConnectionLimiter>(100, 100);
+    auto p = tenantPolicy("acme", 1);
+    ASSERT_TRUE(lim->tryAcquireTenant(p));
+    {
+        TenantGuard guard(lim, "acme");
+        EXPECT_FALSE(lim->tryAcquireTenant(p));
+    }
+    EXPECT_TRUE(lim->tryAcquireTenant(p));
+    lim->releaseTenant("acme");
+}
+
 // ─── ConnectionGuard ─────────────────────────────────────────────────────────
 
 TEST(ConnectionGuard, ReleasesSlotOnDestruction) {
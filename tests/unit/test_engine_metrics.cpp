@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include "whisper/EngineMetrics.h"
+#include <string>
+
+// EngineMetrics es un singleton de contadores monotónicos — los tests comparan deltas.
+
+TEST(EngineMetrics, LoopAbortCountsSavedTokens) {
+    auto& m = EngineMetrics::instance();
+    auto saved = [](const std::string& s) {
+        auto pos = s.find("transcription_decode_tokens_saved_total ");
+        return std::stoull(s.substr(pos + std::string("transcription_decode_tokens_saved_total ").size()));
+    };
+    uint64_t before = m.loopAborts();
+    uint64_t saved_before = saved(m.getMetrics());
+    m.recordLoopAbort(24, 224);
+    EXPECT_EQ(m.loopAborts(), before + 1);
+    EXPECT_EQ(saved(m.getMetrics()), saved_before + 200); // presupuesto - emitidos
+}
+
+TEST(EngineMetrics, SavedTokensNeverNegative) {
+    auto& m = EngineMetrics::instance();
+    std::string before = m.getMetrics();
+    m.recordLoopAbort(300, 224); // más tokens que el presupuesto: no resta
+    std::string after = m.getMetrics();
+    auto saved = [](const std::string& s) {
+        auto pos = s.find("transcription_decode_tokens_saved_total ");
+        return std::stoull(s.substr(pos + std::string("transcription_decode_tokens_saved_total ").size()));
+    };
+    EXPECT_EQ(saved(after), saved(before));
+}
+
+TEST(EngineMetrics, PrometheusFormat) {
+    std::string text = EngineMetrics::instance().getMetrics();
+    EXPECT_NE(text.find("transcription_decodes_total "), std::string::npos);
+    EXPECT_NE(text.find("transcription_decode_loop_aborts_total "), std::string::npos);
+    EXPECT_EQ(text.back(), '\n');
+}
+
+TEST(EngineMetrics, FinalLatencyHistogram) {
+    auto& m = EngineMetrics::instance();
+    auto value = [](const std::string& s, const std::string& key) {
+        auto pos = s.find(key + " ");
+        return std::stoull(s.substr(pos + key.size() + 1));
+    };
+    const std::string le_half = "transcription_final_latency_seconds_bucket{le=\"0.5\"}";
+    const std::string le_inf  = "transcription_final_latency_seconds_bucket{le=\"+Inf\"}";
+    std::string before = m.getMetrics();
+
+    m.recordFinal(0.3, true);
+    m.recordFinal(3.0, false);
+
+    std::string after = m.getMetrics();
+    EXPECT_EQ(value(after, le_half), value(before, le_half) + 1); // buckets acumulativos
+    EXPECT_EQ(value(after, le_inf), value(before, le_inf) + 2);
+    EXPECT_EQ(value(after, "transcription_final_latency_seconds_count"),
+              value(before, "transcription_final_latency_seconds_count") + 2);
+    EXPECT_EQ(value(after, "transcription_final_reused_total"),
+              value(before, "transcription_final_reused_total") + 1);
+}
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include "server/FlowControl.h"
+#include <chrono>
+
+using namespace std::chrono_literals;
+using Clock = CreditWindow::Clock;
+
+namespace {
+constexpr size_t WINDOW = 16000 * 20;
+constexpr size_t UPDATE = 16000;
+}
+
+TEST(CreditWindowTest, OpenGrantsFreeRoom) {
+    CreditWindow cw(WINDOW, UPDATE);
+    EXPECT_EQ(cw.open(0), WINDOW);
+    EXPECT_DOUBLE_EQ(cw.availableSeconds(), 20.0);
+
+    CreditWindow partial(WINDOW, UPDATE);
+    EXPECT_EQ(partial.open(16000 * 5), WINDOW - 16000 * 5);
+}
+
+TEST(CreditWindowTest, AudioWithinLimitConsumesCredit) {
+    CreditWindow cw(WINDOW, UPDATE);
+    cw.open(0);
+    EXPECT_TRUE(cw.onAudio(16000 * 5));
+    EXPECT_EQ(cw.received(), 16000u * 5);
+    EXPECT_DOUBLE_EQ(cw.availableSeconds(), 15.0);
+    EXPECT_FALSE(cw.stalled());
+}
+
+TEST(CreditWindowTest, AudioPastLimitIsAnOverrun) {
+    CreditWindow cw(WINDOW, UPDATE);
+    cw.open(0);
+    EXPECT_TRUE(cw.onAudio(WINDOW));
+    EXPECT_TRUE(cw.stalled());            // créditos agotados exactamente
+    EXPECT_FALSE(cw.onAudio(1600));       // cliente que ignora los créditos
+    EXPECT_DOUBLE_EQ(cw.availableSeconds(), 0.0);
+}
+
+TEST(CreditWindowTest, DrainReturnsCreditOnlyInUsefulSteps) {
+    CreditWindow cw(WINDOW, UPDATE);
+    cw.open(0);
+    cw.onAudio(16000 * 12);               // buffer = 12s
+
+    // Sin drenar nada: el límite no cambia
+    EXPECT_FALSE(cw.onDrain(16000 * 12).has_value());
+    // Drenar 0.5s no merece mensaje (cliente con crédito de sobra)
+    EXPECT_FALSE(cw.onDrain(16000 * 12 - 8000).has_value());
+    // Drenar 8s sí: límite = recibido + (ventana - buffer)
+    auto grant = cw.onDrain(16000 * 4);
+    ASSERT_TRUE(grant.has_value());
+    EXPECT_EQ(*grant, 16000u * 12 + WINDOW - 16000 * 4);
+    EXPECT_EQ(cw.limit(), *grant);
+}
+
+TEST(CreditWindowTest, GrantsAreNeverRevoked) {
+    CreditWindow cw(WINDOW, UPDATE);
+    uint64_t first = cw.open(0);
+    cw.onAudio(16000);
+    // El buffer crece por encima de la ventana (p.ej. audio de un cliente que se pasó)
+    EXPECT_FALSE(cw.onDrain(WINDOW + 16000).has_value());
+    EXPECT_EQ(cw.limit(), first);
+}
+
+TEST(CreditWindowTest, StalledClientGetsAnyGrantAndStallIsTimed) {
+    auto before = FlowControlMetrics::instance().getMetrics();
+    CreditWindow cw(WINDOW, UPDATE);
+    cw.open(0);
+    auto t0 = Clock::now();
+    cw.onAudio(WINDOW, t0);
+    ASSERT_TRUE(cw.stalled());
+
+    // Aunque solo se liberen 100ms, un cliente parado recibe el crédito enseguida
+    auto grant = cw.onDrain(WINDOW - 1600, t0 + 2s);
+    ASSERT_TRUE(grant.has_value());
+    EXPECT_EQ(*grant, WINDOW + 1600);
+    EXPECT_FALSE(cw.stalled());
+
+    auto after = FlowControlMetrics::instance().getMetrics();
+    EXPECT_NE(before, after);
+    EXPECT_NE(after.find("transcription_flow_credit_stall_seconds_total"), std::string::npos);
+}
+
+TEST(CreditWindowTest, DroppedAudioStillCountsAsConsumed) {
+    // El audio descartado no ocupa buffer: el límite avanza como si se hubiera procesado,
+    // así el contador del cliente (que lo incluye) sigue alineado con el del servidor.
+    CreditWindow cw(WINDOW, UPDATE);
+    cw.open(0);
+    cw.onAudio(WINDOW);
+    cw.onAudio(16000 * 2);                // descartado en el HWM
+    auto grant = cw.onDrain(WINDOW - 16000 * 3);
+    ASSERT_TRUE(grant.has_value());
+    EXPECT_EQ(*grant, WINDOW + 16000 * 2 + 16000 * 3);
+}
+
+TEST(CreditWindowTest, ReopenKeepsTheLimitCumulative) {
+    // Un segundo config cambia de motor: el contador del cliente no se reinicia,
+    // así que el límite sigue contando desde el inicio de la conexión.
+    CreditWindow cw(WINDOW, UPDATE);
+    uint64_t first = cw.open(0);
+    cw.onAudio(16000 * 15);               // 15s en el buffer del motor viejo
+    uint64_t limit = cw.reopen(0);        // motor nuevo, buffer vacío
+    EXPECT_GT(limit, first);
+    EXPECT_EQ(limit, 16000u * 15 + WINDOW);
+    EXPECT_EQ(cw.received(), 16000u * 15);
+    EXPECT_DOUBLE_EQ(cw.availableSeconds(), 20.0);
+}
+
+TEST(CreditWindowTest, ReopenEndsAStall) {
+    CreditWindow cw(WINDOW, UPDATE);
+    cw.open(0);
+    cw.onAudio(WINDOW);
+    ASSERT_TRUE(cw.stalled());
+    EXPECT_EQ(cw.reopen(0), 2 * WINDOW);
+    EXPECT_FALSE(cw.stalled());
+}
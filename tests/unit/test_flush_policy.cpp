@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include "server/FlushPolicy.h"
+#include "whisper/DecodeConfig.h"
+#include <chrono>
+
+using namespace std::chrono_literals;
+
+namespace {
+constexpr size_t STRIDE = 4000; // 250ms @ 16kHz
+} // namespace
+
+TEST(FlushPolicyTest, NothingBelowTwoSeconds) {
+    FlushPolicy p;
+    EXPECT_FALSE(p.hasMinimumBuffer(31999));
+    EXPECT_FALSE(p.due(31999, 0, 1000ms, false, STRIDE));
+    EXPECT_TRUE(p.due(32000, 0, 0ms, false, STRIDE));
+}
+
+TEST(FlushPolicyTest, LiveDecodesAfterOneStride) {
+    FlushPolicy p;
+    EXPECT_FALSE(p.due(40000, 37000, 0ms, false, STRIDE)); // 3000 muestras nuevas
+    EXPECT_TRUE(p.due(41000, 37000, 0ms, false, STRIDE));
+}
+
+TEST(FlushPolicyTest, SilenceFlushesUndecodedAudio) {
+    FlushPolicy p;
+    EXPECT_FALSE(p.due(40000, 39000, 400ms, false, STRIDE)); // aún no pasaron 400ms
+    EXPECT_TRUE(p.due(40000, 39000, 401ms, false, STRIDE));
+    EXPECT_FALSE(p.due(40000, 40000, 5000ms, false, STRIDE)); // nada nuevo que decodificar
+}
+
+TEST(FlushPolicyTest, BulkWaitsForAFullChunk) {
+    FlushPolicy p;
+    EXPECT_EQ(p.pollInterval(true), 20ms);
+    EXPECT_EQ(p.pollInterval(false), 200ms);
+    EXPECT_FALSE(p.due(TranscriptionEngine::BULK_MAX_CHUNK_SAMPLES - 1, 0, 5000ms, true, STRIDE));
+    EXPECT_TRUE(p.due(TranscriptionEngine::BULK_MAX_CHUNK_SAMPLES, 0, 0ms, true, STRIDE));
+}
+
+TEST(FlushPolicyTest, OptionsOverrideDefaults) {
+    FlushPolicy::Options o;
+    o.min_buffer_samples = 16000;
+    o.silence_flush = 100ms;
+    FlushPolicy p(o);
+    EXPECT_TRUE(p.due(16000, 15000, 150ms, false, STRIDE));
+}
+
+TEST(FlushPolicyTest, AudioCtxFollowsTheWindow) {
+    EXPECT_EQ(audioCtxFor(16000 * 30), 1500); // ventana completa de whisper
+    EXPECT_EQ(audioCtxFor(16000 * 5), 250);
+    EXPECT_EQ(audioCtxFor(8000), 64);         // mínimo
+}
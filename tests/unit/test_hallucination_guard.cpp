@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include "utils/HallucinationGuard.h"
+#include <string>
+#include <string_view>
 
 TEST(HallucinationGuard, NormalTextIsNotHallucination) {
     EXPECT_FALSE(isHallucination("Hola, buenos días. ¿Cómo estás?"));
@@ -53,3 +55,74 @@ TEST(HallucinationGuard, NormalLongSentenceIsNotHallucination) {
         "usando una ventana deslizante con commit semántico basado "
         "en los timestamps de los segmentos de Whisper."));
 }
+
+TEST(HallucinationGuard, TabsAndNewlinesSeparateWords) {
+    EXPECT_TRUE(isHallucination("hola\thola\nhola  hola"));
+}
+
+TEST(HallucinationGuard, AcceptsStringView) {
+    std::string_view text = "la verdad la verdad la verdad la verdad y algo más";
+    EXPECT_TRUE(isHallucination(text.substr(0, 39)));
+    EXPECT_FALSE(isHallucination(text.substr(0, 29)));
+}
+
+// ─── HallucinationTracker (repetición entre commits) ────────────────────────
+
+TEST(HallucinationTracker, RepeatedShortCommitsAreDetected) {
+    HallucinationTracker tracker;
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_FALSE(tracker.check(" Gracias."));
+        tracker.append(" Gracias.");
+    }
+    // Cuarta repetición consecutiva a través de commits
+    EXPECT_TRUE(tracker.check(" Gracias."));
+}
+
+TEST(HallucinationTracker, BigramLoopAcrossCommitsIsDetected) {
+    HallucinationTracker tracker;
+    tracker.append(" la verdad la verdad");
+    EXPECT_FALSE(isHallucination(" la verdad la verdad"));
+    EXPECT_TRUE(tracker.check(" la verdad la verdad"));
+}
+
+TEST(HallucinationTracker, NormalCommitsAreNotDetected) {
+    HallucinationTracker tracker;
+    const char* commits[] = {
+        " El motor de transcripción procesa el audio en tiempo real.",
+        " Usa una ventana deslizante con commit semántico.",
+        " Los timestamps de los segmentos marcan el punto de corte.",
+        " Después el buffer se recorta y sigue el streaming.",
+    };
+    for (const char* c : commits) {
+        EXPECT_FALSE(tracker.check(c)) << c;
+        EXPECT_FALSE(tracker.append(c)) << c;
+    }
+}
+
+TEST(HallucinationTracker, CheckDoesNotModifyState) {
+    HallucinationTracker tracker;
+    tracker.append(" hola hola");
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_FALSE(tracker.check(" hola"));
+    }
+}
+
+TEST(HallucinationTracker, OldBigramsLeaveTheWindow) {
+    HallucinationTracker tracker;
+    tracker.append(" la verdad la verdad la verdad");
+    // Empuja la repetición fuera de la ventana con texto distinto
+    std::string filler;
+    for (size_t i = 0; i < HallucinationTracker::kWindowBigrams; ++i) {
+        filler += " w" + std::to_string(i);
+    }
+    tracker.append(filler);
+    EXPECT_FALSE(tracker.check(" la verdad"));
+}
+
+TEST(HallucinationTracker, ResetClearsHistory) {
+    HallucinationTracker tracker;
+    tracker.append(" hola hola hola");
+    EXPECT_TRUE(tracker.check(" hola"));
+    tracker.reset();
+    EXPECT_FALSE(tracker.check(" hola"));
+}
@@ -4,12 +4,15 @@
 #include <atomic>
 #include <chrono>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 // El InferenceLimiter es un singleton — cada test lo resetea a un estado conocido.
 class InferenceLimiterTest : public ::testing::Test {
 protected:
     void SetUp() override {
         InferenceLimiter::instance().setMaxConcurrency(4);
+        InferenceLimiter::instance().setReservedSlots(1);
     }
 };
 
@@ -92,3 +95,178 @@ TEST_F(InferenceLimiterTest, TryAcquireSucceedsAfterRelease) {
     EXPECT_TRUE(acquired);
     if (acquired) InferenceLimiter::instance().release();
 }
+
+// ─── Prioridades (tier del cliente) ─────────────────────────────────────────
+
+TEST_F(InferenceLimiterTest, LowestPriorityCannotTakeReservedSlot) {
+    InferenceLimiter::instance().setMaxConcurrency(2);
+    auto& lim = InferenceLimiter::instance();
+
+    ASSERT_TRUE(lim.try_acquire(0));
+    EXPECT_FALSE(lim.try_acquire(0)); // el último slot queda reservado
+    EXPECT_TRUE(lim.try_acquire(1));  // standard sí puede usarlo
+    lim.release();
+    lim.release();
+}
+
+TEST_F(InferenceLimiterTest, ReservationNeverBlocksASingleSlot) {
+    InferenceLimiter::instance().setMaxConcurrency(1);
+    InferenceLimiter::instance().setReservedSlots(3);
+    auto& lim = InferenceLimiter::instance();
+    ASSERT_TRUE(lim.try_acquire(0));
+    lim.release();
+}
+
+TEST_F(InferenceLimiterTest, TryAcquireYieldsToHigherPriorityWaiter) {
+    InferenceLimiter::instance().setMaxConcurrency(1);
+    auto& lim = InferenceLimiter::instance();
+    auto holder = std::make_unique<InferenceLimiter::Guard>(1);
+
+    std::atomic<bool> acquired{false};
+    std::atomic<bool> done{false};
+    std::thread premium([&]() {
+        InferenceLimiter::Guard g(2);
+        acquired = true;
+        while (!done) std::this_thread::yield();
+    });
+    while (lim.getMetrics().find("transcription_inference_waiting{priority=\"2\"} 1") == std::string::npos) {
+        std::this_thread::yield();
+    }
+
+    holder.reset();
+    // El slot libre es para el waiter premium, no para un sondeo standard
+    bool stolen = lim.try_acquire(1);
+    if (stolen) lim.release();
+    while (!acquired) std::this_thread::yield();
+    done = true;
+    premium.join();
+    EXPECT_TRUE(acquired);
+    EXPECT_FALSE(stolen);
+}
+
+TEST_F(InferenceLimiterTest, WaitersAreServedByPriority) {
+    InferenceLimiter::instance().setMaxConcurrency(1);
+    auto& lim = InferenceLimiter::instance();
+    auto holder = std::make_unique<InferenceLimiter::Guard>(1);
+
+    std::mutex order_mutex;
+    std::vector<int> order;
+    auto waiter = [&](int priority) {
+        InferenceLimiter::Guard g(priority);
+        std::lock_guard<std::mutex> lock(order_mutex);
+        order.push_back(priority);
+    };
+    std::thread low(waiter, 0);
+    while (lim.getMetrics().find("transcription_inference_waiting{priority=\"0\"} 1") == std::string::npos) {
+        std::this_thread::yield();
+    }
+    std::thread high(waiter, 2);
+    while (lim.getMetrics().find("transcription_inference_waiting{priority=\"2\"} 1") == std::string::npos) {
+        std::this_thread::yield();
+    }
+
+    holder.reset();
+    low.join();
+    high.join();
+    ASSERT_EQ(order.size(), 2u);
+    EXPECT_EQ(order[0], 2);
+    EXPECT_EQ(order[1], 0);
+}
+
+TEST_F(InferenceLimiterTest, CountsBusySkipsPerPriority) {
+    InferenceLimiter::instance().setMaxConcurrency(1);
+    auto& lim = InferenceLimiter::instance();
+    std::string before = lim.getMetrics();
+    {
+        InferenceLimiter::Guard g;
+        EXPECT_FALSE(lim.try_acquire(0));
+    }
+    EXPECT_NE(lim.getMetrics(), before);
+    EXPECT_NE(lim.getMetrics().find("transcription_inference_busy_skips_total{priority=\"0\"}"), std::string::npos);
+}
+
+TEST_F(InferenceLimiterTest, FinalsGoAheadOfEveryTier) {
+    InferenceLimiter::instance().setMaxConcurrency(1);
+    auto& lim = InferenceLimiter::instance();
+    auto holder = std::make_unique<InferenceLimiter::Guard>(1);
+
+    std::mutex order_mutex;
+    std::vector<int> order;
+    auto waiter = [&](int priority) {
+        InferenceLimiter::Guard g(priority);
+        std::lock_guard<std::mutex> lock(order_mutex);
+        order.push_back(priority);
+    };
+    std::thread premium(waiter, 2);
+    while (lim.getMetrics().find("transcription_inference_waiting{priority=\"2\"} 1") == std::string::npos) {
+        std::this_thread::yield();
+    }
+    std::thread final_(waiter, InferenceLimiter::FINAL_PRIORITY);
+    while (lim.getMetrics().find("transcription_inference_waiting{priority=\"3\"} 1") == std::string::npos) {
+        std::this_thread::yield();
+    }
+
+    holder.reset();
+    premium.join();
+    final_.join();
+    ASSERT_EQ(order.size(), 2u);
+    EXPECT_EQ(order[0], InferenceLimiter::FINAL_PRIORITY); // el final adelanta incluso a premium
+    EXPECT_EQ(order[1], 2);
+}
+
+TEST_F(InferenceLimiterTest, DuePartialHoldsItsPlaceAgainstLowerTierWaiters) {
+    InferenceLimiter::instance().setMaxConcurrency(1);
+    auto& lim = InferenceLimiter::instance();
+    auto holder = std::make_unique<InferenceLimiter::Guard>(1);
+
+    // Un parcial premium sondea, no encuentra slot y queda marcado como waiter
+    ASSERT_FALSE(lim.try_acquire(2));
+    InferenceLimiter::WaitMark mark;
+    mark.set(2);
+
+    std::atomic<bool> acquired{false};
+    std::thread offline([&]() {
+        InferenceLimiter::Guard g(0); // worker offline / final free-tier bloqueante
+        acquired = true;
+    });
+    while (lim.getMetrics().find("transcription_inference_waiting{priority=\"0\"} 1") == std::string::npos) {
+        std::this_thread::yield();
+    }
+
+    holder.reset();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(acquired); // el slot libre queda para el parcial
+    ASSERT_TRUE(lim.try_acquire(2)); // su propia marca no lo frena
+    mark.clear();
+    lim.release();
+    offline.join();
+    EXPECT_TRUE(acquired);
+}
+
+TEST_F(InferenceLimiterTest, WaitMarkClearsOnDestruction) {
+    auto& lim = InferenceLimiter::instance();
+    {
+        InferenceLimiter::WaitMark mark;
+        mark.set(1);
+        mark.set(2); // cambio de tier: se mueve, no se duplica
+        EXPECT_NE(lim.getMetrics().find("transcription_inference_waiting{priority=\"1\"} 0"), std::string::npos);
+        EXPECT_NE(lim.getMetrics().find("transcription_inference_waiting{priority=\"2\"} 1"), std::string::npos);
+        EXPECT_FALSE(lim.try_acquire(1));
+    }
+    EXPECT_NE(lim.getMetrics().find("transcription_inference_waiting{priority=\"2\"} 0"), std::string::npos);
+    EXPECT_TRUE(lim.try_acquire(1));
+    lim.release();
+}
+
+TEST(InferenceLimiterAdmitsTest, PureRuleMatchesTheLimiter) {
+    // La regla sin estado que usa el simulador (bench/sim)
+    std::array<int, InferenceLimiter::PRIORITY_LEVELS> waiting{};
+    EXPECT_TRUE(InferenceLimiter::admits(1, 1, 2, 1, waiting));
+    EXPECT_FALSE(InferenceLimiter::admits(0, 1, 2, 1, waiting)); // slot reservado
+    EXPECT_FALSE(InferenceLimiter::admits(1, 2, 2, 1, waiting)); // lleno
+    EXPECT_TRUE(InferenceLimiter::admits(0, 0, 1, 3, waiting));  // la reserva nunca bloquea un único slot
+
+    waiting[InferenceLimiter::FINAL_PRIORITY] = 1;
+    EXPECT_FALSE(InferenceLimiter::admits(2, 0, 2, 1, waiting)); // un final espera
+    EXPECT_TRUE(InferenceLimiter::admits(InferenceLimiter::FINAL_PRIORITY, 0, 2, 1, waiting));
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include "log/Log.h"
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::string readAll(std::FILE* f) {
+    std::fflush(f);
+    std::rewind(f);
+    std::string content;
+    char buf[4096];
+    size_t n;
+    while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) content.append(buf, n);
+    return content;
+}
+
+} // namespace
+
+// El logger es global — cada test redirige la salida a ficheros temporales
+// y restaura nivel/formato/salida al terminar.
+class LogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        out_ = std::tmpfile();
+        err_ = std::tmpfile();
+        ASSERT_NE(out_, nullptr);
+        ASSERT_NE(err_, nullptr);
+        Log::flush();
+        Log::setOutput(out_, err_);
+        Log::setLevel(Log::Level::INFO);
+        Log::setFormat(Log::Format::TEXT);
+    }
+
+    void TearDown() override {
+        Log::flush();
+        Log::setOutput(stdout, stderr);
+        Log::configureFromEnv();
+        std::fclose(out_);
+        std::fclose(err_);
+    }
+
+    std::FILE* out_ = nullptr;
+    std::FILE* err_ = nullptr;
+};
+
+TEST(LogLevel, ParseLevelIsCaseInsensitive) {
+    EXPECT_EQ(Log::parseLevel("DEBUG", Log::Level::INFO), Log::Level::DEBUG);
+    EXPECT_EQ(Log::parseLevel("Warn", Log::Level::INFO), Log::Level::WARN);
+    EXPECT_EQ(Log::parseLevel("warning", Log::Level::INFO), Log::Level::WARN);
+    EXPECT_EQ(Log::parseLevel("error", Log::Level::INFO), Log::Level::ERROR);
+    EXPECT_EQ(Log::parseLevel("off", Log::Level::INFO), Log::Level::OFF);
+}
+
+TEST(LogLevel, ParseLevelFallsBackOnUnknown) {
+    EXPECT_EQ(Log::parseLevel("verbose", Log::Level::WARN), Log::Level::WARN);
+    EXPECT_EQ(Log::parseLevel("", Log::Level::INFO), Log::Level::INFO);
+}
+
+TEST(LogFormat, TextLineHasTagAndContext) {
+    auto line = Log::formatLine(Log::Level::WARN, std::chrono::system_clock::now(),
+                                "Cache miss", "session-1", Log::Format::TEXT);
+    EXPECT_NE(line.find("[WARN]  [session-1] Cache miss"), std::string::npos);
+}
+
+TEST(LogFormat, JsonLineEscapesSpecialCharacters) {
+    auto line = Log::formatLine(Log::Level::ERROR, std::chrono::system_clock::now(),
+                                "bad \"quote\"\n\\", "", Log::Format::JSON);
+    EXPECT_EQ(line.front(), '{');
+    EXPECT_EQ(line.back(), '}');
+    EXPECT_NE(line.find("\"level\":\"error\""), std::string::npos);
+    EXPECT_NE(line.find("\"msg\":\"bad \\\"quote\\\"\\n\\\\\""), std::string::npos);
+    EXPECT_EQ(line.find("\"ctx\""), std::string::npos); // ctx vacío se omite
+}
+
+TEST_F(LogTest, RecordsAreWrittenAfterFlush) {
+    Log::info("hello", "ctx");
+    Log::error("boom");
+    Log::flush();
+    EXPECT_NE(readAll(out_).find("[INFO]  [ctx] hello"), std::string::npos);
+    EXPECT_NE(readAll(err_).find("[ERROR] boom"), std::string::npos);
+}
+
+TEST_F(LogTest, DisabledLevelDoesNotBuildMessage) {
+    bool built = false;
+    Log::debug([&] { built = true; return std::string("expensive"); });
+    Log::flush();
+    EXPECT_FALSE(built);
+    EXPECT_TRUE(readAll(out_).empty());
+}
+
+TEST_F(LogTest, ConcurrentProducersLoseNoRecords) {
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 500;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([t] {
+            for (int i = 0; i < kPerThread; ++i) {
+                Log::info("msg " + std::to_string(i), "t" + std::to_string(t));
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    Log::flush();
+
+    std::string content = readAll(out_);
+    size_t lines = 0;
+    for (char c : content) if (c == '\n') ++lines;
+    EXPECT_EQ(lines, static_cast<size_t>(kThreads * kPerThread));
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include "whisper/MappedModelFile.h"
+#include "whisper/ModelCache.h"
+#include "utils/ProcessMemory.h"
+#include <unistd.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+class MappedModelFileTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = fs::temp_directory_path() / ("mapped_model_" + std::to_string(::getpid()));
+        fs::create_directories(dir_);
+    }
+
+    void TearDown() override { fs::remove_all(dir_); }
+
+    fs::path write(const std::string& name, const std::string& content) {
+        fs::path p = dir_ / name;
+        std::ofstream(p, std::ios::binary) << content;
+        return p;
+    }
+
+    fs::path dir_;
+};
+
+// ─── Loader sobre el mapeo ───────────────────────────────────────────────────
+
+TEST_F(MappedModelFileTest, LoaderReadsTheWholeFileInOrder) {
+    std::string content;
+    for (int i = 0; i < 10000; ++i) content += static_cast<char>(i * 31);
+    MappedModelFile file(write("model.bin", content).string());
+    EXPECT_EQ(file.size(), content.size());
+
+    whisper_model_loader l = file.loader();
+    std::string out;
+    char buf[777];
+    while (!l.eof(l.context)) {
+        size_t n = l.read(l.context, buf, sizeof buf);
+        ASSERT_GT(n, 0u);
+        out.append(buf, n);
+    }
+    l.close(l.context);
+    EXPECT_EQ(out, content);
+    EXPECT_EQ(file.position(), content.size());
+}
+
+TEST_F(MappedModelFileTest, ReadPastTheEndIsShort) {
+    MappedModelFile file(write("small.bin", "abcdef").string());
+    whisper_model_loader l = file.loader();
+    char buf[16] = {};
+    EXPECT_EQ(l.read(l.context, buf, 4), 4u);
+    EXPECT_FALSE(l.eof(l.context));
+    EXPECT_EQ(l.read(l.context, buf, sizeof buf), 2u);   // solo quedaban 2 bytes
+    EXPECT_EQ(std::string(buf, 2), "ef");
+    EXPECT_TRUE(l.eof(l.context));
+    EXPECT_EQ(l.read(l.context, buf, sizeof buf), 0u);
+}
+
+TEST_F(MappedModelFileTest, MissingOrEmptyFileThrows) {
+    EXPECT_THROW(MappedModelFile((dir_ / "nope.bin").string()), std::runtime_error);
+    EXPECT_THROW(MappedModelFile(write("empty.bin", "").string()), std::runtime_error);
+}
+
+TEST_F(MappedModelFileTest, ParsesLoadMode) {
+    EXPECT_EQ(ModelCache::parseLoadMode("read"), ModelCache::LoadMode::Read);
+    EXPECT_EQ(ModelCache::parseLoadMode("mmap"), ModelCache::LoadMode::Mmap);
+    EXPECT_STREQ(ModelCache::loadModeName(ModelCache::LoadMode::Mmap), "mmap");
+    EXPECT_THROW(ModelCache::parseLoadMode("MMAP"), std::invalid_argument);
+}
+
+// ─── Memoria del proceso ─────────────────────────────────────────────────────
+
+TEST_F(MappedModelFileTest, ParsesProcStatusAndSmapsRollup) {
+    auto status = write("status",
+                        "Name:\tjota-transcriber\n"
+                        "VmRSS:\t  524288 kB\n"
+                        "RssAnon:\t  409600 kB\n"
+                        "RssFile:\t  114688 kB\n"
+                        "RssShmem:\t       0 kB\n");
+    auto rollup = write("smaps_rollup",
+                        "00400000-7fff0000 ---p 00000000 00:00 0  [rollup]\n"
+                        "Rss:              524288 kB\n"
+                        "Pss:              430080 kB\n"
+                        "Pss_Anon:         409600 kB\n");
+    auto u = procmem::read(status.string(), rollup.string());
+    EXPECT_EQ(u.rss, 524288u * 1024);
+    EXPECT_EQ(u.rss_anon, 409600u * 1024);
+    EXPECT_EQ(u.rss_file, 114688u * 1024);
+    EXPECT_EQ(u.rss_shmem, 0u);
+    EXPECT_EQ(u.pss, 430080u * 1024);                      // Pss, no Pss_Anon
+}
+
+TEST_F(MappedModelFileTest, MissingProcFilesReadAsZero) {
+    auto u = procmem::read((dir_ / "no_status").string(), (dir_ / "no_rollup").string());
+    EXPECT_EQ(u.rss, 0u);
+    EXPECT_EQ(u.pss, 0u);
+}
+
+TEST_F(MappedModelFileTest, UnmappingReturnsFilePagesFromRss) {
+    std::string content(8u << 20, 'x');
+    auto path = write("big.bin", content).string();
+    // En tmpfs (/tmp en muchos sistemas) las páginas mapeadas cuentan como RssShmem, no RssFile.
+    auto mapped = [] {
+        const auto u = procmem::read();
+        return u.rss_file + u.rss_shmem;
+    };
+    if (procmem::read().rss == 0) GTEST_SKIP() << "sin /proc/self/status";
+    const size_t before = mapped();
+    {
+        MappedModelFile file(path);
+        whisper_model_loader l = file.loader();
+        std::vector<char> buf(1 << 20);
+        while (!l.eof(l.context)) l.read(l.context, buf.data(), buf.size());
+        EXPECT_GE(mapped(), before + (4u << 20)); // páginas del fichero residentes
+    }
+    EXPECT_LT(mapped(), before + (4u << 20));     // munmap las devuelve
+}
@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include "server/MemoryBudget.h"
+#include <chrono>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace {
+constexpr size_t MB = 1024 * 1024;
+} // namespace
+
+// ─── Contabilidad ────────────────────────────────────────────────────────────
+
+TEST(MemoryBudgetTest, UnlimitedBudgetOnlyAccounts) {
+    MemoryBudget budget;
+    auto a = budget.reserve(10 * MB, 500 * MB);
+    auto b = budget.reserve(10 * MB, 500 * MB);
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    EXPECT_EQ(budget.charged(), 20 * MB);
+    EXPECT_EQ(budget.available(), SIZE_MAX);
+    a.reset();
+    EXPECT_EQ(budget.charged(), 10 * MB);
+}
+
+TEST(MemoryBudgetTest, SessionIsChargedMaxOfEstimateAndUse) {
+    MemoryBudget budget;
+    auto a = budget.reserve(10 * MB, 0);
+    a->update(MemoryBudget::Component::State, 4 * MB);
+    a->update(MemoryBudget::Component::Audio, 2 * MB);
+    EXPECT_EQ(a->used(), 6 * MB);
+    EXPECT_EQ(budget.charged(), 10 * MB); // por debajo de lo reservado
+
+    a->update(MemoryBudget::Component::Text, 7 * MB);
+    EXPECT_EQ(budget.charged(), 13 * MB); // creció por encima de la estimación
+
+    a->update(MemoryBudget::Component::Text, 1 * MB); // reemplaza, no suma
+    EXPECT_EQ(a->used(), 7 * MB);
+    EXPECT_EQ(budget.charged(), 10 * MB);
+}
+
+TEST(MemoryBudgetTest, EstimateCoversStateAudioAndText) {
+    EXPECT_EQ(MemoryBudget::sessionEstimate(0),
+              MemoryBudget::AUDIO_RESERVE_BYTES + MemoryBudget::TEXT_ALLOWANCE_BYTES);
+    EXPECT_EQ(MemoryBudget::sessionEstimate(40 * MB) - MemoryBudget::sessionEstimate(0), 40 * MB);
+}
+
+// ─── Presupuesto ─────────────────────────────────────────────────────────────
+
+TEST(MemoryBudgetTest, RefusesBeyondBudgetIncludingSharedMemory) {
+    MemoryBudget budget;
+    MemoryBudget::Config cfg;
+    cfg.budget_bytes = 100 * MB;
+    budget.configure(cfg);
+
+    auto a = budget.reserve(30 * MB, 50 * MB);
+    ASSERT_NE(a, nullptr);
+    EXPECT_EQ(budget.available(), 20 * MB);
+    EXPECT_EQ(budget.reserve(30 * MB, 50 * MB), nullptr); // 50 + 30 + 30 > 100
+    EXPECT_NE(budget.reserve(20 * MB, 50 * MB), nullptr); // cabe justo
+
+    EXPECT_NE(budget.getMetrics().find("transcription_memory_rejected_total 1\n"), std::string::npos);
+    EXPECT_NE(budget.getMetrics().find("transcription_memory_queued_total 0\n"), std::string::npos); // sin espera
+    EXPECT_NE(budget.getMetrics().find("transcription_memory_shared_bytes 52428800\n"), std::string::npos);
+}
+
+TEST(MemoryBudgetTest, SharedBytesCanBeRefreshedWithoutAReservation) {
+    MemoryBudget budget;
+    MemoryBudget::Config cfg;
+    cfg.budget_bytes = 100 * MB;
+    budget.configure(cfg);
+
+    auto a = budget.reserve(10 * MB, 20 * MB);
+    ASSERT_NE(a, nullptr);
+    budget.updateShared(60 * MB); // se cargó una segunda réplica del modelo
+    EXPECT_EQ(budget.available(), 30 * MB);
+    budget.updateShared(0);
+    EXPECT_EQ(budget.available(), 90 * MB);
+}
+
+TEST(MemoryBudgetTest, GrowthPastEstimateCountsAgainstBudget) {
+    MemoryBudget budget;
+    MemoryBudget::Config cfg;
+    cfg.budget_bytes = 100 * MB;
+    budget.configure(cfg);
+
+    auto a = budget.reserve(40 * MB, 0);
+    a->update(MemoryBudget::Component::Audio, 70 * MB);
+    EXPECT_EQ(budget.reserve(40 * MB, 0), nullptr);
+    a->update(MemoryBudget::Component::Audio, 10 * MB);
+    EXPECT_NE(budget.reserve(40 * MB, 0), nullptr);
+}
+
+TEST(MemoryBudgetTest, QueuedSessionIsAdmittedWhenMemoryFrees) {
+    MemoryBudget budget;
+    MemoryBudget::Config cfg;
+    cfg.budget_bytes = 100 * MB;
+    cfg.queue_timeout = 5000ms;
+    budget.configure(cfg);
+
+    auto a = budget.reserve(80 * MB, 0);
+    std::thread closer([&] {
+        std::this_thread::sleep_for(50ms);
+        a.reset(); // la sesión termina y despierta a la que espera
+    });
+    auto b = budget.reserve(80 * MB, 0);
+    closer.join();
+    EXPECT_NE(b, nullptr);
+    EXPECT_NE(budget.getMetrics().find("transcription_memory_queued_total 1\n"), std::string::npos);
+    EXPECT_NE(budget.getMetrics().find("transcription_memory_rejected_total 0\n"), std::string::npos);
+}
+
+TEST(MemoryBudgetTest, QueueTimesOut) {
+    MemoryBudget budget;
+    MemoryBudget::Config cfg;
+    cfg.budget_bytes = 100 * MB;
+    cfg.queue_timeout = 30ms;
+    budget.configure(cfg);
+
+    auto a = budget.reserve(80 * MB, 0);
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(budget.reserve(80 * MB, 0), nullptr);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 30ms);
+}
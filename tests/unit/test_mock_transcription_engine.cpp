@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+#include "whisper/MockTranscriptionEngine.h"
+#include "whisper/TranscriptionBackend.h"
+#include "whisper/CancellationToken.h"
+#include "whisper/EngineMetrics.h"
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Sin latencia: los tests de texto y buffer no deben dormir.
+MockTranscriptionEngine::Options instant() {
+    MockTranscriptionEngine::Options o;
+    o.base_latency_ms = 0.0;
+    o.latency_ms_per_audio_second = 0.0;
+    return o; // 2.5 palabras/s = una palabra cada 6400 muestras
+}
+
+std::vector<float> seconds(double s) {
+    return std::vector<float>(static_cast<size_t>(s * 16000), 0.0f);
+}
+
+} // namespace
+
+// ─── Texto sintético ─────────────────────────────────────────────────────────
+
+TEST(MockTranscriptionEngineTest, ShortWindowIsAllPartial) {
+    MockTranscriptionEngine engine(instant());
+    engine.processAudioChunk(seconds(3));
+
+    auto res = engine.transcribeSlidingWindow();
+    EXPECT_EQ(res.partial_text, " w0 w1 w2 w3 w4 w5 w6 w7");
+    EXPECT_TRUE(res.committed_text.empty());
+    EXPECT_EQ(engine.getBufferSize(), 48000u);
+}
+
+TEST(MockTranscriptionEngineTest, CommitKeepsLastTwoSecondsAsOverlap) {
+    MockTranscriptionEngine engine(instant());
+    engine.processAudioChunk(seconds(12));
+
+    auto res = engine.transcribeSlidingWindow();
+    EXPECT_EQ(res.committed_text, engine.textFor(0, 160000)); // w0..w24
+    EXPECT_EQ(res.partial_text, " w25 w26 w27 w28 w29");
+    EXPECT_EQ(engine.getBufferSize(), 32000u);
+}
+
+TEST(MockTranscriptionEngineTest, CommitWindowIsConfigurable) {
+    auto opt = instant();
+    opt.commit_window_samples = 16000 * 5;
+    MockTranscriptionEngine engine(opt);
+    engine.processAudioChunk(seconds(6));
+
+    auto res = engine.transcribeSlidingWindow();
+    EXPECT_EQ(res.committed_text, engine.textFor(0, 64000)); // w0..w9
+    EXPECT_EQ(engine.getBufferSize(), 32000u);
+}
+
+TEST(MockTranscriptionEngineTest, ForceCommitDrainsEverything) {
+    MockTranscriptionEngine engine(instant());
+    engine.processAudioChunk(seconds(1));
+
+    auto res = engine.transcribeSlidingWindow(true);
+    EXPECT_EQ(res.committed_text, " w0 w1 w2");
+    EXPECT_EQ(engine.getBufferSize(), 0u);
+}
+
+TEST(MockTranscriptionEngineTest, TextDoesNotDependOnChunking) {
+    // 25s en chunks de 250ms con un parcial cada 2s: cada palabra sale una sola vez.
+    MockTranscriptionEngine engine(instant());
+    std::string text;
+    for (int i = 1; i <= 100; ++i) {
+        engine.processAudioChunk(seconds(0.25));
+        if (i % 8 == 0) text += engine.transcribeSlidingWindow().committed_text;
+    }
+    text += engine.transcribeSlidingWindow(true).committed_text;
+    EXPECT_EQ(text, engine.textFor(0, 16000 * 25));
+}
+
+TEST(MockTranscriptionEngineTest, VocabularyCycles) {
+    auto opt = instant();
+    opt.vocabulary = {"hola", "mundo"};
+    MockTranscriptionEngine engine(opt);
+    engine.processAudioChunk(seconds(1.2));
+    EXPECT_EQ(engine.transcribeSlidingWindow(true).committed_text, " hola mundo hola");
+}
+
+// ─── Buffer y modos ──────────────────────────────────────────────────────────
+
+TEST(MockTranscriptionEngineTest, HighWaterMarkDropsChunks) {
+    MockTranscriptionEngine engine(instant());
+    EXPECT_FALSE(engine.processAudioChunk(seconds(20)));
+    EXPECT_TRUE(engine.processAudioChunk(seconds(1)));
+    EXPECT_EQ(engine.getBufferSize(), TranscriptionEngine::HIGH_WATER_MARK_SAMPLES);
+}
+
+TEST(MockTranscriptionEngineTest, BulkChunkCommitsAtMostMaxChunk) {
+    MockTranscriptionEngine engine(instant());
+    engine.processAudioChunk(seconds(20));
+
+    auto res = engine.transcribeBulkChunk();
+    EXPECT_EQ(res.committed_text, engine.textFor(0, TranscriptionEngine::BULK_MAX_CHUNK_SAMPLES));
+    EXPECT_TRUE(res.partial_text.empty());
+    EXPECT_EQ(engine.getBufferSize(), 32000u);
+}
+
+TEST(MockTranscriptionEngineTest, FreshPartialIsReusedAsFinal) {
+    MockTranscriptionEngine engine(instant());
+    engine.processAudioChunk(seconds(3));
+    auto partial = engine.transcribeSlidingWindow();
+
+    auto final_text = engine.takeFreshHypothesis();
+    ASSERT_TRUE(final_text.has_value());
+    EXPECT_EQ(*final_text, partial.partial_text);
+    EXPECT_EQ(engine.getBufferSize(), 0u);
+}
+
+TEST(MockTranscriptionEngineTest, NewAudioInvalidatesHypothesis) {
+    MockTranscriptionEngine engine(instant());
+    engine.processAudioChunk(seconds(3));
+    engine.transcribeSlidingWindow();
+    engine.processAudioChunk(seconds(0.1));
+    EXPECT_FALSE(engine.takeFreshHypothesis().has_value());
+}
+
+TEST(MockTranscriptionEngineTest, UnchangedWindowIsNotDecodedAgain) {
+    MockTranscriptionEngine engine(instant());
+    engine.processAudioChunk(seconds(3));
+    auto first = engine.transcribeSlidingWindow();
+
+    uint64_t hits = EngineMetrics::instance().decodeCacheHits();
+    auto second = engine.transcribeSlidingWindow();
+    EXPECT_EQ(EngineMetrics::instance().decodeCacheHits(), hits + 1);
+    EXPECT_EQ(second.partial_text, first.partial_text);
+}
+
+// ─── Latencia sintética ──────────────────────────────────────────────────────
+
+TEST(MockTranscriptionEngineTest, LatencyGrowsWithWindow) {
+    MockTranscriptionEngine::Options opt;
+    opt.base_latency_ms = 20.0;
+    opt.latency_ms_per_audio_second = 10.0;
+    MockTranscriptionEngine engine(opt);
+    engine.processAudioChunk(seconds(3));
+
+    auto t0 = std::chrono::steady_clock::now();
+    engine.transcribeSlidingWindow();
+    auto elapsed = std::chrono::steady_clock::now() - t0;
+    EXPECT_GE(elapsed, std::chrono::milliseconds(50)); // 20 + 3 x 10
+}
+
+TEST(MockTranscriptionEngineTest, CancelStopsTheSleepAndKeepsBuffer) {
+    MockTranscriptionEngine::Options opt;
+    opt.base_latency_ms = 10000.0;
+    MockTranscriptionEngine engine(opt);
+    engine.processAudioChunk(seconds(3));
+
+    CancellationToken token;
+    token.setDeadline(std::chrono::steady_clock::now() + std::chrono::milliseconds(30));
+    auto t0 = std::chrono::steady_clock::now();
+    auto res = engine.transcribeSlidingWindow(false, &token);
+    EXPECT_LT(std::chrono::steady_clock::now() - t0, std::chrono::seconds(2));
+    EXPECT_TRUE(res.cancelled);
+    EXPECT_TRUE(res.partial_text.empty());
+    EXPECT_EQ(engine.getBufferSize(), 48000u);
+}
+
+// ─── Selección de backend ────────────────────────────────────────────────────
+
+TEST(TranscriptionBackendTest, ParsesBackendNames) {
+    EXPECT_EQ(TranscriptionBackend::parse("whisper"), TranscriptionBackend::Kind::Whisper);
+    EXPECT_EQ(TranscriptionBackend::parse("mock"), TranscriptionBackend::Kind::Mock);
+    EXPECT_FALSE(TranscriptionBackend::parse("gpt").has_value());
+}
+
+TEST(TranscriptionBackendTest, MockBackendSkipsTheModel) {
+    auto& backend = TranscriptionBackend::instance();
+    backend.configure(TranscriptionBackend::Kind::Mock, instant());
+    EXPECT_FALSE(backend.usesModel());
+    auto engine = backend.createMock();
+    ASSERT_NE(engine, nullptr);
+    EXPECT_TRUE(engine->isReady());
+
+    backend.configure(TranscriptionBackend::Kind::Whisper);
+    EXPECT_TRUE(backend.usesModel());
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "whisper/ModelCache.h"
+#include "whisper/NumaPlacement.h"
 #include <filesystem>
 #include <thread>
 #include <chrono>
@@ -24,6 +25,7 @@ protected:
     void TearDown() override {
         ModelCache::instance().forceUnload();
         ModelCache::instance().configure(300); // restaurar default
+        ModelCache::instance().setLoadMode(ModelCache::LoadMode::Read);
     }
 };
 
@@ -81,3 +83,55 @@ TEST_F(ModelCacheTest, MetricsContainExpectedKeys) {
     EXPECT_NE(m.find("transcription_model_ref_count"), std::string::npos);
     ModelCache::instance().release();
 }
+
+TEST_F(ModelCacheTest, LoadedModelIsNeverBudgetedAsFree) {
+    // Medido o, si el delta del heap no sirve, estimado por el tamaño del fichero
+    ModelCache::instance().acquire(MODEL_PATH);
+    EXPECT_GT(ModelCache::instance().modelBytes(), 0u);
+    EXPECT_GT(ModelCache::instance().stateBytes(), 0u);
+    EXPECT_GE(ModelCache::instance().sharedBytes(), ModelCache::instance().modelBytes());
+    ModelCache::instance().release();
+}
+
+TEST(ModelCacheEstimate, FallbackIsAnUpperBoundFromTheFileSize) {
+    EXPECT_EQ(ModelCache::estimateModelBytes(500u << 20), 500u << 20);
+    EXPECT_EQ(ModelCache::estimateStateBytes(1u << 30), 256u << 20);
+    EXPECT_EQ(ModelCache::estimateStateBytes(0), ModelCache::STATE_ESTIMATE_MIN_BYTES);
+}
+
+TEST_F(ModelCacheTest, ReplicasLoadSeparatelyOnTheirNode) {
+    NumaPlacement::instance().configure(NumaPlacement::Mode::Replicate, numa::parseSpec("0;0"));
+    std::thread([] {
+        auto* ctx0 = ModelCache::replica(0).acquire(MODEL_PATH);
+        auto* ctx1 = ModelCache::replica(1).acquire(MODEL_PATH);
+        EXPECT_NE(ctx0, ctx1);                                  // una copia por nodo
+        EXPECT_EQ(&ModelCache::replica(0), &ModelCache::instance());
+        EXPECT_EQ(ModelCache::replica(1).refCount(), 1);
+        EXPECT_EQ(NumaPlacement::pinnedNode(), -1);             // la carga no deja el hilo fijado
+
+        // Un decode del nodo 0 sobre la réplica 1 cuenta como remoto.
+        NumaPlacement::instance().pinCurrentThread(0);
+        NumaPlacement::instance().recordDecode(ctx1, 1.0, 0.1);
+        NumaPlacement::instance().recordDecode(ctx0, 1.0, 0.1);
+        EXPECT_DOUBLE_EQ(NumaPlacement::instance().remoteRatio(), 0.5);
+    }).join();
+    // El presupuesto de memoria ve los pesos de las dos réplicas
+    EXPECT_EQ(ModelCache::totalSharedBytes(),
+              ModelCache::instance().sharedBytes() + ModelCache::replica(1).sharedBytes());
+    EXPECT_GT(ModelCache::totalSharedBytes(), ModelCache::instance().sharedBytes());
+    ModelCache::replica(1).release();
+    ModelCache::replica(1).forceUnload();
+    ModelCache::instance().release();
+    NumaPlacement::instance().configure(NumaPlacement::Mode::Off, {});
+}
+
+TEST_F(ModelCacheTest, MmapLoadIsTimedAndMeasured) {
+    ModelCache::instance().setLoadMode(ModelCache::LoadMode::Mmap);
+    auto* ctx = ModelCache::instance().acquire(MODEL_PATH);
+    EXPECT_NE(ctx, nullptr);
+    EXPECT_GT(ModelCache::instance().loadSeconds(), 0.0);
+    std::string m = ModelCache::instance().getMetrics();
+    EXPECT_NE(m.find("transcription_model_load_seconds{mode=\"mmap\"}"), std::string::npos);
+    EXPECT_NE(m.find("transcription_model_load_rss_bytes"), std::string::npos);
+    ModelCache::instance().release();
+}
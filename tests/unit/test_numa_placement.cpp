@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include "whisper/NumaPlacement.h"
+#include "utils/NumaTopology.h"
+#include <unistd.h>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+class NumaPlacementTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        NumaPlacement::instance().configure(NumaPlacement::Mode::Off, {});
+    }
+
+    // Todos los nodos simulados sobre la CPU 0, que existe en cualquier máquina.
+    void simulate(NumaPlacement::Mode mode, int nodes) {
+        std::string spec;
+        for (int i = 0; i < nodes; ++i) spec += (i ? ";" : "") + std::string("0");
+        NumaPlacement::instance().configure(mode, numa::parseSpec(spec));
+    }
+
+    // Pinning en un hilo aparte: la afinidad del hilo de gtest no se toca.
+    template <class F>
+    static void onThread(F f) {
+        std::thread(f).join();
+    }
+};
+
+// ─── Topología ───────────────────────────────────────────────────────────────
+
+TEST_F(NumaPlacementTest, ParsesSimulatedTopology) {
+    auto t = numa::parseSpec("0-3;4-5,7");
+    EXPECT_TRUE(t.simulated);
+    ASSERT_EQ(t.nodes.size(), 2u);
+    EXPECT_EQ(t.nodes[0].cpus, (std::vector<int>{0, 1, 2, 3}));
+    EXPECT_EQ(t.nodes[1].cpus, (std::vector<int>{4, 5, 7}));
+    EXPECT_EQ(t.nodeOfCpu(5), 1);
+    EXPECT_EQ(t.nodeOfCpu(6), -1);
+    EXPECT_THROW(numa::parseSpec(""), std::invalid_argument);
+    EXPECT_THROW(numa::parseSpec("0-3;"), std::invalid_argument);
+    EXPECT_THROW(numa::parseSpec("0-3;x"), std::invalid_argument);
+}
+
+TEST_F(NumaPlacementTest, ReadsSysfsNodes) {
+    const fs::path root = fs::temp_directory_path() / ("numa-test-" + std::to_string(::getpid()));
+    fs::create_directories(root / "node0");
+    fs::create_directories(root / "node2");
+    fs::create_directories(root / "node3");  // sólo memoria (CXL): sin CPUs
+    fs::create_directories(root / "power");
+    std::ofstream(root / "node0" / "cpulist") << "0-7,16-23\n";
+    std::ofstream(root / "node2" / "cpulist") << "8-15\n";
+    std::ofstream(root / "node3" / "cpulist") << "\n";
+
+    auto t = numa::readSysfs(root.string());
+    fs::remove_all(root);
+    EXPECT_FALSE(t.simulated);
+    ASSERT_EQ(t.nodes.size(), 2u);
+    EXPECT_EQ(t.nodes[0].id, 0);
+    EXPECT_EQ(t.nodes[0].cpus.size(), 16u);
+    EXPECT_EQ(t.nodes[1].id, 2);
+    EXPECT_EQ(t.nodeOfCpu(9), 2);
+
+    EXPECT_EQ(numa::readSysfs("/nonexistent").nodes.size(), 1u); // sin sysfs: un nodo con todo
+}
+
+// ─── Reparto de sesiones ─────────────────────────────────────────────────────
+
+TEST_F(NumaPlacementTest, OffLeasesNothing) {
+    simulate(NumaPlacement::Mode::Off, 2);
+    EXPECT_EQ(NumaPlacement::instance().assign(), nullptr);
+}
+
+TEST_F(NumaPlacementTest, SessionsGoToTheLeastLoadedNode) {
+    simulate(NumaPlacement::Mode::Pin, 2);
+    auto a = NumaPlacement::instance().assign();
+    auto b = NumaPlacement::instance().assign();
+    auto c = NumaPlacement::instance().assign();
+    EXPECT_EQ(a->node(), 0);
+    EXPECT_EQ(b->node(), 1);
+    EXPECT_EQ(c->node(), 0);
+    EXPECT_EQ(b->replica(), 0); // pin: un solo modelo
+    a.reset();
+    c.reset();
+    EXPECT_EQ(NumaPlacement::instance().assign()->node(), 0);
+    EXPECT_NE(NumaPlacement::instance().getMetrics().find("transcription_numa_sessions{node=\"1\"} 1\n"),
+              std::string::npos);
+}
+
+TEST_F(NumaPlacementTest, ReplicateRoutesToTheNodeReplica) {
+    simulate(NumaPlacement::Mode::Replicate, 2);
+    auto a = NumaPlacement::instance().assign();
+    auto b = NumaPlacement::instance().assign();
+    EXPECT_EQ(a->replica(), 0);
+    EXPECT_EQ(b->replica(), 1);
+}
+
+// ─── Pinning y atribución ────────────────────────────────────────────────────
+
+TEST_F(NumaPlacementTest, PinnedThreadIsAttributedToItsNode) {
+    simulate(NumaPlacement::Mode::Pin, 2);
+    onThread([] {
+        EXPECT_EQ(NumaPlacement::pinnedNode(), -1);
+        NumaPlacement::instance().pinCurrentThread(1);
+        EXPECT_EQ(NumaPlacement::pinnedNode(), 1);
+        EXPECT_EQ(NumaPlacement::instance().currentNode(), 1);
+        EXPECT_EQ(numa::currentAffinity(), (std::vector<int>{0}));
+
+        // Los hilos creados después heredan la máscara (los workers de whisper).
+        std::thread([] { EXPECT_EQ(numa::currentAffinity(), (std::vector<int>{0})); }).join();
+    });
+}
+
+TEST_F(NumaPlacementTest, RemoteDecodesAreCounted) {
+    simulate(NumaPlacement::Mode::Pin, 2);
+    int model_on_0 = 0, unknown = 0;
+    NumaPlacement::instance().registerModel(&model_on_0, 0);
+    NumaPlacement::instance().registerModel(&unknown, -1);
+    onThread([&] {
+        NumaPlacement::instance().pinCurrentThread(1);
+        NumaPlacement::instance().recordDecode(&model_on_0, 2.0, 0.5); // remoto
+        NumaPlacement::instance().recordDecode(&unknown, 2.0, 0.5);    // sin nodo: no se sabe
+    });
+    onThread([&] {
+        NumaPlacement::instance().pinCurrentThread(0);
+        NumaPlacement::instance().recordDecode(&model_on_0, 1.0, 0.25); // local
+        NumaPlacement::instance().recordDecode(&model_on_0, 1.0, 0.25);
+    });
+    EXPECT_DOUBLE_EQ(NumaPlacement::instance().remoteRatio(), 0.25);
+
+    const std::string m = NumaPlacement::instance().getMetrics();
+    EXPECT_NE(m.find("transcription_numa_decodes_total{node=\"1\"} 2\n"), std::string::npos);
+    EXPECT_NE(m.find("transcription_numa_remote_decodes_total{node=\"1\"} 1\n"), std::string::npos);
+    EXPECT_NE(m.find("transcription_numa_audio_seconds_total{node=\"0\"} 2.0"), std::string::npos);
+    NumaPlacement::instance().unregisterModel(&model_on_0);
+    NumaPlacement::instance().unregisterModel(&unknown);
+}
+
+TEST_F(NumaPlacementTest, ScopedLoadRestoresThePreviousPin) {
+    simulate(NumaPlacement::Mode::Replicate, 2);
+    onThread([] {
+        const auto before = numa::currentAffinity();
+        {
+            NumaPlacement::ScopedLoad load(NumaPlacement::instance(), 1);
+            EXPECT_EQ(NumaPlacement::pinnedNode(), 1);
+            EXPECT_FALSE(load.memoryBound()); // topología simulada: sin política de memoria
+        }
+        EXPECT_EQ(NumaPlacement::pinnedNode(), -1);
+        EXPECT_EQ(numa::currentAffinity(), before);
+    });
+}
+
+TEST_F(NumaPlacementTest, ScopedPinRestoresTheThreadForTheNextRequest) {
+    simulate(NumaPlacement::Mode::Pin, 2);
+    onThread([] {
+        NumaPlacement::instance().pinCurrentThread(0); // fijado antes, p.ej. por otra subida
+        const auto before = numa::currentAffinity();
+        {
+            NumaPlacement::ScopedPin pin(NumaPlacement::instance(), 1);
+            EXPECT_EQ(NumaPlacement::pinnedNode(), 1);
+        }
+        EXPECT_EQ(NumaPlacement::pinnedNode(), 0);
+        EXPECT_EQ(numa::currentAffinity(), before);
+    });
+}
+
+TEST_F(NumaPlacementTest, UnknownModeThrows) {
+    EXPECT_EQ(NumaPlacement::parseMode("replicate"), NumaPlacement::Mode::Replicate);
+    EXPECT_THROW(NumaPlacement::parseMode("interleave"), std::invalid_argument);
+}
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include "whisper/OfflineTranscriber.h"
+#include "whisper/WhisperStatePool.h"
+#include "whisper/CancellationToken.h"
+#include "whisper/InferenceLimiter.h"
+#include <whisper.h>
+#include <cmath>
+#include <filesystem>
+
+#ifndef PROJECT_ROOT
+#define PROJECT_ROOT "."
+#endif
+
+const std::string OFFLINE_MODEL_PATH =
+    std::string(PROJECT_ROOT) + "/third_party/whisper.cpp/models/ggml-small.bin";
+
+class OfflineTranscriberTest : public ::testing::Test {
+protected:
+    whisper_context* ctx_ = nullptr;
+
+    void SetUp() override {
+        if (!std::filesystem::exists(OFFLINE_MODEL_PATH)) {
+            GTEST_SKIP() << "Model not found: " << OFFLINE_MODEL_PATH;
+        }
+        whisper_context_params p = whisper_context_default_params();
+        p.use_gpu    = true;
+        p.flash_attn = false; // CI/CPU safe
+        ctx_ = whisper_init_from_file_with_params(OFFLINE_MODEL_PATH.c_str(), p);
+        if (!ctx_) GTEST_SKIP() << "Failed to load model";
+    }
+
+    void TearDown() override {
+        if (ctx_) { whisper_free(ctx_); ctx_ = nullptr; }
+    }
+
+    // Tono de 300Hz con pausas de 1s cada 15s
+    static std::vector<float> toneWithPauses(float seconds) {
+        std::vector<float> v(static_cast<size_t>(seconds * 16000));
+        for (size_t i = 0; i < v.size(); ++i) {
+            bool pause = (i / 16000) % 16 == 15;
+            v[i] = pause ? 0.0f : 0.3f * sinf(2.0f * M_PI * 300.0f * i / 16000.0f);
+        }
+        return v;
+    }
+
+    static OfflineTranscriber::Options fastOptions() {
+        OfflineTranscriber::Options opts;
+        opts.decode.beam_size   = 1;
+        opts.decode.temperature = 0.0f;
+        opts.decode.language    = "en";
+        return opts;
+    }
+};
+
+// ─── WhisperStatePool ────────────────────────────────────────────────────────
+
+TEST(WhisperStatePoolBasic, NullContextThrows) {
+    EXPECT_THROW(WhisperStatePool pool(nullptr), std::runtime_error);
+}
+
+TEST_F(OfflineTranscriberTest, StatePoolReusesReleasedStates) {
+    WhisperStatePool pool(ctx_, 1);
+    whisper_state* a = pool.acquire();
+    pool.release(a);
+    EXPECT_EQ(pool.idleCount(), 1u);
+
+    whisper_state* b = pool.acquire();
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(pool.createdCount(), 1u);
+
+    whisper_state* c = pool.acquire();
+    EXPECT_EQ(pool.createdCount(), 2u);
+    pool.release(b);
+    pool.release(c); // over max_idle → freed
+    EXPECT_EQ(pool.idleCount(), 1u);
+}
+
+TEST(OfflineTranscriberParallelism, DefaultLeavesOneSlotToLiveSessions) {
+    auto& limiter = InferenceLimiter::instance();
+    const int saved = limiter.maxConcurrency();
+    limiter.setMaxConcurrency(4);
+    EXPECT_EQ(OfflineTranscriber::defaultParallelism(), 3);
+    limiter.setMaxConcurrency(1);
+    EXPECT_EQ(OfflineTranscriber::defaultParallelism(), 1); // nunca 0 workers
+    limiter.setMaxConcurrency(saved);
+}
+
+// ─── Transcripción ───────────────────────────────────────────────────────────
+
+TEST_F(OfflineTranscriberTest, SilenceIsNotDecoded) {
+    WhisperStatePool pool(ctx_);
+    OfflineTranscriber tr(pool, fastOptions());
+    auto res = tr.transcribe(std::vector<float>(16000 * 40, 0.0f));
+    EXPECT_GT(res.chunks, 0u);
+    EXPECT_EQ(res.chunks_decoded, 0u);
+    EXPECT_EQ(res.workers, 0);
+    EXPECT_TRUE(res.segments.empty());
+    EXPECT_EQ(pool.createdCount(), 0u);
+}
+
+TEST_F(OfflineTranscriberTest, SegmentsAreOrderedWithAbsoluteTimestamps) {
+    WhisperStatePool pool(ctx_);
+    auto opts = fastOptions();
+    opts.max_parallel = 2;
+    OfflineTranscriber tr(pool, opts);
+
+    auto pcm = toneWithPauses(64.0f);
+    auto res = tr.transcribe(pcm);
+
+    EXPECT_FALSE(res.cancelled);
+    EXPECT_DOUBLE_EQ(res.audio_seconds, 64.0);
+    EXPECT_GE(res.chunks, 3u);
+    EXPECT_LE(res.workers, 2);
+    EXPECT_LE(pool.createdCount(), 2u);
+
+    double prev_start = -1.0;
+    for (const auto& s : res.segments) {
+        EXPECT_GE(s.start, prev_start);
+        EXPECT_LE(s.start, s.end);
+        EXPECT_LE(s.start, res.audio_seconds);
+        prev_start = s.start;
+    }
+}
+
+TEST_F(OfflineTranscriberTest, CancelledTokenStopsBeforeDecoding) {
+    WhisperStatePool pool(ctx_);
+    OfflineTranscriber tr(pool, fastOptions());
+    CancellationToken cancel;
+    cancel.cancel();
+
+    auto res = tr.transcribe(toneWithPauses(30.0f), &cancel);
+    EXPECT_TRUE(res.cancelled);
+    EXPECT_TRUE(res.segments.empty());
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include "server/PartialCadence.h"
+#include "whisper/LoadEstimator.h"
+#include <chrono>
+
+using namespace std::chrono_literals;
+
+namespace {
+// Converge: varias actualizaciones con la misma entrada
+PartialCadence::ms settle(PartialCadence& c, double utilization, int rounds = 40) {
+    PartialCadence::ms s{0};
+    for (int i = 0; i < rounds; ++i) s = c.update(utilization);
+    return s;
+}
+} // namespace
+
+TEST(PartialCadenceTest, IdleBoxKeepsMinimumStride) {
+    PartialCadence c;
+    EXPECT_EQ(c.update(0.0), 250ms);
+    EXPECT_EQ(c.strideSamples(), 4000u); // 250ms @ 16kHz
+}
+
+TEST(PartialCadenceTest, StrideStretchesWithGlobalLoad) {
+    PartialCadence c;
+    EXPECT_EQ(settle(c, 0.5), 250ms);   // umbral: aún sin presión
+    EXPECT_EQ(settle(c, 0.7), 625ms);   // mitad del rango
+    EXPECT_EQ(settle(c, 0.95), 1000ms); // saturado → máximo
+}
+
+TEST(PartialCadenceTest, StretchingIsGradual) {
+    PartialCadence c;
+    auto first = c.update(1.0);
+    EXPECT_GT(first, 250ms);
+    EXPECT_LT(first, 1000ms); // no salta de golpe al máximo
+    auto second = c.update(1.0);
+    EXPECT_GT(second, first);
+}
+
+TEST(PartialCadenceTest, ShrinksBackSlowerThanItGrows) {
+    PartialCadence c;
+    settle(c, 1.0);
+    auto before = c.stride();
+    auto after_one = c.update(0.0);
+    EXPECT_LT(after_one, before);
+    // Crecer cierra el 50% de la distancia por paso; encoger solo el 20%
+    EXPECT_GT(after_one, 800ms);
+    EXPECT_EQ(settle(c, 0.0), 250ms);
+}
+
+TEST(PartialCadenceTest, SlowOwnDecodesStretchTheStride) {
+    PartialCadence c;
+    c.onDecode(0.3); // 300ms por parcial → con duty cycle 0.5, al menos 600ms
+    EXPECT_EQ(settle(c, 0.0), 600ms);
+}
+
+TEST(PartialCadenceTest, BusySlotBacksOff) {
+    PartialCadence c;
+    c.onBusy();
+    auto s = c.update(0.0);
+    EXPECT_GT(s, 250ms);
+    // Sin más rechazos vuelve al mínimo
+    EXPECT_EQ(settle(c, 0.0), 250ms);
+}
+
+TEST(PartialCadenceTest, StrideNeverExceedsBounds) {
+    PartialCadence c;
+    c.onDecode(10.0);
+    for (int i = 0; i < 20; ++i) {
+        c.onBusy();
+        EXPECT_LE(c.update(5.0), 1000ms);
+    }
+}
+
+TEST(PartialCadenceTest, MetricsReportAverageStride) {
+    // El singleton puede tener otras sesiones registradas: se comparan deltas.
+    auto& metrics = CadenceMetrics::instance();
+    const int64_t sessions = metrics.sessions();
+    const int64_t sum_ms = metrics.strideSumMs();
+    const int stretched = metrics.stretched();
+    {
+        PartialCadence a, b;
+        a.update(0.0);                 // 250ms
+        b.onDecode(0.5);
+        settle(b, 0.0);                // 1000ms
+        EXPECT_EQ(metrics.sessions() - sessions, 2);
+        EXPECT_EQ(metrics.strideSumMs() - sum_ms, 1250); // media de las dos: 0.625s
+        EXPECT_EQ(metrics.stretched() - stretched, 1);
+        EXPECT_NE(metrics.getMetrics().find("transcription_partial_stride_seconds "), std::string::npos);
+    }
+    // Las sesiones destruidas dejan de contar
+    EXPECT_EQ(metrics.sessions(), sessions);
+    EXPECT_EQ(metrics.strideSumMs(), sum_ms);
+    EXPECT_EQ(metrics.stretched(), stretched);
+}
+
+TEST(LoadEstimatorTest, CheapLoadMatchesSnapshot) {
+    LoadEstimator est(30s);
+    auto t0 = LoadEstimator::Clock::now();
+    for (int i = 0; i < 20; ++i) {
+        est.recordDecode(0.25, 0.0, true, t0 + std::chrono::milliseconds(500 * i));
+    }
+    auto now = t0 + 10s;
+    EXPECT_NEAR(est.load(now), est.snapshot(now).load, 1e-9);
+    EXPECT_DOUBLE_EQ(est.load(t0 + 60s), 0.0); // ventana vacía
+}
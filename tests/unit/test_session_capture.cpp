@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include "server/SessionCapture.h"
+#include "utils/CaptureFile.h"
+#include <unistd.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+class SessionCaptureTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = fs::temp_directory_path() / ("capture-test-" + std::to_string(::getpid()));
+        fs::create_directories(dir_);
+        CaptureWriter::Config cfg;
+        cfg.dir = dir_.string();
+        CaptureWriter::instance().configure(cfg);
+    }
+
+    void TearDown() override {
+        CaptureWriter::instance().drain();
+        CaptureWriter::instance().configure({});
+        fs::remove_all(dir_);
+    }
+
+    fs::path dir_;
+};
+
+// ─── Escritura y lectura ─────────────────────────────────────────────────────
+
+TEST_F(SessionCaptureTest, RecordsRoundTrip) {
+    std::string path;
+    {
+        auto cap = CaptureWriter::instance().open("s1");
+        ASSERT_NE(cap, nullptr);
+        path = cap->path();
+        const std::vector<float> pcm = {0.25f, -0.5f};
+        cap->textIn(R"({"type":"config"})");
+        cap->audioIn(pcm.data(), pcm.size() * sizeof(float));
+        cap->textOut(R"({"type":"ready"})");
+    } // el destructor entrega el resto del buffer
+    CaptureWriter::instance().drain();
+
+    auto file = capture::read(path);
+    EXPECT_FALSE(file.truncated);
+    ASSERT_EQ(file.records.size(), 4u);
+    EXPECT_EQ(file.records[0].type, capture::RecordType::Meta);
+    EXPECT_NE(file.records[0].payload.find("\"session_id\":\"s1\""), std::string::npos);
+    EXPECT_EQ(file.records[1].type, capture::RecordType::TextIn);
+    EXPECT_EQ(file.records[1].payload, R"({"type":"config"})");
+    EXPECT_EQ(file.records[2].type, capture::RecordType::AudioIn);
+    ASSERT_EQ(file.records[2].payload.size(), 2 * sizeof(float));
+    float second;
+    std::memcpy(&second, file.records[2].payload.data() + sizeof(float), sizeof(float));
+    EXPECT_FLOAT_EQ(second, -0.5f);
+    EXPECT_EQ(file.records[3].type, capture::RecordType::TextOut);
+    for (size_t i = 1; i < file.records.size(); ++i) {
+        EXPECT_GE(file.records[i].t_us, file.records[i - 1].t_us);
+    }
+}
+
+TEST_F(SessionCaptureTest, LargeSessionsAreWrittenInChunks) {
+    std::string path;
+    const std::vector<float> chunk(1600, 0.1f); // 100 ms
+    {
+        auto cap = CaptureWriter::instance().open("s2");
+        ASSERT_NE(cap, nullptr);
+        path = cap->path();
+        for (int i = 0; i < 100; ++i) cap->audioIn(chunk.data(), chunk.size() * sizeof(float));
+        CaptureWriter::instance().drain();
+        // Más de FLUSH_BYTES acumulados: ya hay datos en disco con la sesión abierta.
+        EXPECT_GT(fs::file_size(path), SessionCapture::FLUSH_BYTES);
+    }
+    CaptureWriter::instance().drain();
+    EXPECT_EQ(capture::read(path).records.size(), 101u);
+}
+
+TEST_F(SessionCaptureTest, DisabledCaptureOpensNothing) {
+    CaptureWriter::instance().configure({});
+    EXPECT_FALSE(CaptureWriter::instance().enabled());
+    EXPECT_EQ(CaptureWriter::instance().open("s3"), nullptr);
+}
+
+TEST_F(SessionCaptureTest, BacklogLimitAbandonsCapture) {
+    CaptureWriter::Config cfg;
+    cfg.dir = dir_.string();
+    cfg.max_queued_bytes = 16; // ni la cabecera cabe
+    CaptureWriter::instance().configure(cfg);
+
+    auto before = CaptureWriter::instance().getMetrics();
+    std::string path;
+    {
+        auto cap = CaptureWriter::instance().open("s4");
+        ASSERT_NE(cap, nullptr);
+        path = cap->path();
+        cap->textIn("{}");
+    }
+    CaptureWriter::instance().drain();
+    EXPECT_EQ(fs::file_size(path), 0u);
+    EXPECT_NE(CaptureWriter::instance().getMetrics(), before);
+}
+
+// ─── Formato ─────────────────────────────────────────────────────────────────
+
+TEST_F(SessionCaptureTest, TruncatedTailIsReported) {
+    std::string bytes(capture::MAGIC, sizeof(capture::MAGIC));
+    capture::appendRecord(bytes, capture::RecordType::TextIn, 7, "abc", 3);
+    std::string cut;
+    capture::appendRecord(cut, capture::RecordType::TextOut, 9, "defgh", 5);
+    bytes += cut.substr(0, cut.size() - 2); // escritura interrumpida
+
+    const auto path = (dir_ / "cut.cap").string();
+    std::ofstream(path, std::ios::binary) << bytes;
+
+    auto file = capture::read(path);
+    EXPECT_TRUE(file.truncated);
+    ASSERT_EQ(file.records.size(), 1u);
+    EXPECT_EQ(file.records[0].t_us, 7u);
+    EXPECT_EQ(file.records[0].payload, "abc");
+}
+
+TEST_F(SessionCaptureTest, NotACaptureThrows) {
+    const auto path = (dir_ / "bogus.cap").string();
+    std::ofstream(path, std::ios::binary) << "RIFF....WAVE";
+    EXPECT_THROW(capture::read(path), std::runtime_error);
+    EXPECT_THROW(capture::read((dir_ / "missing.cap").string()), std::runtime_error);
+}
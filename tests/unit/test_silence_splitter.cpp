@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include "utils/SilenceSplitter.h"
+#include <cmath>
+#include <vector>
+
+// Helper: "voz" = tono de 300Hz; silencio = ceros
+static void appendTone(std::vector<float>& v, float seconds, float amplitude = 0.3f) {
+    size_t n = static_cast<size_t>(seconds * 16000);
+    size_t base = v.size();
+    for (size_t i = 0; i < n; ++i)
+        v.push_back(amplitude * sinf(2.0f * M_PI * 300.0f * (base + i) / 16000.0f));
+}
+
+static void appendSilence(std::vector<float>& v, float seconds) {
+    v.insert(v.end(), static_cast<size_t>(seconds * 16000), 0.0f);
+}
+
+static void expectContiguous(const std::vector<SilenceSplitter::Chunk>& chunks, size_t total) {
+    size_t pos = 0;
+    for (const auto& c : chunks) {
+        EXPECT_EQ(c.offset, pos);
+        EXPECT_GT(c.length, 0u);
+        pos += c.length;
+    }
+    EXPECT_EQ(pos, total);
+}
+
+TEST(SilenceSplitter, EmptyInputHasNoChunks) {
+    EXPECT_TRUE(SilenceSplitter::split({}).empty());
+}
+
+TEST(SilenceSplitter, ShortAudioIsOneChunk) {
+    std::vector<float> pcm;
+    appendTone(pcm, 10.0f);
+    auto chunks = SilenceSplitter::split(pcm);
+    ASSERT_EQ(chunks.size(), 1u);
+    EXPECT_TRUE(chunks[0].speech);
+    expectContiguous(chunks, pcm.size());
+}
+
+TEST(SilenceSplitter, CutsInsideSilenceGap) {
+    std::vector<float> pcm;
+    appendTone(pcm, 18.0f);
+    appendSilence(pcm, 1.0f);   // gap at 18-19s
+    appendTone(pcm, 20.0f);
+
+    auto chunks = SilenceSplitter::split(pcm);
+    ASSERT_GE(chunks.size(), 2u);
+    expectContiguous(chunks, pcm.size());
+
+    // First cut lands in the middle of the gap
+    size_t cut = chunks[0].length;
+    EXPECT_GE(cut, 18u * 16000);
+    EXPECT_LE(cut, 19u * 16000);
+    EXPECT_NEAR(static_cast<double>(cut) / 16000.0, 18.5, 0.05);
+}
+
+TEST(SilenceSplitter, PrefersLongestSilence) {
+    std::vector<float> pcm;
+    appendTone(pcm, 8.0f);
+    appendSilence(pcm, 0.3f);   // short pause at 8s
+    appendTone(pcm, 6.0f);
+    appendSilence(pcm, 1.5f);   // long pause at ~14.3s
+    appendTone(pcm, 20.0f);
+
+    auto chunks = SilenceSplitter::split(pcm);
+    ASSERT_GE(chunks.size(), 2u);
+    double cut_s = static_cast<double>(chunks[0].length) / 16000.0;
+    EXPECT_GT(cut_s, 14.3);
+    EXPECT_LT(cut_s, 15.8);
+}
+
+TEST(SilenceSplitter, ContinuousSpeechRespectsMaxLength) {
+    std::vector<float> pcm;
+    appendTone(pcm, 70.0f);
+
+    SilenceSplitter::Options opt;
+    auto chunks = SilenceSplitter::split(pcm, opt);
+    ASSERT_GE(chunks.size(), 3u);
+    expectContiguous(chunks, pcm.size());
+    for (const auto& c : chunks) {
+        EXPECT_LE(c.length, opt.max_chunk_samples);
+    }
+    // Without pauses, cuts are made as late as allowed (not at min_chunk_samples)
+    EXPECT_GT(chunks[0].length, opt.max_chunk_samples - 16000);
+}
+
+TEST(SilenceSplitter, SilentChunksAreMarkedNonSpeech) {
+    std::vector<float> pcm;
+    appendTone(pcm, 20.0f);
+    appendSilence(pcm, 40.0f);
+
+    auto chunks = SilenceSplitter::split(pcm);
+    expectContiguous(chunks, pcm.size());
+    ASSERT_GE(chunks.size(), 2u);
+    EXPECT_TRUE(chunks.front().speech);
+    EXPECT_FALSE(chunks.back().speech);
+}
+
+TEST(SilenceSplitter, LowLevelNoiseCountsAsSilence) {
+    // Pausa con ruido de fondo (no silencio digital)
+    std::vector<float> pcm;
+    appendTone(pcm, 18.0f);
+    appendTone(pcm, 1.0f, 0.008f); // background noise only
+    appendTone(pcm, 18.0f);
+
+    auto chunks = SilenceSplitter::split(pcm);
+    ASSERT_GE(chunks.size(), 2u);
+    double cut_s = static_cast<double>(chunks[0].length) / 16000.0;
+    EXPECT_GE(cut_s, 18.0);
+    EXPECT_LE(cut_s, 19.0);
+}
@@ -10,6 +10,10 @@
 #include "server/SessionTracker.h"
 #include "whisper/ModelCache.h"
 #include "whisper/InferenceLimiter.h"
+#include "whisper/TranscriptionBackend.h"
+#include "server/SessionCapture.h"
+#include "utils/CaptureFile.h"
+#include <filesystem>
 #include <thread>
 #include <memory>
 #include <atomic>
@@ -74,6 +78,11 @@ protected:
     void SetUp() override {
         InferenceLimiter::instance().setMaxConcurrency(1);
         ModelCache::instance().configure(60);
+        // Motor sintético: los tests de sesión no necesitan el modelo.
+        MockTranscriptionEngine::Options mock;
+        mock.base_latency_ms = 5.0;
+        mock.latency_ms_per_audio_second = 1.0;
+        TranscriptionBackend::instance().configure(TranscriptionBackend::Kind::Mock, mock);
     }
 
     static void TearDownTestSuite() {
@@ -82,6 +91,7 @@ protected:
 
 
     void TearDown() override {
+        TranscriptionBackend::instance().configure(TranscriptionBackend::Kind::Whisper);
         // Stop acceptor and IO context
         if (acceptor_ && acceptor_->is_open()) {
             boost::system::error_code ec;
@@ -192,6 +202,36 @@ TEST_F(StreamingSessionTest, ValidConfigReturnsReady) {
     EXPECT_EQ(msg["config"]["language"], "es");
 }
 
+TEST_F(StreamingSessionTest, ReadyAdvertisesFlowControlCredits) {
+    auto port = startServer(false);
+    auto client = connect(port);
+    client.sendJson({{"type", "config"}, {"language", "es"}});
+    auto msg = client.recvJson();
+    ASSERT_EQ(msg["type"], "ready");
+    ASSERT_TRUE(msg.contains("flow_control"));
+    // Buffer vacío: el cliente puede enviar la ventana completa (20s @ 16kHz)
+    EXPECT_EQ(msg["flow_control"]["limit_samples"], StreamingWhisperEngine::HIGH_WATER_MARK_SAMPLES);
+    EXPECT_DOUBLE_EQ(msg["flow_control"]["window_seconds"].get<double>(), 20.0);
+}
+
+TEST_F(StreamingSessionTest, BulkModeIsEchoedInReady) {
+    auto port = startServer(false);
+    auto client = connect(port);
+    client.sendJson({{"type", "config"}, {"language", "es"}, {"mode", "bulk"}});
+    auto msg = client.recvJson();
+    ASSERT_EQ(msg["type"], "ready");
+    EXPECT_EQ(msg["config"]["mode"], "bulk");
+}
+
+TEST_F(StreamingSessionTest, InvalidModeIsRejected) {
+    auto port = startServer(false);
+    auto client = connect(port);
+    client.sendJson({{"type", "config"}, {"language", "es"}, {"mode", "turbo"}});
+    auto msg = client.recvJson();
+    EXPECT_EQ(msg["type"], "error");
+    EXPECT_EQ(msg["code"], "CONFIG_ERROR");
+}
+
 TEST_F(StreamingSessionTest, JsonWithoutType) {
     auto port = startServer(false);
     auto client = connect(port);
@@ -265,3 +305,140 @@ TEST_F(StreamingSessionTest, DoubleConfig) {
     EXPECT_EQ(msg2["type"], "ready");
     EXPECT_EQ(msg2["config"]["language"], "en");
 }
+
+// ─── Flujo completo con el motor sintético ───────────────────────────────────
+
+namespace {
+std::vector<unsigned char> silenceFrame(size_t samples) {
+    return std::vector<unsigned char>(samples * sizeof(float), 0);
+}
+} // namespace
+
+TEST_F(StreamingSessionTest, StreamedAudioProducesPartialsAndFinal) {
+    auto port = startServer(false);
+    auto client = connect(port);
+    client.sendJson({{"type", "config"}, {"language", "es"}});
+    ASSERT_EQ(client.recvJson()["type"], "ready");
+
+    // 3s en chunks de 250ms: supera el mínimo de 2s del flushLoop.
+    for (int i = 0; i < 12; ++i) client.sendBinary(silenceFrame(4000));
+
+    auto partial = client.recvJson();
+    ASSERT_EQ(partial["type"], "transcription");
+    EXPECT_FALSE(partial["is_final"]);
+    EXPECT_EQ(partial["text"].get<std::string>().rfind(" w0 w1 w2", 0), 0u);
+
+    client.sendJson({{"type", "end"}});
+    json msg;
+    do {
+        msg = client.recvJson();
+    } while (msg["type"] != "transcription" || !msg["is_final"].get<bool>());
+
+    // 48000 muestras = palabras w0..w7, sin importar cuántos parciales hubo.
+    EXPECT_EQ(msg["text"], MockTranscriptionEngine().textFor(0, 48000));
+}
+
+TEST_F(StreamingSessionTest, LongStreamCommitsEveryWordOnce) {
+    auto port = startServer(false);
+    auto client = connect(port);
+    client.sendJson({{"type", "config"}, {"language", "es"}});
+    ASSERT_EQ(client.recvJson()["type"], "ready");
+
+    // 14s en chunks de 1s: pasa la ventana de commit (10s); con o sin commits
+    // intermedios, cada palabra aparece una sola vez en el final.
+    for (int i = 0; i < 14; ++i) {
+        client.sendBinary(silenceFrame(16000));
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    client.sendJson({{"type", "end"}});
+
+    json msg;
+    do {
+        msg = client.recvJson();
+    } while (msg["type"] != "transcription" || !msg["is_final"].get<bool>());
+    EXPECT_EQ(msg["text"], MockTranscriptionEngine().textFor(0, 16000 * 14));
+}
+
+TEST_F(StreamingSessionTest, ReconfigUnderBusySlotDropsTheTierMark) {
+    auto& lim = InferenceLimiter::instance();
+    auto waiting = [&](int p) {
+        const std::string key = "transcription_inference_waiting{priority=\"" + std::to_string(p) + "\"} ";
+        const std::string m = lim.getMetrics();
+        return std::stoi(m.substr(m.find(key) + key.size()));
+    };
+    auto eventually = [](auto pred) {
+        const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!pred() && std::chrono::steady_clock::now() < until) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return pred();
+    };
+
+    auto port = startServer(false);
+    auto client = connect(port);
+    client.sendJson({{"type", "config"}, {"language", "es"}});
+    ASSERT_EQ(client.recvJson()["type"], "ready");
+
+    // Slot ocupado: el parcial (tier standard) queda marcado como waiter
+    auto holder = std::make_unique<InferenceLimiter::Guard>(InferenceLimiter::FINAL_PRIORITY);
+    for (int i = 0; i < 12; ++i) client.sendBinary(silenceFrame(4000));
+    ASSERT_TRUE(eventually([&] { return waiting(1) == 1; }));
+
+    // Re-config: buffer vacío, nada que decodificar — la marca no puede quedarse
+    client.sendJson({{"type", "config"}, {"language", "en"}});
+    ASSERT_EQ(client.recvJson()["type"], "ready");
+    EXPECT_TRUE(eventually([&] { return waiting(1) == 0; }));
+
+    holder.reset();
+    ASSERT_TRUE(lim.try_acquire(0)); // los tiers inferiores vuelven a tener slot
+    lim.release();
+}
+
+TEST_F(StreamingSessionTest, CaptureRecordsTheSessionWithoutItsToken) {
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::temp_directory_path() / ("session-capture-" + std::to_string(::getpid()));
+    fs::create_directories(dir);
+    CaptureWriter::Config cfg;
+    cfg.dir = dir.string();
+    CaptureWriter::instance().configure(cfg);
+
+    auto port = startServer(false);
+    {
+        auto client = connect(port);
+        client.sendJson({{"type", "config"}, {"language", "es"}, {"token", "secret-token"}});
+        ASSERT_EQ(client.recvJson()["type"], "ready");
+        client.sendBinary(silenceFrame(16000));
+        client.sendJson({{"type", "end"}});
+        json msg;
+        do {
+            msg = client.recvJson();
+        } while (msg["type"] != "transcription" || !msg["is_final"].get<bool>());
+    }
+
+    // El fichero se completa al destruirse la sesión (hilo del servidor).
+    std::vector<capture::Record> records;
+    for (int i = 0; i < 100 && records.size() < 6; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        CaptureWriter::instance().drain();
+        for (const auto& entry : fs::directory_iterator(dir)) {
+            if (fs::file_size(entry.path()) == 0) continue; // sesión aún abierta
+            records = capture::read(entry.path().string()).records;
+        }
+    }
+    CaptureWriter::instance().configure({});
+    fs::remove_all(dir);
+
+    // meta, config, audio, end (entrada) + ready, final (salida)
+    ASSERT_EQ(records.size(), 6u);
+    EXPECT_EQ(records[0].type, capture::RecordType::Meta);
+    EXPECT_EQ(records[1].type, capture::RecordType::TextIn);
+    EXPECT_EQ(records[1].payload.find("secret-token"), std::string::npos);
+    EXPECT_NE(records[1].payload.find("<redacted>"), std::string::npos);
+    size_t audio = 0, out = 0;
+    for (const auto& r : records) {
+        if (r.type == capture::RecordType::AudioIn) audio += r.payload.size();
+        if (r.type == capture::RecordType::TextOut) ++out;
+    }
+    EXPECT_EQ(audio, 16000 * sizeof(float));
+    EXPECT_EQ(out, 2u);
+}
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include "whisper/StreamingWhisperEngine.h"
+#include "whisper/CancellationToken.h"
+#include "whisper/EngineMetrics.h"
 #include <whisper.h>
 #include <filesystem>
 #include <thread>
@@ -110,6 +112,44 @@ TEST_F(StreamingWhisperEngineTest, TranscribeEmptyBufferReturnsEmpty) {
     EXPECT_TRUE(res.partial_text.empty());
 }
 
+// ─── Cancelación ─────────────────────────────────────────────────────────────
+
+TEST_F(StreamingWhisperEngineTest, CancelledTokenSkipsDecodeAndKeepsBuffer) {
+    StreamingWhisperEngine engine(ctx_);
+    engine.processAudioChunk(std::vector<float>(16000 * 3, 0.0f));
+
+    CancellationToken token;
+    token.cancel();
+    auto res = engine.transcribeSlidingWindow(true, &token);
+    EXPECT_TRUE(res.cancelled);
+    EXPECT_TRUE(res.committed_text.empty());
+    EXPECT_EQ(engine.getBufferSize(), static_cast<size_t>(16000 * 3)); // force commit not applied
+}
+
+TEST_F(StreamingWhisperEngineTest, ExpiredDeadlineCancelsDecode) {
+    StreamingWhisperEngine engine(ctx_);
+    engine.processAudioChunk(std::vector<float>(16000 * 3, 0.0f));
+
+    CancellationToken token;
+    token.setDeadline(CancellationToken::Clock::now() - std::chrono::milliseconds(1));
+    auto res = engine.transcribeSlidingWindow(false, &token);
+    EXPECT_TRUE(res.cancelled);
+}
+
+TEST_F(StreamingWhisperEngineTest, CancelFromAnotherThreadStopsDecode) {
+    StreamingWhisperEngine engine(ctx_);
+    engine.processAudioChunk(std::vector<float>(16000 * 10, 0.1f));
+
+    // Cancelado desde otro hilo antes de decodificar: determinista, sin depender
+    // de cuánto tarde el decode en esta máquina.
+    CancellationToken token;
+    std::thread canceller([&] { token.cancel(); });
+    canceller.join();
+    auto res = engine.transcribeSlidingWindow(false, &token);
+    EXPECT_TRUE(res.cancelled);
+    EXPECT_EQ(engine.getBufferSize(), static_cast<size_t>(16000 * 10)); // buffer intacto
+}
+
 // ─── Configuración ───────────────────────────────────────────────────────────
 
 TEST_F(StreamingWhisperEngineTest, SetLanguageDoesNotCrash) {
@@ -232,3 +272,111 @@ TEST_F(StreamingWhisperEngineTest, ProcessAudioChunkReturnsTrueConsecutivelyAtHW
     EXPECT_TRUE(engine.processAudioChunk(std::vector<float>(1600, 0.0f)));
     EXPECT_TRUE(engine.processAudioChunk(std::vector<float>(1600, 0.0f)));
 }
+
+// ─── Modo bulk ───────────────────────────────────────────────────────────────
+
+namespace {
+std::vector<float> tone(size_t samples, float freq = 440.0f) {
+    std::vector<float> v(samples);
+    for (size_t i = 0; i < samples; ++i) v[i] = 0.3f * std::sin(2.0f * 3.14159265f * freq * i / 16000.0f);
+    return v;
+}
+} // namespace
+
+TEST_F(StreamingWhisperEngineTest, BulkChunkCutsAtPauseAndDrainsIt) {
+    StreamingWhisperEngine engine(ctx_);
+    // 10s de señal + 1s de silencio + 8s de señal: el corte cae dentro de la pausa
+    engine.processAudioChunk(tone(16000 * 10));
+    engine.processAudioChunk(std::vector<float>(16000, 0.0f));
+    engine.processAudioChunk(tone(16000 * 8));
+    ASSERT_EQ(engine.getBufferSize(), 16000u * 19);
+
+    auto res = engine.transcribeBulkChunk();
+    EXPECT_FALSE(res.cancelled);
+    EXPECT_TRUE(res.partial_text.empty()); // bulk: todo se confirma
+    EXPECT_GE(engine.getBufferSize(), 16000u * 8);
+    EXPECT_LE(engine.getBufferSize(), 16000u * 9);
+}
+
+TEST_F(StreamingWhisperEngineTest, BulkChunkSkipsSilenceWithoutDecoding) {
+    StreamingWhisperEngine engine(ctx_);
+    engine.processAudioChunk(std::vector<float>(16000 * 19, 0.0f));
+
+    auto res = engine.transcribeBulkChunk();
+    EXPECT_TRUE(res.committed_text.empty());
+    EXPECT_LT(engine.getBufferSize(), 16000u * 19);
+}
+
+TEST_F(StreamingWhisperEngineTest, BulkChunkCancelledLeavesBufferIntact) {
+    StreamingWhisperEngine engine(ctx_);
+    engine.processAudioChunk(tone(16000 * 19));
+    CancellationToken token;
+    token.cancel();
+
+    auto res = engine.transcribeBulkChunk(&token);
+    EXPECT_TRUE(res.cancelled);
+    EXPECT_EQ(engine.getBufferSize(), 16000u * 19);
+}
+
+// ─── Reutilización del último parcial como final ─────────────────────────────
+
+TEST_F(StreamingWhisperEngineTest, FreshPartialIsReusedAsFinal) {
+    StreamingWhisperEngine engine(ctx_);
+    engine.processAudioChunk(tone(16000 * 3));
+    auto partial = engine.transcribeSlidingWindow(false);
+    ASSERT_FALSE(partial.cancelled);
+
+    auto final_text = engine.takeFreshHypothesis();
+    ASSERT_TRUE(final_text.has_value());
+    EXPECT_EQ(*final_text, partial.partial_text);
+    EXPECT_EQ(engine.getBufferSize(), 0u); // como un force commit
+    EXPECT_FALSE(engine.takeFreshHypothesis().has_value()); // se consume una sola vez
+}
+
+TEST_F(StreamingWhisperEngineTest, NewAudioInvalidatesHypothesis) {
+    StreamingWhisperEngine engine(ctx_);
+    engine.processAudioChunk(tone(16000 * 3));
+    engine.transcribeSlidingWindow(false);
+    engine.processAudioChunk(tone(1600));
+
+    EXPECT_FALSE(engine.takeFreshHypothesis().has_value());
+    EXPECT_EQ(engine.getBufferSize(), 16000u * 3 + 1600); // el buffer queda para el final
+}
+
+TEST_F(StreamingWhisperEngineTest, NoHypothesisWithoutPartialOrAfterCancel) {
+    StreamingWhisperEngine engine(ctx_);
+    engine.processAudioChunk(tone(16000 * 3));
+    EXPECT_FALSE(engine.takeFreshHypothesis().has_value());
+
+    CancellationToken token;
+    token.cancel();
+    engine.transcribeSlidingWindow(false, &token);
+    EXPECT_FALSE(engine.takeFreshHypothesis().has_value());
+}
+
+// ─── Caché de la última ventana decodificada ─────────────────────────────────
+
+TEST_F(StreamingWhisperEngineTest, UnchangedWindowReusesLastDecode) {
+    StreamingWhisperEngine engine(ctx_);
+    engine.processAudioChunk(tone(16000 * 3));
+    auto first = engine.transcribeSlidingWindow(false);
+
+    uint64_t hits = EngineMetrics::instance().decodeCacheHits();
+    auto second = engine.transcribeSlidingWindow(false);
+    EXPECT_EQ(EngineMetrics::instance().decodeCacheHits(), hits + 1);
+    EXPECT_EQ(second.partial_text, first.partial_text);
+    EXPECT_EQ(second.committed_text, first.committed_text);
+}
+
+TEST_F(StreamingWhisperEngineTest, ChangedWindowDecodesAgain) {
+    StreamingWhisperEngine engine(ctx_);
+    engine.processAudioChunk(tone(16000 * 3));
+    engine.transcribeSlidingWindow(false);
+
+    uint64_t hits = EngineMetrics::instance().decodeCacheHits();
+    engine.processAudioChunk(tone(1600));
+    engine.transcribeSlidingWindow(false);
+    engine.setInitialPrompt("otro contexto"); // nuevos parámetros: tampoco vale la caché
+    engine.transcribeSlidingWindow(false);
+    EXPECT_EQ(EngineMetrics::instance().decodeCacheHits(), hits);
+}
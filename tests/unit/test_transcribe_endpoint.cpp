@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+#include "server/TranscribeEndpoint.h"
+#include "server/AdmissionController.h"
+#include "server/AuthManager.h"
+#include "server/MemoryBudget.h"
+#include "whisper/ModelCache.h"
+#include <nlohmann/json.hpp>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+
+#ifndef PROJECT_ROOT
+#define PROJECT_ROOT "."
+#endif
+
+namespace http = boost::beast::http;
+using json = nlohmann::json;
+
+const std::string ENDPOINT_MODEL_PATH =
+    std::string(PROJECT_ROOT) + "/third_party/whisper.cpp/models/ggml-small.bin";
+
+static TranscribeEndpoint::Request makeRequest(const std::string& target, const std::string& body,
+                                               http::verb method = http::verb::post) {
+    TranscribeEndpoint::Request req{method, target, 11};
+    req.body() = body;
+    req.prepare_payload();
+    return req;
+}
+
+static std::string f32Body(const std::vector<float>& v) {
+    std::string s(v.size() * 4, '\0');
+    std::memcpy(&s[0], v.data(), s.size());
+    return s;
+}
+
+static TranscribeEndpoint makeEndpoint(const std::string& token = "",
+                                       const std::string& model = "/nonexistent/model.bin") {
+    ApiAuthConfig auth;
+    auth.static_token = token;
+    TranscribeEndpoint::Config cfg;
+    cfg.model_path = model;
+    cfg.decode.beam_size = 1;
+    cfg.decode.temperature = 0.0f;
+    return TranscribeEndpoint(cfg, std::make_shared<AuthManager>(auth));
+}
+
+static std::string errorCode(const TranscribeEndpoint::Response& res) {
+    return json::parse(res.body()).value("code", "");
+}
+
+// ─── Routing y query string ──────────────────────────────────────────────────
+
+TEST(TranscribeEndpoint, MatchesPathIgnoringQuery) {
+    EXPECT_TRUE(TranscribeEndpoint::matches("/v1/transcribe"));
+    EXPECT_TRUE(TranscribeEndpoint::matches("/v1/transcribe?language=en"));
+    EXPECT_FALSE(TranscribeEndpoint::matches("/v1/transcribe/x"));
+    EXPECT_FALSE(TranscribeEndpoint::matches("/metrics"));
+}
+
+TEST(TranscribeEndpoint, QueryParamParsing) {
+    const char* t = "/v1/transcribe?language=en&encoding=s16le&flag";
+    EXPECT_EQ(TranscribeEndpoint::queryParam(t, "language"), "en");
+    EXPECT_EQ(TranscribeEndpoint::queryParam(t, "encoding"), "s16le");
+    EXPECT_EQ(TranscribeEndpoint::queryParam(t, "flag"), "");
+    EXPECT_EQ(TranscribeEndpoint::queryParam(t, "lang"), "");
+    EXPECT_EQ(TranscribeEndpoint::queryParam("/v1/transcribe", "language"), "");
+}
+
+// ─── Validación ──────────────────────────────────────────────────────────────
+
+TEST(TranscribeEndpoint, RejectsNonPost) {
+    auto res = makeEndpoint().handle(makeRequest("/v1/transcribe", "", http::verb::get));
+    EXPECT_EQ(res.result(), http::status::method_not_allowed);
+    EXPECT_EQ(res[http::field::allow], "POST");
+}
+
+TEST(TranscribeEndpoint, RequiresTokenWhenAuthEnabled) {
+    auto ep = makeEndpoint("secret");
+    auto body = f32Body({0.1f, 0.2f});
+
+    auto res = ep.handle(makeRequest("/v1/transcribe", body));
+    EXPECT_EQ(res.result(), http::status::unauthorized);
+    EXPECT_EQ(errorCode(res), "AUTH_REQUIRED");
+
+    auto req = makeRequest("/v1/transcribe", body);
+    req.set(http::field::authorization, "Bearer wrong");
+    res = ep.handle(req);
+    EXPECT_EQ(res.result(), http::status::unauthorized);
+    EXPECT_EQ(errorCode(res), "AUTH_FAILED");
+
+    // Valid token passes auth (and then fails on the missing model, not on auth)
+    req = makeRequest("/v1/transcribe", body);
+    req.set("X-API-Key", "secret");
+    res = ep.handle(req);
+    EXPECT_NE(res.result(), http::status::unauthorized);
+}
+
+TEST(TranscribeEndpoint, PrecheckRejectsBeforeTheBodyIsRead) {
+    auto ep = makeEndpoint("secret");
+    TranscribeEndpoint::Request head{http::verb::post, "/v1/transcribe", 11}; // solo cabeceras
+
+    auto res = ep.precheck(head);
+    ASSERT_TRUE(res.has_value());
+    EXPECT_EQ(errorCode(*res), "AUTH_REQUIRED");
+
+    head.set(http::field::authorization, "Bearer wrong");
+    ASSERT_TRUE(ep.precheck(head).has_value());
+
+    head.set(http::field::authorization, "Bearer secret");
+    EXPECT_FALSE(ep.precheck(head).has_value());               // se puede leer el body
+
+    TranscribeEndpoint::Request get{http::verb::get, "/v1/transcribe", 11};
+    get.set(http::field::authorization, "Bearer secret");
+    res = ep.precheck(get);
+    ASSERT_TRUE(res.has_value());
+    EXPECT_EQ(res->result(), http::status::method_not_allowed);
+}
+
+TEST(TranscribeEndpoint, PrecheckShedsAnOverloadedNodeBeforeTheBody) {
+    // Un p90 de 1s con un SLO de 1ms: el nodo rechaza sin esperar al body
+    AdmissionController::Config cfg;
+    cfg.partial_latency_slo_ms = 1;
+    cfg.min_samples = 1;
+    cfg.retry_after_seconds = 3;
+    AdmissionController::instance().configure(cfg);
+    LoadEstimator::instance().recordDecode(0.5, 1.0, true);
+
+    TranscribeEndpoint::Request head{http::verb::post, "/v1/transcribe", 11};
+    auto res = makeEndpoint().precheck(head);
+    AdmissionController::instance().configure({});
+    LoadEstimator::instance().reset();
+
+    ASSERT_TRUE(res.has_value());
+    EXPECT_EQ(res->result(), http::status::service_unavailable);
+    EXPECT_EQ(errorCode(*res), "OVERLOADED");
+    EXPECT_EQ((*res)[http::field::retry_after], "3");
+    EXPECT_FALSE(makeEndpoint().precheck(head).has_value()); // sin carga, se lee el body
+}
+
+TEST(TranscribeEndpoint, RejectsBadAudio) {
+    auto ep = makeEndpoint();
+    EXPECT_EQ(errorCode(ep.handle(makeRequest("/v1/transcribe", ""))), "EMPTY_AUDIO");
+    EXPECT_EQ(errorCode(ep.handle(makeRequest("/v1/transcribe", "abc"))), "EMPTY_AUDIO");
+    EXPECT_EQ(errorCode(ep.handle(makeRequest("/v1/transcribe?encoding=mp3", "abcd"))), "INVALID_AUDIO");
+
+    std::string broken_wav("RIFF\x04\x00\x00\x00WAVE", 12); // header only, no chunks
+    auto res = ep.handle(makeRequest("/v1/transcribe", broken_wav));
+    EXPECT_EQ(res.result(), http::status::bad_request);
+    EXPECT_EQ(errorCode(res), "INVALID_AUDIO");
+}
+
+TEST(TranscribeEndpoint, RejectsUnknownLanguage) {
+    auto res = makeEndpoint().handle(makeRequest("/v1/transcribe?language=xx", f32Body({0.1f})));
+    EXPECT_EQ(res.result(), http::status::bad_request);
+    EXPECT_EQ(errorCode(res), "INVALID_LANGUAGE");
+}
+
+TEST(TranscribeEndpoint, MissingModelIsServiceUnavailable) {
+    auto res = makeEndpoint().handle(makeRequest("/v1/transcribe", f32Body({0.1f, 0.2f})));
+    EXPECT_EQ(res.result(), http::status::service_unavailable);
+    EXPECT_EQ(errorCode(res), "MODEL_UNAVAILABLE");
+}
+
+TEST(TranscribeEndpoint, UploadOverMemoryBudgetIsRefusedBeforeDecoding) {
+    // Presupuesto de 1 MB: no cabe ni un estado de decodificación (estimado ≥ 64 MB)
+    MemoryBudget::Config cfg;
+    cfg.budget_bytes = 1u << 20;
+    cfg.retry_after_seconds = 7;
+    MemoryBudget::instance().configure(cfg);
+
+    auto res = makeEndpoint().handle(makeRequest("/v1/transcribe", f32Body({0.1f, 0.2f})));
+    MemoryBudget::instance().configure({});
+    EXPECT_EQ(res.result(), http::status::service_unavailable);
+    EXPECT_EQ(errorCode(res), "OVERLOADED"); // antes de cargar el modelo: no MODEL_UNAVAILABLE
+    EXPECT_EQ(res[http::field::retry_after], "7");
+    EXPECT_EQ(MemoryBudget::instance().charged(), 0u); // nada queda reservado
+}
+
+// ─── Transcripción completa (requiere modelo) ────────────────────────────────
+
+TEST(TranscribeEndpoint, TranscribesRawPcm) {
+    if (!std::filesystem::exists(ENDPOINT_MODEL_PATH)) {
+        GTEST_SKIP() << "Model not found: " << ENDPOINT_MODEL_PATH;
+    }
+    ModelCache::instance().forceUnload();
+
+    std::vector<float> pcm(16000 * 5);
+    for (size_t i = 0; i < pcm.size(); ++i) pcm[i] = 0.3f * sinf(2.0f * M_PI * 300.0f * i / 16000.0f);
+
+    auto res = makeEndpoint("", ENDPOINT_MODEL_PATH).handle(makeRequest("/v1/transcribe?language=en", f32Body(pcm)));
+    ASSERT_EQ(res.result(), http::status::ok) << res.body();
+
+    auto body = json::parse(res.body());
+    EXPECT_EQ(body["language"], "en");
+    EXPECT_DOUBLE_EQ(body["duration"].get<double>(), 5.0);
+    EXPECT_TRUE(body["segments"].is_array());
+    EXPECT_TRUE(body.contains("text"));
+    EXPECT_EQ(ModelCache::instance().refCount(), 0);
+
+    ModelCache::instance().forceUnload();
+}